@@ -0,0 +1,271 @@
+"""Export trained policies for on-device inference with the Sim-SDK.
+
+Writes the ``.rrlp`` layout described in ``sdk-sim/include/rrl_policy_format.h``
+so that the C++ SDK can load a policy with ``rrl_load_policy_file`` and run it
+in place with ``rrl_act_batch``. Only feed-forward MLP and small CNN policies
+are supported (dense / valid-padding conv layers with ReLU or Tanh).
+
+**Usage:** ``export_sb3(model, "policy.rrlp")`` for a Stable-Baselines3 model,
+or build the layer list yourself with :func:`dense` / :func:`conv2d` and call
+:func:`write_policy`.
+"""
+from __future__ import annotations
+
+import struct
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any, List, Sequence, Tuple, Union
+
+import numpy as np
+
+# -----------------------------------------------------------------------------
+# 1. Format constants (mirror rrl_policy_format.h / rrl_env.h)
+# -----------------------------------------------------------------------------
+
+POLICY_MAGIC = 0x504C5252          # "RRLP"
+POLICY_VERSION = 2
+POLICY_ALIGN = 64
+
+LAYER_DENSE, LAYER_CONV2D = 0, 1
+ACTIVATIONS = {"none": 0, "relu": 1, "tanh": 2}
+OUTPUTS = {"argmax": 0, "continuous": 1}
+DTYPE_FLOAT32, DTYPE_UINT8, DTYPE_INT8, DTYPE_FLOAT16 = 0, 4, 5, 6
+WEIGHT_DTYPES = {"float32": DTYPE_FLOAT32, "float16": DTYPE_FLOAT16, "int8": DTYPE_INT8}
+
+_HEADER = struct.Struct("<4I i 3I 2f 6I")            # 64 bytes
+_LAYER = struct.Struct("<2I 3I 3I 2I i I 2Q 2Q")      # 80 bytes
+assert _HEADER.size == 64 and _LAYER.size == 80
+
+
+@dataclass
+class Layer:
+    """One layer already converted to the SDK layout (weights K×N, float32).
+
+    Quantisation to the file's ``weight_dtype`` happens in :func:`write_policy`.
+    """
+
+    kind: int
+    weight: np.ndarray
+    bias: np.ndarray
+    activation: str = "none"
+    kernel: int = 0
+    stride: int = 0
+
+
+def _to_numpy(x: Any) -> np.ndarray:
+    """Accept numpy arrays or torch tensors."""
+    if hasattr(x, "detach"):
+        x = x.detach().cpu().numpy()
+    return np.asarray(x, dtype=np.float32)
+
+
+def dense(weight: Any, bias: Any, activation: str = "none") -> Layer:
+    """Dense layer from a PyTorch-style ``(out, in)`` weight matrix."""
+    w = _to_numpy(weight)
+    if w.ndim != 2:
+        raise ValueError(f"dense weight must be 2-D, got shape {w.shape}")
+    return Layer(LAYER_DENSE, np.ascontiguousarray(w.T), _to_numpy(bias), activation)
+
+
+def conv2d(weight: Any, bias: Any, stride: int = 1, activation: str = "none") -> Layer:
+    """Valid-padding conv from a PyTorch-style ``(out_c, in_c, k, k)`` weight."""
+    w = _to_numpy(weight)
+    if w.ndim != 4 or w.shape[2] != w.shape[3]:
+        raise ValueError(f"conv2d weight must be (out_c, in_c, k, k), got shape {w.shape}")
+    out_c, in_c, k, _ = w.shape
+    # (out_c, in_c, ky, kx) -> (ky, kx, in_c, out_c) -> K×N with K ordered (ky, kx, c)
+    w = np.ascontiguousarray(w.transpose(2, 3, 1, 0).reshape(k * k * in_c, out_c))
+    return Layer(LAYER_CONV2D, w, _to_numpy(bias), activation, kernel=k, stride=int(stride))
+
+
+# -----------------------------------------------------------------------------
+# 2. Writer
+# -----------------------------------------------------------------------------
+
+def _align(n: int, align: int = POLICY_ALIGN) -> int:
+    return (n + align - 1) // align * align
+
+
+def _quantize(weight: np.ndarray, weight_dtype: str) -> Tuple[bytes, Union[bytes, None]]:
+    """Encode a K×N float32 matrix; int8 also returns per-column float32 scales."""
+    if weight_dtype == "float16":
+        return np.ascontiguousarray(weight, dtype="<f2").tobytes(), None
+    if weight_dtype == "int8":
+        # Symmetric per-output-column scale: W[:, j] ~= q[:, j] * scale[j].
+        scale = np.abs(weight).max(axis=0) / 127.0
+        scale = np.where(scale > 0, scale, 1.0).astype(np.float32)
+        q = np.clip(np.rint(weight / scale), -127, 127).astype(np.int8)
+        return np.ascontiguousarray(q).tobytes(), scale.astype("<f4").tobytes()
+    return np.ascontiguousarray(weight, dtype="<f4").tobytes(), None
+
+
+def write_policy(
+    path: Union[str, Path],
+    layers: Sequence[Layer],
+    input_shape: Tuple[int, ...],
+    *,
+    input_dtype: str = "float32",
+    input_scale: float = 1.0,
+    input_offset: float = 0.0,
+    output: str = "argmax",
+    chw_input: bool = True,
+    weight_dtype: str = "float32",
+    weight_align: int = POLICY_ALIGN,
+) -> Path:
+    """Serialise ``layers`` into an ``.rrlp`` file.
+
+    Args:
+        path: Destination file.
+        layers: Layers in execution order (see :func:`dense`, :func:`conv2d`).
+        input_shape: Observation shape as the trainer sees it: ``(features,)``
+            for vectors, ``(C, H, W)`` for images when ``chw_input`` is true or
+            ``(H, W, C)`` otherwise. The SDK always consumes HWC.
+        input_dtype: ``"float32"`` or ``"uint8"`` (raw observation dtype).
+        input_scale, input_offset: Applied on device as ``x * scale + offset``
+            (e.g. ``1/255`` for SB3 image policies).
+        output: ``"argmax"`` (discrete, int32 per env) or ``"continuous"``.
+        chw_input: Whether image ``input_shape`` is channel-first.
+        weight_dtype: ``"float32"``, ``"float16"`` or ``"int8"`` (symmetric,
+            one scale per output column). Biases always stay float32.
+        weight_align: Byte alignment of every blob; a power of two >= 4.
+
+    Returns:
+        Path: The written file.
+
+    Raises:
+        ValueError: If layer shapes do not chain or an option is unknown.
+    """
+    if input_dtype not in ("float32", "uint8"):
+        raise ValueError(f"unsupported input_dtype {input_dtype!r}")
+    if output not in OUTPUTS:
+        raise ValueError(f"unknown output kind {output!r}")
+    if weight_dtype not in WEIGHT_DTYPES:
+        raise ValueError(f"unsupported weight_dtype {weight_dtype!r}")
+    if weight_align < 4 or weight_align & (weight_align - 1):
+        raise ValueError(f"weight_align must be a power of two >= 4, got {weight_align}")
+    if len(input_shape) == 1:
+        dims = (1, 1, int(input_shape[0]))
+    elif len(input_shape) == 3:
+        c, h, w = input_shape if chw_input else (input_shape[2], input_shape[0], input_shape[1])
+        dims = (int(h), int(w), int(c))
+    else:
+        raise ValueError(f"input_shape must be 1-D or 3-D, got {input_shape}")
+
+    table_end = _HEADER.size + _LAYER.size * len(layers)
+    offset = _align(table_end, weight_align)
+    entries: List[bytes] = []
+    blobs: List[Tuple[int, bytes]] = []
+    cur = dims
+    # Whether the trainer flattens the current tensor in CHW order (PyTorch
+    # conv outputs and channel-first image inputs); the SDK flattens HWC.
+    torch_chw = len(input_shape) == 3 and chw_input
+    for i, layer in enumerate(layers):
+        if layer.activation not in ACTIVATIONS:
+            raise ValueError(f"layer {i}: unknown activation {layer.activation!r}")
+        weight = layer.weight
+        k_rows, n_out = weight.shape
+        if layer.kind == LAYER_CONV2D:
+            h, w, c = cur
+            if k_rows != layer.kernel * layer.kernel * c:
+                raise ValueError(f"layer {i}: conv expects {c} input channels")
+            out = ((h - layer.kernel) // layer.stride + 1,
+                   (w - layer.kernel) // layer.stride + 1, n_out)
+            torch_chw = True
+        else:
+            if k_rows != cur[0] * cur[1] * cur[2]:
+                raise ValueError(f"layer {i}: dense expects {k_rows} inputs, got {cur}")
+            if torch_chw and (cur[0] > 1 or cur[1] > 1):
+                h, w, c = cur   # reorder input rows from CHW to HWC
+                weight = weight.reshape(c, h, w, n_out).transpose(1, 2, 0, 3).reshape(k_rows, n_out)
+            torch_chw = False
+            out = (1, 1, n_out)
+        w_data, s_data = _quantize(weight, weight_dtype)
+        w_off = offset
+        offset = _align(w_off + len(w_data), weight_align)
+        blobs.append((w_off, w_data))
+        s_off = 0
+        if s_data is not None:
+            s_off = offset
+            offset = _align(s_off + len(s_data), weight_align)
+            blobs.append((s_off, s_data))
+        b_off = offset
+        offset = _align(b_off + n_out * 4, weight_align)
+        blobs.append((b_off, np.ascontiguousarray(layer.bias, dtype="<f4").tobytes()))
+        entries.append(_LAYER.pack(
+            layer.kind, ACTIVATIONS[layer.activation], *cur, *out,
+            layer.kernel, layer.stride, WEIGHT_DTYPES[weight_dtype], 0, w_off, b_off, s_off, 0))
+        cur = out
+
+    header = _HEADER.pack(
+        POLICY_MAGIC, POLICY_VERSION, len(layers), OUTPUTS[output],
+        DTYPE_UINT8 if input_dtype == "uint8" else DTYPE_FLOAT32, *dims,
+        float(input_scale), float(input_offset), weight_align, *([0] * 5))
+
+    buf = bytearray(offset)
+    buf[:_HEADER.size] = header
+    buf[_HEADER.size:table_end] = b"".join(entries)
+    for off, data in blobs:
+        buf[off:off + len(data)] = data
+    path = Path(path)
+    path.write_bytes(bytes(buf))
+    return path
+
+
+# -----------------------------------------------------------------------------
+# 3. Framework adapters
+# -----------------------------------------------------------------------------
+
+def layers_from_torch(modules: Sequence[Any]) -> List[Layer]:
+    """Convert a flat list of ``torch.nn`` modules (Linear/Conv2d/ReLU/Tanh/Flatten)."""
+    import torch.nn as nn  # lazily: torch is only needed for this adapter
+
+    layers: List[Layer] = []
+    for m in modules:
+        if isinstance(m, nn.Linear):
+            layers.append(dense(m.weight, m.bias))
+        elif isinstance(m, nn.Conv2d):
+            if m.padding not in (0, (0, 0)) or m.dilation not in (1, (1, 1)) or m.groups != 1:
+                raise ValueError("only valid-padding, undilated, ungrouped Conv2d is supported")
+            stride = m.stride[0] if isinstance(m.stride, tuple) else m.stride
+            layers.append(conv2d(m.weight, m.bias, stride=stride))
+        elif isinstance(m, (nn.ReLU, nn.Tanh)):
+            if not layers or layers[-1].activation != "none":
+                raise ValueError(f"activation {type(m).__name__} must follow a Linear/Conv2d")
+            layers[-1].activation = "relu" if isinstance(m, nn.ReLU) else "tanh"
+        elif isinstance(m, (nn.Flatten, nn.Identity, nn.Sequential)):  # empty containers too
+            continue
+        else:
+            raise ValueError(f"unsupported module {type(m).__name__}")
+    return layers
+
+
+def _leaves(module: Any) -> List[Any]:
+    children = list(module.children())
+    return [module] if not children else [leaf for c in children for leaf in _leaves(c)]
+
+
+def export_sb3(model: Any, path: Union[str, Path], weight_dtype: str = "float32") -> Path:
+    """Export the deterministic actor of a Stable-Baselines3 on-policy model.
+
+    Supports ``MlpPolicy`` / ``CnnPolicy`` with ``Discrete`` (argmax) or
+    ``Box`` (mean action) action spaces, without a shared features/value split
+    beyond the default extractor. ``weight_dtype`` is forwarded to
+    :func:`write_policy` (``"float16"`` / ``"int8"`` shrink the file 2x / 4x).
+    """
+    import gymnasium as gym
+
+    policy = model.policy
+    modules = _leaves(policy.features_extractor)
+    modules += _leaves(policy.mlp_extractor.policy_net)
+    modules += _leaves(policy.action_net)
+    obs_space = policy.observation_space
+    is_image = len(obs_space.shape) == 3
+    uint8 = is_image and obs_space.dtype == np.uint8
+    output = "argmax" if isinstance(policy.action_space, gym.spaces.Discrete) else "continuous"
+    return write_policy(
+        path, layers_from_torch(modules), tuple(obs_space.shape),
+        input_dtype="uint8" if uint8 else "float32",
+        input_scale=(1.0 / 255.0) if uint8 and policy.normalize_images else 1.0,
+        output=output,
+        weight_dtype=weight_dtype,
+    )
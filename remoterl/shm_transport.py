@@ -0,0 +1,292 @@
+"""Trainer side of the same-host shared-memory transport.
+
+Attaches to the segment a co-located simulator created with
+``rrl_shm_create`` (``sdk-sim/include/rrl_shm.h``) and moves wire frames
+(:mod:`remoterl.wire_format`) through its per-env rings instead of the
+cloud relay: ``STEP`` frames arrive on channel ``i``'s UP ring, ``ACTION``
+replies go back on its DOWN ring.
+
+**Usage:** ``for name in discover(api_key): shm = ShmSession.attach(name)``,
+then ``frame = shm.read(i)`` / ``shm.write(i, write_action(...))`` per env
+and ``shm.close()``. :func:`discover` returns nothing when no simulator with
+that key runs on this host, so callers fall back to the relay.
+
+Linux on x86-64 only (``/dev/shm`` listing, futex wake-ups). Python cannot
+issue acquire / release barriers, so head and tail are plain aligned 8-byte
+stores and loads; that publishes a frame safely only under x86-64's total
+store order, where the payload stores land before the head store and the
+head load comes before the payload loads. On weakly ordered CPUs (arm64)
+:data:`SUPPORTED` is false, :func:`discover` finds nothing and callers stay
+on the relay. This side always makes the wake-up syscall after publishing
+(the C side skips it when the peer is awake); going to sleep is safe
+without a fence of its own because the futex syscall orders the wait flag
+before its check of the seq word.
+"""
+from __future__ import annotations
+
+import ctypes
+import errno
+import fcntl
+import mmap
+import os
+import platform
+import struct
+import time
+from typing import List, Optional
+
+# -----------------------------------------------------------------------------
+# 1. Layout (mirror rrl_shm.h)
+# -----------------------------------------------------------------------------
+
+SHM_MAGIC = 0x534C5252            # "RRLS"
+SHM_VERSION = 1
+HEADER_BYTES = 128
+SKIP = 0xFFFFFFFF
+UP, DOWN = 0, 1
+ALIGN = 16
+
+_HEADER = struct.Struct("<4I Q 2i 32x")                  # 64 bytes
+_CTL_BYTES = 128
+_HEAD, _DATA_SEQ, _DATA_WAIT = 0, 8, 12                 # producer line
+_TAIL, _SPACE_SEQ, _SPACE_WAIT = 64, 72, 76             # consumer line
+_RECORD = struct.Struct("<I 12x")                       # 16 bytes
+_TRAINER_PID = 28
+assert _HEADER.size == 64 and _RECORD.size == 16
+
+_SPIN = 200
+_FUTEX_WAIT, _FUTEX_WAKE = 0, 1                         # shared, not *_PRIVATE
+_SYS_FUTEX = 202                                        # x86-64
+
+# Plain stores / loads order the rings only under total store order.
+SUPPORTED = os.name == "posix" and platform.system() == "Linux" \
+    and platform.machine() in ("x86_64", "AMD64")
+
+
+def _align(n: int) -> int:
+    return (n + ALIGN - 1) // ALIGN * ALIGN
+
+
+def segment_name(key: Optional[str], pid: int) -> str:
+    """``rrl_shm_name``: ``/rrl-<uid>-<fnv1a64(key)>-<pid>``."""
+    h = 14695981039346656037
+    for b in (key or "").encode():
+        h = ((h ^ b) * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+    return f"/rrl-{os.getuid()}-{h:016x}-{pid}"
+
+
+def _alive(pid: int) -> bool:
+    if pid <= 0:
+        return False
+    try:
+        os.kill(pid, 0)
+    except ProcessLookupError:
+        return False
+    except PermissionError:
+        pass
+    return True
+
+
+def discover(key: Optional[str]) -> List[str]:
+    """Segments of live simulators on this host using ``key``."""
+    if not SUPPORTED:
+        return []
+    prefix = segment_name(key, 0)[1:-1]                 # strip "/" and the pid
+    try:
+        entries = os.listdir("/dev/shm")
+    except OSError:
+        return []
+    found = []
+    for entry in sorted(entries):
+        pid = entry[len(prefix):]
+        if entry.startswith(prefix) and pid.isdigit() and _alive(int(pid)):
+            found.append("/" + entry)
+    return found
+
+
+# -----------------------------------------------------------------------------
+# 2. Futex wake-ups
+# -----------------------------------------------------------------------------
+
+class _Futex:
+    def __init__(self) -> None:
+        if not SUPPORTED:
+            self._syscall = None
+            return
+        libc = ctypes.CDLL(None, use_errno=True)
+        self._syscall = libc.syscall
+        self._syscall.restype = ctypes.c_long
+
+    def wait(self, addr: int, seen: int, timeout_s: Optional[float]) -> None:
+        if self._syscall is None:
+            time.sleep(min(timeout_s if timeout_s is not None else 1e-3, 1e-3))
+            return
+        ts = None
+        if timeout_s is not None:
+            sec = int(timeout_s)
+            ts = ctypes.byref((ctypes.c_long * 2)(sec, int((timeout_s - sec) * 1e9)))
+        self._syscall(_SYS_FUTEX, ctypes.c_void_p(addr), _FUTEX_WAIT, ctypes.c_uint32(seen), ts, None, 0)
+
+    def wake(self, addr: int) -> None:
+        if self._syscall is not None:
+            self._syscall(_SYS_FUTEX, ctypes.c_void_p(addr), _FUTEX_WAKE, 1, None, None, 0)
+
+
+_futex = _Futex()
+
+
+# -----------------------------------------------------------------------------
+# 3. Session
+# -----------------------------------------------------------------------------
+
+class ShmSession:
+    """One attached segment: the trainer end of every env channel."""
+
+    def __init__(self, fd: int, mm: mmap.mmap) -> None:
+        self._fd, self._mm = fd, mm
+        magic, version, channels, ring, stride, sim_pid, _ = _HEADER.unpack_from(mm, 0)
+        if magic != SHM_MAGIC or version != SHM_VERSION:
+            raise ValueError("not an RRL shared-memory segment")
+        if ring < 4096 or ring & (ring - 1) or stride != 2 * (_CTL_BYTES + ring) \
+                or HEADER_BYTES + channels * stride > len(mm):
+            raise ValueError("inconsistent RRL shared-memory segment")
+        if not _alive(sim_pid):
+            raise ConnectionError("simulator of this segment is gone")
+        self.channels, self._ring, self._stride, self.sim_pid = channels, ring, stride, sim_pid
+        self._u64 = memoryview(mm).cast("Q")
+        self._u32 = memoryview(mm).cast("I")
+        self._base = ctypes.addressof(ctypes.c_char.from_buffer(mm))   # futex words' addresses
+        # Resume where an earlier trainer stopped.
+        self._tail = [self._load64(self._ctl(c, UP) + _TAIL) for c in range(channels)]
+        self._head = [self._load64(self._ctl(c, DOWN) + _HEAD) for c in range(channels)]
+        struct.pack_into("<i", mm, _TRAINER_PID, os.getpid())
+
+    @classmethod
+    def attach(cls, name: str) -> "ShmSession":
+        """``rrl_shm_attach``: claim ``name`` for this process."""
+        if not SUPPORTED:
+            raise OSError(errno.ENOTSUP, "shared-memory transport needs Linux on x86-64")
+        fd = os.open("/dev/shm" + name, os.O_RDWR)
+        try:
+            try:
+                fcntl.flock(fd, fcntl.LOCK_EX | fcntl.LOCK_NB)
+            except OSError as e:
+                if e.errno in (errno.EAGAIN, errno.EWOULDBLOCK):
+                    raise BlockingIOError(f"another trainer is attached to {name}") from None
+                raise
+            mm = mmap.mmap(fd, os.fstat(fd).st_size)
+            return cls(fd, mm)
+        except BaseException:
+            os.close(fd)
+            raise
+
+    def close(self) -> None:
+        """Detach; the simulator sees ``rrl_shm_peer_alive() == 0``."""
+        if self._mm is None:
+            return
+        struct.pack_into("<i", self._mm, _TRAINER_PID, 0)
+        self._u64.release()
+        self._u32.release()
+        self._mm.close()
+        os.close(self._fd)
+        self._mm = None
+
+    def __enter__(self) -> "ShmSession":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    # -- ring access ---------------------------------------------------------
+
+    def _ctl(self, channel: int, direction: int) -> int:
+        if not 0 <= channel < self.channels:
+            raise IndexError(f"channel {channel} out of range")
+        return HEADER_BYTES + channel * self._stride + direction * (_CTL_BYTES + self._ring)
+
+    def _load64(self, off: int) -> int:
+        return self._u64[off // 8]
+
+    def _load32(self, off: int) -> int:
+        return self._u32[off // 4]
+
+    def _wait(self, seq: int, waiting: int, ready, timeout: Optional[float]) -> bool:
+        for _ in range(_SPIN):
+            if ready():
+                return True
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            seen = self._load32(seq)
+            self._u32[waiting // 4] = 1
+            if ready():
+                self._u32[waiting // 4] = 0
+                return True
+            left = None if deadline is None else deadline - time.monotonic()
+            if left is not None and left <= 0:
+                self._u32[waiting // 4] = 0
+                return False
+            _futex.wait(self._base + seq, seen, left)
+            self._u32[waiting // 4] = 0
+            if ready():
+                return True
+
+    def _notify(self, seq: int) -> None:
+        self._u32[seq // 4] = (self._load32(seq) + 1) & 0xFFFFFFFF
+        _futex.wake(self._base + seq)
+
+    def read(self, channel: int, timeout: Optional[float] = None) -> bytes:
+        """Next frame the simulator wrote on ``channel`` (a copy).
+
+        Raises :class:`TimeoutError` if none arrives within ``timeout``
+        seconds (``None`` waits forever, ``0`` just checks).
+        """
+        ctl = self._ctl(channel, UP)
+        tail = self._tail[channel]
+        if not self._wait(ctl + _DATA_SEQ, ctl + _DATA_WAIT,
+                          lambda: self._load64(ctl + _HEAD) != tail, timeout):
+            raise TimeoutError(f"no frame on channel {channel}")
+        data = ctl + _CTL_BYTES
+        pos = tail & (self._ring - 1)
+        size, = _RECORD.unpack_from(self._mm, data + pos)
+        if size == SKIP:
+            tail += self._ring - pos
+            pos = 0
+            size, = _RECORD.unpack_from(self._mm, data)
+        if size == 0 or size == SKIP or _RECORD.size + _align(size) > self._ring - pos:
+            raise ValueError("corrupt shared-memory ring")
+        start = data + pos + _RECORD.size
+        frame = self._mm[start:start + size]
+        self._tail[channel] = tail = tail + _RECORD.size + _align(size)
+        self._u64[(ctl + _TAIL) // 8] = tail
+        self._notify(ctl + _SPACE_SEQ)
+        return frame
+
+    def write(self, channel: int, frame: bytes, timeout: Optional[float] = None) -> None:
+        """Send ``frame`` to the simulator on ``channel``.
+
+        Raises :class:`TimeoutError` if the ring stays full (simulator
+        not draining) for ``timeout`` seconds.
+        """
+        ctl = self._ctl(channel, DOWN)
+        need = _RECORD.size + _align(len(frame))
+        if not frame or need > self._ring // 2:
+            raise ValueError("frame empty or over half the ring")
+        head = self._head[channel]
+        pos = head & (self._ring - 1)
+        skip = self._ring - pos if self._ring - pos < need else 0
+        total = skip + need
+        if not self._wait(ctl + _SPACE_SEQ, ctl + _SPACE_WAIT,
+                          lambda: self._ring - (head - self._load64(ctl + _TAIL)) >= total, timeout):
+            raise TimeoutError(f"channel {channel} full")
+        data = ctl + _CTL_BYTES
+        if skip:
+            _RECORD.pack_into(self._mm, data + pos, SKIP)
+            pos = 0
+        start = data + pos + _RECORD.size
+        self._mm[start:start + len(frame)] = frame
+        _RECORD.pack_into(self._mm, data + pos, len(frame))
+        self._head[channel] = head = head + total
+        self._u64[(ctl + _HEAD) // 8] = head
+        self._notify(ctl + _DATA_SEQ)
+
+    def simulator_alive(self) -> bool:
+        return _alive(self.sim_pid)
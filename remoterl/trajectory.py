@@ -0,0 +1,148 @@
+"""Trajectory files written by the Sim-SDK recorder.
+
+Reads the layout described in ``sdk-sim/include/rrl_record.h``: a 128-byte
+header carrying the observation / action spaces, then chunks of up to
+``rows_per_chunk`` rows stored column by column (env id, observation,
+action, reward, done), every column 64-byte aligned.
+
+**Usage:** ``with Recording(path) as rec:`` then ``for chunk in
+rec.chunks()`` yields one dict of arrays per chunk, or ``rec.column("obs")``
+concatenates a whole column. The file is memory-mapped and uncompressed
+columns come back as zero-copy numpy views of it, so keep the
+:class:`Recording` open while they are in use. Columns the simulator
+compressed (``RRL_RecorderConfig.compression``) need the ``lz4`` or
+``zstandard`` package. A file still being written, or cut short by a crash,
+reads up to its last whole chunk.
+"""
+from __future__ import annotations
+
+import mmap
+import struct
+from typing import Dict, Iterator, List, Tuple
+
+import numpy as np
+
+from .wire_format import Schema, _read_space, _SPACE
+
+# -----------------------------------------------------------------------------
+# 1. Format constants (mirror rrl_record.h / rrl_wire.h)
+# -----------------------------------------------------------------------------
+
+RECORD_MAGIC = 0x54525252          # "RRRT"
+RECORD_CHUNK = 0x43525252          # "RRRC"
+RECORD_VERSION = 1
+RECORD_ALIGN = 64
+
+COLUMNS = ("env", "obs", "action", "reward", "done")
+COMP_NONE, COMP_LZ4, COMP_ZSTD = 0, 1, 2
+
+_HEADER = struct.Struct("<I 2H 2I 4I")                  # 32 bytes + 2 spaces + 16 pad
+_COLUMN = struct.Struct("<2Q 2I")                       # 24 bytes
+_CHUNK = struct.Struct("<2I Q")                         # 16 bytes + 5 columns + 56 pad
+_HEADER_SIZE, _CHUNK_SIZE = 128, 192
+assert _HEADER.size + 2 * _SPACE.size + 16 == _HEADER_SIZE
+assert _CHUNK.size + len(COLUMNS) * _COLUMN.size + 56 == _CHUNK_SIZE
+
+
+# -----------------------------------------------------------------------------
+# 2. Reader
+# -----------------------------------------------------------------------------
+
+class Recording:
+    """One trajectory file, mapped read-only."""
+
+    def __init__(self, path: str) -> None:
+        with open(path, "rb") as f:
+            self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        self._buf = memoryview(self._map)
+        self._zstd = None
+        try:
+            self.schema = self._read_header()
+        except Exception:
+            self.close()
+            raise
+        obs, action = self.schema.obs, self.schema.action
+        # (dtype, per-row shape) for each column
+        self._types = (
+            (np.dtype(np.uint32), ()), (obs.dtype, obs.shape), (action.dtype, action.shape),
+            (np.dtype(np.float32), ()), (np.dtype(np.uint8), ()),
+        )
+
+    def _read_header(self) -> Schema:
+        buf = self._buf
+        if len(buf) < _HEADER_SIZE:
+            raise ValueError("not an RRL trajectory file (too short)")
+        magic, version, columns, obs_bytes, action_bytes, *_ = _HEADER.unpack_from(buf, 0)
+        if magic != RECORD_MAGIC:
+            raise ValueError("not an RRL trajectory file")
+        if version != RECORD_VERSION or columns != len(COLUMNS):
+            raise ValueError(f"unsupported trajectory version {version} ({columns} columns)")
+        schema = Schema(_read_space(buf, _HEADER.size), _read_space(buf, _HEADER.size + _SPACE.size))
+        if schema.obs.nbytes != obs_bytes or schema.action.nbytes != action_bytes:
+            raise ValueError("trajectory header sizes disagree with its spaces")
+        return schema
+
+    def _decompress(self, comp: int, data: memoryview, size: int) -> bytes:
+        if comp == COMP_ZSTD:
+            if self._zstd is None:
+                import zstandard  # optional dependency
+                self._zstd = zstandard.ZstdDecompressor()
+            return self._zstd.decompress(bytes(data), max_output_size=size)
+        if comp == COMP_LZ4:
+            import lz4.block  # optional dependency
+            return lz4.block.decompress(bytes(data), uncompressed_size=size)
+        raise ValueError(f"unknown column compression {comp}")
+
+    def _chunk_headers(self) -> Iterator[Tuple[int, int]]:
+        """(offset, rows) of every whole chunk."""
+        buf, end, pos = self._buf, len(self._buf), _HEADER_SIZE
+        while pos + _CHUNK_SIZE <= end:
+            magic, rows, chunk_bytes = _CHUNK.unpack_from(buf, pos)
+            if magic != RECORD_CHUNK or chunk_bytes < _CHUNK_SIZE or chunk_bytes > end - pos:
+                return  # torn tail
+            yield pos, rows
+            pos += chunk_bytes
+
+    def chunks(self) -> Iterator[Dict[str, np.ndarray]]:
+        """Yield ``{"env", "obs", "action", "reward", "done"}`` per chunk."""
+        buf = self._buf
+        for pos, rows in self._chunk_headers():
+            out = {}
+            for k, name in enumerate(COLUMNS):
+                offset, nbytes, comp, _ = _COLUMN.unpack_from(buf, pos + _CHUNK.size + k * _COLUMN.size)
+                dtype, shape = self._types[k]
+                raw = rows * int(np.prod(shape, dtype=np.int64)) * dtype.itemsize
+                data = buf[pos + offset:pos + offset + nbytes]
+                if comp != COMP_NONE:
+                    data = self._decompress(comp, data, raw)
+                if len(data) != raw:
+                    raise ValueError(f"chunk at {pos}: {name} column is {len(data)} bytes, expected {raw}")
+                out[name] = np.frombuffer(data, dtype=dtype).reshape((rows,) + tuple(shape))
+            yield out
+
+    def column(self, name: str) -> np.ndarray:
+        """One column across every chunk (always a copy)."""
+        if name not in COLUMNS:
+            raise KeyError(name)
+        parts: List[np.ndarray] = [c[name] for c in self.chunks()]
+        if not parts:
+            dtype, shape = self._types[COLUMNS.index(name)]
+            return np.empty((0,) + tuple(shape), dtype=dtype)
+        return np.concatenate(parts)
+
+    def __len__(self) -> int:
+        return sum(rows for _, rows in self._chunk_headers())
+
+    def close(self) -> None:
+        # Views handed out keep the map alive; release ours first.
+        self._buf.release()
+        try:
+            self._map.close()
+        except BufferError:
+            pass  # a caller still holds a column view
+
+    def __enter__(self) -> "Recording":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
@@ -0,0 +1,323 @@
+"""Binary step frames exchanged with the Sim-SDK.
+
+Reads and writes the layout described in ``sdk-sim/include/rrl_wire.h``: one
+``SCHEMA`` frame fixes the observation / action tensors at handshake, after
+which every ``STEP`` (simulator → trainer) and ``ACTION`` (trainer →
+simulator) frame is a 16-byte header plus raw tensor bytes.
+
+**Usage:** ``schema = read_schema(first_frame)``, then
+``seq, obs, rewards, dones = read_step(schema, frame)`` per step and
+``write_action(schema, seq, actions)`` for the reply. Observations come back
+as zero-copy numpy views of the frame. For streams the simulator compresses
+(``rrl_set_wire_codec``) use a :class:`StepDecoder` configured the same way;
+it needs the ``lz4`` or ``zstandard`` package for the matching codec.
+Multiplexed connections (``rrl_set_mux``) carry ``MUX`` frames instead;
+``for stream, frame in read_mux(batch)`` yields the per-stream frames
+above, in the order each stream wrote them.  After a reconnect the
+simulator opens with a ``RESUME`` frame (:func:`read_resume`); answer with
+:func:`write_resume` carrying the last step seq received, or ``reject=True``
+if the session is gone (a ``SCHEMA`` frame then starts it over).
+"""
+from __future__ import annotations
+
+import struct
+from dataclasses import dataclass
+from typing import Iterable, Iterator, Tuple
+
+import numpy as np
+
+# -----------------------------------------------------------------------------
+# 1. Format constants (mirror rrl_wire.h / rrl_env.h)
+# -----------------------------------------------------------------------------
+
+WIRE_MAGIC = 0x574C5252            # "RRLW"
+WIRE_VERSION = 1
+WIRE_ALIGN = 16
+
+KIND_SCHEMA, KIND_STEP, KIND_ACTION, KIND_MUX, KIND_RESUME = 1, 2, 3, 4, 5
+FLAG_DELTA, FLAG_LZ4, FLAG_ZSTD = 0x1, 0x2, 0x4
+RESUME_REJECT = 0x1
+RESUME_TOKEN = 16
+
+# RRL_DTYPE_* -> numpy
+DTYPES = {
+    0: np.float32, 1: np.float64, 2: np.int32, 3: np.int64,
+    4: np.uint8, 5: np.int8, 6: np.float16, 7: np.bool_,
+}
+
+_SPACE = struct.Struct("<i I 8I")                       # 40 bytes
+_SCHEMA = struct.Struct("<I 2H 2I 4I")                  # 32 bytes + 2 spaces
+_HEADER = struct.Struct("<2H 2I I")                     # 16 bytes
+_RECORD = struct.Struct("<2I 8x")                       # 16 bytes
+_RESUME = struct.Struct("<2H 2I 4x 16s")                # 32 bytes
+assert _SPACE.size == 40 and _SCHEMA.size + 2 * _SPACE.size == 112 and _HEADER.size == 16
+assert _RECORD.size == 16 and _RESUME.size == 32
+
+
+@dataclass(frozen=True)
+class Space:
+    """One tensor of the schema."""
+
+    dtype: np.dtype
+    shape: Tuple[int, ...]
+
+    @property
+    def nbytes(self) -> int:
+        return int(np.prod(self.shape, dtype=np.int64)) * np.dtype(self.dtype).itemsize
+
+
+@dataclass(frozen=True)
+class Schema:
+    """Decoded ``RRL_WireSchema``."""
+
+    obs: Space
+    action: Space
+
+
+def _align(n: int) -> int:
+    return (n + WIRE_ALIGN - 1) // WIRE_ALIGN * WIRE_ALIGN
+
+
+def _read_space(buf: memoryview, offset: int) -> Space:
+    dtype, ndim, *shape = _SPACE.unpack_from(buf, offset)
+    if dtype not in DTYPES or not 1 <= ndim <= 8:
+        raise ValueError(f"bad space (dtype={dtype}, ndim={ndim})")
+    return Space(np.dtype(DTYPES[dtype]), tuple(shape[:ndim]))
+
+
+def _write_space(space: Space) -> bytes:
+    code = next(k for k, v in DTYPES.items() if np.dtype(v) == np.dtype(space.dtype))
+    shape = list(space.shape) + [0] * (8 - len(space.shape))
+    return _SPACE.pack(code, len(space.shape), *shape)
+
+
+# -----------------------------------------------------------------------------
+# 2. Schema (once per connection)
+# -----------------------------------------------------------------------------
+
+def read_schema(frame: bytes) -> Schema:
+    """Validate a ``SCHEMA`` frame the simulator sent at handshake."""
+    buf = memoryview(frame)
+    if len(buf) != _SCHEMA.size + 2 * _SPACE.size:
+        raise ValueError(f"schema frame must be 112 bytes, got {len(buf)}")
+    magic, version, kind, obs_bytes, action_bytes, *_ = _SCHEMA.unpack_from(buf, 0)
+    if magic != WIRE_MAGIC or kind != KIND_SCHEMA:
+        raise ValueError("not an RRL wire schema frame")
+    if version != WIRE_VERSION:
+        raise ValueError(f"unsupported wire version {version}")
+    schema = Schema(_read_space(buf, _SCHEMA.size), _read_space(buf, _SCHEMA.size + _SPACE.size))
+    if schema.obs.nbytes != obs_bytes or schema.action.nbytes != action_bytes:
+        raise ValueError("schema sizes disagree with its spaces")
+    return schema
+
+
+def write_schema(schema: Schema) -> bytes:
+    """Encode a ``SCHEMA`` frame (used by tests and loopback peers)."""
+    head = _SCHEMA.pack(WIRE_MAGIC, WIRE_VERSION, KIND_SCHEMA,
+                        schema.obs.nbytes, schema.action.nbytes, 0, 0, 0, 0)
+    return head + _write_space(schema.obs) + _write_space(schema.action)
+
+
+# -----------------------------------------------------------------------------
+# 3. Per-step frames
+# -----------------------------------------------------------------------------
+
+def _step_offsets(count: int) -> Tuple[int, int]:
+    dones = _HEADER.size + 4 * count
+    return dones, _align(dones + count)
+
+
+def read_step(schema: Schema, frame: bytes) -> Tuple[int, np.ndarray, np.ndarray, np.ndarray]:
+    """Decode a ``STEP`` frame into ``(seq, obs[count, ...], rewards, dones)``.
+
+    The arrays are read-only views into ``frame``; copy them to keep them
+    beyond the frame's lifetime.
+    """
+    buf = memoryview(frame)
+    kind, flags, seq, count, _ = _HEADER.unpack_from(buf, 0)
+    if kind != KIND_STEP:
+        raise ValueError(f"expected a step frame, got kind {kind}")
+    if flags:
+        raise ValueError("encoded step frame; decode it with StepDecoder")
+    off_dones, off_obs = _step_offsets(count)
+    if len(buf) != off_obs + count * schema.obs.nbytes:
+        raise ValueError("step frame size does not match schema")
+    rewards = np.frombuffer(buf, np.float32, count, _HEADER.size)
+    dones = np.frombuffer(buf, np.uint8, count, off_dones).astype(bool)
+    obs = np.frombuffer(buf, schema.obs.dtype, count * int(np.prod(schema.obs.shape)), off_obs)
+    return seq, obs.reshape((count,) + schema.obs.shape), rewards, dones
+
+
+def write_action(schema: Schema, seq: int, actions: np.ndarray) -> bytes:
+    """Encode an ``ACTION`` frame answering step ``seq``; ``actions`` is
+    ``(count, *action.shape)`` (a leading ``count`` of 1 may be omitted)."""
+    a = np.ascontiguousarray(actions, dtype=schema.action.dtype)
+    if a.shape == schema.action.shape:
+        a = a[None]
+    if a.shape[1:] != schema.action.shape:
+        raise ValueError(f"actions must be (count, {schema.action.shape}), got {a.shape}")
+    return _HEADER.pack(KIND_ACTION, 0, seq, a.shape[0], 0) + a.tobytes()
+
+
+def write_step(schema: Schema, seq: int, obs: np.ndarray,
+               rewards: np.ndarray, dones: np.ndarray) -> bytes:
+    """Encode a ``STEP`` frame (used by tests and loopback peers)."""
+    o = np.ascontiguousarray(obs, dtype=schema.obs.dtype).reshape((-1,) + schema.obs.shape)
+    count = o.shape[0]
+    off_dones, off_obs = _step_offsets(count)
+    out = bytearray(off_obs + o.nbytes)
+    _HEADER.pack_into(out, 0, KIND_STEP, 0, seq, count, 0)
+    out[_HEADER.size:off_dones] = np.asarray(rewards, np.float32).reshape(count).tobytes()
+    out[off_dones:off_dones + count] = np.asarray(dones, np.uint8).reshape(count).tobytes()
+    out[off_obs:] = o.tobytes()
+    return bytes(out)
+
+
+# -----------------------------------------------------------------------------
+# 4. Compressed / delta-coded streams (mirror rrl_wire_codec_*)
+# -----------------------------------------------------------------------------
+
+def _dict_id(data: bytes) -> int:
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h or 1
+
+
+class StepDecoder:
+    """Reader for one simulator's STEP stream.
+
+    Mirrors ``rrl_wire_codec_read``: keeps the last observations so
+    XOR-delta frames can be rebuilt, hence frames must be fed in order.
+    ``delta`` and ``dictionary`` must match the simulator's codec config.
+    """
+
+    def __init__(self, schema: Schema, *, delta: bool = False, dictionary: bytes = b"") -> None:
+        self.schema = schema
+        self.delta = delta
+        self.dictionary = bytes(dictionary)
+        self.dict_id = _dict_id(self.dictionary) if self.dictionary else 0
+        self._prev: "np.ndarray | None" = None
+        self._zstd = None
+
+    def _decompress(self, flags: int, payload: memoryview, size: int) -> bytes:
+        if flags & FLAG_ZSTD:
+            if self._zstd is None:
+                import zstandard  # optional dependency
+                d = zstandard.ZstdCompressionDict(self.dictionary) if self.dictionary else None
+                self._zstd = zstandard.ZstdDecompressor(dict_data=d)
+            return self._zstd.decompress(bytes(payload), max_output_size=size)
+        import lz4.block  # optional dependency
+        return lz4.block.decompress(bytes(payload), uncompressed_size=size,
+                                    dict=self.dictionary or None)
+
+    def read_step(self, frame: bytes) -> Tuple[int, np.ndarray, np.ndarray, np.ndarray]:
+        """Like :func:`read_step`, for plain or encoded frames.
+
+        Delta streams return copies (the decoder reuses its buffer).
+        """
+        buf = memoryview(frame)
+        kind, flags, seq, count, dict_id = _HEADER.unpack_from(buf, 0)
+        if not flags and not self.delta:
+            return read_step(self.schema, frame)
+        if kind != KIND_STEP:
+            raise ValueError(f"expected a step frame, got kind {kind}")
+        _, off_obs = _step_offsets(count)
+        size = off_obs + count * self.schema.obs.nbytes - _HEADER.size
+        if flags & (FLAG_LZ4 | FLAG_ZSTD):
+            if dict_id != self.dict_id:
+                raise ValueError("compression dictionary mismatch")
+            payload = self._decompress(flags, buf[_HEADER.size:], size)
+        else:
+            payload = bytes(buf[_HEADER.size:])
+        if len(payload) != size:
+            raise ValueError("step frame size does not match schema")
+        plain = bytearray(_HEADER.pack(KIND_STEP, 0, seq, count, 0) + payload)
+        obs = np.frombuffer(plain, np.uint8, count * self.schema.obs.nbytes, off_obs)
+        if flags & FLAG_DELTA:
+            if self._prev is None or self._prev.size != obs.size:
+                raise ValueError("delta frame without keyframe")
+            obs = np.bitwise_xor(obs, self._prev)
+            plain[off_obs:] = obs.tobytes()
+        if self.delta:
+            self._prev = obs.copy()
+        return read_step(self.schema, bytes(plain))
+
+    def reset(self) -> None:
+        """Forget delta state (e.g. after a reconnect)."""
+        self._prev = None
+
+
+# -----------------------------------------------------------------------------
+# 5. Multiplexed connections (mirror rrl_wire_mux_next / rrl_mux_write)
+# -----------------------------------------------------------------------------
+
+def read_mux(frame: bytes) -> Iterator[Tuple[int, memoryview]]:
+    """Yield ``(stream, frame)`` for every record of a ``MUX`` frame.
+
+    The frames are views into ``frame``; a stream's first one is its
+    ``SCHEMA``, so keep one schema (and :class:`StepDecoder`) per stream.
+    """
+    buf = memoryview(frame)
+    if len(buf) < _HEADER.size:
+        raise ValueError("mux frame too short")
+    kind, _, _, count, nbytes = _HEADER.unpack_from(buf, 0)
+    if kind != KIND_MUX or nbytes != len(buf) or len(buf) % WIRE_ALIGN:
+        raise ValueError("not an RRL mux frame")
+    off = _HEADER.size
+    for _ in range(count):
+        if off + _RECORD.size > len(buf):
+            raise ValueError("mux frame shorter than its record count")
+        stream, size = _RECORD.unpack_from(buf, off)
+        off += _RECORD.size
+        if size == 0 or off + _align(size) > len(buf):
+            raise ValueError("mux record overruns the frame")
+        yield stream, buf[off:off + size]
+        off += _align(size)
+    if off != len(buf):
+        raise ValueError("mux frame longer than its records")
+
+
+def write_mux(records: Iterable[Tuple[int, bytes]], seq: int = 0) -> bytes:
+    """Encode ``(stream, frame)`` pairs as one ``MUX`` frame (used by
+    tests and loopback peers)."""
+    out = bytearray(_HEADER.size)
+    count = 0
+    for stream, frame in records:
+        out += _RECORD.pack(stream, len(frame)) + bytes(frame)
+        out += bytes(_align(len(out)) - len(out))
+        count += 1
+    _HEADER.pack_into(out, 0, KIND_MUX, 0, seq, count, len(out))
+    return bytes(out)
+
+
+# -----------------------------------------------------------------------------
+# 6. Session resume (mirror RRL_WireResume)
+# -----------------------------------------------------------------------------
+
+@dataclass(frozen=True)
+class Resume:
+    """Decoded ``RRL_WireResume``: the sender's last in-order seq."""
+
+    token: bytes
+    seq: int
+    stream: int = 0
+    reject: bool = False
+
+
+def read_resume(frame: bytes) -> Resume:
+    """Validate a ``RESUME`` frame."""
+    if len(frame) != _RESUME.size:
+        raise ValueError(f"resume frame must be {_RESUME.size} bytes, got {len(frame)}")
+    kind, flags, seq, stream, token = _RESUME.unpack_from(frame, 0)
+    if kind != KIND_RESUME:
+        raise ValueError(f"expected a resume frame, got kind {kind}")
+    return Resume(token, seq, stream, bool(flags & RESUME_REJECT))
+
+
+def write_resume(resume: Resume) -> bytes:
+    """Encode a ``RESUME`` frame (the reply to a simulator's, typically)."""
+    if len(resume.token) != RESUME_TOKEN:
+        raise ValueError(f"resume token must be {RESUME_TOKEN} bytes")
+    flags = RESUME_REJECT if resume.reject else 0
+    return _RESUME.pack(KIND_RESUME, flags, resume.seq & 0xFFFFFFFF, resume.stream, resume.token)
@@ -0,0 +1,36 @@
+//─────────────────────────────────────────────────────────────
+//  bench_core.cpp  —  Minimal stand-in for the closed core
+//
+//  • Supplies the core exports the open layer links against, so the
+//    benchmarks run without the real transport.
+//  • Every call succeeds immediately: measured time is SDK dispatch
+//    only, never I/O.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+
+extern "C" {
+
+int rrl_action_space(RRLHandle handle, RRL_SpaceDesc* out_space)
+{
+    if (!handle || !out_space) return RRL_ERR_INVALID_ARGUMENT;
+    *out_space = RRL_SpaceDesc{};
+    out_space->ndim = 1;
+    out_space->shape[0] = 4;
+    out_space->dtype = RRL_DTYPE_FLOAT32;
+    return RRL_SUCCESS;
+}
+
+int rrl_observation_space(RRLHandle handle, RRL_SpaceDesc* out_space)
+{
+    if (!handle || !out_space) return RRL_ERR_INVALID_ARGUMENT;
+    *out_space = RRL_SpaceDesc{};
+    out_space->ndim = 1;
+    out_space->shape[0] = 16;
+    out_space->dtype = RRL_DTYPE_FLOAT32;
+    return RRL_SUCCESS;
+}
+
+// Exported by the core; rrl_env.hpp calls it from ~Env().
+void rrl_close(RRLHandle handle) { rrl_handle_closed(handle); }
+
+} // extern "C"
@@ -0,0 +1,28 @@
+//─────────────────────────────────────────────────────────────
+//  bench_static.cpp  —  Exports generated by RRL_DEFINE_BACKEND
+//
+//  • Linked into rrl_bench_static only: same trivial engine as
+//    bench_weak.cpp, but routed through rrl::StaticBackend<Impl> so
+//    the SDK argument checks and error reporting are included.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+
+#include "rrl_env.hpp"
+
+namespace {
+
+struct BenchEngine {
+    static int poll(RRLHandle) { return 1; }
+    static int get_stats(RRLHandle, RRL_Stats* s)
+    {
+        s->fps = 60.0;
+        s->latency_ms = 1.0;
+        s->steps = 1;
+        return RRL_SUCCESS;
+    }
+    static int load_policy(RRLHandle, const void*, std::size_t) { return RRL_SUCCESS; }
+};
+
+} // namespace (anonymous)
+
+RRL_DEFINE_BACKEND(BenchEngine);
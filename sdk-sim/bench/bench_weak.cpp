@@ -0,0 +1,26 @@
+//─────────────────────────────────────────────────────────────
+//  bench_weak.cpp  —  Strong overrides of the weak exports
+//
+//  • Linked into rrl_bench_weak only: the linker picks these over
+//    the RRL_WEAK defaults, as an integrator shipping their own
+//    transport would.
+//  • Kept in their own translation unit so the benchmark loop
+//    cannot inline them away.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+
+extern "C" {
+
+int rrl_poll(RRLHandle) { return 1; }
+
+int rrl_get_stats(RRLHandle, RRL_Stats* s)
+{
+    s->fps = 60.0;
+    s->latency_ms = 1.0;
+    s->steps = 1;
+    return RRL_SUCCESS;
+}
+
+int rrl_load_policy(RRLHandle, const void*, size_t) { return RRL_SUCCESS; }
+
+} // extern "C"
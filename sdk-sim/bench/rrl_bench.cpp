@@ -0,0 +1,224 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_bench.cpp  —  Per-call cost of the public C ABI hot paths
+//
+//  • rrl_poll / rrl_get_stats / rrl_load_policy dispatch through
+//      stub      no backend registered (built-in defaults; for
+//                rrl_load_policy that is the built-in engine, so
+//                it is named builtin)
+//      backend   table installed with rrl_register_backend()
+//      override  strong definitions replacing the weak exports
+//                (rrl_bench_weak: bench_weak.cpp linked in)
+//      static    RRL_DEFINE_BACKEND / rrl::StaticBackend<Impl>
+//                (rrl_bench_static: bench_static.cpp linked in)
+//  • Error path (set_error into thread-local storage), where the
+//    exports check their arguments, and the rrl::Env wrapper
+//    against the raw C call.
+//  • Every dispatch case runs at 1, 8 and 32 threads.
+//  • Full step round trips (submit → trainer thread → rrl_wait_any)
+//    against the rrl_loopback.h ghost trainer, one driver thread over
+//    1 and 64 envs.
+//  • Pass --benchmark_out=<file> --benchmark_out_format=json to
+//    record a baseline for compare.py.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_loopback.h"
+#include "rrl_policy_format.h"
+
+#include "rrl_env.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+//──────────────────── Fixtures ──────────────────────────────
+RRLHandle fake_handle(int thread)
+{
+    return reinterpret_cast<RRLHandle>(static_cast<uintptr_t>(0x1000 + thread * 64));
+}
+
+// Smallest valid policy: one dense 16 → 4 layer, argmax head.
+const std::vector<uint8_t>& policy_blob()
+{
+    static const std::vector<uint8_t> blob = [] {
+        constexpr uint32_t K = 16, N = 4;
+        const size_t w_off = 192, b_off = w_off + K * N * sizeof(float);
+        std::vector<uint8_t> b(b_off + 64, 0);
+        RRL_PolicyHeader h{};
+        h.magic = RRL_POLICY_MAGIC;
+        h.version = RRL_POLICY_VERSION;
+        h.num_layers = 1;
+        h.output_kind = RRL_POLICY_OUT_ARGMAX;
+        h.input_dtype = RRL_DTYPE_FLOAT32;
+        h.input_dims[0] = h.input_dims[1] = 1;
+        h.input_dims[2] = K;
+        h.input_scale = 1.f;
+        RRL_PolicyLayer l{};
+        l.kind = RRL_LAYER_DENSE;
+        l.in_dims[0] = l.in_dims[1] = l.out_dims[0] = l.out_dims[1] = 1;
+        l.in_dims[2] = K;
+        l.out_dims[2] = N;
+        l.weight_dtype = RRL_DTYPE_FLOAT32;
+        l.weight_offset = w_off;
+        l.bias_offset = b_off;
+        std::memcpy(b.data(), &h, sizeof(h));
+        std::memcpy(b.data() + sizeof(h), &l, sizeof(l));
+        return b;
+    }();
+    return blob;
+}
+
+//──────────────────── Dispatch ──────────────────────────────
+void BM_Poll(benchmark::State& state)
+{
+    const RRLHandle h = fake_handle(state.thread_index());
+    for (auto _ : state) benchmark::DoNotOptimize(rrl_poll(h));
+}
+
+void BM_GetStats(benchmark::State& state)
+{
+    const RRLHandle h = fake_handle(state.thread_index());
+    RRL_Stats s{};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rrl_get_stats(h, &s));
+        benchmark::ClobberMemory();
+    }
+}
+
+// Without a backend this is a built-in engine load: validate the
+// model, find the policy already serving the same bytes (hash +
+// compare) and rebind the handle to it.
+void BM_LoadPolicy(benchmark::State& state)
+{
+    const RRLHandle h = fake_handle(state.thread_index());
+    const std::vector<uint8_t>& blob = policy_blob();
+    for (auto _ : state) benchmark::DoNotOptimize(rrl_load_policy(h, blob.data(), blob.size()));
+}
+
+//──────────────────── Error path ────────────────────────────
+// Each failing call formats into the calling thread's error slot.
+#if !defined(RRL_BENCH_OVERRIDE) || defined(RRL_BENCH_CHECKED)
+void BM_ErrorPath(benchmark::State& state)
+{
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rrl_poll(nullptr));
+        benchmark::DoNotOptimize(rrl_last_error());
+    }
+}
+#endif
+
+//──────────────────── C++ wrapper ───────────────────────────
+void BM_EnvPoll(benchmark::State& state)
+{
+    rrl::Env env(fake_handle(state.thread_index()));
+    for (auto _ : state) benchmark::DoNotOptimize(env.poll());
+}
+
+void BM_EnvStats(benchmark::State& state)
+{
+    rrl::Env env(fake_handle(state.thread_index()));
+    for (auto _ : state) {
+        try {
+            benchmark::DoNotOptimize(env.stats());
+        } catch (const std::exception&) {
+            // Stub get_stats is unsupported: this times the throw path.
+        }
+    }
+}
+
+#if !defined(RRL_BENCH_OVERRIDE)
+//──────────────────── Backend under test ────────────────────
+// Trivial hooks so the measurement is the dispatch itself.
+int be_poll(RRLHandle) { return 1; }
+int be_get_stats(RRLHandle, RRL_Stats* s) { s->fps = 60.0; s->latency_ms = 1.0; s->steps = 1; return RRL_SUCCESS; }
+int be_load_policy(RRLHandle, const void*, size_t) { return RRL_SUCCESS; }
+
+void install_backend(const benchmark::State&)
+{
+    rrl::Backend(be_poll, be_get_stats, be_load_policy).install();
+}
+
+void restore_stubs(const benchmark::State&)
+{
+    rrl_register_backends(nullptr, nullptr);
+}
+
+//──────────────────── Error message ─────────────────────────
+void BM_ErrorMessage(benchmark::State& state)
+{
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rrl_get_stats(nullptr, nullptr));
+        benchmark::DoNotOptimize(rrl_last_error_msg());
+    }
+}
+
+//──────────────────── Loopback round trip ───────────────────
+// Zero latency / service time: what is left is the SDK plus one
+// hand-off to a trainer thread and back, per step.
+void BM_LoopbackStep(benchmark::State& state)
+{
+    RRL_LoopbackConfig cfg{};
+    cfg.struct_size = sizeof(cfg);
+    const RRLLoopback lb = rrl_loopback_create(&cfg);
+    rrl_loopback_install(lb);
+    RRL_OpenConfig oc{};
+    oc.struct_size = sizeof(oc);
+    std::vector<RRLHandle> envs(static_cast<size_t>(state.range(0)));
+    for (RRLHandle& h : envs) {
+        h = rrl_open(&oc);
+        rrl_loopback_submit(h);
+    }
+    for (auto _ : state) {
+        const int i = rrl_wait_any(envs.data(), envs.size(), -1);
+        benchmark::DoNotOptimize(rrl_loopback_submit(envs[static_cast<size_t>(i)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    rrl_loopback_destroy(lb);
+}
+
+#endif
+
+void threads(benchmark::internal::Benchmark* b)
+{
+    b->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
+}
+
+#if defined(RRL_BENCH_OVERRIDE)   // "override" or "static": exports replaced at link time
+BENCHMARK(BM_Poll)->Name("rrl_poll/" RRL_BENCH_OVERRIDE)->Apply(threads);
+BENCHMARK(BM_GetStats)->Name("rrl_get_stats/" RRL_BENCH_OVERRIDE)->Apply(threads);
+BENCHMARK(BM_LoadPolicy)->Name("rrl_load_policy/" RRL_BENCH_OVERRIDE)->Apply(threads);
+#if defined(RRL_BENCH_CHECKED)   // bench_weak's rrl_poll never reports an error
+BENCHMARK(BM_ErrorPath)->Name("error/null_handle/" RRL_BENCH_OVERRIDE)->Apply(threads);
+#endif
+BENCHMARK(BM_EnvPoll)->Name("env_poll/" RRL_BENCH_OVERRIDE)->Apply(threads);
+BENCHMARK(BM_EnvStats)->Name("env_stats/" RRL_BENCH_OVERRIDE)->Apply(threads);
+#else
+BENCHMARK(BM_Poll)->Name("rrl_poll/stub")->Apply(threads);
+BENCHMARK(BM_GetStats)->Name("rrl_get_stats/stub")->Apply(threads);
+BENCHMARK(BM_LoadPolicy)->Name("rrl_load_policy/builtin")->Apply(threads);
+
+BENCHMARK(BM_Poll)->Name("rrl_poll/backend")
+    ->Setup(install_backend)->Teardown(restore_stubs)->Apply(threads);
+BENCHMARK(BM_GetStats)->Name("rrl_get_stats/backend")
+    ->Setup(install_backend)->Teardown(restore_stubs)->Apply(threads);
+BENCHMARK(BM_LoadPolicy)->Name("rrl_load_policy/backend")
+    ->Setup(install_backend)->Teardown(restore_stubs)->Apply(threads);
+
+BENCHMARK(BM_ErrorPath)->Name("error/null_handle")->Apply(threads);
+BENCHMARK(BM_ErrorMessage)->Name("error/last_error_msg")->Apply(threads);
+
+BENCHMARK(BM_EnvPoll)->Name("env_poll/backend")
+    ->Setup(install_backend)->Teardown(restore_stubs)->Apply(threads);
+BENCHMARK(BM_EnvStats)->Name("env_stats/backend")
+    ->Setup(install_backend)->Teardown(restore_stubs)->Apply(threads);
+BENCHMARK(BM_EnvStats)->Name("env_stats/stub_throw")->Apply(threads);
+
+BENCHMARK(BM_LoopbackStep)->Name("loopback_step")->Arg(1)->Arg(64)->UseRealTime();
+#endif
+
+} // namespace (anonymous)
+
+BENCHMARK_MAIN();
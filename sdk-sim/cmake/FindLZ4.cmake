@@ -0,0 +1,19 @@
+# FindLZ4 — liblz4 for rrl_wire_codec, as the imported target
+# LZ4::lz4.  Installed next to remoterlConfig.cmake so a consumer of
+# the static library resolves the same target.
+#
+#   LZ4_FOUND, LZ4_INCLUDE_DIR, LZ4_LIBRARY
+
+find_path(LZ4_INCLUDE_DIR NAMES lz4.h)
+find_library(LZ4_LIBRARY NAMES lz4 liblz4)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4 REQUIRED_VARS LZ4_LIBRARY LZ4_INCLUDE_DIR)
+mark_as_advanced(LZ4_INCLUDE_DIR LZ4_LIBRARY)
+
+if(LZ4_FOUND AND NOT TARGET LZ4::lz4)
+    add_library(LZ4::lz4 UNKNOWN IMPORTED)
+    set_target_properties(LZ4::lz4 PROPERTIES
+        IMPORTED_LOCATION             "${LZ4_LIBRARY}"
+        INTERFACE_INCLUDE_DIRECTORIES "${LZ4_INCLUDE_DIR}")
+endif()
@@ -0,0 +1,19 @@
+# Findzstd — libzstd for rrl_wire_codec, as the imported target
+# zstd::libzstd.  Installed next to remoterlConfig.cmake so a consumer
+# of the static library resolves the same target.
+#
+#   zstd_FOUND, zstd_INCLUDE_DIR, zstd_LIBRARY
+
+find_path(zstd_INCLUDE_DIR NAMES zstd.h zdict.h)
+find_library(zstd_LIBRARY NAMES zstd zstd_static libzstd)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(zstd REQUIRED_VARS zstd_LIBRARY zstd_INCLUDE_DIR)
+mark_as_advanced(zstd_INCLUDE_DIR zstd_LIBRARY)
+
+if(zstd_FOUND AND NOT TARGET zstd::libzstd)
+    add_library(zstd::libzstd UNKNOWN IMPORTED)
+    set_target_properties(zstd::libzstd PROPERTIES
+        IMPORTED_LOCATION             "${zstd_LIBRARY}"
+        INTERFACE_INCLUDE_DIRECTORIES "${zstd_INCLUDE_DIR}")
+endif()
@@ -18,6 +18,7 @@ extern "C" {
 #endif
 
 #include <stddef.h>  /* size_t */
+#include <stdint.h>  /* uint64_t */
 
 /*────────────────── Error codes ──────────────────────────*/
 enum {
@@ -26,16 +27,63 @@ enum {
     RRL_ERR_INVALID_ARGUMENT = -2,
     RRL_ERR_UNSUPPORTED      = -3,
     RRL_ERR_NO_BACKEND       = -4,
+    RRL_ERR_IO               = -5,
+    RRL_ERR_TIMEOUT          = -6,
+    RRL_ERR_EXHAUSTED        = -7,   /* fixed capacity used up (RRLPool) */
+    RRL_ERR_NO_MEMORY        = -8,   /* an allocation failed             */
 };
 
 /*────────────────── Opaque handle ────────────────────────*/
 typedef struct RRLHandleImpl *RRLHandle; /* defined inside closed core */
 
+/*────────────────── Element types ────────────────────────*/
+enum {
+    RRL_DTYPE_FLOAT32 = 0,
+    RRL_DTYPE_FLOAT64 = 1,
+    RRL_DTYPE_INT32   = 2,
+    RRL_DTYPE_INT64   = 3,
+    RRL_DTYPE_UINT8   = 4,
+    RRL_DTYPE_INT8    = 5,
+    RRL_DTYPE_FLOAT16 = 6,
+    RRL_DTYPE_BOOL    = 7,   /* one byte per element */
+};
+
+/*────────────────── Mapped file (read-only) ──────────────*/
+typedef struct RRLMappedFileImpl *RRLMappedFile; /* refcounted, shared */
+
+/*────────────────── Shared policy ────────────────────────*/
+typedef struct RRLPolicyImpl *RRLPolicy; /* refcounted, bound to N handles */
+
+/*────────────────── Vectorized env ───────────────────────*/
+typedef struct RRLVecHandleImpl *RRLVecHandle; /* K sub-envs, one step call */
+
+/* Struct-of-arrays step buffers of an RRLVecHandle, owned by the vec.
+ * Every array starts RRL_BUFFER_ALIGN-aligned; sub-env i lives at
+ *   obs     + i * obs_stride     (obs_bytes used, stride 64-rounded)
+ *   actions + i * action_stride  (action_bytes used)
+ *   rewards[i], dones[i]         (dones: nonzero = episode ended) */
+typedef struct {
+    size_t   num_envs;
+    void    *obs;
+    size_t   obs_bytes, obs_stride;
+    void    *actions;
+    size_t   action_bytes, action_stride;
+    float   *rewards;
+    uint8_t *dones;
+} RRL_VecBuffers;
+
+/*────────────────── OS wait handle ───────────────────────*/
+/* eventfd (Linux) / kqueue descriptor (Apple) / HANDLE (Windows).
+ * Level-triggered: readable or signalled while rrl_poll() on the
+ * owning handle would return 1. */
+typedef intptr_t RRLWaitHandle;
+#define RRL_INVALID_WAIT_HANDLE ((RRLWaitHandle)-1)
+
 /*────────────────── Space descriptor ─────────────────────*/
 typedef struct {
     int shape[8];    /* tensor dimensions (up to 8-D)          */
     int ndim;        /* number of valid dims in shape[]         */
-    int dtype;       /* RRL_DTYPE_*  (enum defined elsewhere)   */
+    int dtype;       /* RRL_DTYPE_*                             */
 } RRL_SpaceDesc;
 
 /*────────────────── Stats snapshot ───────────────────────*/
@@ -45,10 +93,63 @@ typedef struct {
     unsigned long steps;      /* total environment steps taken   */
 } RRL_Stats;
 
+/*────────────────── Latency histogram ────────────────────*/
+/* Fixed log-linear buckets over microseconds (HDR-style): values
+ * below 8 µs are exact, above that each power of two is split into
+ * 8 sub-buckets (≤12.5 % error).  The last bucket catches everything
+ * from 15 << 23 µs (≈ 126 s) up, so percentiles saturate there. */
+#define RRL_HIST_BUCKETS 200
+
+typedef struct {
+    uint64_t counts[RRL_HIST_BUCKETS];
+    uint64_t total;    /* number of samples recorded */
+    uint64_t max_us;   /* exact largest sample       */
+} RRL_LatencyHist;
+
+/* Record one sample; lock-free and safe from any thread */
+void   rrl_hist_record    (RRL_LatencyHist *hist, uint64_t latency_us);
+/* Value (µs) at quantile q in [0,1]; 0 if the histogram is empty */
+double rrl_hist_percentile(const RRL_LatencyHist *hist, double q);
+
+/*────────────────── Stats snapshot v2 ────────────────────*/
+/* Versioned: set `struct_size` to sizeof(RRL_StatsV2) before calling
+ * rrl_get_stats_v2(); only that many bytes are written back. */
+typedef struct {
+    size_t          struct_size;
+    RRL_Stats       base;             /* v1 fields                       */
+    double          latency_p50_ms;   /* round-trip percentiles, derived */
+    double          latency_p90_ms;   /*   from `latency` by the SDK     */
+    double          latency_p99_ms;
+    double          latency_p999_ms;
+    double          latency_max_ms;
+    uint64_t        bytes_in;         /* wire bytes received             */
+    uint64_t        bytes_out;        /* wire bytes sent                 */
+    uint32_t        queue_depth;      /* steps currently queued          */
+    RRL_LatencyHist latency;          /* raw round-trip histogram        */
+    uint32_t        pipeline_depth;       /* configured in-flight limit  */
+    uint32_t        pipeline_depth_max;   /* most steps in flight so far */
+    uint64_t        reconnects;           /* transport sessions re-opened */
+    uint64_t        downtime_us;          /* time spent without a session */
+} RRL_StatsV2;
+
 /*────────────────── Core metadata API ────────────────────*/
 int rrl_action_space(RRLHandle handle, RRL_SpaceDesc *out_space);
 int rrl_observation_space(RRLHandle handle, RRL_SpaceDesc *out_space);
 
+/* Release `handle` and everything the core holds for it (exported by
+ * the core, for handles from rrl_open() or any other source). */
+void rrl_close(RRLHandle handle);
+
+/* Drop what the SDK keeps for `handle` (policy binding, preprocess
+ * pipeline, metrics tracking, replay binding).  The core's
+ * rrl_close() calls it before releasing the handle (exporters read
+ * its stats one last time); code that frees handles any other way
+ * does the same.  Never fails. */
+void rrl_handle_closed(RRLHandle handle);
+
+/* Dense byte size of one tensor of `space`; 0 if the descriptor is invalid */
+size_t rrl_space_bytes(const RRL_SpaceDesc *space);
+
 /* Legacy aliases (deprecated) */
 #define rrl_get_action_space       rrl_action_space
 #define rrl_get_observation_space rrl_observation_space
@@ -60,15 +161,466 @@ typedef struct {
     int (*load_policy)(RRLHandle, const void *bytes, size_t len);
 } RRL_BackendHooks;
 
-/* Register custom function table (pass NULL to restore stubs) */
+/* Register custom function table (pass NULL to restore stubs).
+ * The table is copied; swapping is safe while other threads are inside
+ * rrl_* calls — those finish on the table they started with. */
 int rrl_register_backend(const RRL_BackendHooks *hooks);
 
+/* Defined in rrl_wire.h */
+struct RRL_WireCodecConfig;
+struct RRL_MuxConfig;
+
+/*────────────────── Handle lifecycle ─────────────────────*/
+/* RRL_OpenConfig.transport */
+enum {
+    RRL_TRANSPORT_AUTO  = 0,   /* shared memory if the trainer is on this host */
+    RRL_TRANSPORT_RELAY = 1,   /* always the cloud relay                       */
+    RRL_TRANSPORT_SHM   = 2,   /* same-host only (rrl_shm.h); wait for it      */
+};
+
+/* Versioned: set `struct_size` to sizeof(RRL_OpenConfig). */
+typedef struct {
+    size_t      struct_size;
+    const char *api_key;     /* RemoteRL Cloud key; NULL on-premises   */
+    const char *env_id;      /* name the trainer sees for this env    */
+    size_t      resume_bytes; /* unacknowledged uplink kept for replay
+                                 after a reconnect; 0 = 1 MiB          */
+    int         transport;   /* RRL_TRANSPORT_*                        */
+} RRL_OpenConfig;
+
+/*────────────────── Backend extension table ──────────────*/
+/* Hooks added after v1 live here, not in RRL_BackendHooks, so the
+ * original table keeps its layout.  Set `struct_size` to
+ * sizeof(RRL_BackendHooksExt); hooks past that size (i.e. added in a
+ * newer header) are treated as NULL and fall back to the core path. */
+typedef struct {
+    size_t struct_size;
+    int (*poll_many)(const RRLHandle *handles, size_t n,
+                     uint64_t *ready_mask, size_t *ready_idx);
+    int (*bind_buffers)(RRLHandle, void *obs, size_t obs_bytes,
+                        void *act, size_t act_bytes);
+    int (*get_stats_v2)(RRLHandle, RRL_StatsV2 *);
+    /* Use the mapping in place; call rrl_mapped_retain() to keep it
+     * and rrl_mapped_release() once the handle stops using it. */
+    int (*load_policy_mapped)(RRLHandle, RRLMappedFile);
+    /* Reference `policy` for this handle (rrl_policy_retain it, release
+     * the previously bound one); read weights via rrl_policy_data(). */
+    int (*bind_policy)(RRLHandle, RRLPolicy);
+    int (*act_batch)(const RRLHandle *handles, size_t n,
+                     const void *obs, void *actions);
+    /* OS readiness object for the handle (see RRLWaitHandle) */
+    int (*get_wait_handle)(RRLHandle, RRLWaitHandle *out);
+    /* Block until one handle is ready: its index, or RRL_ERR_TIMEOUT */
+    int (*wait_any)(const RRLHandle *handles, size_t n, int64_t timeout_us);
+    /* Submit all k sub-env steps of `bufs` as one frame and block until
+     * every action is in bufs->actions (RRL_ERR_TIMEOUT otherwise).
+     * `bufs` is stable for the vec's lifetime and may be cached. */
+    int (*vec_step)(const RRLHandle *envs, size_t k,
+                    const RRL_VecBuffers *bufs, int64_t timeout_us);
+    /* Allow up to `depth` unanswered steps (see rrl_set_pipeline_depth) */
+    int (*set_pipeline_depth)(RRLHandle, unsigned depth);
+    /* Compress / delta-encode the handle's uplink (see rrl_wire.h) */
+    int (*set_wire_codec)(RRLHandle, const struct RRL_WireCodecConfig *cfg);
+    /* Report `space` from rrl_observation_space() and size uplink
+     * observations for it; NULL restores the env's own space
+     * (see rrl_set_preprocess) */
+    int (*set_observation_space)(RRLHandle, const RRL_SpaceDesc *space);
+    /* Create a handle for `cfg` (rrl_open); released by rrl_close() */
+    int (*open)(const RRL_OpenConfig *cfg, RRLHandle *out);
+    /* Start a new episode on a live handle, keeping its connection,
+     * buffers and bindings; must not allocate (see RRLPool) */
+    int (*reset)(RRLHandle);
+    /* Share connections between handles (see rrl_set_mux in rrl_wire.h) */
+    int (*set_mux)(const struct RRL_MuxConfig *cfg);
+} RRL_BackendHooksExt;
+
+/* Register extension table (pass NULL to restore stubs); copied as above */
+int rrl_register_backend_ext(const RRL_BackendHooksExt *ext);
+/* Both tables in one swap, so no call sees the new base hooks with the
+ * old extension hooks or the other way round; NULL restores the stubs
+ * of that table. */
+int rrl_register_backends(const RRL_BackendHooks *hooks, const RRL_BackendHooksExt *ext);
+
+/*────────────────── Tracing ──────────────────────────────*/
+/* Span kinds along one step.  The SDK records POLL, SERIALIZE,
+ * DESERIALIZE, POLICY_ACT and PREPROCESS itself and rrl::Runner wraps
+ * its callbacks in CALLBACK; SEND / RECV happen in the transport, so
+ * the core or backend reports them with rrl_trace_begin / _end. */
+enum {
+    RRL_SPAN_POLL        = 0,   /* rrl_poll / rrl_poll_many          */
+    RRL_SPAN_SERIALIZE   = 1,   /* rrl_wire_write_* / codec write    */
+    RRL_SPAN_SEND        = 2,
+    RRL_SPAN_RECV        = 3,
+    RRL_SPAN_DESERIALIZE = 4,   /* rrl_wire_parse / codec read       */
+    RRL_SPAN_POLICY_ACT  = 5,   /* rrl_policy_act / rrl_act_batch    */
+    RRL_SPAN_CALLBACK    = 6,   /* user step / observe / act code    */
+    RRL_SPAN_PREPROCESS  = 7,   /* rrl_preprocess                    */
+    RRL_SPAN_KINDS
+};
+
+/* Instrumentation hooks, called for every finished span on the thread
+ * that ran it (times in steady-clock nanoseconds).  Set `struct_size`
+ * to sizeof(RRL_TraceHooks).  Runs inside SDK calls: keep it short;
+ * spans from SDK calls it makes itself are not reported. */
+typedef struct {
+    size_t struct_size;
+    void  *user;
+    void (*span)(void *user, int kind, RRLHandle handle,
+                 uint64_t begin_ns, uint64_t end_ns);
+} RRL_TraceHooks;
+
+/* Copied; NULL removes them.  Safe while other threads are tracing. */
+int         rrl_register_trace_hooks(const RRL_TraceHooks *hooks);
+
+/* Built-in tracer: a ring of `spans_per_thread` spans (rounded up to a
+ * power of two; the oldest are overwritten) per thread that records
+ * one, filled in under 20 ns per span.  Restarting drops the spans
+ * recorded so far; the ring size applies to threads that start
+ * recording afterwards.  Builds configured with RRL_ENABLE_TRACING=OFF
+ * compile every SDK span out and return RRL_ERR_UNSUPPORTED here. */
+int         rrl_trace_start     (size_t spans_per_thread);
+void        rrl_trace_stop      (void);
+
+enum {
+    RRL_TRACE_CHROME_JSON = 0,  /* chrome://tracing, ui.perfetto.dev */
+    RRL_TRACE_PERFETTO    = 1,  /* Perfetto protobuf (TrackEvent)    */
+};
+/* Write the spans recorded since rrl_trace_start() to `path`.  Works
+ * while tracing; spans overwritten during the write are skipped. */
+int         rrl_trace_write     (const char *path, int format);
+
+/* Report a span from outside the SDK: t = rrl_trace_begin(); ...;
+ * rrl_trace_end(RRL_SPAN_SEND, handle, t).  rrl_trace_begin() returns 0
+ * when nothing is tracing, and rrl_trace_end() ignores a 0 begin. */
+uint64_t    rrl_trace_begin     (void);
+void        rrl_trace_end       (int kind, RRLHandle handle, uint64_t begin);
+
 /*────────────────── Five overridable exports ─────────────*/
 int         rrl_poll            (RRLHandle handle);                                /* 0/1 */
 int         rrl_get_stats       (RRLHandle handle, RRL_Stats *out_stats);          /* RRL_SUCCESS / err */
 int         rrl_load_policy     (RRLHandle handle, const void *bytes, size_t len); /* RRL_SUCCESS / err */
-int         rrl_last_error      (void);                                            /* returns last err code */
-const char *rrl_last_error_msg  (void);                                            /* human-readable */
+int         rrl_last_error      (void);                                            /* last err code (this thread) */
+const char *rrl_last_error_msg  (void);                                            /* human-readable (this thread) */
+
+/* Record `code` / `msg` as this thread's last error, exactly as the
+ * built-in exports do.  For link-time overrides of the functions above
+ * (see RRL_DEFINE_BACKEND in rrl_env.hpp); `msg` is copied. */
+void        rrl_set_last_error  (int code, const char *msg);
+
+/*────────────────── Batched readiness ────────────────────*/
+/* Number of uint64_t words needed for a ready mask over n handles */
+#define RRL_MASK_WORDS(n) (((n) + 63u) / 64u)
+
+/* Poll `n` handles in one call.  Both outputs are optional:
+ *   ready_mask : RRL_MASK_WORDS(n) words, bit i set if handles[i] is ready
+ *   ready_idx  : up to n entries, indices of ready handles in ascending order
+ * Returns the number of ready handles, or a negative RRL_ERR_* code.
+ * A null or failing handle counts as not ready and records last_error. */
+int         rrl_poll_many       (const RRLHandle *handles, size_t n,
+                                 uint64_t *ready_mask, size_t *ready_idx);
+
+/*────────────────── Event-driven readiness ───────────────*/
+/* OS object that becomes ready together with rrl_poll(), for callers
+ * running their own epoll / kevent / WaitForMultipleObjects loop.
+ * Owned by the handle: do not close it, and do not read it (the core
+ * clears it once the step is consumed).  RRL_INVALID_WAIT_HANDLE (and
+ * RRL_ERR_UNSUPPORTED in last_error) if the backend has none. */
+RRLWaitHandle rrl_get_wait_handle(RRLHandle handle);
+
+/* Block until any of `handles` is ready or `timeout_us` elapses
+ * (negative = forever, 0 = just check).  Returns the lowest index of
+ * a ready handle or RRL_ERR_TIMEOUT.  Sleeps on the wait handles when
+ * every handle has one; otherwise polls with a bounded back-off. */
+int         rrl_wait_any        (const RRLHandle *handles, size_t n, int64_t timeout_us);
+
+/*────────────────── Extended stats ───────────────────────*/
+/* Without a get_stats_v2 hook, `base` comes from rrl_get_stats() and
+ * the remaining fields are zero. */
+int         rrl_get_stats_v2    (RRLHandle handle, RRL_StatsV2 *out_stats);
+
+/*────────────────── Memory-mapped policies ───────────────*/
+/* Map `path` read-only; pages are faulted in lazily, never read up
+ * front.  Mapping the same file again returns the existing mapping
+ * with its refcount bumped, so N handles share one resident copy.
+ * Returns NULL (and sets last_error) on failure. */
+RRLMappedFile rrl_map_file      (const char *path);
+const void   *rrl_mapped_data   (RRLMappedFile file, size_t *out_len);
+void          rrl_mapped_retain (RRLMappedFile file);
+void          rrl_mapped_release(RRLMappedFile file);  /* unmaps at zero */
+
+/* Load a policy straight from a mapping.  Backends without a
+ * load_policy_mapped hook get the mapped bytes via rrl_load_policy();
+ * with no backend, every handle loading it binds one shared policy
+ * that reads the mapping in place. */
+int         rrl_load_policy_mapped(RRLHandle handle, RRLMappedFile file);
+/* Convenience: map, load, drop the caller's reference */
+int         rrl_load_policy_file  (RRLHandle handle, const char *path);
+
+/*────────────────── Shared policies ──────────────────────*/
+/* One loaded model referenced by any number of handles.  Binding is a
+ * refcount bump; rrl_policy_update*() swaps the weights for every
+ * bound handle in one atomic step.  Create returns NULL on error. */
+RRLPolicy   rrl_policy_create        (const void *bytes, size_t len); /* copies once */
+RRLPolicy   rrl_policy_create_mapped (RRLMappedFile file);            /* no copy     */
+int         rrl_policy_update        (RRLPolicy policy, const void *bytes, size_t len);
+int         rrl_policy_update_mapped (RRLPolicy policy, RRLMappedFile file);
+void        rrl_policy_retain        (RRLPolicy policy);
+void        rrl_policy_release       (RRLPolicy policy);
+
+/* Current weights and their version (bumped by every update).  The
+ * pointer is only usable inside a backend hook: it stays valid until
+ * the rrl_* call running the hook returns.  Anywhere else an update
+ * may free it at once; only the length and version can be used. */
+const void *rrl_policy_data          (RRLPolicy policy, size_t *out_len, uint64_t *out_version);
+
+/* Point `handle` at `policy` (NULL unbinds).  The SDK records the
+ * binding for rrl_act_batch(); backends without a bind_policy hook also
+ * get a one-off copy through rrl_load_policy() and miss later updates. */
+int         rrl_bind_policy          (RRLHandle handle, RRLPolicy policy);
+
+/*────────────────── On-device inference ──────────────────*/
+/* Built-in engine for policies in the rrl_policy_format.h layout
+ * (MLP / small CNN).  One batched forward pass per policy per call:
+ *   obs     : n observations packed back to back in the model's
+ *             input dtype and HWC layout
+ *   actions : n actions — int32 (argmax head) or float32[N]
+ * Sizes per env come from rrl_policy_io(). */
+int         rrl_policy_io            (RRLPolicy policy, size_t *obs_bytes, size_t *action_bytes);
+int         rrl_policy_act           (RRLPolicy policy, size_t n, const void *obs, void *actions);
+
+/* Same for the policies bound to `handles` (mixed policies must share
+ * obs/action sizes).  Routed to the act_batch hook when a backend
+ * provides one.  Unbound handles fail with RRL_ERR_INVALID_HANDLE.
+ * Without a backend, rrl_load_policy() also binds through this engine. */
+int         rrl_act_batch            (const RRLHandle *handles, size_t n,
+                                      const void *obs, void *actions);
+
+/*────────────────── Threads ──────────────────────────────*/
+/* Pin the calling thread to logical CPU `core` (used by rrl::Runner).
+ * RRL_ERR_UNSUPPORTED where the OS has no hard affinity (Apple). */
+int         rrl_pin_thread      (unsigned core);
+/* Logical CPUs this process may run on (its affinity mask, which
+ * taskset / cgroup cpusets narrow), ascending: the first `cap` go to
+ * `cores`, the total count is returned.  RRL_ERR_UNSUPPORTED where
+ * the OS does not say (Apple). */
+int         rrl_allowed_cores   (unsigned *cores, size_t cap);
+
+/*────────────────── Vectorized envs ──────────────────────*/
+/* Group k handles with identical observation/action spaces.  The vec
+ * keeps its own copy of `envs` but does not close them; destroy it
+ * before closing any sub-env.  Without a vec_step hook each sub-env
+ * gets its slices bound with rrl_bind_buffers(), which must succeed.
+ * Returns NULL (and sets last_error) on failure. */
+RRLVecHandle rrl_vec_create     (const RRLHandle *envs, size_t k);
+void         rrl_vec_destroy    (RRLVecHandle vec);
+int          rrl_vec_buffers    (RRLVecHandle vec, RRL_VecBuffers *out);
+const RRLHandle *rrl_vec_envs   (RRLVecHandle vec, size_t *out_k);
+
+/* Step all k sub-envs: fill obs/rewards/dones, call, read actions.
+ * The vec_step hook sends one frame for the whole vector; without it
+ * this waits until every sub-env reports ready (rewards/dones are then
+ * not transmitted).  RRL_ERR_TIMEOUT after `timeout_us` (negative =
+ * forever).  One thread at a time per vec. */
+int          rrl_vec_step       (RRLVecHandle vec, int64_t timeout_us);
+
+/*────────────────── Zero-copy I/O buffers ────────────────*/
+/* Required alignment for buffers passed to rrl_bind_buffers() */
+#define RRL_BUFFER_ALIGN 64
+
+/* Register caller-owned observation/action buffers for `handle`.
+ * Each must be RRL_BUFFER_ALIGN-aligned and at least
+ * rrl_space_bytes() of the matching space.  Once bound, the core
+ * reads observations straight from `obs` when a step is submitted and
+ * writes the next action into `act` before rrl_poll() reports ready,
+ * with no per-step copy or allocation.  Buffers must stay valid until
+ * unbound (pass NULL, 0) or the handle is closed. */
+int         rrl_bind_buffers    (RRLHandle handle,
+                                 void *obs, size_t obs_bytes,
+                                 void *act, size_t act_bytes);
+
+/*────────────────── Pipelined steps ──────────────────────*/
+/* Largest depth accepted by rrl_set_pipeline_depth() */
+#define RRL_MAX_PIPELINE_DEPTH 64
+
+/* Let `handle` send observations for steps t+1..t+depth-1 while the
+ * action for step t is still in flight, hiding WAN round trips.
+ * depth 1 (the default) is lock-step.  In pipelined mode rrl_poll()
+ * reports ready whenever fewer than `depth` steps are unanswered, the
+ * core copies each observation out when it is submitted (so a bound
+ * obs buffer is free again at once) and actions arrive in step order.
+ * Actions then lag observations by up to depth-1 steps: only suitable
+ * for trainers that tolerate it (off-policy).  Depths above 1 need a
+ * set_pipeline_depth hook; RRL_StatsV2 reports the depth reached. */
+int         rrl_set_pipeline_depth(RRLHandle handle, unsigned depth);
+
+/*────────────────── Observation preprocessing ────────────*/
+/* The usual grayscale → area resize → frame stack → normalize chain,
+ * run in the SDK on uint8 or float32 observations.  Shapes follow
+ * RRL_SpaceDesc: rank 3 is H×W×C, rank 2 is H×W (one channel), rank 1
+ * a feature vector (stacking and normalizing only).  Stages left at 0
+ * are skipped; the output space (rrl_preproc_output_space) is
+ *   grayscale   : C 3 → 1 (BT.601 luma)
+ *   resize      : H×W → resize_h×resize_w, each output pixel the
+ *                 area-weighted mean of the input pixels it covers
+ *   frame_stack : last N frames, oldest first, concatenated along the
+ *                 last axis (rank 2 gains a channel axis: H×W×N)
+ *   normalize   : float32 output (dtype is kept for RRL_NORM_NONE) */
+enum {
+    RRL_NORM_NONE    = 0,
+    RRL_NORM_SCALE   = 1,   /* x * scale + offset                      */
+    RRL_NORM_RUNNING = 2,   /* (x - mean) / std per element, clipped   */
+};
+
+typedef struct {
+    size_t struct_size;        /* sizeof(RRL_PreprocConfig)              */
+    int    grayscale;          /* nonzero: RGB → luma (needs C == 3)     */
+    int    resize_h, resize_w; /* 0, 0 = keep                            */
+    int    frame_stack;        /* N; 0 or 1 = off                        */
+    int    normalize;          /* RRL_NORM_*                             */
+    float  scale, offset;      /* SCALE; both 0 = 1/255 (uint8) or 1, 0  */
+    float  clip;               /* RUNNING: clamp to ±clip; 0 = 10        */
+    int    freeze_stats;       /* RUNNING: nonzero = normalize only      */
+} RRL_PreprocConfig;
+
+typedef struct RRLPreprocImpl *RRLPreproc;  /* one per observation stream */
+
+/* Build a pipeline for observations of space `in`; NULL (and
+ * last_error) if the config does not apply to it. */
+RRLPreproc  rrl_preproc_create      (const RRL_SpaceDesc *in, const RRL_PreprocConfig *cfg);
+void        rrl_preproc_destroy     (RRLPreproc pp);
+int         rrl_preproc_output_space(RRLPreproc pp, RRL_SpaceDesc *out_space);
+
+/* Transform one observation: `raw` in the input space, `out` has
+ * rrl_space_bytes() of the output space.  Frames are kept in a ring, so
+ * stacking costs one write per output element and nothing is shifted.
+ * Stateful (ring, running stats): one thread at a time per pipeline. */
+int         rrl_preproc_apply       (RRLPreproc pp, const void *raw, void *out);
+/* Episode boundary: the next frame fills the whole stack */
+void        rrl_preproc_reset       (RRLPreproc pp);
+
+/* Running mean / variance per output element (rrl_space_bytes(out) / 4
+ * floats each), e.g. to checkpoint them or share them between envs.
+ * Safe while another thread is in rrl_preproc_apply(). */
+int         rrl_preproc_get_stats   (RRLPreproc pp, float *mean, float *var, uint64_t *count);
+int         rrl_preproc_set_stats   (RRLPreproc pp, const float *mean, const float *var, uint64_t count);
+
+/* Attach a pipeline to `handle` (NULL cfg removes it).  From then on
+ * rrl_observation_space() reports the transformed space, and
+ * rrl_preprocess() turns a raw observation into one to submit (e.g.
+ * into the bound obs buffer).  The input space is the env's own, even
+ * when replacing a pipeline; a replacement with RRL_NORM_RUNNING over
+ * the same output size shares the running stats (a step still running
+ * on the old pipeline updates them too), any other starts afresh.
+ * rrl_close() detaches the pipeline.  Needs a set_observation_space
+ * hook. */
+int         rrl_set_preprocess      (RRLHandle handle, const RRL_PreprocConfig *cfg);
+int         rrl_preprocess          (RRLHandle handle, const void *raw, void *out);
+int         rrl_preprocess_reset    (RRLHandle handle);
+
+/*────────────────── Open / reset ─────────────────────────*/
+/* Weak defaults routed to the open / reset hooks (RRL_ERR_UNSUPPORTED
+ * without them); a core that creates handles itself overrides them.
+ * rrl_open returns NULL and sets last_error on failure. */
+RRLHandle   rrl_open            (const RRL_OpenConfig *cfg);
+int         rrl_reset           (RRLHandle handle);
+
+/*────────────────── Handle pools ─────────────────────────*/
+/* `capacity` handles opened once, up front.  Their obs / action
+ * buffers live in one contiguous arena and are bound with
+ * rrl_bind_buffers() where the backend supports it.  Acquire and
+ * release are a lock-free free-list pop / push plus rrl_reset(): no
+ * allocation, no syscalls in the SDK.  Handles stay owned by the pool
+ * — never rrl_close() one, nor wrap it in rrl::Env. */
+typedef struct RRLPoolImpl *RRLPool;
+
+typedef struct {
+    size_t       index;          /* 0 .. capacity-1, stable per handle */
+    void        *obs;            /* RRL_BUFFER_ALIGN-aligned          */
+    size_t       obs_bytes;
+    void        *actions;
+    size_t       action_bytes;
+    int          bound;          /* nonzero: bound to the handle      */
+} RRL_PoolSlot;
+
+/* NULL (and last_error) if any handle fails to open or bind */
+RRLPool     rrl_pool_create     (size_t capacity, const RRL_OpenConfig *cfg);
+/* Closes every handle, including ones still acquired */
+void        rrl_pool_destroy    (RRLPool pool);
+
+/* A free handle, or NULL with RRL_ERR_EXHAUSTED.  Safe from any thread. */
+RRLHandle   rrl_pool_acquire    (RRLPool pool);
+/* rrl_reset() the handle and make it available again.  If the reset
+ * fails the handle stays acquired (retry, or destroy the pool). */
+int         rrl_pool_release    (RRLPool pool, RRLHandle handle);
+
+int         rrl_pool_slot       (RRLPool pool, RRLHandle handle, RRL_PoolSlot *out);
+size_t      rrl_pool_available  (RRLPool pool);
+
+/*────────────────── Hot per-handle state ─────────────────*/
+/* Readiness and step counters for `n` handles, laid out so a
+ * backend's transport threads can update them without sharing cache
+ * lines: readiness is one bit per handle in a 64-byte-aligned bitmap,
+ * and each of `writers` threads owns padded struct-of-arrays counters
+ * (steps, latency, bytes) that only it writes.  Counters are summed
+ * across writers only when stats are read.
+ *
+ * Once registered, the SDK answers rrl_poll / rrl_poll_many /
+ * rrl_get_stats / rrl_get_stats_v2 from it for the handles it covers
+ * whenever the backend has no hook for the call.  Passing
+ * rrl_hot_handles() itself to rrl_poll_many() copies the bitmap
+ * straight into the ready mask. */
+typedef struct RRLHotStateImpl *RRLHotState;
+
+RRLHotState rrl_hot_create      (const RRLHandle *handles, size_t n, unsigned writers);
+/* Unregisters it if needed; memory is freed once no call can see it */
+void        rrl_hot_destroy     (RRLHotState hot);
+/* Handles in creation order (index i = handles[i]) */
+const RRLHandle *rrl_hot_handles(RRLHotState hot, size_t *out_n);
+/* Serve the calls above from `hot` (NULL = stop) */
+int         rrl_hot_register    (RRLHotState hot);
+
+/* Hot path, any thread; out-of-range indices are ignored */
+void        rrl_hot_set_ready   (RRLHotState hot, size_t index, int ready);
+/* One completed step of handle `index`, from writer thread `writer`
+ * (0 .. writers-1, each used by one thread at a time) */
+void        rrl_hot_record      (RRLHotState hot, unsigned writer, size_t index,
+                                 uint64_t latency_us, uint64_t bytes_in, uint64_t bytes_out);
+
+/*────────────────── Metrics export ───────────────────────*/
+/* Prometheus exposition of rrl_get_stats_v2() for the handles tracked
+ * by an exporter: fps, steps, bytes, reconnects, queue depth and the
+ * step latency, both as a histogram (aggregatable across a fleet) and
+ * as per-process quantiles.  Every series carries `node`; each tracked
+ * handle also adds to one aggregate per label it has, marked
+ * label="<label>" — the set-of-labels scheme of
+ * remoterl.init(labels=...) — next to the process-wide series, which
+ * have no `label`.  Versioned: set `struct_size`. */
+typedef struct {
+    size_t      struct_size;
+    const char *node;             /* NULL = "<hostname>-<pid>"                  */
+    const char *labels;           /* default labels, comma-separated: "gpu,lab-2" */
+    const char *listen;           /* "[host]:port" serving GET /metrics; NULL = off;
+                                     port 0 picks one (see rrl_metrics_port) */
+    const char *push_url;         /* "http://host:port" Pushgateway; NULL = off  */
+    unsigned    push_interval_ms; /* 0 = 10000                                  */
+} RRL_MetricsConfig;
+
+typedef struct RRLMetricsImpl *RRLMetrics;
+
+/* Starts one background thread if `listen` or `push_url` is set */
+RRLMetrics  rrl_metrics_create  (const RRL_MetricsConfig *cfg);
+void        rrl_metrics_destroy (RRLMetrics m);
+/* Labels as in the config; NULL uses the config's.  rrl_close()
+ * untracks the handle from every exporter.  Either way its gauges go
+ * and its last counter values stay in the totals, so exported
+ * counters never go backwards. */
+int         rrl_metrics_track   (RRLMetrics m, RRLHandle handle, const char *labels);
+int         rrl_metrics_untrack (RRLMetrics m, RRLHandle handle);
+/* Exposition text, NUL-terminated if it fits; returns its length
+ * (call with cap 0 to size the buffer). */
+size_t      rrl_metrics_render  (RRLMetrics m, char *out, size_t cap);
+/* Port of the /metrics endpoint, or 0 if none */
+int         rrl_metrics_port    (RRLMetrics m);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -3,26 +3,200 @@
 //─────────────────────────────────────────────────────────────
 //  • Keeps the *stable C ABI* underneath (rrl_env.h)
 //  • Adds RAII, std::string, and type-safe enums for C++ users.
-//  • Header-only: just #include and link against libremoterl.
+//  • Header-only: just #include and link against libremoterl
+//    (CMake: remoterl::cpp plus remoterl::static or ::shared).
 //─────────────────────────────────────────────────────────────
 #ifndef RRL_ENV_HPP
 #define RRL_ENV_HPP
 
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
 #include <string>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include <vector>
 #include "rrl_env.h"   // C API generated earlier
 
 namespace rrl {
+namespace coro { class NextAction; class Step; }   // rrl_env_coro.hpp (C++20)
+
 //──── Strong-typed view wrappers ───────────────────────────//
-struct ActionSpace { RRL_SpaceDesc raw; };
-struct ObservationSpace { RRL_SpaceDesc raw; };
+struct ActionSpace {
+    RRL_SpaceDesc raw;
+    std::size_t bytes() const noexcept { return rrl_space_bytes(&raw); }
+};
+struct ObservationSpace {
+    RRL_SpaceDesc raw;
+    std::size_t bytes() const noexcept { return rrl_space_bytes(&raw); }
+};
 struct Stats {
     RRL_Stats raw{};
     double      fps()      const noexcept { return raw.fps; }
     double      latency()  const noexcept { return raw.latency_ms; }
     unsigned long steps()  const noexcept { return raw.steps; }
 };
+struct StatsV2 {
+    RRL_StatsV2 raw{};
+    StatsV2() noexcept { raw.struct_size = sizeof(raw); }
+    Stats       base()      const noexcept { return {raw.base}; }
+    double      p50()       const noexcept { return raw.latency_p50_ms; }
+    double      p90()       const noexcept { return raw.latency_p90_ms; }
+    double      p99()       const noexcept { return raw.latency_p99_ms; }
+    double      p999()      const noexcept { return raw.latency_p999_ms; }
+    double      max()       const noexcept { return raw.latency_max_ms; }
+    uint64_t    bytes_in()  const noexcept { return raw.bytes_in; }
+    uint64_t    bytes_out() const noexcept { return raw.bytes_out; }
+    uint32_t    queue_depth() const noexcept { return raw.queue_depth; }
+    uint32_t    pipeline_depth() const noexcept     { return raw.pipeline_depth; }
+    uint32_t    pipeline_depth_max() const noexcept { return raw.pipeline_depth_max; }
+    uint64_t    reconnects() const noexcept         { return raw.reconnects; }
+    double      downtime_ms() const noexcept        { return static_cast<double>(raw.downtime_us) / 1000.0; }
+    double      percentile(double q) const noexcept { return rrl_hist_percentile(&raw.latency, q) / 1000.0; }
+};
+
+//──── Trace span (rrl_trace_begin / _end) ──────────────────//
+// Records RRL_SPAN_* `kind` around the enclosing scope.  Define
+// RRL_NO_TRACING to compile the wrapper's own spans out.
+class TraceSpan {
+public:
+#if defined(RRL_NO_TRACING)
+    TraceSpan(int, RRLHandle = nullptr) noexcept {}
+#else
+    TraceSpan(int kind, RRLHandle handle = nullptr) noexcept
+        : begin_(rrl_trace_begin()), kind_(kind), handle_(handle) {}
+    ~TraceSpan() { if (begin_) rrl_trace_end(kind_, handle_, begin_); }
+#endif
+    TraceSpan(const TraceSpan&)            = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+#if !defined(RRL_NO_TRACING)
+private:
+    uint64_t  begin_;
+    int       kind_;
+    RRLHandle handle_;
+#endif
+};
+
+//──── Caller-owned aligned buffer (for rrl_bind_buffers) ──//
+class AlignedBuffer {
+public:
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(std::size_t bytes)
+        : data_(bytes ? ::operator new(bytes, std::align_val_t{RRL_BUFFER_ALIGN}) : nullptr),
+          size_(bytes) {}
+    AlignedBuffer(const AlignedBuffer&)            = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    AlignedBuffer(AlignedBuffer&& o) noexcept : data_(o.data_), size_(o.size_) { o.data_ = nullptr; o.size_ = 0; }
+    AlignedBuffer& operator=(AlignedBuffer&& o) noexcept { std::swap(data_, o.data_); std::swap(size_, o.size_); return *this; }
+    ~AlignedBuffer() { if (data_) ::operator delete(data_, std::align_val_t{RRL_BUFFER_ALIGN}); }
+
+    void*       data() noexcept       { return data_; }
+    const void* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+    template <class T> T* as() noexcept { return static_cast<T*>(data_); }
+
+private:
+    void*       data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+//──── Shared read-only file mapping (refcounted) ──────────//
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) : f_(rrl_map_file(path.c_str())) {
+        if (!f_) throw std::runtime_error("rrl_map_file failed: " + path + " (" +
+                                          (rrl_last_error_msg() ? rrl_last_error_msg() : "") + ")");
+    }
+    MappedFile(const MappedFile& o) noexcept : f_(o.f_) { rrl_mapped_retain(f_); }
+    MappedFile& operator=(MappedFile o) noexcept { std::swap(f_, o.f_); return *this; }
+    MappedFile(MappedFile&& o) noexcept : f_(o.f_) { o.f_ = nullptr; }
+    ~MappedFile() { rrl_mapped_release(f_); }
+
+    const void* data() const noexcept { return rrl_mapped_data(f_, nullptr); }
+    std::size_t size() const noexcept { std::size_t n = 0; rrl_mapped_data(f_, &n); return n; }
+    RRLMappedFile raw() const noexcept { return f_; }
+
+private:
+    RRLMappedFile f_{};
+};
+
+//──── Shared policy (one model, many handles) ─────────────//
+class Policy {
+public:
+    Policy(const void* bytes, std::size_t len) : p_(rrl_policy_create(bytes, len)) { check(); }
+    explicit Policy(const MappedFile& file) : p_(rrl_policy_create_mapped(file.raw())) { check(); }
+    Policy(const Policy& o) noexcept : p_(o.p_) { rrl_policy_retain(p_); }
+    Policy& operator=(Policy o) noexcept { std::swap(p_, o.p_); return *this; }
+    Policy(Policy&& o) noexcept : p_(o.p_) { o.p_ = nullptr; }
+    ~Policy() { rrl_policy_release(p_); }
+
+    // Swap weights for every bound handle at once.
+    void update(const void* bytes, std::size_t len) {
+        if (rrl_policy_update(p_, bytes, len) != RRL_SUCCESS) fail("rrl_policy_update");
+    }
+    void update(const MappedFile& file) {
+        if (rrl_policy_update_mapped(p_, file.raw()) != RRL_SUCCESS) fail("rrl_policy_update_mapped");
+    }
+
+    // Built-in engine: one batched forward pass over n observations.
+    void act(std::size_t n, const void* obs, void* actions) const {
+        if (rrl_policy_act(p_, n, obs, actions) != RRL_SUCCESS) fail("rrl_policy_act");
+    }
+    std::size_t obs_bytes() const    { std::size_t o = 0; io(&o, nullptr); return o; }
+    std::size_t action_bytes() const { std::size_t a = 0; io(nullptr, &a); return a; }
+
+    RRLPolicy raw() const noexcept { return p_; }
+
+private:
+    RRLPolicy p_{};
+
+    void io(std::size_t* o, std::size_t* a) const {
+        if (rrl_policy_io(p_, o, a) != RRL_SUCCESS) fail("rrl_policy_io");
+    }
+
+    void check() const { if (!p_) fail("rrl_policy_create"); }
+    [[noreturn]] static void fail(const char* what) {
+        const char* msg = rrl_last_error_msg();
+        throw std::runtime_error(std::string(what) + " failed: " + (msg ? msg : ""));
+    }
+};
+
+//──── Observation preprocessing pipeline ──────────────────//
+class Preproc {
+public:
+    Preproc(const RRL_SpaceDesc& in, const RRL_PreprocConfig& cfg) : p_(rrl_preproc_create(&in, &cfg)) {
+        if (!p_) fail("rrl_preproc_create");
+    }
+    Preproc(const Preproc&)            = delete;
+    Preproc& operator=(const Preproc&) = delete;
+    Preproc(Preproc&& o) noexcept : p_(o.p_) { o.p_ = nullptr; }
+    Preproc& operator=(Preproc&& o) noexcept { std::swap(p_, o.p_); return *this; }
+    ~Preproc() { rrl_preproc_destroy(p_); }
+
+    ObservationSpace output_space() const {
+        RRL_SpaceDesc s{};
+        if (rrl_preproc_output_space(p_, &s) != RRL_SUCCESS) fail("rrl_preproc_output_space");
+        return {s};
+    }
+    void apply(const void* raw, void* out) {
+        if (rrl_preproc_apply(p_, raw, out) != RRL_SUCCESS) fail("rrl_preproc_apply");
+    }
+    void reset() noexcept { rrl_preproc_reset(p_); }
+
+    RRLPreproc raw() const noexcept { return p_; }
+
+private:
+    RRLPreproc p_{};
+
+    [[noreturn]] static void fail(const char* what) {
+        const char* msg = rrl_last_error_msg();
+        throw std::runtime_error(std::string(what) + " failed: " + (msg ? msg : ""));
+    }
+};
 
 //──── RAII handle wrapper ─────────────────────────────────//
 class Env {
@@ -34,10 +208,23 @@ public:
     Env(const Env&)            = delete;
     Env& operator=(const Env&) = delete;
     // Moveable
-    Env(Env&& other) noexcept : h_(other.h_) { other.h_ = nullptr; }
-    Env& operator=(Env&& o) noexcept { std::swap(h_, o.h_); return *this; }
+    Env(Env&& other) noexcept : h_(other.h_), io_(other.io_) { other.h_ = nullptr; other.io_ = {}; }
+    Env& operator=(Env&& o) noexcept { std::swap(h_, o.h_); std::swap(io_, o.io_); return *this; }
     ~Env() noexcept { if (h_) rrl_close(h_); }
 
+    // New handle from the backend / core (see rrl_open)
+    static Env open(const RRL_OpenConfig& cfg) {
+        RRLHandle h = rrl_open(&cfg);
+        if (!h) throw_error("open");
+        return Env(h);
+    }
+
+    // New episode on the same connection and buffers
+    void reset() {
+        if (rrl_reset(h_) != RRL_SUCCESS)
+            throw_error("reset");
+    }
+
     ActionSpace action_space() const {
         RRL_SpaceDesc s{};
         if (rrl_action_space(h_, &s) != RRL_SUCCESS)
@@ -52,8 +239,82 @@ public:
         return {s};
     }
 
+    // Zero-copy path: the core reads/writes these buffers in place.
+    // The buffers must outlive the binding (see rrl_bind_buffers).
+    void bind_buffers(void* obs, std::size_t obs_bytes, void* act, std::size_t act_bytes) {
+        if (rrl_bind_buffers(h_, obs, obs_bytes, act, act_bytes) != RRL_SUCCESS)
+            throw_error("bind_buffers");
+        io_ = {obs, obs_bytes, act, act_bytes};
+    }
+    void bind_buffers(AlignedBuffer& obs, AlignedBuffer& act) {
+        bind_buffers(obs.data(), obs.size(), act.data(), act.size());
+    }
+    void unbind_buffers() { bind_buffers(nullptr, 0, nullptr, 0); }
+
     bool poll() const { return rrl_poll(h_) != 0; }
 
+    // SDK-side observation pipeline; observation_space() then reports
+    // its output (see rrl_set_preprocess).
+    void set_preprocess(const RRL_PreprocConfig& cfg) {
+        if (rrl_set_preprocess(h_, &cfg) != RRL_SUCCESS)
+            throw_error("set_preprocess");
+    }
+    void clear_preprocess() {
+        if (rrl_set_preprocess(h_, nullptr) != RRL_SUCCESS)
+            throw_error("clear_preprocess");
+    }
+    // Raw observation → `out`, or into the bound obs buffer
+    void preprocess(const void* raw, void* out) {
+        if (rrl_preprocess(h_, raw, out) != RRL_SUCCESS)
+            throw_error("preprocess");
+    }
+    void preprocess(const void* raw) { preprocess(raw, io_.obs); }
+    void preprocess_reset() {
+        if (rrl_preprocess_reset(h_) != RRL_SUCCESS)
+            throw_error("preprocess_reset");
+    }
+
+    // Up to `depth` steps in flight at once (1 = lock-step; see rrl_set_pipeline_depth).
+    void set_pipeline_depth(unsigned depth) {
+        if (rrl_set_pipeline_depth(h_, depth) != RRL_SUCCESS)
+            throw_error("set_pipeline_depth");
+    }
+
+    // Batched readiness: one C call for the whole array.  `ready_idx`
+    // needs room for n entries; returns how many were filled.
+    static std::size_t poll_many(const RRLHandle* hs, std::size_t n, std::size_t* ready_idx) {
+        int rc = rrl_poll_many(hs, n, nullptr, ready_idx);
+        if (rc < 0) throw_error("poll_many");
+        return static_cast<std::size_t>(rc);
+    }
+
+    // Same, reusing `ready` across frames (no reallocation once grown).
+    static void poll_many(const std::vector<RRLHandle>& hs, std::vector<std::size_t>& ready) {
+        ready.resize(hs.size());
+        ready.resize(poll_many(hs.data(), hs.size(), ready.data()));
+    }
+
+    // OS readiness object for external epoll/kevent loops (see rrl_get_wait_handle).
+    RRLWaitHandle wait_handle() const {
+        RRLWaitHandle w = rrl_get_wait_handle(h_);
+        if (w == RRL_INVALID_WAIT_HANDLE) throw_error("wait_handle");
+        return w;
+    }
+
+    // Block until one of `hs` is ready; its index, or -1 on timeout.
+    static int wait_any(const RRLHandle* hs, std::size_t n, int64_t timeout_us = -1) {
+        int rc = rrl_wait_any(hs, n, timeout_us);
+        if (rc == RRL_ERR_TIMEOUT) return -1;
+        if (rc < 0) throw_error("wait_any");
+        return rc;
+    }
+
+    // On-device inference for the policies bound to `hs` (see rrl_act_batch).
+    static void act_batch(const RRLHandle* hs, std::size_t n, const void* obs, void* actions) {
+        if (rrl_act_batch(hs, n, obs, actions) != RRL_SUCCESS)
+            throw_error("act_batch");
+    }
+
     Stats stats() const {
         Stats s;
         if (rrl_get_stats(h_, &s.raw) != RRL_SUCCESS)
@@ -61,16 +322,58 @@ public:
         return s;
     }
 
+    StatsV2 stats_v2() const {
+        StatsV2 s;
+        if (rrl_get_stats_v2(h_, &s.raw) != RRL_SUCCESS)
+            throw_error("get_stats_v2");
+        return s;
+    }
+
     void load_policy(const void* bytes, size_t len) {
         if (rrl_load_policy(h_, bytes, len) != RRL_SUCCESS)
             throw_error("load_policy");
     }
 
+    void load_policy(const MappedFile& file) {
+        if (rrl_load_policy_mapped(h_, file.raw()) != RRL_SUCCESS)
+            throw_error("load_policy_mapped");
+    }
+
+    void load_policy_file(const std::string& path) {
+        if (rrl_load_policy_file(h_, path.c_str()) != RRL_SUCCESS)
+            throw_error("load_policy_file");
+    }
+
+    void bind_policy(const Policy& policy) {
+        if (rrl_bind_policy(h_, policy.raw()) != RRL_SUCCESS)
+            throw_error("bind_policy");
+    }
+
+#if defined(__cpp_impl_coroutine)
+    // Awaitables, defined in rrl_env_coro.hpp:
+    //   co_await env.next_action()     resumes once poll() reports ready
+    //   co_await env.step(obs, bytes)  copies into the bound obs buffer, then
+    //                                  awaits; yields the bound action buffer
+    coro::NextAction next_action() const;
+    coro::Step       step(const void* obs, std::size_t bytes);
+#endif
+
+    // Buffers from the last bind_buffers() (null when unbound)
+    void*       obs_buffer() const noexcept { return io_.obs; }
+    void*       action_buffer() const noexcept { return io_.act; }
+
     // direct raw access if really needed
     RRLHandle raw() const noexcept { return h_; }
 
 private:
+    struct Buffers {
+        void*       obs = nullptr;
+        std::size_t obs_bytes = 0;
+        void*       act = nullptr;
+        std::size_t act_bytes = 0;
+    };
     RRLHandle h_{};
+    Buffers   io_{};
 
     static void throw_error(const char* what) {
         auto code = rrl_last_error();
@@ -79,25 +382,347 @@ private:
     }
 };
 
+//──── Vectorized env (K sub-envs, SoA buffers) ───────────//
+class VecEnv {
+public:
+    // Sub-envs stay owned by the caller and must outlive the VecEnv.
+    explicit VecEnv(const std::vector<RRLHandle>& envs)
+        : v_(rrl_vec_create(envs.data(), envs.size())) {
+        if (!v_) throw_error("vec_create");
+        rrl_vec_buffers(v_, &b_);
+    }
+    VecEnv(const VecEnv&)            = delete;
+    VecEnv& operator=(const VecEnv&) = delete;
+    VecEnv(VecEnv&& o) noexcept : v_(o.v_), b_(o.b_) { o.v_ = nullptr; o.b_ = {}; }
+    VecEnv& operator=(VecEnv&& o) noexcept { std::swap(v_, o.v_); std::swap(b_, o.b_); return *this; }
+    ~VecEnv() { rrl_vec_destroy(v_); }
+
+    // Step every sub-env; false on timeout (negative = wait forever).
+    bool step(int64_t timeout_us = -1) {
+        int rc = rrl_vec_step(v_, timeout_us);
+        if (rc == RRL_ERR_TIMEOUT) return false;
+        if (rc != RRL_SUCCESS) throw_error("vec_step");
+        return true;
+    }
+
+    std::size_t size() const noexcept { return b_.num_envs; }
+    void*       obs(std::size_t i) const noexcept    { return static_cast<unsigned char*>(b_.obs) + i * b_.obs_stride; }
+    void*       action(std::size_t i) const noexcept { return static_cast<unsigned char*>(b_.actions) + i * b_.action_stride; }
+    float*      rewards() const noexcept { return b_.rewards; }
+    uint8_t*    dones() const noexcept   { return b_.dones; }
+    const RRLHandle* envs() const noexcept { return rrl_vec_envs(v_, nullptr); }
+
+    const RRL_VecBuffers& buffers() const noexcept { return b_; }
+    RRLVecHandle raw() const noexcept { return v_; }
+
+private:
+    RRLVecHandle   v_{};
+    RRL_VecBuffers b_{};
+
+    static void throw_error(const char* what) {
+        auto code = rrl_last_error();
+        const char* msg = rrl_last_error_msg();
+        throw std::runtime_error(std::string("RRL ") + what + ": [" + std::to_string(code) + "] " + (msg ? msg : ""));
+    }
+};
+
+//──── Preallocated handle pool ────────────────────────────//
+class Pool {
+public:
+    // Handle checked out of a Pool; released (reset) when destroyed.
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(const Lease&)            = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& o) noexcept : pool_(o.pool_), h_(o.h_) { o.h_ = nullptr; }
+        Lease& operator=(Lease&& o) noexcept { std::swap(pool_, o.pool_); std::swap(h_, o.h_); return *this; }
+        ~Lease() { if (h_) rrl_pool_release(pool_, h_); }
+
+        explicit operator bool() const noexcept { return h_ != nullptr; }
+        RRLHandle raw() const noexcept { return h_; }
+        RRL_PoolSlot slot() const {
+            RRL_PoolSlot s{};
+            if (rrl_pool_slot(pool_, h_, &s) != RRL_SUCCESS) fail("rrl_pool_slot");
+            return s;
+        }
+        // Hand back now; throws (and keeps the lease) if the reset fails.
+        void release() {
+            if (h_ && rrl_pool_release(pool_, h_) != RRL_SUCCESS) fail("rrl_pool_release");
+            h_ = nullptr;
+        }
+
+    private:
+        friend class Pool;
+        Lease(RRLPool p, RRLHandle h) noexcept : pool_(p), h_(h) {}
+        RRLPool   pool_{};
+        RRLHandle h_{};
+    };
+
+    Pool(std::size_t capacity, const RRL_OpenConfig& cfg) : p_(rrl_pool_create(capacity, &cfg)) {
+        if (!p_) fail("rrl_pool_create");
+    }
+    Pool(const Pool&)            = delete;
+    Pool& operator=(const Pool&) = delete;
+    Pool(Pool&& o) noexcept : p_(o.p_) { o.p_ = nullptr; }
+    Pool& operator=(Pool&& o) noexcept { std::swap(p_, o.p_); return *this; }
+    ~Pool() { rrl_pool_destroy(p_); }   // outstanding Leases must be gone
+
+    // Empty Lease when every handle is in use.
+    Lease acquire() noexcept { return Lease(p_, rrl_pool_acquire(p_)); }
+    std::size_t available() const noexcept { return rrl_pool_available(p_); }
+
+    RRLPool raw() const noexcept { return p_; }
+
+private:
+    RRLPool p_{};
+
+    [[noreturn]] static void fail(const char* what) {
+        const char* msg = rrl_last_error_msg();
+        throw std::runtime_error(std::string(what) + " failed: " + (msg ? msg : ""));
+    }
+};
+
+//──── Hot per-handle state (readiness bitmap, counters) ───//
+class HotState {
+public:
+    HotState(const RRLHandle* handles, std::size_t n, unsigned writers)
+        : h_(rrl_hot_create(handles, n, writers)) {
+        if (!h_) {
+            const char* msg = rrl_last_error_msg();
+            throw std::runtime_error(std::string("rrl_hot_create failed: ") + (msg ? msg : ""));
+        }
+    }
+    HotState(const HotState&)            = delete;
+    HotState& operator=(const HotState&) = delete;
+    HotState(HotState&& o) noexcept : h_(o.h_) { o.h_ = nullptr; }
+    HotState& operator=(HotState&& o) noexcept { std::swap(h_, o.h_); return *this; }
+    ~HotState() { rrl_hot_destroy(h_); }
+
+    void make_current() noexcept { rrl_hot_register(h_); }
+
+    void set_ready(std::size_t i, bool ready) noexcept { rrl_hot_set_ready(h_, i, ready ? 1 : 0); }
+    void record(unsigned writer, std::size_t i, std::uint64_t latency_us,
+                std::uint64_t bytes_in = 0, std::uint64_t bytes_out = 0) noexcept {
+        rrl_hot_record(h_, writer, i, latency_us, bytes_in, bytes_out);
+    }
+
+    // Pass to rrl_poll_many / VecEnv-style loops for the bitmap fast path.
+    const RRLHandle* handles(std::size_t* n = nullptr) const noexcept { return rrl_hot_handles(h_, n); }
+    RRLHotState raw() const noexcept { return h_; }
+
+private:
+    RRLHotState h_{};
+};
+
+//──── Prometheus exporter ─────────────────────────────────//
+class Metrics {
+public:
+    explicit Metrics(const RRL_MetricsConfig& cfg) : m_(rrl_metrics_create(&cfg)) {
+        if (!m_) fail("rrl_metrics_create");
+    }
+    Metrics(const Metrics&)            = delete;
+    Metrics& operator=(const Metrics&) = delete;
+    Metrics(Metrics&& o) noexcept : m_(o.m_) { o.m_ = nullptr; }
+    Metrics& operator=(Metrics&& o) noexcept { std::swap(m_, o.m_); return *this; }
+    ~Metrics() { rrl_metrics_destroy(m_); }
+
+    // `labels` = nullptr keeps the config's (comma-separated otherwise).
+    void track(RRLHandle h, const char* labels = nullptr) {
+        if (rrl_metrics_track(m_, h, labels) != RRL_SUCCESS) fail("rrl_metrics_track");
+    }
+    void untrack(RRLHandle h) noexcept { rrl_metrics_untrack(m_, h); }
+
+    std::string render() const {
+        // Text can grow between calls (new label values): retry until it fits.
+        std::string s(4096, '\0');
+        for (;;) {
+            const size_t n = rrl_metrics_render(m_, &s[0], s.size());
+            if (n < s.size()) { s.resize(n); return s; }
+            s.resize(n + 1024);
+        }
+    }
+    int port() const noexcept { return rrl_metrics_port(m_); }
+    RRLMetrics raw() const noexcept { return m_; }
+
+private:
+    RRLMetrics m_{};
+
+    [[noreturn]] static void fail(const char* what) {
+        const char* msg = rrl_last_error_msg();
+        throw std::runtime_error(std::string(what) + " failed: " + (msg ? msg : ""));
+    }
+};
+
 //──── Backend helper (runtime registration) ───────────────//
 class Backend {
 public:
     using poll_fn  = int(*)(RRLHandle);
     using stats_fn = int(*)(RRLHandle, RRL_Stats*);
     using load_fn  = int(*)(RRLHandle, const void*, size_t);
+    using poll_many_fn = int(*)(const RRLHandle*, size_t, uint64_t*, size_t*);
+    using bind_fn      = int(*)(RRLHandle, void*, size_t, void*, size_t);
+    using stats_v2_fn  = int(*)(RRLHandle, RRL_StatsV2*);
+    using mapped_fn    = int(*)(RRLHandle, RRLMappedFile);
+    using bind_policy_fn = int(*)(RRLHandle, RRLPolicy);
+    using act_batch_fn   = int(*)(const RRLHandle*, size_t, const void*, void*);
+    using wait_handle_fn = int(*)(RRLHandle, RRLWaitHandle*);
+    using wait_any_fn    = int(*)(const RRLHandle*, size_t, int64_t);
+    using vec_step_fn    = int(*)(const RRLHandle*, size_t, const RRL_VecBuffers*, int64_t);
+    using pipeline_fn    = int(*)(RRLHandle, unsigned);
+    using obs_space_fn   = int(*)(RRLHandle, const RRL_SpaceDesc*);
+    using open_fn        = int(*)(const RRL_OpenConfig*, RRLHandle*);
+    using reset_fn       = int(*)(RRLHandle);
 
     constexpr Backend(poll_fn p=nullptr, stats_fn s=nullptr, load_fn l=nullptr)
-        : hooks_{p,s,l} {}
+        : hooks_{p,s,l}, ext_{} { ext_.struct_size = sizeof(RRL_BackendHooksExt); }
+
+    constexpr Backend& with_poll_many(poll_many_fn f)  { ext_.poll_many = f;    return *this; }
+    constexpr Backend& with_bind_buffers(bind_fn f)    { ext_.bind_buffers = f; return *this; }
+    constexpr Backend& with_stats_v2(stats_v2_fn f)    { ext_.get_stats_v2 = f; return *this; }
+    constexpr Backend& with_load_policy_mapped(mapped_fn f) { ext_.load_policy_mapped = f; return *this; }
+    constexpr Backend& with_bind_policy(bind_policy_fn f)   { ext_.bind_policy = f; return *this; }
+    constexpr Backend& with_act_batch(act_batch_fn f)       { ext_.act_batch = f; return *this; }
+    constexpr Backend& with_wait_handle(wait_handle_fn f)   { ext_.get_wait_handle = f; return *this; }
+    constexpr Backend& with_wait_any(wait_any_fn f)         { ext_.wait_any = f; return *this; }
+    constexpr Backend& with_vec_step(vec_step_fn f)         { ext_.vec_step = f; return *this; }
+    constexpr Backend& with_pipeline_depth(pipeline_fn f)   { ext_.set_pipeline_depth = f; return *this; }
+    constexpr Backend& with_observation_space(obs_space_fn f) { ext_.set_observation_space = f; return *this; }
+    constexpr Backend& with_open(open_fn f)                 { ext_.open = f; return *this; }
+    constexpr Backend& with_reset(reset_fn f)               { ext_.reset = f; return *this; }
 
+    // One table swap.  Without with_*() hooks only the base table is
+    // replaced and extension hooks registered earlier stay in place.
     void install() const {
-        if (rrl_register_backend(&hooks_) != RRL_SUCCESS) {
-            throw std::runtime_error("rrl_register_backend failed");
-        }
+        const int rc = has_ext() ? rrl_register_backends(&hooks_, &ext_) : rrl_register_backend(&hooks_);
+        if (rc != RRL_SUCCESS) throw std::runtime_error("rrl_register_backends failed");
     }
 private:
-    RRL_BackendHooks hooks_;
+    bool has_ext() const noexcept {
+        RRL_BackendHooksExt none{};
+        none.struct_size = sizeof(none);
+        return std::memcmp(&ext_, &none, sizeof(none)) != 0;
+    }
+
+    RRL_BackendHooks    hooks_;
+    RRL_BackendHooksExt ext_;
+};
+
+//──── Static backend (link-time override) ─────────────────//
+// StaticBackend<Impl> implements the exports with the same checks and
+// error reporting as the built-in defaults, but calls Impl's static
+// members directly: no table snapshot, no indirect branch, and Impl's
+// code can be inlined into the SDK checks.  Impl provides
+//     static int poll(RRLHandle);                                  // required
+//     static int get_stats(RRLHandle, RRL_Stats*);                 // optional
+//     static int load_policy(RRLHandle, const void*, std::size_t); // optional
+//     static int poll_many(const RRLHandle*, std::size_t,
+//                          uint64_t* mask, std::size_t* idx);      // optional
+// Omitted hooks report RRL_ERR_UNSUPPORTED (poll_many loops over poll).
+// RRL_DEFINE_BACKEND(Impl) in exactly one .cpp emits the strong C
+// symbols; rrl_register_backend() tables are then bypassed for them.
+namespace detail {
+template <class T, class = void> struct has_get_stats : std::false_type {};
+template <class T>
+struct has_get_stats<T, std::void_t<decltype(T::get_stats(RRLHandle{}, static_cast<RRL_Stats*>(nullptr)))>>
+    : std::true_type {};
+
+template <class T, class = void> struct has_load_policy : std::false_type {};
+template <class T>
+struct has_load_policy<T, std::void_t<decltype(T::load_policy(RRLHandle{}, static_cast<const void*>(nullptr), std::size_t{}))>>
+    : std::true_type {};
+
+template <class T, class = void> struct has_poll_many : std::false_type {};
+template <class T>
+struct has_poll_many<T, std::void_t<decltype(T::poll_many(static_cast<const RRLHandle*>(nullptr), std::size_t{},
+                                                          static_cast<uint64_t*>(nullptr),
+                                                          static_cast<std::size_t*>(nullptr)))>>
+    : std::true_type {};
+} // namespace detail
+
+template <class Impl>
+struct StaticBackend {
+    static int poll(RRLHandle h) {
+        if (!h) {
+            rrl_set_last_error(RRL_ERR_INVALID_HANDLE, "rrl_poll: null handle");
+            return 0;
+        }
+        int rc = Impl::poll(h);
+        if (rc < 0) {
+            rrl_set_last_error(rc, "rrl_poll: backend error");
+            return 0;
+        }
+        return rc;
+    }
+
+    static int get_stats(RRLHandle h, RRL_Stats* out) {
+        if (!h || !out) {
+            rrl_set_last_error(RRL_ERR_INVALID_ARGUMENT, "rrl_get_stats: null arg");
+            return RRL_ERR_INVALID_ARGUMENT;
+        }
+        int rc = RRL_ERR_UNSUPPORTED;
+        if constexpr (detail::has_get_stats<Impl>::value) rc = Impl::get_stats(h, out);
+        else *out = RRL_Stats{};
+        if (rc != RRL_SUCCESS) rrl_set_last_error(rc, "rrl_get_stats: backend error");
+        return rc;
+    }
+
+    static int load_policy(RRLHandle h, const void* bytes, std::size_t len) {
+        if (!h) {
+            rrl_set_last_error(RRL_ERR_INVALID_HANDLE, "rrl_load_policy: null handle");
+            return RRL_ERR_INVALID_HANDLE;
+        }
+        if (!bytes || len == 0) {
+            rrl_set_last_error(RRL_ERR_INVALID_ARGUMENT, "rrl_load_policy: empty blob");
+            return RRL_ERR_INVALID_ARGUMENT;
+        }
+        int rc = RRL_ERR_UNSUPPORTED;
+        if constexpr (detail::has_load_policy<Impl>::value) rc = Impl::load_policy(h, bytes, len);
+        if (rc != RRL_SUCCESS) rrl_set_last_error(rc, "rrl_load_policy: backend error");
+        return rc;
+    }
+
+    static int poll_many(const RRLHandle* hs, std::size_t n, uint64_t* mask, std::size_t* idx) {
+        if ((!hs && n) || n > static_cast<std::size_t>(INT_MAX)) {
+            rrl_set_last_error(RRL_ERR_INVALID_ARGUMENT, "rrl_poll_many: bad handle array");
+            return RRL_ERR_INVALID_ARGUMENT;
+        }
+        if (mask) std::memset(mask, 0, RRL_MASK_WORDS(n) * sizeof(uint64_t));
+        if constexpr (detail::has_poll_many<Impl>::value) {
+            int rc = Impl::poll_many(hs, n, mask, idx);
+            if (rc < 0) rrl_set_last_error(rc, "rrl_poll_many: backend error");
+            return rc;
+        } else {
+            int ready = 0;
+            int first_err = RRL_SUCCESS;
+            for (std::size_t i = 0; i < n; ++i) {
+                int rc = hs[i] ? Impl::poll(hs[i]) : RRL_ERR_INVALID_HANDLE;
+                if (rc < 0) { if (first_err == RRL_SUCCESS) first_err = rc; continue; }
+                if (rc == 0) continue;
+                if (mask) mask[i / 64] |= uint64_t(1) << (i % 64);
+                if (idx)  idx[ready] = i;
+                ++ready;
+            }
+            if (first_err != RRL_SUCCESS)
+                rrl_set_last_error(first_err, "rrl_poll_many: null handle or backend error");
+            return ready;
+        }
+    }
 };
 
 } // namespace rrl
 
+// Emit strong rrl_poll / rrl_get_stats / rrl_load_policy / rrl_poll_many
+// backed by rrl::StaticBackend<Impl>.  Use at namespace scope, once per binary.
+#define RRL_DEFINE_BACKEND(Impl)                                                        \
+    extern "C" int rrl_poll(RRLHandle h)                                                \
+    { return ::rrl::StaticBackend<Impl>::poll(h); }                                     \
+    extern "C" int rrl_get_stats(RRLHandle h, RRL_Stats* s)                             \
+    { return ::rrl::StaticBackend<Impl>::get_stats(h, s); }                             \
+    extern "C" int rrl_load_policy(RRLHandle h, const void* b, size_t n)                \
+    { return ::rrl::StaticBackend<Impl>::load_policy(h, b, n); }                        \
+    extern "C" int rrl_poll_many(const RRLHandle* hs, size_t n, uint64_t* m, size_t* i) \
+    { return ::rrl::StaticBackend<Impl>::poll_many(hs, n, m, i); }                      \
+    static_assert(true, "require a trailing semicolon")
+
 #endif /* RRL_ENV_HPP */
@@ -0,0 +1,275 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_env_coro.hpp  —  C++20 coroutine layer over rrl::Env
+//─────────────────────────────────────────────────────────────
+//  • Optional: include after (or instead of) rrl_env.hpp in C++20
+//    translation units; the C ABI and rrl_env.hpp are unchanged.
+//  • co_await env.next_action() / env.step(obs, bytes) suspend the
+//    calling coroutine until the env is ready.
+//  • rrl::coro::Executor drives any number of such coroutines on one
+//    thread: every round it resumes what is runnable, collects ready
+//    envs with one rrl_poll_many(), and blocks in rrl_wait_any() only
+//    when nothing is ready.
+//  • A handle that fails (closed, backend error) resumes its waiting
+//    coroutine with a std::runtime_error out of the co_await instead
+//    of leaving it parked forever; a failing rrl_poll_many() or
+//    rrl_wait_any() call throws out of run_once().  Both clear this
+//    thread's last error before polling, to tell failures apart.
+//─────────────────────────────────────────────────────────────
+#ifndef RRL_ENV_CORO_HPP
+#define RRL_ENV_CORO_HPP
+
+#include "rrl_env.hpp"
+
+#if !defined(__cpp_impl_coroutine)
+#  error "rrl_env_coro.hpp requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rrl { namespace coro {
+
+class Executor;
+
+// Why a wait ended without the env becoming ready (code 0: it did not).
+struct WaitError {
+    int         code = RRL_SUCCESS;
+    std::string msg;
+
+    void set(int c) { code = c; msg = rrl_last_error_msg() ? rrl_last_error_msg() : ""; }
+    [[noreturn]] void raise(const char* what) const {
+        throw std::runtime_error(std::string("RRL ") + what + ": [" + std::to_string(code) + "] " + msg);
+    }
+};
+
+//──── Task: a top-level coroutine owned by an Executor ────//
+class Task {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+        Task get_return_object() noexcept {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    Task(Task&& o) noexcept : h_(std::exchange(o.h_, {})) {}
+    Task& operator=(Task o) noexcept { std::swap(h_, o.h_); return *this; }
+    Task(const Task&) = delete;
+    ~Task() { if (h_) h_.destroy(); }
+
+private:
+    friend class Executor;
+    explicit Task(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+    std::coroutine_handle<promise_type> release() noexcept { return std::exchange(h_, {}); }
+
+    std::coroutine_handle<promise_type> h_;
+};
+
+//──── Single-threaded executor ────────────────────────────//
+class Executor {
+public:
+    Executor() = default;
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+    ~Executor() {
+        for (auto h : tasks_) h.destroy();
+    }
+
+    // Queue a coroutine; it first runs inside the next run_once().
+    void spawn(Task t) {
+        auto h = t.release();
+        tasks_.push_back(h);
+        runnable_.push_back(h);
+    }
+
+    // One scheduling round: resume everything runnable, then wait up to
+    // `timeout_us` (negative = forever) for a suspended env to become
+    // ready.  Rethrows the first exception escaping a task.  Returns
+    // false once every task has finished.
+    bool run_once(int64_t timeout_us = -1) {
+        Current scope(this);
+        resume_runnable();
+        if (waiting_h_.empty()) return !tasks_.empty();
+        if (!collect_ready()) {
+            const int rc = rrl_wait_any(waiting_h_.data(), waiting_h_.size(), timeout_us);
+            if (rc >= 0) collect_ready();
+            else if (rc != RRL_ERR_TIMEOUT) fail(rc, "wait_any");
+        }
+        return true;
+    }
+
+    // Drive until every task has finished.
+    void run() { while (run_once()) {} }
+
+    std::size_t tasks()     const noexcept { return tasks_.size(); }
+    std::size_t suspended() const noexcept { return waiting_h_.size(); }
+
+    // Executor running on this thread (inside run_once), or null.
+    static Executor* current() noexcept { return current_ref(); }
+
+    // Park `co` until `h` reports ready.  If `h` fails instead, `co`
+    // is resumed with the failure in `*err`; without `err`, run_once()
+    // throws it.
+    void wait_for(RRLHandle h, std::coroutine_handle<> co, WaitError* err = nullptr) {
+        waiting_h_.push_back(h);
+        waiting_co_.push_back(co);
+        waiting_err_.push_back(err);
+    }
+
+private:
+    using TaskHandle = std::coroutine_handle<Task::promise_type>;
+
+    struct Current {
+        Executor* prev;
+        explicit Current(Executor* e) : prev(std::exchange(current_ref(), e)) {}
+        ~Current() { current_ref() = prev; }
+    };
+    static Executor*& current_ref() noexcept {
+        static thread_local Executor* cur = nullptr;
+        return cur;
+    }
+
+    void resume_runnable() {
+        batch_.swap(runnable_);
+        for (auto co : batch_) co.resume();
+        batch_.clear();
+        reap();
+    }
+
+    // Destroy finished tasks; rethrow the first failure.
+    void reap() {
+        std::exception_ptr first;
+        for (std::size_t i = 0; i < tasks_.size();) {
+            TaskHandle h = tasks_[i];
+            if (!h.done()) { ++i; continue; }
+            if (h.promise().error && !first) first = h.promise().error;
+            h.destroy();
+            tasks_[i] = tasks_.back();
+            tasks_.pop_back();
+        }
+        if (first) std::rethrow_exception(first);
+    }
+
+    [[noreturn]] static void fail(int code, const char* what) {
+        WaitError e;
+        e.set(code);
+        e.raise(what);
+    }
+
+    // Waiter `i` becomes runnable (swap-remove).
+    void wake(std::size_t i) {
+        runnable_.push_back(waiting_co_[i]);
+        waiting_h_[i]   = waiting_h_.back();
+        waiting_co_[i]  = waiting_co_.back();
+        waiting_err_[i] = waiting_err_.back();
+        waiting_h_.pop_back();
+        waiting_co_.pop_back();
+        waiting_err_.pop_back();
+    }
+
+    // Move every ready or failed waiter to the runnable list; false if none.
+    bool collect_ready() {
+        idx_.resize(waiting_h_.size());
+        rrl_set_last_error(RRL_SUCCESS, nullptr);
+        const int n = rrl_poll_many(waiting_h_.data(), waiting_h_.size(), nullptr, idx_.data());
+        if (n < 0) fail(n, "poll_many");
+        // Failing handles count as not ready but leave last_error set.
+        const bool broken = rrl_last_error() != RRL_SUCCESS;
+        // Indices ascend, so swap-remove from the back keeps lower ones valid.
+        for (int k = n - 1; k >= 0; --k) wake(idx_[k]);
+        return (broken && wake_failed()) || n > 0;
+    }
+
+    // Poll the rest one by one and hand each failure to its waiter.
+    // Walks down so a swap-remove only moves entries already seen.
+    bool wake_failed() {
+        bool any = false;
+        for (std::size_t i = waiting_h_.size(); i-- > 0;) {
+            rrl_set_last_error(RRL_SUCCESS, nullptr);
+            const int rc  = rrl_poll(waiting_h_[i]);
+            const int err = rc < 0 ? rc : rrl_last_error();
+            if (err == RRL_SUCCESS && rc == 0) continue;
+            if (err != RRL_SUCCESS) {
+                if (!waiting_err_[i]) fail(err, "poll");
+                waiting_err_[i]->set(err);
+            }
+            wake(i);
+            any = true;
+        }
+        return any;
+    }
+
+    std::vector<TaskHandle>              tasks_;
+    std::vector<std::coroutine_handle<>> runnable_, batch_;
+    std::vector<RRLHandle>               waiting_h_;   // parallel to waiting_co_
+    std::vector<std::coroutine_handle<>> waiting_co_;
+    std::vector<WaitError*>              waiting_err_;
+    std::vector<std::size_t>             idx_;
+};
+
+//──── Awaitables ──────────────────────────────────────────//
+// Resumes once rrl_poll() reports the env ready; no suspension at all
+// if it already is.  Throws std::runtime_error from the co_await if
+// the handle fails instead.
+class NextAction {
+public:
+    explicit NextAction(RRLHandle h) noexcept : h_(h) {}
+    bool await_ready() {
+        rrl_set_last_error(RRL_SUCCESS, nullptr);
+        const int rc  = rrl_poll(h_);
+        const int err = rc < 0 ? rc : rrl_last_error();
+        if (err != RRL_SUCCESS) err_.set(err);   // resume at once and throw
+        return rc > 0 || err != RRL_SUCCESS;
+    }
+    void await_suspend(std::coroutine_handle<> co) {
+        Executor* ex = Executor::current();
+        if (!ex) throw std::logic_error("rrl::coro: co_await outside Executor::run_once");
+        ex->wait_for(h_, co, &err_);
+    }
+    void await_resume() const {
+        if (err_.code != RRL_SUCCESS) err_.raise("next_action");
+    }
+
+private:
+    RRLHandle h_;
+    WaitError err_;
+};
+
+// Same, yielding the bound action buffer.
+class Step : public NextAction {
+public:
+    Step(RRLHandle h, void* act) noexcept : NextAction(h), act_(act) {}
+    void* await_resume() const {
+        NextAction::await_resume();
+        return act_;
+    }
+
+private:
+    void* act_;
+};
+
+}} // namespace rrl::coro
+
+namespace rrl {
+
+inline coro::NextAction Env::next_action() const { return coro::NextAction{h_}; }
+
+inline coro::Step Env::step(const void* obs, std::size_t bytes) {
+    if (!io_.obs || bytes > io_.obs_bytes)
+        throw std::invalid_argument("rrl::Env::step: no bound observation buffer of that size");
+    if (obs != io_.obs) std::memcpy(io_.obs, obs, bytes);
+    return coro::Step{h_, io_.act};
+}
+
+} // namespace rrl
+
+#endif /* RRL_ENV_CORO_HPP */
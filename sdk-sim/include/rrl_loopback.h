@@ -0,0 +1,87 @@
+/*───────────────────────────────────────────────────────────
+ *  rrl_loopback.h  —  In-process ghost trainer for load tests
+ *
+ *  A backend that answers every step itself, so a simulator build can
+ *  be driven at full speed in CI without a cloud trainer: installed
+ *  with rrl_loopback_install() it serves rrl_open / rrl_poll /
+ *  rrl_wait_any / rrl_vec_step / rrl_get_stats(_v2) and reports the
+ *  same RRL_Stats a real session would.
+ *
+ *  Actions are replayed from a recorded stream (back-to-back raw
+ *  actions, looped per handle and rewound by rrl_reset) or drawn at
+ *  random for the action space.  `concurrency` trainer threads answer
+ *  steps in due order; each step is due `latency_us` (+ up to
+ *  `jitter_us`) after it was submitted, no earlier than 1/rate_hz
+ *  after the handle's previous one, and occupies a thread for
+ *  `service_us`.  With a fixed seed and no jitter, runs are
+ *  reproducible up to the OS scheduler.
+ *
+ *  The step protocol the core normally implements is explicit here:
+ *  rrl_loopback_submit() sends the observation, rrl_poll() reports 1
+ *  once the action is in the bound act buffer (or rrl_loopback_action)
+ *  and keeps reporting 1 until the next submit.
+ *───────────────────────────────────────────────────────────*/
+#ifndef RRL_LOOPBACK_H
+#define RRL_LOOPBACK_H
+
+#include "rrl_env.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Versioned: set `struct_size` to sizeof(RRL_LoopbackConfig). */
+typedef struct {
+    size_t               struct_size;
+    /* Spaces of the handles it opens; NULL = ask the core
+     * (rrl_action_space / rrl_observation_space), which must then
+     * accept loopback handles — stand-in cores such as
+     * bench/bench_core.cpp do. */
+    const RRL_SpaceDesc *action_space;
+    const RRL_SpaceDesc *observation_space;
+    /* Recorded actions, rrl_space_bytes(action_space) each; copied.
+     * `actions_path` maps a file of the same layout instead.  Neither
+     * = random: floats uniform in [-1, 1], integers in
+     * [0, action_high), bools 0 / 1. */
+    const void          *actions;
+    size_t               actions_bytes;
+    const char          *actions_path;
+    int32_t              action_high;  /* 0 = 2                            */
+    double               rate_hz;      /* per-handle step cap; 0 = none    */
+    uint32_t             latency_us;   /* submit → due                     */
+    uint32_t             jitter_us;    /* + uniform [0, jitter_us]          */
+    uint32_t             service_us;   /* trainer thread time per step     */
+    unsigned             concurrency;  /* trainer threads; 0 = 1           */
+    uint64_t             seed;         /* actions and jitter               */
+} RRL_LoopbackConfig;
+
+typedef struct RRLLoopbackImpl *RRLLoopback;
+
+/* Starts the trainer threads; NULL (and last_error) on a bad config */
+RRLLoopback rrl_loopback_create (const RRL_LoopbackConfig *cfg);
+/* Uninstalls it if needed (as rrl_loopback_install(NULL)) and frees
+ * every handle it opened (the core's rrl_close() does not: close them
+ * only through here) */
+void        rrl_loopback_destroy(RRLLoopback lb);
+
+/* Register it as the backend (both hook tables in one swap), replacing
+ * any other.  NULL uninstalls the installed loopback and restores the
+ * backend registered before it (before the first, if loopbacks were
+ * installed over each other), unless another backend was registered
+ * since.  Hooks given a handle the loopback did not open return
+ * RRL_ERR_INVALID_HANDLE. */
+int         rrl_loopback_install(RRLLoopback lb);
+
+/* Submit the handle's next observation (precondition: nothing in
+ * flight; RRL_ERR_INVALID_ARGUMENT otherwise).  Any thread, one at a
+ * time per handle.  RRL_ERR_INVALID_HANDLE unless the installed
+ * loopback opened it. */
+int         rrl_loopback_submit (RRLHandle handle);
+/* Last delivered action when no act buffer is bound (NULL otherwise) */
+const void *rrl_loopback_action (RRLHandle handle, size_t *out_len);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RRL_LOOPBACK_H */
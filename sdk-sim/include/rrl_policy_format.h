@@ -0,0 +1,85 @@
+/*───────────────────────────────────────────────────────────
+ *  rrl_policy_format.h  —  On-disk layout of exported policies
+ *
+ *  Written by remoterl/policy_export.py, read in place by the
+ *  built-in inference engine (rrl_policy_act / rrl_act_batch).
+ *  All fields are little-endian.  A file is:
+ *
+ *      RRL_PolicyHeader                       (64 bytes)
+ *      RRL_PolicyLayer[num_layers]            (80 bytes each)
+ *      weight / scale / bias blobs, each `weight_align`-aligned
+ *
+ *  Activations are laid out HWC; dense layers see the flattened
+ *  HWC tensor.  Weights are stored K×N row-major (input-major), so
+ *  a layer is Y[M×N] = X[M×K] · W[K×N] + b, with K = kernel²·in_C
+ *  ordered (ky, kx, c) for convolutions.
+ *
+ *  Weights may be float32, float16, or int8 with one float32 scale
+ *  per output column (W[k][n] = q[k][n] · scale[n]); accumulation is
+ *  always float32.  Biases are float32.  The built-in engine widens
+ *  quantized weights to float32 as it reads them, so they save file
+ *  size, resident memory and bandwidth; it has no int8 arithmetic
+ *  path and does not run faster per multiply.
+ *───────────────────────────────────────────────────────────*/
+#ifndef RRL_POLICY_FORMAT_H
+#define RRL_POLICY_FORMAT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RRL_POLICY_MAGIC    0x504C5252u   /* "RRLP" */
+#define RRL_POLICY_VERSION  2u    /* v2: quantized weights, weight_align */
+#define RRL_POLICY_ALIGN    64u   /* default / minimum useful alignment  */
+
+enum {
+    RRL_LAYER_DENSE  = 0,
+    RRL_LAYER_CONV2D = 1,   /* valid padding, square kernel */
+};
+
+enum {
+    RRL_ACT_NONE = 0,
+    RRL_ACT_RELU = 1,
+    RRL_ACT_TANH = 2,
+};
+
+enum {
+    RRL_POLICY_OUT_ARGMAX     = 0,  /* one int32 action per env          */
+    RRL_POLICY_OUT_CONTINUOUS = 1,  /* float32[last layer N] per env     */
+};
+
+typedef struct {
+    uint32_t magic;          /* RRL_POLICY_MAGIC                       */
+    uint32_t version;        /* RRL_POLICY_VERSION                     */
+    uint32_t num_layers;
+    uint32_t output_kind;    /* RRL_POLICY_OUT_*                       */
+    int32_t  input_dtype;    /* RRL_DTYPE_FLOAT32 or RRL_DTYPE_UINT8   */
+    uint32_t input_dims[3];  /* H, W, C  (vectors: 1, 1, features)     */
+    float    input_scale;    /* x = raw * scale + offset               */
+    float    input_offset;
+    uint32_t weight_align;   /* blob alignment, power of two; 0 = 64   */
+    uint32_t reserved[5];
+} RRL_PolicyHeader;
+
+typedef struct {
+    uint32_t kind;           /* RRL_LAYER_*                            */
+    uint32_t activation;     /* RRL_ACT_*                              */
+    uint32_t in_dims[3];     /* H, W, C                                */
+    uint32_t out_dims[3];    /* H, W, C  (dense: 1, 1, N)              */
+    uint32_t kernel;         /* conv only                              */
+    uint32_t stride;         /* conv only                              */
+    int32_t  weight_dtype;   /* RRL_DTYPE_FLOAT32 / FLOAT16 / INT8     */
+    uint32_t reserved0;
+    uint64_t weight_offset;  /* from file start, K×N                   */
+    uint64_t bias_offset;    /* N float32                              */
+    uint64_t scale_offset;   /* N float32, int8 weights only           */
+    uint64_t reserved1;
+} RRL_PolicyLayer;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RRL_POLICY_FORMAT_H */
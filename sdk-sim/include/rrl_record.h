@@ -0,0 +1,134 @@
+/*───────────────────────────────────────────────────────────
+ *  rrl_record.h  —  Trajectory recorder, columnar on disk
+ *
+ *  Captures (env, obs, action, reward, done) rows off the game
+ *  thread: rrl_record() copies one row into the calling thread's
+ *  current chunk, a preallocated block of `rows_per_chunk` rows, and
+ *  full chunks go to a flush thread that compresses and appends
+ *  them.  When every chunk of a thread is still waiting to be
+ *  written the row is dropped and counted, never waited for.
+ *
+ *  The file is append-only and laid out to be mapped: every column
+ *  block starts RRL_RECORD_ALIGN-aligned, so remoterl/trajectory.py
+ *  reads uncompressed columns as zero-copy numpy views.  Columns are
+ *  typed from RRL_SpaceDesc through RRL_WireSpace (rrl_wire.h).
+ *
+ *      file   : RRL_RecordHeader | chunk*
+ *      chunk  : RRL_RecordChunk | column[RRL_RECORD_COLUMNS]
+ *      column : rows values back to back (or their compressed
+ *               bytes) | pad to RRL_RECORD_ALIGN
+ *
+ *  A chunk whose bytes run past the end of the file was cut short by
+ *  a crash; readers stop before it.
+ *───────────────────────────────────────────────────────────*/
+#ifndef RRL_RECORD_H
+#define RRL_RECORD_H
+
+#include "rrl_wire.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RRL_RECORD_MAGIC     0x54525252u   /* "RRRT" file  */
+#define RRL_RECORD_CHUNK     0x43525252u   /* "RRRC" chunk */
+#define RRL_RECORD_VERSION   1u
+#define RRL_RECORD_ALIGN     64u
+
+enum {
+    RRL_RECORD_ENV    = 0,   /* uint32, caller-chosen env id      */
+    RRL_RECORD_OBS    = 1,   /* header.obs                        */
+    RRL_RECORD_ACTION = 2,   /* header.action                     */
+    RRL_RECORD_REWARD = 3,   /* float32                           */
+    RRL_RECORD_DONE   = 4,   /* uint8, nonzero = episode ended    */
+    RRL_RECORD_COLUMNS
+};
+
+typedef struct {
+    uint32_t      magic;          /* RRL_RECORD_MAGIC                  */
+    uint16_t      version;        /* RRL_RECORD_VERSION                */
+    uint16_t      columns;        /* RRL_RECORD_COLUMNS                */
+    uint32_t      obs_bytes;
+    uint32_t      action_bytes;
+    uint32_t      reserved[4];
+    RRL_WireSpace obs;
+    RRL_WireSpace action;
+    uint8_t       pad[16];
+} RRL_RecordHeader;               /* 128 bytes */
+
+typedef struct {
+    uint64_t offset;              /* from the chunk header             */
+    uint64_t bytes;               /* stored                            */
+    uint32_t compression;         /* RRL_WIRE_COMP_*; NONE if it did not shrink */
+    uint32_t reserved;
+} RRL_RecordColumn;               /* 24 bytes */
+
+typedef struct {
+    uint32_t         magic;       /* RRL_RECORD_CHUNK                  */
+    uint32_t         rows;
+    uint64_t         chunk_bytes; /* header + columns; the next chunk follows */
+    RRL_RecordColumn column[RRL_RECORD_COLUMNS];
+    uint8_t          pad[56];
+} RRL_RecordChunk;                /* 192 bytes */
+
+/* Versioned: set `struct_size` to sizeof(RRL_RecorderConfig). */
+typedef struct {
+    size_t               struct_size;
+    const RRL_SpaceDesc *obs_space;       /* required                        */
+    const RRL_SpaceDesc *action_space;    /* required                        */
+    uint32_t             rows_per_chunk;  /* 0 = 1024                        */
+    uint32_t             chunks_per_thread; /* preallocated per thread; 0 = 4 */
+    int                  compression;     /* RRL_WIRE_COMP_* (per column)    */
+    int                  level;           /* zstd level; 0 = 1               */
+    int                  append;          /* nonzero: add to the recording at
+                                             `path` after its last whole chunk;
+                                             a missing or empty file is started,
+                                             any other file must be a recording
+                                             of the same spaces             */
+} RRL_RecorderConfig;
+
+typedef struct {
+    uint64_t rows;                /* written to the file               */
+    uint64_t dropped;             /* no free chunk when recorded       */
+    uint64_t bytes;               /* file size after the last write    */
+} RRL_RecorderStats;
+
+typedef struct RRLRecorderImpl *RRLRecorder;
+
+/* Creates (or, without `append`, truncates) `path` and starts the
+ * flush thread; NULL and last_error on failure (RRL_ERR_UNSUPPORTED
+ * for a codec this build lacks, RRL_ERR_INVALID_ARGUMENT when
+ * appending to a file that is not a recording of the same spaces). */
+RRLRecorder rrl_recorder_create (const char *path, const RRL_RecorderConfig *cfg);
+/* Flushes, then closes the file.  No rrl_record* call may be running. */
+void        rrl_recorder_destroy(RRLRecorder rec);
+
+/* One row from the calling thread: obs / action in the configured
+ * spaces.  Never contends with other recording threads; allocates
+ * only on a thread's first row.  RRL_ERR_EXHAUSTED if the row was
+ * dropped, RRL_ERR_IO once a write has failed. */
+int         rrl_record          (RRLRecorder rec, uint32_t env,
+                                 const void *obs, const void *action,
+                                 float reward, uint8_t done);
+/* `count` rows for envs first_env .. first_env+count-1, strided like
+ * RRL_VecBuffers; rewards / dones may be NULL (recorded as 0). */
+int         rrl_record_batch    (RRLRecorder rec, uint32_t first_env, size_t count,
+                                 const void *obs, size_t obs_stride,
+                                 const void *actions, size_t action_stride,
+                                 const float *rewards, const uint8_t *dones);
+
+/* Hand every partly filled chunk to the flush thread and wait until
+ * all rows recorded so far are in the file. */
+int         rrl_recorder_flush  (RRLRecorder rec);
+int         rrl_recorder_stats  (RRLRecorder rec, RRL_RecorderStats *out);
+
+/* Record every rrl_vec_step() of `vec` (sub-env i as env first_env+i):
+ * the observations, rewards and dones it sent and the actions it got
+ * back.  NULL stops.  The recorder must outlive the binding. */
+int         rrl_vec_set_recorder(RRLVecHandle vec, RRLRecorder rec, uint32_t first_env);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RRL_RECORD_H */
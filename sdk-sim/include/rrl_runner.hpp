@@ -0,0 +1,324 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_runner.hpp  —  Work‑stealing runner for many envs per process
+//─────────────────────────────────────────────────────────────
+//  • rrl::Runner owns N env handles and W worker threads (optionally
+//    pinned one per core among those the process may use, see
+//    rrl_allowed_cores()).  Envs are split into per‑worker home sets;
+//    each worker batch‑polls its home set with rrl_poll_many() and
+//    queues the ready ones on its own deque.
+//  • A worker drains its deque (newest first) before polling again,
+//    so every ready env gets one step per round; an idle worker steals
+//    the oldest half of another's deque, so a slow step (e.g. an Atari
+//    reset) never strands ready envs behind it.
+//  • The deques are std::deque behind a per‑worker mutex, not
+//    lock‑free Chase–Lev deques: each lock covers a few index moves
+//    (a pop, or a whole stolen batch), and only an owner and a thief
+//    of that one deque ever contend for it.
+//  • Step mode calls your callback per ready env.  Inference mode
+//    gathers the observations of a whole batch, runs one
+//    rrl_act_batch(), then hands each env its action.
+//  • An env is never queued twice or stepped by two workers at once.
+//─────────────────────────────────────────────────────────────
+#ifndef RRL_RUNNER_HPP
+#define RRL_RUNNER_HPP
+
+#include "rrl_env.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rrl {
+
+struct RunnerConfig {
+    unsigned     workers      = 0;     // 0 = std::thread::hardware_concurrency()
+    bool         pin          = true;  // worker i → allowed core (first_core + i) % allowed
+    unsigned     first_core   = 0;     // index into the allowed cores, not a CPU id
+    std::size_t  batch        = 64;    // max envs per rrl_act_batch() / steal
+    int64_t      idle_wait_us = 200;   // rrl_wait_any() timeout when idle
+    // Inference mode only: per-env sizes for rrl_act_batch()
+    std::size_t  obs_bytes    = 0;
+    std::size_t  action_bytes = 0;
+};
+
+class Runner {
+public:
+    using StepFn    = std::function<void(std::size_t env)>;
+    using ObserveFn = std::function<void(std::size_t env, void* obs)>;
+    using ActFn     = std::function<void(std::size_t env, const void* action)>;
+
+    // Step mode: `step(i)` runs whenever envs[i] is ready.
+    Runner(std::vector<RRLHandle> envs, StepFn step, RunnerConfig cfg = {})
+        : envs_(std::move(envs)), step_(std::move(step)), cfg_(cfg) { init(); }
+
+    // Inference mode: `observe(i, obs)` fills cfg.obs_bytes, the batch
+    // goes through rrl_act_batch(), then `act(i, action)` consumes it.
+    Runner(std::vector<RRLHandle> envs, ObserveFn observe, ActFn act, RunnerConfig cfg)
+        : envs_(std::move(envs)), observe_(std::move(observe)), act_(std::move(act)), cfg_(cfg) {
+        if (!cfg_.obs_bytes || !cfg_.action_bytes)
+            throw std::invalid_argument("rrl::Runner: inference mode needs obs_bytes and action_bytes");
+        init();
+    }
+
+    Runner(const Runner&) = delete;
+    Runner& operator=(const Runner&) = delete;
+    ~Runner() { halt(); }
+
+    void start() {
+        if (!threads_.empty()) return;
+        stop_.store(false, std::memory_order_relaxed);
+        for (unsigned w = 0; w < workers_.size(); ++w)
+            threads_.emplace_back([this, w] { loop(w); });
+    }
+
+    // Join every worker; rethrows the first exception a callback threw,
+    // or the rrl_poll_many / rrl_act_batch failure that stopped them.
+    void stop() {
+        halt();
+        if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+
+    bool running() const noexcept { return !threads_.empty() && !stop_.load(std::memory_order_relaxed); }
+
+    std::size_t size()    const noexcept { return envs_.size(); }
+    unsigned    workers() const noexcept { return static_cast<unsigned>(workers_.size()); }
+    uint64_t    steps()   const noexcept { return sum(&Worker::steps); }
+    uint64_t    steals()  const noexcept { return sum(&Worker::steals); }
+
+private:
+    struct alignas(64) Worker {
+        std::mutex               mtx;          // guards q (owner: back, thieves: front)
+        std::deque<uint32_t>     q;
+        std::vector<uint32_t>    home;
+        std::atomic<uint64_t>    steps{0};
+        std::atomic<uint64_t>    steals{0};
+        // scratch, owner thread only
+        std::vector<RRLHandle>   poll_h;
+        std::vector<uint32_t>    poll_env;
+        std::vector<std::size_t> ready;
+        std::vector<uint32_t>    run;
+        std::vector<RRLHandle>   batch_h;
+        std::vector<unsigned char> obs, act;
+        uint32_t                 rng = 0;
+    };
+
+    std::vector<RRLHandle>                envs_;
+    StepFn                                step_;
+    ObserveFn                             observe_;
+    ActFn                                 act_;
+    RunnerConfig                          cfg_;
+    std::unique_ptr<std::atomic<bool>[]>  busy_;   // queued or being stepped
+    std::vector<std::unique_ptr<Worker>>  workers_;
+    std::vector<unsigned>                 cores_;  // pin targets (cfg_.pin)
+    std::vector<std::thread>              threads_;
+    std::atomic<bool>                     stop_{false};
+    std::mutex                            err_mtx_;
+    std::exception_ptr                    error_;
+
+    void init() {
+        if (envs_.empty()) throw std::invalid_argument("rrl::Runner: no envs");
+        for (RRLHandle h : envs_)
+            if (!h) throw std::invalid_argument("rrl::Runner: null env handle");
+        if (envs_.size() > UINT32_MAX) throw std::invalid_argument("rrl::Runner: too many envs");
+        unsigned n = cfg_.workers ? cfg_.workers : std::max(1u, std::thread::hardware_concurrency());
+        n = static_cast<unsigned>(std::min<std::size_t>(n, envs_.size()));
+        cfg_.batch = std::max<std::size_t>(cfg_.batch, 1);
+        busy_.reset(new std::atomic<bool>[envs_.size()]);
+        for (std::size_t i = 0; i < envs_.size(); ++i) busy_[i].store(false, std::memory_order_relaxed);
+        for (unsigned w = 0; w < n; ++w) {
+            workers_.emplace_back(new Worker);
+            workers_.back()->rng = 0x9E3779B9u * (w + 1);
+        }
+        // Round-robin homes keep cheap and expensive envs spread out.
+        for (std::size_t i = 0; i < envs_.size(); ++i)
+            workers_[i % n]->home.push_back(static_cast<uint32_t>(i));
+        if (cfg_.pin) init_cores();
+    }
+
+    // Allowed cores, rotated so worker 0 gets index first_core.  Falls
+    // back to 0..hardware_concurrency-1 where the OS cannot say.
+    void init_cores() {
+        int n = rrl_allowed_cores(nullptr, 0);
+        if (n > 0) {
+            cores_.resize(static_cast<std::size_t>(n));
+            n = rrl_allowed_cores(cores_.data(), cores_.size());
+            cores_.resize(static_cast<std::size_t>(std::max(0, std::min(n, int(cores_.size())))));
+        }
+        if (cores_.empty()) {
+            cores_.resize(std::max(1u, std::thread::hardware_concurrency()));
+            for (unsigned c = 0; c < cores_.size(); ++c) cores_[c] = c;
+        }
+        std::rotate(cores_.begin(), cores_.begin() + cfg_.first_core % cores_.size(), cores_.end());
+    }
+
+    void halt() noexcept {
+        stop_.store(true, std::memory_order_relaxed);
+        for (auto& t : threads_) t.join();
+        threads_.clear();
+        for (auto& w : workers_) {
+            for (uint32_t e : w->q) busy_[e].store(false, std::memory_order_relaxed);
+            w->q.clear();
+        }
+    }
+
+    uint64_t sum(std::atomic<uint64_t> Worker::*field) const noexcept {
+        uint64_t s = 0;
+        for (const auto& w : workers_) s += ((*w).*field).load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void fail() noexcept {
+        std::lock_guard<std::mutex> lk(err_mtx_);
+        if (!error_) error_ = std::current_exception();
+        stop_.store(true, std::memory_order_relaxed);
+    }
+
+    void loop(unsigned w) {
+        Worker& me = *workers_[w];
+        if (cfg_.pin) rrl_pin_thread(cores_[w % cores_.size()]);   // best effort
+        try {
+            while (!stop_.load(std::memory_order_relaxed)) {
+                if (!queued(me)) refill(me);
+                if (run_local(me)) continue;
+                if (steal(w)) continue;
+                idle(me);
+            }
+        } catch (...) {
+            fail();
+        }
+    }
+
+    std::size_t queued(Worker& me) {
+        std::lock_guard<std::mutex> lk(me.mtx);
+        return me.q.size();
+    }
+
+    // Handles of home envs not already queued or running.
+    std::size_t free_home(Worker& me) {
+        me.poll_h.clear();
+        me.poll_env.clear();
+        for (uint32_t e : me.home) {
+            if (busy_[e].load(std::memory_order_acquire)) continue;
+            me.poll_h.push_back(envs_[e]);
+            me.poll_env.push_back(e);
+        }
+        return me.poll_h.size();
+    }
+
+    // Batch poll: one rrl_poll_many() over the free part of the home set.
+    void refill(Worker& me) {
+        const std::size_t n = free_home(me);
+        if (!n) return;
+        me.ready.resize(n);
+        const int r = rrl_poll_many(me.poll_h.data(), n, nullptr, me.ready.data());
+        if (r < 0) {   // would otherwise look idle forever
+            const char* msg = rrl_last_error_msg();
+            throw std::runtime_error(std::string("rrl::Runner: poll_many failed: ") + (msg ? msg : ""));
+        }
+        std::lock_guard<std::mutex> lk(me.mtx);
+        for (int k = 0; k < r; ++k) {
+            const uint32_t e = me.poll_env[me.ready[k]];
+            busy_[e].store(true, std::memory_order_relaxed);
+            me.q.push_back(e);
+        }
+    }
+
+    bool run_local(Worker& me) {
+        const std::size_t take = act_ ? cfg_.batch : 1;
+        me.run.clear();
+        {
+            std::lock_guard<std::mutex> lk(me.mtx);
+            while (!me.q.empty() && me.run.size() < take) {
+                me.run.push_back(me.q.back());
+                me.q.pop_back();
+            }
+        }
+        if (me.run.empty()) return false;
+        execute(me);
+        return true;
+    }
+
+    // Take the oldest half (up to one batch) of a random victim's deque.
+    bool steal(unsigned w) {
+        Worker& me = *workers_[w];
+        const unsigned n = static_cast<unsigned>(workers_.size());
+        if (n < 2) return false;
+        me.rng = me.rng * 1664525u + 1013904223u;
+        const unsigned start = me.rng % n;
+        for (unsigned k = 0; k < n; ++k) {
+            const unsigned v = (start + k) % n;
+            if (v == w) continue;
+            Worker& victim = *workers_[v];
+            me.run.clear();
+            {
+                std::lock_guard<std::mutex> lk(victim.mtx);
+                const std::size_t take = std::min(cfg_.batch, (victim.q.size() + 1) / 2);
+                for (std::size_t i = 0; i < take; ++i) {
+                    me.run.push_back(victim.q.front());
+                    victim.q.pop_front();
+                }
+            }
+            if (me.run.empty()) continue;
+            me.steals.fetch_add(1, std::memory_order_relaxed);
+            execute(me);
+            return true;
+        }
+        return false;
+    }
+
+    void idle(Worker& me) {
+        const std::size_t n = free_home(me);
+        if (n) rrl_wait_any(me.poll_h.data(), n, cfg_.idle_wait_us);
+        else   std::this_thread::sleep_for(std::chrono::microseconds(cfg_.idle_wait_us));
+    }
+
+    // Run me.run (owned: every env in it is marked busy).
+    void execute(Worker& me) {
+        struct Release {   // clear busy flags even if a callback throws
+            Runner* r; Worker& me;
+            ~Release() { for (uint32_t e : me.run) r->busy_[e].store(false, std::memory_order_release); }
+        } release{this, me};
+
+        if (!act_) {
+            for (uint32_t e : me.run) {
+                TraceSpan span(RRL_SPAN_CALLBACK, envs_[e]);
+                step_(e);
+            }
+        } else {
+            const std::size_t n = me.run.size();
+            me.obs.resize(n * cfg_.obs_bytes);
+            me.act.resize(n * cfg_.action_bytes);
+            me.batch_h.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                me.batch_h[i] = envs_[me.run[i]];
+                TraceSpan span(RRL_SPAN_CALLBACK, me.batch_h[i]);
+                observe_(me.run[i], me.obs.data() + i * cfg_.obs_bytes);
+            }
+            if (rrl_act_batch(me.batch_h.data(), n, me.obs.data(), me.act.data()) != RRL_SUCCESS) {
+                const char* msg = rrl_last_error_msg();
+                throw std::runtime_error(std::string("rrl::Runner: act_batch failed: ") + (msg ? msg : ""));
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                TraceSpan span(RRL_SPAN_CALLBACK, me.batch_h[i]);
+                act_(me.run[i], me.act.data() + i * cfg_.action_bytes);
+            }
+        }
+        me.steps.fetch_add(me.run.size(), std::memory_order_relaxed);
+    }
+};
+
+} // namespace rrl
+
+#endif /* RRL_RUNNER_HPP */
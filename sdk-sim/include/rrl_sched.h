@@ -0,0 +1,103 @@
+/*───────────────────────────────────────────────────────────
+ *  rrl_sched.h  —  Decision-rate scheduler (frame skip)
+ *
+ *  Lets a game ticking at 60–144 Hz ask the trainer for a decision
+ *  only every k-th frame.  rrl_sched_tick() is called once per frame
+ *  in place of waiting on rrl_poll(): it adds the frame's reward to
+ *  the running sum, fills the action to apply this frame (the last
+ *  one held, or eased towards it for float actions) and says whether
+ *  this frame is a decision point.  Only then does the game submit a
+ *  step, exactly as it does in lock-step mode, reporting the summed
+ *  reward; every other frame sends nothing.
+ *
+ *  k starts at tick_hz / decision_hz and widens so that one round
+ *  trip (p90 RTT from rrl_get_stats_v2, plus a quarter) fits inside
+ *  it.  A decision frame whose previous action is still in flight is
+ *  not waited on: the held action is applied again, the frame counts
+ *  as late and k grows by one until actions arrive with a frame to
+ *  spare.  The game thread never waits on the trainer: a frame costs
+ *  at most one rrl_poll(), and a decision frame one rrl_get_stats_v2()
+ *  as well, which is as cheap as the backend's stats hook.  `fixed`
+ *  skips that read, as does a backend whose stats have failed once.
+ *
+ *  A done frame ends the interval: it is a decision as soon as the
+ *  previous action is in.  Until then keep passing done (reward 0)
+ *  for the terminal frame.
+ *───────────────────────────────────────────────────────────*/
+#ifndef RRL_SCHED_H
+#define RRL_SCHED_H
+
+#include "rrl_env.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* RRL_SchedConfig.hold */
+enum {
+    RRL_SCHED_REPEAT = 0,   /* apply the last action unchanged            */
+    RRL_SCHED_LERP   = 1,   /* float actions: ease from the previous action
+                               to the new one over `ramp` frames          */
+};
+
+/* rrl_sched_tick() results */
+enum {
+    RRL_SCHED_HOLD   = 0,   /* nothing to send this frame                 */
+    RRL_SCHED_DECIDE = 1,   /* submit this frame's observation            */
+};
+
+/* Versioned: set `struct_size` to sizeof(RRL_SchedConfig). */
+typedef struct {
+    size_t      struct_size;
+    const void *act;          /* the act buffer bound with rrl_bind_buffers
+                                 (required; read once per delivered action) */
+    double      decision_hz;  /* wanted decision rate; 0 = 20               */
+    double      tick_hz;      /* game frame rate; 0 = measured per tick     */
+    unsigned    min_skip;     /* frames per decision, lower bound; 0 = 1    */
+    unsigned    max_skip;     /* upper bound; 0 = 32                        */
+    int         hold;         /* RRL_SCHED_*                                */
+    unsigned    ramp;         /* LERP frames; 0 = the whole interval        */
+    float       gamma;        /* per-frame discount of the reward sum; 0 = 1 */
+    int         fixed;        /* nonzero: keep k, ignore RTT                */
+} RRL_SchedConfig;
+
+/* Filled by rrl_sched_tick() */
+typedef struct {
+    float    reward;          /* DECIDE: discounted sum since the last one  */
+    float    discount;        /*   gamma^frames, to bootstrap the next value */
+    uint32_t frames;          /*   frames it covers (this one included)      */
+    uint8_t  done;            /*   a done frame ended the interval           */
+    uint8_t  fresh;           /* a new action took effect this frame        */
+    uint8_t  pad[2];
+} RRL_SchedTick;
+
+typedef struct {
+    uint64_t ticks;
+    uint64_t decisions;
+    uint64_t late;            /* decision frames with the action not back   */
+    unsigned interval;        /* current k                                  */
+    double   tick_hz;         /* configured or measured                     */
+    double   rtt_ms;          /* last RTT used to size k                    */
+} RRL_SchedStats;
+
+typedef struct RRLSchedImpl *RRLSched;
+
+/* Schedule steps of `handle` (one schedule per handle); NULL and
+ * last_error on a bad config, or RRL_SCHED_LERP on non-float actions. */
+RRLSched    rrl_sched_create (RRLHandle handle, const RRL_SchedConfig *cfg);
+void        rrl_sched_destroy(RRLSched sched);
+
+/* One game frame: RRL_SCHED_DECIDE / RRL_SCHED_HOLD, or an error.
+ * `action` (rrl_space_bytes of the action space) receives the action
+ * to apply this frame; zeros until the first one arrives.  Never
+ * waits on the trainer or allocates; decision frames read the
+ * handle's stats (see above).  One thread at a time per schedule. */
+int         rrl_sched_tick   (RRLSched sched, float reward, uint8_t done,
+                              void *action, RRL_SchedTick *out);
+int         rrl_sched_stats  (RRLSched sched, RRL_SchedStats *out);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RRL_SCHED_H */
@@ -0,0 +1,110 @@
+/*───────────────────────────────────────────────────────────
+ *  rrl_shm.h  —  Same-host transport over shared memory
+ *
+ *  When the trainer runs on the simulator's machine, wire frames
+ *  (rrl_wire.h) skip the relay: the simulator process creates one
+ *  segment, the trainer process attaches to it, and every env gets a
+ *  channel of two single-producer / single-consumer byte rings.
+ *  Frames are read in place and can be encoded in place; a side that
+ *  finds its ring empty (or full) sleeps on a futex the other side
+ *  wakes only if it is really asleep.  remoterl/shm_transport.py is
+ *  the trainer-side reader.
+ *
+ *      segment : RRL_ShmHeader | pad to 128 | channel[channels]
+ *      channel : ring UP (simulator → trainer) | ring DOWN
+ *      ring    : RRL_ShmRingCtl | data[ring_bytes]
+ *      record  : RRL_ShmRecord | frame | pad to RRL_WIRE_ALIGN
+ *
+ *  Records never wrap: one that would is preceded by a SKIP record
+ *  filling the end of the ring.  head / tail are byte counts, the
+ *  position is count % ring_bytes.  POSIX hosts only (futex wake-ups
+ *  on Linux, a bounded back-off elsewhere).
+ *───────────────────────────────────────────────────────────*/
+#ifndef RRL_SHM_H
+#define RRL_SHM_H
+
+#include "rrl_env.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RRL_SHM_MAGIC         0x534C5252u   /* "RRLS" */
+#define RRL_SHM_VERSION       1u
+#define RRL_SHM_HEADER_BYTES  128u
+#define RRL_SHM_SKIP          0xFFFFFFFFu   /* RRL_ShmRecord.bytes: jump to offset 0 */
+
+enum {
+    RRL_SHM_UP   = 0,   /* simulator → trainer (STEP)   */
+    RRL_SHM_DOWN = 1,   /* trainer → simulator (ACTION) */
+};
+
+typedef struct {
+    uint32_t magic;          /* RRL_SHM_MAGIC, stored last by the creator */
+    uint32_t version;        /* RRL_SHM_VERSION                         */
+    uint32_t channels;
+    uint32_t ring_bytes;     /* power of two                            */
+    uint64_t channel_bytes;  /* 2 * (sizeof(RRL_ShmRingCtl) + ring_bytes) */
+    int32_t  sim_pid;
+    int32_t  trainer_pid;    /* 0 until a trainer attaches              */
+    uint32_t reserved[8];
+} RRL_ShmHeader;             /* 64 bytes */
+
+typedef struct {
+    uint64_t head;           /* bytes published (producer)              */
+    uint32_t data_seq;       /* futex word, bumped after each publish   */
+    uint32_t data_wait;      /* consumer is (about to be) asleep        */
+    uint8_t  pad0[48];
+    uint64_t tail;           /* bytes consumed (consumer)               */
+    uint32_t space_seq;      /* futex word, bumped after each release   */
+    uint32_t space_wait;     /* producer is (about to be) asleep        */
+    uint8_t  pad1[48];
+} RRL_ShmRingCtl;            /* 128 bytes: one line per side */
+
+typedef struct {
+    uint32_t bytes;          /* frame length, or RRL_SHM_SKIP           */
+    uint32_t reserved[3];
+} RRL_ShmRecord;             /* 16 bytes */
+
+typedef struct RRLShmImpl *RRLShm;
+
+/* Segment name both sides derive without talking: "/rrl-<uid>-<hash
+ * of key>-<simulator pid>" (key may be NULL; pid 0 = this process).
+ * A trainer lists the segments for its key under /dev/shm (Linux). */
+int     rrl_shm_name      (const char *key, int pid, char *out, size_t cap);
+
+/* Simulator side: create `name` with `channels` channels of two
+ * `ring_bytes` rings (rounded up to a power of two; 0 = 1 MiB).  A
+ * stale segment of the same name is replaced; close unlinks it. */
+RRLShm  rrl_shm_create    (const char *name, uint32_t channels, size_t ring_bytes);
+/* Trainer side: attach to a live segment; RRL_ERR_EXHAUSTED if
+ * another trainer holds it, RRL_ERR_IO if its simulator is gone. */
+RRLShm  rrl_shm_attach    (const char *name);
+void    rrl_shm_close     (RRLShm shm);
+uint32_t rrl_shm_channels (RRLShm shm);
+/* 1 if the other process is attached and alive */
+int     rrl_shm_peer_alive(RRLShm shm);
+
+/* Outgoing ring of `channel` (UP for the creator, DOWN for the
+ * trainer); one thread per channel and direction.  reserve() waits up
+ * to `timeout_us` (negative = forever) for `cap` free bytes and
+ * returns where to encode the frame; commit() publishes its first
+ * `len` bytes.  NULL / RRL_ERR_TIMEOUT when the peer is not draining. */
+void   *rrl_shm_reserve   (RRLShm shm, uint32_t channel, size_t cap, int64_t timeout_us);
+int     rrl_shm_commit    (RRLShm shm, uint32_t channel, size_t len);
+/* reserve + copy + commit */
+int     rrl_shm_write     (RRLShm shm, uint32_t channel, const void *frame, size_t len,
+                           int64_t timeout_us);
+
+/* Incoming ring: the next frame in place (16-aligned, so rrl_wire_parse
+ * can decode it there), valid until rrl_shm_release; RRL_ERR_TIMEOUT
+ * if none arrives within `timeout_us` (0 = just check). */
+int     rrl_shm_read      (RRLShm shm, uint32_t channel, const void **frame, size_t *len,
+                           int64_t timeout_us);
+int     rrl_shm_release   (RRLShm shm, uint32_t channel);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RRL_SHM_H */
@@ -0,0 +1,292 @@
+/*───────────────────────────────────────────────────────────
+ *  rrl_wire.h  —  Binary step frames derived from RRL_SpaceDesc
+ *
+ *  Shared by the core transport, custom backends (e.g. a vec_step
+ *  hook) and remoterl/wire_format.py on the trainer side.  The
+ *  observation / action layout is fixed once per connection by an
+ *  RRL_WireSchema frame; every step after that is a 16‑byte header
+ *  plus raw tensor bytes — no field names, no per‑step type tags.
+ *  All fields are little‑endian (the SDK targets LE hosts only).
+ *
+ *      SCHEMA : RRL_WireSchema                                (112 bytes)
+ *      STEP   : RRL_WireHeader | float32 rewards[count]
+ *               | uint8 dones[count] | pad to RRL_WIRE_ALIGN
+ *               | observations[count]  (obs_bytes each, dense)
+ *      ACTION : RRL_WireHeader | actions[count]  (action_bytes each)
+ *
+ *  `count` is 1 for a plain handle and K for an RRLVecHandle, so a
+ *  vector of envs costs one frame per step, not K.
+ *───────────────────────────────────────────────────────────*/
+#ifndef RRL_WIRE_H
+#define RRL_WIRE_H
+
+#include "rrl_env.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RRL_WIRE_MAGIC    0x574C5252u   /* "RRLW" */
+#define RRL_WIRE_VERSION  1u
+#define RRL_WIRE_ALIGN    16u           /* tensor payloads start 16-aligned */
+
+enum {
+    RRL_WIRE_SCHEMA = 1,
+    RRL_WIRE_STEP   = 2,   /* simulator → trainer */
+    RRL_WIRE_ACTION = 3,   /* trainer → simulator */
+    RRL_WIRE_MUX    = 4,   /* several streams' frames, one batch */
+    RRL_WIRE_RESUME = 5,   /* session resume handshake, either way */
+};
+
+typedef struct {
+    int32_t  dtype;          /* RRL_DTYPE_*                            */
+    uint32_t ndim;
+    uint32_t shape[8];
+} RRL_WireSpace;             /* 40 bytes */
+
+typedef struct {
+    uint32_t      magic;          /* RRL_WIRE_MAGIC                    */
+    uint16_t      version;        /* RRL_WIRE_VERSION                  */
+    uint16_t      kind;           /* RRL_WIRE_SCHEMA                   */
+    uint32_t      obs_bytes;      /* one observation                   */
+    uint32_t      action_bytes;   /* one action                        */
+    uint32_t      reserved[4];
+    RRL_WireSpace obs;
+    RRL_WireSpace action;
+} RRL_WireSchema;                 /* 112 bytes */
+
+/* RRL_WireHeader.flags (STEP frames from an RRLWireCodec) */
+#define RRL_WIRE_F_DELTA  0x1u   /* observations XOR the previous frame's */
+#define RRL_WIRE_F_LZ4    0x2u   /* payload after the header is LZ4      */
+#define RRL_WIRE_F_ZSTD   0x4u   /* payload after the header is zstd     */
+
+typedef struct {
+    uint16_t kind;           /* RRL_WIRE_STEP / RRL_WIRE_ACTION        */
+    uint16_t flags;          /* RRL_WIRE_F_*; 0 = plain layout         */
+    uint32_t seq;            /* step number; an ACTION echoes its STEP */
+    uint32_t count;          /* sub-envs in this frame                 */
+    uint32_t dict_id;        /* compression dictionary, 0 = none       */
+} RRL_WireHeader;            /* 16 bytes */
+
+/* Decoded frame: pointers into the caller's frame buffer (no copy).
+ * rewards / dones are NULL for ACTION frames. */
+typedef struct {
+    RRL_WireHeader header;
+    const float   *rewards;
+    const uint8_t *dones;
+    const void    *tensors;  /* count × obs_bytes or × action_bytes    */
+} RRL_WireFrame;
+
+/* Describe `obs` / `action` (done once, at handshake) */
+int    rrl_wire_schema      (const RRL_SpaceDesc *obs, const RRL_SpaceDesc *action,
+                             RRL_WireSchema *out);
+/* Validate a received SCHEMA frame and copy it to `out` */
+int    rrl_wire_read_schema (const void *frame, size_t len, RRL_WireSchema *out);
+
+/* Exact size of a STEP or ACTION frame carrying `count` sub-envs; 0 if invalid */
+size_t rrl_wire_frame_bytes (const RRL_WireSchema *schema, int kind, size_t count);
+
+/* Encode a frame into `out` (cap bytes).  Tensors are read every
+ * `stride` bytes (0 = dense), so RRL_VecBuffers can be passed as is;
+ * NULL rewards / dones encode as zeros.  Returns bytes written, or 0
+ * (and sets last_error) if `cap` is too small or an argument is bad. */
+size_t rrl_wire_write_step  (const RRL_WireSchema *schema, uint32_t seq, size_t count,
+                             const void *obs, size_t obs_stride,
+                             const float *rewards, const uint8_t *dones,
+                             void *out, size_t cap);
+size_t rrl_wire_write_action(const RRL_WireSchema *schema, uint32_t seq, size_t count,
+                             const void *actions, size_t action_stride,
+                             void *out, size_t cap);
+
+/* Decode a plain STEP or ACTION frame in place; `frame` must be 4-byte
+ * aligned and exactly rrl_wire_frame_bytes() long.  Frames with flags
+ * set fail with RRL_ERR_UNSUPPORTED (use rrl_wire_codec_read). */
+int    rrl_wire_parse       (const RRL_WireSchema *schema, const void *frame, size_t len,
+                             RRL_WireFrame *out);
+
+/*────────────────── Compression / delta codec ────────────*/
+/* Opt-in, per stream.  Only STEP frames are transformed: first the
+ * observations are XORed with the previous frame's (consecutive game
+ * frames leave mostly zero bytes), then the whole payload is LZ4 or
+ * zstd compressed, optionally with a dictionary trained on sample
+ * frames.  A frame that would not shrink is sent plain.  ACTION
+ * frames pass through unchanged.  LZ4 / zstd are available only if
+ * the SDK was built with them (rrl_wire_codec_available). */
+enum {
+    RRL_WIRE_COMP_NONE = 0,
+    RRL_WIRE_COMP_LZ4  = 1,
+    RRL_WIRE_COMP_ZSTD = 2,
+};
+
+typedef struct RRL_WireCodecConfig {
+    size_t      struct_size;        /* sizeof(RRL_WireCodecConfig)          */
+    int         compression;        /* RRL_WIRE_COMP_*                      */
+    int         level;              /* zstd level / LZ4 acceleration; 0 = 1 */
+    int         delta;              /* nonzero: XOR-delta (needs compression) */
+    uint32_t    keyframe_interval;  /* full frame every N; 0 = first only   */
+    const void *dict;               /* optional dictionary (copied)         */
+    size_t      dict_len;
+} RRL_WireCodecConfig;
+
+/* One codec per stream and direction: the writer and the reader keep
+ * the previous observations, so frames must be read in the order they
+ * were written.  Both ends must use the same config. */
+typedef struct RRLWireCodecImpl *RRLWireCodec;
+
+int          rrl_wire_codec_available(int compression);   /* 1 / 0 */
+RRLWireCodec rrl_wire_codec_create (const RRL_WireSchema *schema, const RRL_WireCodecConfig *cfg);
+void         rrl_wire_codec_destroy(RRLWireCodec codec);
+/* Next written frame is a keyframe (e.g. after a reconnect) */
+void         rrl_wire_codec_reset  (RRLWireCodec codec);
+
+/* Worst-case encoded size of a STEP frame with `count` sub-envs */
+size_t       rrl_wire_codec_bound  (RRLWireCodec codec, size_t count);
+/* As rrl_wire_write_step(), then delta + compress; bytes written or 0 */
+size_t       rrl_wire_codec_write_step(RRLWireCodec codec, uint32_t seq, size_t count,
+                                       const void *obs, size_t obs_stride,
+                                       const float *rewards, const uint8_t *dones,
+                                       void *out, size_t cap);
+/* Decode any frame the matching writer produced.  `out` points into
+ * codec-owned storage (or into `frame` for plain frames) and stays
+ * valid until the next call on this codec. */
+int          rrl_wire_codec_read   (RRLWireCodec codec, const void *frame, size_t len,
+                                    RRL_WireFrame *out);
+
+/* Train a zstd dictionary from `n` sample payloads laid end to end
+ * (typically STEP frames); returns its size, or 0 without zstd. */
+size_t       rrl_wire_train_dict   (const void *samples, const size_t *sample_sizes, unsigned n,
+                                    void *dict, size_t dict_cap);
+
+/* Ask the transport to use `cfg` on `handle`'s uplink (NULL = plain).
+ * Needs a set_wire_codec backend hook; without one only plain frames
+ * are accepted. */
+int          rrl_set_wire_codec    (RRLHandle handle, const RRL_WireCodecConfig *cfg);
+
+/*────────────────── Stream multiplexing ──────────────────*/
+/* Every handle in a process can share one connection (or a few): each
+ * handle is a stream, and the frames written during one flush tick
+ * travel as a single MUX frame, so 1000 envs cost a handful of
+ * sessions / heartbeats and one send per tick instead of 1000.
+ *
+ *      MUX : RRL_WireMuxHeader | records[count]
+ *   record : RRL_WireMuxRecord | frame[bytes] | pad to RRL_WIRE_ALIGN
+ *
+ * Records keep every frame 16-aligned and in write order per stream;
+ * a stream's first record is its SCHEMA frame.  Streams are routed to
+ * connection `stream % connections`. */
+typedef struct {
+    uint16_t kind;           /* RRL_WIRE_MUX                           */
+    uint16_t flags;          /* 0                                      */
+    uint32_t seq;            /* batch number on this connection        */
+    uint32_t count;          /* records                                */
+    uint32_t bytes;          /* whole MUX frame, header included       */
+} RRL_WireMuxHeader;         /* 16 bytes */
+
+typedef struct {
+    uint32_t stream;         /* rrl_mux_write() stream id              */
+    uint32_t bytes;          /* frame length, padding excluded         */
+    uint32_t reserved[2];
+} RRL_WireMuxRecord;         /* 16 bytes */
+
+typedef struct RRL_MuxConfig {
+    size_t   struct_size;      /* sizeof(RRL_MuxConfig)                    */
+    unsigned connections;      /* 0 = 1                                    */
+    uint32_t flush_us;         /* latency cap: oldest unsent frame; 0 = 500 */
+    size_t   max_batch_bytes;  /* flush early at this size; 0 = 65536      */
+} RRL_MuxConfig;
+
+/* Ask the transport to multiplex every handle opened afterwards as
+ * `cfg` says (NULL = one session per handle).  Needs a set_mux
+ * backend hook; without one RRL_ERR_UNSUPPORTED unless cfg is NULL. */
+int     rrl_set_mux          (const RRL_MuxConfig *cfg);
+
+/* Walk the records of a MUX frame: start with *offset = 0; each call
+ * returns 1 and the next record (`frame` points into `mux`), 0 at the
+ * end, or a negative RRL_ERR_* code if the frame is malformed. */
+int     rrl_wire_mux_next    (const void *mux, size_t len, size_t *offset,
+                              uint32_t *stream, const void **frame, size_t *frame_len);
+
+/* Coalescer a transport or backend feeds its outgoing frames to.
+ * rrl_mux_write() copies the frame into the batch of its stream's
+ * connection; a batch goes to `send` (one call per MUX frame, from the
+ * mux's flush thread or the writer that filled it) once it reaches
+ * max_batch_bytes or its oldest frame is flush_us old.  `send` is
+ * never called concurrently for one connection and its buffer is only
+ * valid during the call; a nonzero return is kept as the connection's
+ * error and reported by the following rrl_mux_write / _flush. */
+typedef int (*RRL_MuxSend)(void *user, unsigned connection, const void *mux, size_t len);
+
+typedef struct RRLMuxImpl *RRLMux;
+
+RRLMux  rrl_mux_create       (const RRL_MuxConfig *cfg, RRL_MuxSend send, void *user);
+/* Flushes what is pending, then stops the flush thread */
+void    rrl_mux_destroy      (RRLMux mux);
+int     rrl_mux_write        (RRLMux mux, uint32_t stream, const void *frame, size_t len);
+/* Send every pending batch now (e.g. before blocking on a reply) */
+int     rrl_mux_flush        (RRLMux mux);
+
+/*────────────────── Session resume ───────────────────────*/
+/* A dropped connection need not cost a re-init.  On reconnect each
+ * side sends RESUME with the handle's token and the last seq it
+ * received in order; a peer that still holds the session answers
+ * with its own, and both then replay what the other is missing from
+ * their RRLReplay buffers.  Spaces, codecs and policies stay as they
+ * were: replayed frames are the bytes first sent, so delta streams
+ * continue.  A peer without the session answers with
+ * RRL_RESUME_F_REJECT and the handle starts over with a SCHEMA frame
+ * (rrl_replay_reset, rrl_wire_codec_reset). */
+#define RRL_RESUME_F_REJECT  0x1u
+#define RRL_RESUME_TOKEN     16
+
+typedef struct {
+    uint16_t kind;           /* RRL_WIRE_RESUME                        */
+    uint16_t flags;          /* RRL_RESUME_F_*                         */
+    uint32_t seq;            /* last seq received from the peer        */
+    uint32_t stream;         /* mux stream id; 0 unmultiplexed         */
+    uint32_t reserved;
+    uint8_t  token[RRL_RESUME_TOKEN];
+} RRL_WireResume;            /* 32 bytes */
+
+/* Bounded buffer of sent, unacknowledged frames for one handle and
+ * direction.  Thread-safe: the sending and receiving threads may call
+ * it concurrently. */
+typedef struct RRLReplayImpl *RRLReplay;
+
+typedef int (*RRL_ReplaySend)(void *user, const void *frame, size_t len);
+
+/* `capacity` bytes of frames (0 = 1 MiB); the token is random until
+ * rrl_replay_set_token() stores the one the relay issued. */
+RRLReplay   rrl_replay_create    (size_t capacity);
+void        rrl_replay_destroy   (RRLReplay replay);
+/* Copies the RRL_RESUME_TOKEN-byte token to `out` */
+void        rrl_replay_token     (RRLReplay replay, uint8_t *out);
+void        rrl_replay_set_token (RRLReplay replay, const uint8_t *token);
+
+/* Keep a copy of frame `seq` as sent.  RRL_ERR_EXHAUSTED when the
+ * buffer is full: wait for acknowledgements before sending more. */
+int         rrl_replay_push      (RRLReplay replay, uint32_t seq, const void *frame, size_t len);
+/* The peer holds every frame up to `seq` (an ACTION echoing a STEP,
+ * or a RESUME); those are dropped.  Seqs compare modulo 2^32. */
+void        rrl_replay_ack       (RRLReplay replay, uint32_t seq);
+/* After the peer's RESUME: ack `peer_seq`, then pass every frame after
+ * it to `send` in order.  Frames sent, or the first nonzero `send`
+ * result (frames stay buffered).  `send` gets copies taken before the
+ * first call and runs unlocked: it may push or ack on `replay`. */
+int         rrl_replay_resend    (RRLReplay replay, uint32_t peer_seq,
+                                  RRL_ReplaySend send, void *user);
+/* Drop everything (the peer rejected the resume) */
+void        rrl_replay_reset     (RRLReplay replay);
+
+/* Link state for RRL_StatsV2: up = 0 when the session drops, 1 once
+ * it is back (counts a reconnect and adds the gap to downtime_us). */
+void        rrl_replay_link      (RRLReplay replay, int up);
+/* rrl_get_stats_v2(handle) reports this buffer's reconnects and
+ * downtime when the backend leaves them 0; NULL handle unbinds, and
+ * so does rrl_handle_closed(handle). */
+int         rrl_replay_bind      (RRLReplay replay, RRLHandle handle);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RRL_WIRE_H */
@@ -10,82 +10,325 @@
 //  • Default bodies are marked **weak** so that engine teams can
 //    override them by simply providing stronger definitions.
 //  • Alternatively, call `rrl_register_backend()` at runtime to
-//    inject function pointers (hot‑swap).
+//    inject function pointers (hot‑swap).  Swaps are lock‑free for
+//    callers: in‑flight calls finish on the table they started with.
 //─────────────────────────────────────────────────────────────
 #include "rrl_env.h"
+#include "rrl_internal.hpp"
 
+#include <climits>   // INT_MAX
+#include <cmath>     // std::ceil
+#include <cstdint>   // uintptr_t, SIZE_MAX
 #include <cstring>   // std::memset, std::strncpy
-#include <string>
+#include <algorithm> // std::min
+#include <atomic>
 #include <mutex>
-
-//─────────────────────────────────────────────────────────────
-//  Portable weak‑symbol attribute
-//─────────────────────────────────────────────────────────────
-#if defined(__GNUC__) || defined(__clang__)
-#  define RRL_WEAK __attribute__((weak))
-#elif defined(_MSC_VER)
-#  define RRL_WEAK __declspec(selectany)
-#else
-#  define RRL_WEAK  /* weak not available → link‑time override only */
-#endif
+#include <string>
+#include <utility>
+#include <vector>
 
 //─────────────────────────────────────────────────────────────
 //  Internal helpers / state
 //─────────────────────────────────────────────────────────────
-namespace {
+namespace rrl { namespace detail {
 
-// Simple thread‑safe error store (per‑thread would be better, but
-// we keep global + mutex here for clarity)
-static std::mutex       g_err_mtx;
-static int              g_last_err   = RRL_SUCCESS;
-static char             g_last_msg[256] = "";
+// Per‑thread error store: each thread sees only its own last error,
+// so workers never contend on it and the pointer returned by
+// rrl_last_error_msg() cannot be overwritten by another thread.
+static thread_local int  t_last_err      = RRL_SUCCESS;
+static thread_local char t_last_msg[256] = "";
 
 void set_error(int code, const char* msg)
 {
-    std::lock_guard<std::mutex> lk(g_err_mtx);
-    g_last_err = code;
+    t_last_err = code;
     if (msg) {
-        std::strncpy(g_last_msg, msg, sizeof(g_last_msg)-1);
-        g_last_msg[sizeof(g_last_msg)-1] = '\0';
+        std::strncpy(t_last_msg, msg, sizeof(t_last_msg)-1);
+        t_last_msg[sizeof(t_last_msg)-1] = '\0';
     } else {
-        g_last_msg[0] = '\0';
+        t_last_msg[0] = '\0';
     }
 }
 
-// Runtime‑switchable backend table (may be nullptr)
-static const RRL_BackendHooks* g_backend = nullptr;
+const BackendTable              g_stub_table{};
+std::atomic<const BackendTable*> g_table{&g_stub_table};
+std::atomic<uint64_t>            g_epoch{1};
+std::atomic<ReaderSlot*>         g_readers{nullptr};
+
+ReaderSlot* acquire_slot()
+{
+    for (ReaderSlot* r = g_readers.load(std::memory_order_acquire); r; r = r->next) {
+        bool free = false;
+        if (!r->in_use.load(std::memory_order_relaxed) &&
+            r->in_use.compare_exchange_strong(free, true, std::memory_order_acquire))
+            return r;
+    }
+    auto* r = new ReaderSlot;
+    r->next = g_readers.load(std::memory_order_relaxed);
+    while (!g_readers.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                            std::memory_order_relaxed)) {}
+    return r;
+}
+
+namespace {
+struct Retired { void* p; void (*deleter)(void*); uint64_t epoch; };
+std::mutex           g_retire_mtx;
+std::vector<Retired> g_retired;
+}
+
+void retire(void* p, void (*deleter)(void*))
+{
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lk(g_retire_mtx);
+        // Readers that could still see `p` announced an epoch below this one.
+        uint64_t retire_at = g_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        g_retired.push_back({p, deleter, retire_at});
+
+        uint64_t oldest = UINT64_MAX;
+        for (ReaderSlot* r = g_readers.load(std::memory_order_acquire); r; r = r->next) {
+            uint64_t e = r->epoch.load(std::memory_order_seq_cst);
+            if (e && e < oldest) oldest = e;
+        }
+        auto keep = g_retired.begin();
+        for (auto& entry : g_retired) {
+            if (entry.epoch <= oldest) ready.push_back(entry);
+            else *keep++ = entry;
+        }
+        g_retired.erase(keep, g_retired.end());
+    }
+    // Deleters run unlocked: they may retire further objects.
+    for (auto& entry : ready) entry.deleter(entry.p);
+}
+
+}} // namespace rrl::detail
+
+namespace {
+
+using namespace rrl::detail;
+
+// Writers (registration) are rare and serialised; readers never take this.
+std::mutex g_publish_mtx;
+
+void delete_table(void* p) { delete static_cast<const BackendTable*>(p); }
+
+// Build a new snapshot from the current one and swap it in.
+template <class Edit>
+void publish(Edit edit)
+{
+    std::lock_guard<std::mutex> lk(g_publish_mtx);
+    const BackendTable* cur = g_table.load(std::memory_order_relaxed);
+    auto* next = new BackendTable(*cur);
+    edit(*next);
+    const BackendTable* old = g_table.exchange(next, std::memory_order_seq_cst);
+    if (old != &g_stub_table) retire(const_cast<BackendTable*>(old), delete_table);
+}
+
+} // namespace (anonymous)
+
+bool rrl::detail::replace_backend(const BackendTable& next, BackendTable* prev, int (*if_poll)(RRLHandle))
+{
+    bool done = false;
+    publish([&](BackendTable& t) {
+        if (if_poll && t.base.poll != if_poll) return;
+        if (prev) *prev = t;
+        t = next;
+        done = true;
+    });
+    return done;
+}
+
+namespace {
 
 // Default stub helpers (weak) — engine can replace by defining its
 // own versions with the same signature *without* weak attribute.
 RRL_WEAK int stub_poll(RRLHandle /*h*/)                            { return 0; }
 RRL_WEAK int stub_get_stats(RRLHandle /*h*/, RRL_Stats* s)         { if (s) std::memset(s,0,sizeof(*s)); return RRL_ERR_UNSUPPORTED; }
-RRL_WEAK int stub_load_policy(RRLHandle /*h*/, const void*, size_t){ return RRL_ERR_UNSUPPORTED; }
+RRL_WEAK int stub_load_policy(RRLHandle h, const void* bytes, size_t len)
+{
+    // No backend: serve the policy from the built‑in engine (rrl_act_batch).
+    if (!policy_blob_valid(bytes, len)) return RRL_ERR_UNSUPPORTED;
+    RRLPolicy p = shared_policy(bytes, len);
+    if (!p) return RRL_ERR_NO_MEMORY;
+    const int rc = bind_local(h, p);
+    rrl_policy_release(p);
+    return rc;
+}
+
+inline int hist_msb(uint64_t v)   // v >= 8
+{
+    int msb = 0;
+    while (v >>= 1) ++msb;
+    return msb;
+}
+
+// rrl_env.h: the last bucket starts at 15 << 23 µs.
+static_assert((RRL_HIST_BUCKETS - 1) / 8 + 2 == 26 && (RRL_HIST_BUCKETS - 1) % 8 == 7,
+              "update the RRL_HIST_BUCKETS comment in rrl_env.h");
+
+int hist_bucket(uint64_t us)
+{
+    if (us < 8) return static_cast<int>(us);
+    const int msb = hist_msb(us);
+    const int idx = (msb - 2) * 8 + static_cast<int>((us >> (msb - 3)) & 7);
+    return idx < RRL_HIST_BUCKETS ? idx : RRL_HIST_BUCKETS - 1;
+}
+
+// Midpoint of a bucket's value range.
+double hist_value(int idx)
+{
+    if (idx < 8) return idx;
+    const int    msb   = idx / 8 + 2;
+    const double width = static_cast<double>(uint64_t(1) << (msb - 3));
+    return (8 + idx % 8) * width + width / 2;
+}
+
+size_t dtype_size(int dtype)
+{
+    switch (dtype) {
+    case RRL_DTYPE_FLOAT64: case RRL_DTYPE_INT64: return 8;
+    case RRL_DTYPE_FLOAT32: case RRL_DTYPE_INT32: return 4;
+    case RRL_DTYPE_FLOAT16:                       return 2;
+    case RRL_DTYPE_UINT8: case RRL_DTYPE_INT8:
+    case RRL_DTYPE_BOOL:                          return 1;
+    default:                                      return 0;
+    }
+}
+
+// Validate one side of rrl_bind_buffers against its space.
+int check_buffer(const void* buf, size_t bytes, const RRL_SpaceDesc& space)
+{
+    if (!buf) return bytes == 0 ? RRL_SUCCESS : RRL_ERR_INVALID_ARGUMENT;
+    if (reinterpret_cast<uintptr_t>(buf) % RRL_BUFFER_ALIGN != 0)
+        return RRL_ERR_INVALID_ARGUMENT;
+    size_t need = rrl_space_bytes(&space);
+    return need != 0 && bytes >= need ? RRL_SUCCESS : RRL_ERR_INVALID_ARGUMENT;
+}
 
 } // namespace (anonymous)
 
+uint64_t rrl::detail::hist_bucket_end(int idx)
+{
+    if (idx < 8) return static_cast<uint64_t>(idx) + 1;
+    if (idx >= RRL_HIST_BUCKETS - 1) return UINT64_MAX;
+    const int msb = idx / 8 + 2;
+    return static_cast<uint64_t>(9 + idx % 8) << (msb - 3);
+}
+
 //─────────────────────────────────────────────────────────────
 //  Public: register backend (C linkage)
 //─────────────────────────────────────────────────────────────
 extern "C" int rrl_register_backend(const RRL_BackendHooks* hooks)
 {
-    g_backend = hooks;  // can be nullptr to reset to stubs
+    // Hooks are copied, so the caller's table need not outlive the call.
+    publish([&](BackendTable& t) {
+        t.base = hooks ? *hooks : RRL_BackendHooks{};  // nullptr resets to stubs
+    });
+    return RRL_SUCCESS;
+}
+
+namespace {
+
+void set_ext(BackendTable& t, const RRL_BackendHooksExt* ext)
+{
+    t.ext = RRL_BackendHooksExt{};                     // nullptr resets to stubs
+    if (ext) std::memcpy(&t.ext, ext, std::min(ext->struct_size, sizeof(t.ext)));
+    t.ext.struct_size = sizeof(t.ext);
+}
+
+} // namespace (anonymous)
+
+extern "C" int rrl_register_backend_ext(const RRL_BackendHooksExt* ext)
+{
+    if (ext && ext->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_register_backend_ext: bad struct_size");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    publish([&](BackendTable& t) { set_ext(t, ext); });
+    return RRL_SUCCESS;
+}
+
+extern "C" int rrl_register_backends(const RRL_BackendHooks* hooks, const RRL_BackendHooksExt* ext)
+{
+    if (ext && ext->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_register_backends: bad struct_size");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    // One snapshot: no call starts on new base hooks with old ext ones.
+    publish([&](BackendTable& t) {
+        t.base = hooks ? *hooks : RRL_BackendHooks{};
+        set_ext(t, ext);
+    });
     return RRL_SUCCESS;
 }
 
+//─────────────────────────────────────────────────────────────
+//  Public: space helpers (C linkage)
+//─────────────────────────────────────────────────────────────
+extern "C" size_t rrl_space_bytes(const RRL_SpaceDesc* space)
+{
+    if (!space || space->ndim < 0 || space->ndim > 8) return 0;
+    size_t bytes = dtype_size(space->dtype);
+    for (int i = 0; i < space->ndim && bytes; ++i) {
+        const int d = space->shape[i];
+        if (d <= 0 || bytes > SIZE_MAX / static_cast<size_t>(d)) return 0;
+        bytes *= static_cast<size_t>(d);
+    }
+    return bytes;
+}
+
+//─────────────────────────────────────────────────────────────
+//  Public: latency histogram (C linkage)
+//─────────────────────────────────────────────────────────────
+extern "C" void rrl_hist_record(RRL_LatencyHist* hist, uint64_t latency_us)
+{
+    if (!hist) return;
+    atomic_add(&hist->counts[hist_bucket(latency_us)], 1);
+    atomic_add(&hist->total, 1);
+    atomic_max(&hist->max_us, latency_us);
+}
+
+extern "C" double rrl_hist_percentile(const RRL_LatencyHist* hist, double q)
+{
+    if (!hist) return 0.0;
+    const uint64_t total = atomic_read(&hist->total);
+    if (total == 0) return 0.0;
+    q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+    const uint64_t max_us = atomic_read(&hist->max_us);
+    if (q >= 1.0) return static_cast<double>(max_us);
+
+    // Nearest rank: the smallest value with at least q·total samples at
+    // or below it (p99 of 100 samples is the 99th).
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total) - 1e-9));
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < RRL_HIST_BUCKETS; ++i) {
+        seen += atomic_read(&hist->counts[i]);
+        if (seen >= rank) return std::min(hist_value(i), static_cast<double>(max_us));
+    }
+    return static_cast<double>(max_us);   // concurrent writers raced `total`
+}
+
 //─────────────────────────────────────────────────────────────
 //  Public exported C functions (overridable)
 //─────────────────────────────────────────────────────────────
 
 extern "C" {
 
-int RRL_WEAK rrl_poll(RRLHandle handle)
+// Body of the weak rrl_poll.  Where the toolchain has weak aliases
+// (ELF), rrl_poll is an alias of it, so the batch paths below can tell
+// whether the application linked its own rrl_poll; elsewhere they
+// assume it did and go through the export.
+static int rrl_poll_default(RRLHandle handle)
 {
+    RRL_TRACE_SCOPE(RRL_SPAN_POLL, handle);
     if (!handle) {
         set_error(RRL_ERR_INVALID_HANDLE, "rrl_poll: null handle");
         return 0;
     }
-    int rc = g_backend && g_backend->poll ? g_backend->poll(handle)
-                                          : stub_poll(handle);
+    BackendGuard be;
+    int rc;
+    if (be->base.poll)             rc = be->base.poll(handle);
+    else if (!hot_poll(handle, rc)) rc = stub_poll(handle);
     if (rc < 0) {
         set_error(rc, "rrl_poll: backend error");
         return 0;
@@ -93,22 +336,121 @@ int RRL_WEAK rrl_poll(RRLHandle handle)
     return rc; // 0 or 1
 }
 
-int RRL_WEAK rrl_get_stats(RRLHandle handle, RRL_Stats* out_stats)
+#if RRL_HAVE_WEAK_ALIAS
+int rrl_poll(RRLHandle handle) __attribute__((weak, alias("rrl_poll_default")));
+#else
+int RRL_WEAK rrl_poll(RRLHandle handle) { return rrl_poll_default(handle); }
+#endif
+
+int RRL_WEAK rrl_poll_many(const RRLHandle* handles, size_t n,
+                           uint64_t* ready_mask, size_t* ready_idx)
+{
+    RRL_TRACE_SCOPE(RRL_SPAN_POLL, nullptr);
+    if ((!handles && n) || n > static_cast<size_t>(INT_MAX)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_poll_many: bad handle array");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (ready_mask)
+        std::memset(ready_mask, 0, RRL_MASK_WORDS(n) * sizeof(uint64_t));
+
+    BackendGuard be;
+    if (auto many = be->ext.poll_many) {
+        int rc = many(handles, n, ready_mask, ready_idx);
+        if (rc < 0) set_error(rc, "rrl_poll_many: backend error");
+        return rc;
+    }
+    // An rrl_poll linked in by the application decides every handle;
+    // the SDK's own paths are only taken when it is ours.
+    const bool own = !RRL_OVERRIDDEN(rrl_poll);
+    int hot_ready;
+    if (own && !be->base.poll && hot_poll_many(handles, n, ready_mask, ready_idx, hot_ready))
+        return hot_ready;
+
+    // Fallback: resolve the per-handle function once, then loop without
+    // touching the error store unless something actually fails.
+    int (*poll)(RRLHandle) = !own ? rrl_poll : be->base.poll ? be->base.poll : stub_poll;
+    int ready = 0;
+    int first_err = RRL_SUCCESS;
+    for (size_t i = 0; i < n; ++i) {
+        int rc = handles[i] ? poll(handles[i]) : RRL_ERR_INVALID_HANDLE;
+        if (rc < 0) { if (first_err == RRL_SUCCESS) first_err = rc; continue; }
+        if (rc == 0) continue;
+        if (ready_mask) ready_mask[i / 64] |= uint64_t(1) << (i % 64);
+        if (ready_idx)  ready_idx[ready] = i;
+        ++ready;
+    }
+    if (first_err != RRL_SUCCESS)
+        set_error(first_err, "rrl_poll_many: null handle or backend error");
+    return ready;
+}
+
+// Body of the weak rrl_get_stats, aliased like rrl_poll_default.
+static int rrl_get_stats_default(RRLHandle handle, RRL_Stats* out_stats)
 {
     if (!handle || !out_stats) {
         set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_get_stats: null arg");
         return RRL_ERR_INVALID_ARGUMENT;
     }
-    int rc = g_backend && g_backend->get_stats ?
-             g_backend->get_stats(handle, out_stats) :
-             stub_get_stats(handle, out_stats);
+    BackendGuard be;
+    int rc;
+    RRL_StatsV2 hot{};
+    if (be->base.get_stats)          rc = be->base.get_stats(handle, out_stats);
+    else if (hot_stats(handle, hot)) { *out_stats = hot.base; rc = RRL_SUCCESS; }
+    else                             rc = stub_get_stats(handle, out_stats);
     if (rc != RRL_SUCCESS) {
         set_error(rc, "rrl_get_stats: backend error");
     }
     return rc;
 }
 
-int RRL_WEAK rrl_load_policy(RRLHandle handle, const void* bytes, size_t len)
+#if RRL_HAVE_WEAK_ALIAS
+int rrl_get_stats(RRLHandle handle, RRL_Stats* out_stats) __attribute__((weak, alias("rrl_get_stats_default")));
+#else
+int RRL_WEAK rrl_get_stats(RRLHandle handle, RRL_Stats* out_stats) { return rrl_get_stats_default(handle, out_stats); }
+#endif
+
+int RRL_WEAK rrl_get_stats_v2(RRLHandle handle, RRL_StatsV2* out_stats)
+{
+    if (!handle || !out_stats || out_stats->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_get_stats_v2: null arg or bad struct_size");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    // Always fill a full-size snapshot, then copy back only what the
+    // caller's (possibly older) struct has room for.
+    RRL_StatsV2 full{};
+    full.struct_size = sizeof(full);
+    BackendGuard be;
+    int rc;
+    if (auto v2 = be->ext.get_stats_v2) {
+        rc = v2(handle, &full);
+    } else if (RRL_OVERRIDDEN(rrl_get_stats)) {
+        rc = rrl_get_stats(handle, &full.base);   // an application's export outranks hot state
+    } else if (!be->base.get_stats && hot_stats(handle, full)) {
+        rc = RRL_SUCCESS;
+    } else {
+        rc = be->base.get_stats ? be->base.get_stats(handle, &full.base)
+                                : stub_get_stats(handle, &full.base);
+    }
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, "rrl_get_stats_v2: backend error");
+        return rc;
+    }
+    if (!full.reconnects && !full.downtime_us) replay_stats(handle, full);
+    full.latency_p50_ms  = rrl_hist_percentile(&full.latency, 0.50)  / 1000.0;
+    full.latency_p90_ms  = rrl_hist_percentile(&full.latency, 0.90)  / 1000.0;
+    full.latency_p99_ms  = rrl_hist_percentile(&full.latency, 0.99)  / 1000.0;
+    full.latency_p999_ms = rrl_hist_percentile(&full.latency, 0.999) / 1000.0;
+    full.latency_max_ms  = static_cast<double>(full.latency.max_us)  / 1000.0;
+    if (full.pipeline_depth == 0) full.pipeline_depth = 1;   // lock-step unless reported
+
+    const size_t n = std::min(out_stats->struct_size, sizeof(full));
+    full.struct_size = n;
+    std::memcpy(out_stats, &full, n);
+    return RRL_SUCCESS;
+}
+
+// Body of the weak rrl_load_policy, aliased like rrl_poll_default.
+static int rrl_load_policy_default(RRLHandle handle, const void* bytes, size_t len)
 {
     if (!handle) {
         set_error(RRL_ERR_INVALID_HANDLE, "rrl_load_policy: null handle");
@@ -118,25 +460,162 @@ int RRL_WEAK rrl_load_policy(RRLHandle handle, const void* bytes, size_t len)
         set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_load_policy: empty blob");
         return RRL_ERR_INVALID_ARGUMENT;
     }
-    int rc = g_backend && g_backend->load_policy ?
-             g_backend->load_policy(handle, bytes, len) :
-             stub_load_policy(handle, bytes, len);
+    BackendGuard be;
+    int rc = be->base.load_policy ? be->base.load_policy(handle, bytes, len)
+                                  : stub_load_policy(handle, bytes, len);
     if (rc != RRL_SUCCESS) {
         set_error(rc, "rrl_load_policy: backend error");
     }
     return rc;
 }
 
+#if RRL_HAVE_WEAK_ALIAS
+int rrl_load_policy(RRLHandle handle, const void* bytes, size_t len) __attribute__((weak, alias("rrl_load_policy_default")));
+#else
+int RRL_WEAK rrl_load_policy(RRLHandle handle, const void* bytes, size_t len) { return rrl_load_policy_default(handle, bytes, len); }
+#endif
+
+int RRL_WEAK rrl_bind_buffers(RRLHandle handle,
+                              void* obs, size_t obs_bytes,
+                              void* act, size_t act_bytes)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_bind_buffers: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    // Sizes are checked here, once, so the core can trust the buffers
+    // on every step without re-validating.
+    RRL_SpaceDesc obs_space{}, act_space{};
+    int rc = RRL_SUCCESS;
+    if (obs && (rc = rrl_observation_space(handle, &obs_space)) != RRL_SUCCESS) {
+        set_error(rc, "rrl_bind_buffers: observation_space failed");
+        return rc;
+    }
+    if (act && (rc = rrl_action_space(handle, &act_space)) != RRL_SUCCESS) {
+        set_error(rc, "rrl_bind_buffers: action_space failed");
+        return rc;
+    }
+    if (check_buffer(obs, obs_bytes, obs_space) != RRL_SUCCESS ||
+        check_buffer(act, act_bytes, act_space) != RRL_SUCCESS) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_bind_buffers: buffer misaligned or too small");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    BackendGuard be;
+    auto bind = be->ext.bind_buffers;
+    rc = bind ? bind(handle, obs, obs_bytes, act, act_bytes) : RRL_ERR_UNSUPPORTED;
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, "rrl_bind_buffers: backend error");
+    }
+    return rc;
+}
+
+int RRL_WEAK rrl_set_pipeline_depth(RRLHandle handle, unsigned depth)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_set_pipeline_depth: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    if (depth == 0 || depth > RRL_MAX_PIPELINE_DEPTH) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_set_pipeline_depth: depth out of range");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    BackendGuard be;
+    auto set = be->ext.set_pipeline_depth;
+    // Lock-step is what every backend does without being told.
+    int rc = set ? set(handle, depth) : depth == 1 ? RRL_SUCCESS : RRL_ERR_UNSUPPORTED;
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, set ? "rrl_set_pipeline_depth: backend error"
+                          : "rrl_set_pipeline_depth: backend is lock-step only");
+    }
+    return rc;
+}
+
+RRLHandle RRL_WEAK rrl_open(const RRL_OpenConfig* cfg)
+{
+    if (!cfg || cfg->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_open: null config or bad struct_size");
+        return nullptr;
+    }
+    // Hooks see a full-size config, like rrl_get_stats_v2's snapshot.
+    RRL_OpenConfig full{};
+    std::memcpy(&full, cfg, std::min(cfg->struct_size, sizeof(full)));
+    full.struct_size = sizeof(full);
+    BackendGuard be;
+    auto open = be->ext.open;
+    RRLHandle h = nullptr;
+    int rc = open ? open(&full, &h) : RRL_ERR_UNSUPPORTED;
+    if (rc == RRL_SUCCESS && !h) rc = RRL_ERR_IO;
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, open ? "rrl_open: backend error" : "rrl_open: backend cannot open handles");
+        return nullptr;
+    }
+    return h;
+}
+
+int RRL_WEAK rrl_reset(RRLHandle handle)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_reset: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    BackendGuard be;
+    auto reset = be->ext.reset;
+    int rc = reset ? reset(handle) : RRL_ERR_UNSUPPORTED;
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, reset ? "rrl_reset: backend error" : "rrl_reset: backend cannot reset handles");
+    }
+    return rc;
+}
+
 int rrl_last_error(void)
 {
-    std::lock_guard<std::mutex> lk(g_err_mtx);
-    return g_last_err;
+    return t_last_err;
 }
 
 const char* rrl_last_error_msg(void)
 {
-    std::lock_guard<std::mutex> lk(g_err_mtx);
-    return g_last_msg;
+    return t_last_msg;  // valid until this thread's next failing call
+}
+
+void rrl_set_last_error(int code, const char* msg)
+{
+    set_error(code, msg);
+}
+
+void rrl_handle_closed(RRLHandle handle)
+{
+    if (!handle) return;
+    bind_local(handle, nullptr);   // an unbind never allocates
+    preproc_forget(handle);
+    metrics_forget(handle);   // reads the replay's reconnects one last time
+    replay_forget(handle);
 }
 
 } // extern "C"
+
+namespace rrl { namespace detail {
+
+bool load_policy_served(bool hook)
+{
+    return hook || RRL_OVERRIDDEN(rrl_load_policy);
+}
+
+int load_policy_mapped_fallback(RRLHandle handle, RRLMappedFile file)
+{
+    size_t len = 0;
+    const void* data = rrl_mapped_data(file, &len);
+    BackendGuard be;
+    if (load_policy_served(be->base.load_policy != nullptr))
+        return rrl_load_policy(handle, data, len);
+    // Built‑in engine: one policy per mapping, however many handles load it.
+    int rc = RRL_ERR_UNSUPPORTED;
+    if (policy_blob_valid(data, len)) {
+        RRLPolicy p = shared_policy(file);
+        rc = p ? bind_local(handle, p) : RRL_ERR_NO_MEMORY;
+        rrl_policy_release(p);
+    }
+    if (rc != RRL_SUCCESS) set_error(rc, "rrl_load_policy_mapped: backend error");
+    return rc;
+}
+
+}} // namespace rrl::detail
@@ -0,0 +1,163 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_gemm.hpp  —  Vector‑width‑generic GEMM for rrl_infer
+//
+//  • Y = X·W (⊙ scale) + b over a `V` vector type (see Vec in
+//    rrl_infer.cpp): included by rrl_infer.cpp for NEON and by
+//    rrl_infer_avx2.cpp, which alone is built with AVX2 flags.
+//  • Everything here has internal linkage, so each including TU
+//    gets its own copy compiled for its own target: no AVX2 code
+//    can be merged into the baseline build.  Keep it free of
+//    std:: templates for the same reason.
+//─────────────────────────────────────────────────────────────
+#ifndef RRL_GEMM_HPP
+#define RRL_GEMM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace rrl { namespace detail {
+
+using half_t = uint16_t;
+
+// Runtime‑selected x86 kernels (rrl_infer_avx2.cpp); only call them
+// when cpu_has_avx2().
+#if defined(RRL_HAVE_AVX2_KERNELS)
+void gemm_avx2(const float* X, size_t M, size_t K, const float*  W, const float* scale,
+               const float* b, float* Y, size_t N);
+void gemm_avx2(const float* X, size_t M, size_t K, const half_t* W, const float* scale,
+               const float* b, float* Y, size_t N);
+void gemm_avx2(const float* X, size_t M, size_t K, const int8_t* W, const float* scale,
+               const float* b, float* Y, size_t N);
+#endif
+
+namespace {
+
+//──────────────────── Weight element types ─────────────────
+// float16 / int8 weights are widened to float32 on load and multiplied
+// in float32: quantization saves storage and memory bandwidth, not
+// arithmetic (there is no int8 dot‑product path).  int8 columns are
+// rescaled once per output (Y = (X·Q) ⊙ scale + b), so the inner loop
+// never multiplies by the scale.
+inline float half_to_float(half_t h)
+{
+    const uint32_t sign = uint32_t(h & 0x8000u) << 16;
+    uint32_t exp  = (h >> 10) & 0x1Fu;
+    uint32_t mant = h & 0x3FFu;
+    uint32_t bits;
+    if (exp == 0x1F) {                       // inf / nan
+        bits = sign | 0x7F800000u | (mant << 13);
+    } else if (exp != 0) {                   // normal
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    } else if (mant == 0) {                  // ±0
+        bits = sign;
+    } else {                                 // subnormal: renormalise
+        exp = 113;
+        while (!(mant & 0x400u)) { mant <<= 1; --exp; }
+        bits = sign | (exp << 23) | ((mant & 0x3FFu) << 13);
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline float widen(float  w) { return w; }
+inline float widen(half_t w) { return half_to_float(w); }
+inline float widen(int8_t w) { return float(w); }
+
+// Weights are read with memcpy: a blob offset promises the file's
+// alignment, not the element type's.
+template <typename Wt>
+inline float weight_at(const Wt* p)
+{
+    Wt w;
+    std::memcpy(&w, p, sizeof(w));
+    return widen(w);
+}
+
+// Per-column epilogue: y = acc · scale + b  (scale == nullptr ⇒ 1).
+inline float finish(float acc, const float* scale, const float* b, size_t j)
+{
+    return (scale ? acc * scale[j] : acc) + b[j];
+}
+
+//──────────────────── GEMM: Y = X·W + b ─────────────────────
+// Falls back to scalar widening when `V` lacks a vector conversion
+// for `Wt` (e.g. float16 on 32‑bit ARM).
+template <class V, typename Wt, typename = void>
+struct WLoad {
+    static typename V::T load(const Wt* p)
+    {
+        alignas(32) float tmp[V::W];
+        for (size_t i = 0; i < V::W; ++i) tmp[i] = weight_at(p + i);
+        return V::load(tmp);
+    }
+};
+template <class V, typename Wt>
+struct WLoad<V, Wt, decltype(void(V::load(static_cast<const Wt*>(nullptr))))> {
+    static typename V::T load(const Wt* p) { return V::load(p); }
+};
+
+template <class V>
+inline void store_out(float* y, typename V::T acc, const float* scale, const float* b, size_t j)
+{
+    if (!scale) { V::store(y, V::add(acc, V::load(b + j))); return; }
+    V::store(y, V::fma(acc, V::load(scale + j), V::load(b + j)));
+}
+
+// R rows × (2·V::W) columns per step: each W load feeds R FMAs.
+template <class V, int R, typename Wt>
+void gemm_rows(const float* X, size_t K, const Wt* W, const float* scale,
+               const float* b, float* Y, size_t N)
+{
+    constexpr size_t VW = V::W;
+    size_t j = 0;
+    for (; j + 2 * VW <= N; j += 2 * VW) {
+        typename V::T acc[R][2];
+        for (int r = 0; r < R; ++r) acc[r][0] = acc[r][1] = V::zero();
+        for (size_t k = 0; k < K; ++k) {
+            const Wt* w = W + k * N + j;
+            const auto w0 = WLoad<V, Wt>::load(w), w1 = WLoad<V, Wt>::load(w + VW);
+            for (int r = 0; r < R; ++r) {
+                const auto x = V::bcast(X + r * K + k);
+                acc[r][0] = V::fma(x, w0, acc[r][0]);
+                acc[r][1] = V::fma(x, w1, acc[r][1]);
+            }
+        }
+        for (int r = 0; r < R; ++r) {
+            store_out<V>(Y + r * N + j,      acc[r][0], scale, b, j);
+            store_out<V>(Y + r * N + j + VW, acc[r][1], scale, b, j + VW);
+        }
+    }
+    for (; j + VW <= N; j += VW) {
+        typename V::T acc[R];
+        for (int r = 0; r < R; ++r) acc[r] = V::zero();
+        for (size_t k = 0; k < K; ++k) {
+            const auto w0 = WLoad<V, Wt>::load(W + k * N + j);
+            for (int r = 0; r < R; ++r) acc[r] = V::fma(V::bcast(X + r * K + k), w0, acc[r]);
+        }
+        for (int r = 0; r < R; ++r) store_out<V>(Y + r * N + j, acc[r], scale, b, j);
+    }
+    for (; j < N; ++j) {
+        for (int r = 0; r < R; ++r) {
+            float s = 0.f;
+            for (size_t k = 0; k < K; ++k) s += X[r * K + k] * weight_at(W + k * N + j);
+            Y[r * N + j] = finish(s, scale, b, j);
+        }
+    }
+}
+
+template <class V, typename Wt>
+void gemm_vec(const float* X, size_t M, size_t K, const Wt* W, const float* scale,
+              const float* b, float* Y, size_t N)
+{
+    size_t i = 0;
+    for (; i + 4 <= M; i += 4) gemm_rows<V, 4>(X + i * K, K, W, scale, b, Y + i * N, N);
+    for (; i < M; ++i)         gemm_rows<V, 1>(X + i * K, K, W, scale, b, Y + i * N, N);
+}
+
+} // namespace (anonymous)
+
+}} // namespace rrl::detail
+
+#endif // RRL_GEMM_HPP
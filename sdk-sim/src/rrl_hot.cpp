@@ -0,0 +1,288 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_hot.cpp  —  Cache‑line‑aware per‑handle hot state
+//
+//  • Readiness: one bit per handle.  Setting it is one atomic OR on
+//    the handle's word; batch polls read whole words and skip 256
+//    handles at a time when none is ready.
+//  • Counters: [writer][counter][handle] arrays, each padded to a
+//    cache line, so a writer thread's increments stay on lines no
+//    other thread writes.  rrl_get_stats sums one column per call.
+//  • fps is derived at read time over a window of ≥ 1 s; that state
+//    is cold and sits behind a mutex.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <vector>
+
+using namespace rrl::detail;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum Counter { kSteps, kLatencySum, kLatencyMax, kBytesIn, kBytesOut, kCounters };
+
+constexpr size_t kLineWords = RRL_BUFFER_ALIGN / sizeof(uint64_t);
+
+constexpr size_t pad_words(size_t n) { return (n + kLineWords - 1) / kLineWords * kLineWords; }
+
+struct Index {
+    RRLHandle handle;
+    size_t    slot;
+};
+
+} // namespace (anonymous)
+
+struct RRLHotStateImpl {
+    size_t   n       = 0;
+    size_t   words   = 0;      // readiness words, line‑padded
+    size_t   stride  = 0;      // uint64 per counter array, line‑padded
+    unsigned writers = 0;
+    uint64_t* block  = nullptr;   // ready bitmap | counters, one aligned allocation
+    uint64_t* ready  = nullptr;
+    uint64_t* counters = nullptr;
+
+    std::vector<RRLHandle> handles;   // creation order
+    std::vector<Index>     index;     // sorted by handle
+
+    // Read side only (rrl_get_stats): fps window per handle
+    std::mutex               fps_mtx;
+    std::vector<uint64_t>    win_steps;
+    std::vector<Clock::time_point> win_start;
+    std::vector<double>      fps;
+
+    uint64_t* column(unsigned writer, Counter c) { return counters + (size_t(writer) * kCounters + c) * stride; }
+
+    ~RRLHotStateImpl() {
+        if (block) ::operator delete(block, std::align_val_t{RRL_BUFFER_ALIGN});
+    }
+};
+
+namespace {
+
+std::atomic<RRLHotStateImpl*> g_hot{nullptr};
+
+void delete_hot(void* p) { delete static_cast<RRLHotStateImpl*>(p); }
+
+bool find(const RRLHotStateImpl* hot, RRLHandle h, size_t& slot)
+{
+    auto it = std::lower_bound(hot->index.begin(), hot->index.end(), h, [](const Index& e, RRLHandle v) {
+        return std::less<RRLHandle>()(e.handle, v);
+    });
+    if (it == hot->index.end() || it->handle != h) return false;
+    slot = it->slot;
+    return true;
+}
+
+inline bool test_ready(const RRLHotStateImpl* hot, size_t i)
+{
+    return (atomic_read(&hot->ready[i / 64]) >> (i % 64)) & 1u;
+}
+
+// Ready indices below `n`, ascending, from the bitmap itself.
+int scan_bitmap(const RRLHotStateImpl* hot, size_t n, uint64_t* mask, size_t* idx)
+{
+    const size_t words = RRL_MASK_WORDS(n);
+    int ready = 0;
+    size_t w = 0;
+    while (w < words) {
+        // Skip all‑zero runs four words (256 handles) at a time.  Relaxed
+        // loads are plain moves on every target the SDK supports, so
+        // this costs what a vector peek would without racing the ORs.
+        if (w % 4 == 0 && w + 4 <= words &&
+            !(atomic_read(&hot->ready[w])     | atomic_read(&hot->ready[w + 1]) |
+              atomic_read(&hot->ready[w + 2]) | atomic_read(&hot->ready[w + 3]))) {
+            w += 4;
+            continue;
+        }
+        uint64_t bits = atomic_read(&hot->ready[w]);
+        if (w == words - 1 && n % 64) bits &= (uint64_t(1) << (n % 64)) - 1;
+        if (mask) mask[w] = bits;
+        while (bits) {
+            const int b = ctz64(bits);
+            if (idx) idx[ready] = w * 64 + static_cast<size_t>(b);
+            ++ready;
+            bits &= bits - 1;
+        }
+        ++w;
+    }
+    return ready;
+}
+
+} // namespace (anonymous)
+
+namespace rrl { namespace detail {
+
+bool hot_poll(RRLHandle handle, int& ready)
+{
+    const RRLHotStateImpl* hot = g_hot.load(std::memory_order_acquire);
+    size_t slot;
+    if (!hot || !find(hot, handle, slot)) return false;
+    ready = test_ready(hot, slot) ? 1 : 0;
+    return true;
+}
+
+bool hot_poll_many(const RRLHandle* handles, size_t n, uint64_t* ready_mask, size_t* ready_idx, int& ready)
+{
+    const RRLHotStateImpl* hot = g_hot.load(std::memory_order_acquire);
+    if (!hot) return false;
+    if (handles == hot->handles.data() && n <= hot->n) {
+        ready = scan_bitmap(hot, n, ready_mask, ready_idx);
+        return true;
+    }
+    // Arbitrary order: one lookup per handle; unknown handles are not ready.
+    ready = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t slot;
+        if (!handles[i] || !find(hot, handles[i], slot) || !test_ready(hot, slot)) continue;
+        if (ready_mask) ready_mask[i / 64] |= uint64_t(1) << (i % 64);
+        if (ready_idx)  ready_idx[ready] = i;
+        ++ready;
+    }
+    return true;
+}
+
+bool hot_stats(RRLHandle handle, RRL_StatsV2& out)
+{
+    RRLHotStateImpl* hot = g_hot.load(std::memory_order_acquire);
+    size_t slot;
+    if (!hot || !find(hot, handle, slot)) return false;
+    uint64_t steps = 0, lat_sum = 0, lat_max = 0, in = 0, outb = 0;
+    for (unsigned w = 0; w < hot->writers; ++w) {
+        steps   += atomic_read(hot->column(w, kSteps) + slot);
+        lat_sum += atomic_read(hot->column(w, kLatencySum) + slot);
+        lat_max  = std::max(lat_max, atomic_read(hot->column(w, kLatencyMax) + slot));
+        in      += atomic_read(hot->column(w, kBytesIn) + slot);
+        outb    += atomic_read(hot->column(w, kBytesOut) + slot);
+    }
+    double fps;
+    {
+        std::lock_guard<std::mutex> lk(hot->fps_mtx);
+        const Clock::time_point now = Clock::now();
+        const double dt = std::chrono::duration<double>(now - hot->win_start[slot]).count();
+        if (dt >= 1.0) {
+            hot->fps[slot]       = static_cast<double>(steps - hot->win_steps[slot]) / dt;
+            hot->win_steps[slot] = steps;
+            hot->win_start[slot] = now;
+        }
+        fps = hot->fps[slot];
+    }
+    out.base.fps        = fps;
+    out.base.latency_ms = steps ? static_cast<double>(lat_sum) / static_cast<double>(steps) / 1000.0 : 0.0;
+    out.base.steps      = static_cast<unsigned long>(steps);
+    out.bytes_in        = in;
+    out.bytes_out       = outb;
+    out.latency.max_us  = lat_max;   // no per-handle histogram: percentiles stay 0
+    return true;
+}
+
+}} // namespace rrl::detail
+
+extern "C" {
+
+RRLHotState rrl_hot_create(const RRLHandle* handles, size_t n, unsigned writers)
+{
+    if (!handles || n == 0 || writers == 0 || writers > 1024) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_hot_create: bad handle array or writer count");
+        return nullptr;
+    }
+    auto* hot = new (std::nothrow) RRLHotStateImpl;
+    if (!hot) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_hot_create: out of memory");
+        return nullptr;
+    }
+    hot->n       = n;
+    hot->writers = writers;
+    hot->words   = pad_words(RRL_MASK_WORDS(n));
+    hot->stride  = pad_words(n);
+    const size_t total = hot->words + size_t(writers) * kCounters * hot->stride;
+    try {
+        hot->handles.assign(handles, handles + n);
+        hot->index.resize(n);
+        hot->win_steps.assign(n, 0);
+        hot->win_start.assign(n, Clock::now());
+        hot->fps.assign(n, 0.0);
+        hot->block = static_cast<uint64_t*>(::operator new(total * sizeof(uint64_t), std::align_val_t{RRL_BUFFER_ALIGN}));
+    } catch (const std::bad_alloc&) {
+        delete hot;
+        set_error(RRL_ERR_NO_MEMORY, "rrl_hot_create: out of memory");
+        return nullptr;
+    }
+    std::memset(hot->block, 0, total * sizeof(uint64_t));
+    hot->ready    = hot->block;
+    hot->counters = hot->block + hot->words;
+    for (size_t i = 0; i < n; ++i) {
+        if (!handles[i]) {
+            delete hot;
+            set_error(RRL_ERR_INVALID_HANDLE, "rrl_hot_create: null handle");
+            return nullptr;
+        }
+        hot->index[i] = Index{handles[i], i};
+    }
+    std::sort(hot->index.begin(), hot->index.end(), [](const Index& a, const Index& b) {
+        return std::less<RRLHandle>()(a.handle, b.handle);
+    });
+    for (size_t i = 1; i < n; ++i)
+        if (hot->index[i].handle == hot->index[i - 1].handle) {
+            delete hot;
+            set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_hot_create: duplicate handle");
+            return nullptr;
+        }
+    return hot;
+}
+
+void rrl_hot_destroy(RRLHotState hot)
+{
+    if (!hot) return;
+    RRLHotStateImpl* expected = hot;
+    g_hot.compare_exchange_strong(expected, nullptr, std::memory_order_seq_cst);
+    // Polls that loaded it before the swap may still be reading.
+    retire(hot, delete_hot);
+}
+
+const RRLHandle* rrl_hot_handles(RRLHotState hot, size_t* out_n)
+{
+    if (out_n) *out_n = hot ? hot->n : 0;
+    return hot ? hot->handles.data() : nullptr;
+}
+
+int rrl_hot_register(RRLHotState hot)
+{
+    g_hot.store(hot, std::memory_order_seq_cst);
+    return RRL_SUCCESS;
+}
+
+void rrl_hot_set_ready(RRLHotState hot, size_t index, int ready)
+{
+    if (!hot || index >= hot->n) return;
+    const uint64_t bit = uint64_t(1) << (index % 64);
+    if (ready) atomic_or (&hot->ready[index / 64], bit);
+    else       atomic_and(&hot->ready[index / 64], ~bit);
+}
+
+void rrl_hot_record(RRLHotState hot, unsigned writer, size_t index,
+                    uint64_t latency_us, uint64_t bytes_in, uint64_t bytes_out)
+{
+    if (!hot || writer >= hot->writers || index >= hot->n) return;
+    // Single writer per column: plain read‑modify‑store, no lock prefix.
+    uint64_t* steps = hot->column(writer, kSteps) + index;
+    uint64_t* lsum  = hot->column(writer, kLatencySum) + index;
+    uint64_t* lmax  = hot->column(writer, kLatencyMax) + index;
+    uint64_t* in    = hot->column(writer, kBytesIn) + index;
+    uint64_t* out   = hot->column(writer, kBytesOut) + index;
+    atomic_write(steps, atomic_read(steps) + 1);
+    atomic_write(lsum,  atomic_read(lsum) + latency_us);
+    if (latency_us > atomic_read(lmax)) atomic_write(lmax, latency_us);
+    atomic_write(in,    atomic_read(in) + bytes_in);
+    atomic_write(out,   atomic_read(out) + bytes_out);
+}
+
+} // extern "C"
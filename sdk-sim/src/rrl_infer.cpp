@@ -0,0 +1,479 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_infer.cpp  —  Built‑in on‑device inference engine
+//
+//  • Runs MLP / small‑CNN policies stored in the
+//    rrl_policy_format.h layout, reading weights in place (works
+//    directly on an rrl_map_file() mapping).
+//  • Every call is batched: each layer is one GEMM over all envs
+//    of the batch (conv layers via HWC im2col, chunked so scratch
+//    stays bounded).
+//  • GEMM micro‑kernel (rrl_gemm.hpp) uses NEON, or AVX2+FMA picked
+//    at run time on x86 CPUs that have it (rrl_infer_avx2.cpp), plain
+//    C++ otherwise.  float16 and per‑column int8 weights are widened
+//    in registers and the math is float32: quantized models are
+//    smaller and lighter on memory bandwidth, not int8 compute.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_policy_format.h"
+#include "rrl_internal.hpp"
+#include "rrl_gemm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define RRL_SIMD_NEON 1
+#endif
+
+using namespace rrl::detail;
+
+static_assert(sizeof(RRL_PolicyHeader) == 64, "policy header layout");
+static_assert(sizeof(RRL_PolicyLayer)  == 80, "policy layer layout");
+
+namespace {
+
+// Scratch activations per call stay under this many floats per buffer.
+constexpr size_t kScratchFloats = size_t(4) << 20;   // 16 MiB
+constexpr uint32_t kMaxLayers   = 64;
+constexpr uint32_t kMaxDim      = 1u << 16;
+
+//──────────────────── Model view ────────────────────────────
+struct Net {
+    const uint8_t*          base   = nullptr;
+    const RRL_PolicyHeader* hdr    = nullptr;
+    const RRL_PolicyLayer*  layers = nullptr;
+    size_t in_elems  = 0;    // per env
+    size_t in_bytes  = 0;
+    size_t out_elems = 0;    // last layer N
+    size_t act_bytes = 0;    // per env action size
+    size_t max_act   = 0;    // largest activation tensor, floats per env
+    size_t max_cols  = 0;    // largest im2col matrix, floats per env
+};
+
+// Dims are capped at kMaxDim, so these stay below 2^48 (exact in
+// uint64_t, not necessarily in size_t).
+inline uint64_t elems(const uint32_t d[3]) { return uint64_t(d[0]) * d[1] * d[2]; }
+
+inline uint64_t k_of(const RRL_PolicyLayer& l)
+{
+    return l.kind == RRL_LAYER_CONV2D ? uint64_t(l.kernel) * l.kernel * l.in_dims[2]
+                                      : elems(l.in_dims);
+}
+
+// out = a · b, false if that overflows.
+inline bool mul_ok(uint64_t a, uint64_t b, uint64_t& out)
+{
+    if (a && b > UINT64_MAX / a) return false;
+    out = a * b;
+    return true;
+}
+
+// `v` floats (bytes `v · 4`) are addressable on this target.
+inline bool floats_ok(uint64_t v) { return v <= SIZE_MAX / sizeof(float); }
+
+inline const float* f32_at(const Net& net, uint64_t off)
+{
+    return reinterpret_cast<const float*>(net.base + off);
+}
+
+bool dims_ok(const uint32_t d[3])
+{
+    return d[0] && d[1] && d[2] && d[0] <= kMaxDim && d[1] <= kMaxDim && d[2] <= kMaxDim;
+}
+
+bool blob_fits(uint64_t off, uint64_t bytes, size_t len, uint64_t align)
+{
+    return off % align == 0 && off <= len && bytes <= len - off;
+}
+
+size_t weight_size(int32_t dtype)
+{
+    switch (dtype) {
+    case RRL_DTYPE_FLOAT32: return 4;
+    case RRL_DTYPE_FLOAT16: return 2;
+    case RRL_DTYPE_INT8:    return 1;
+    default:                return 0;
+    }
+}
+
+bool parse(const void* data, size_t len, Net& net)
+{
+    if (!data || len < sizeof(RRL_PolicyHeader)) return false;
+    net.base = static_cast<const uint8_t*>(data);
+    net.hdr  = reinterpret_cast<const RRL_PolicyHeader*>(net.base);
+    const RRL_PolicyHeader& h = *net.hdr;
+    if (h.magic != RRL_POLICY_MAGIC || h.version == 0 || h.version > RRL_POLICY_VERSION) return false;
+    // v1 files predate weight_align (the field was reserved, always 0).
+    const uint64_t align = h.version >= 2 && h.weight_align ? h.weight_align : RRL_POLICY_ALIGN;
+    if (align < 4 || (align & (align - 1))) return false;
+    if (h.num_layers == 0 || h.num_layers > kMaxLayers) return false;
+    if (h.input_dtype != RRL_DTYPE_FLOAT32 && h.input_dtype != RRL_DTYPE_UINT8) return false;
+    if (!dims_ok(h.input_dims)) return false;
+    if (len < sizeof(h) + sizeof(RRL_PolicyLayer) * h.num_layers) return false;
+    net.layers = reinterpret_cast<const RRL_PolicyLayer*>(net.base + sizeof(h));
+
+    if (!floats_ok(elems(h.input_dims))) return false;
+    net.in_elems = static_cast<size_t>(elems(h.input_dims));
+    net.in_bytes = net.in_elems * (h.input_dtype == RRL_DTYPE_UINT8 ? 1 : 4);
+    net.max_act  = net.in_elems;
+    net.max_cols = 0;
+
+    const uint32_t* prev = h.input_dims;
+    for (uint32_t i = 0; i < h.num_layers; ++i) {
+        const RRL_PolicyLayer& l = net.layers[i];
+        if (!dims_ok(l.in_dims) || !dims_ok(l.out_dims)) return false;
+        if (l.activation > RRL_ACT_TANH) return false;
+        const size_t wsize = weight_size(l.weight_dtype);
+        if (!wsize || (h.version < 2 && l.weight_dtype != RRL_DTYPE_FLOAT32)) return false;
+        if (elems(l.in_dims) != elems(prev)) return false;
+        if (l.kind == RRL_LAYER_CONV2D) {
+            if (std::memcmp(l.in_dims, prev, sizeof(l.in_dims)) != 0) return false;
+            if (!l.kernel || !l.stride || l.kernel > l.in_dims[0] || l.kernel > l.in_dims[1]) return false;
+            if (l.out_dims[0] != (l.in_dims[0] - l.kernel) / l.stride + 1 ||
+                l.out_dims[1] != (l.in_dims[1] - l.kernel) / l.stride + 1) return false;
+            uint64_t cols = 0;
+            if (!mul_ok(uint64_t(l.out_dims[0]) * l.out_dims[1], k_of(l), cols) || !floats_ok(cols))
+                return false;
+            net.max_cols = std::max(net.max_cols, static_cast<size_t>(cols));
+        } else if (l.kind == RRL_LAYER_DENSE) {
+            if (l.out_dims[0] != 1 || l.out_dims[1] != 1) return false;
+        } else {
+            return false;
+        }
+        const uint64_t n = l.out_dims[2];
+        uint64_t kn = 0, wbytes = 0;
+        if (!mul_ok(k_of(l), n, kn) || !mul_ok(kn, wsize, wbytes) ||
+            !blob_fits(l.weight_offset, wbytes, len, align) ||
+            !blob_fits(l.bias_offset, n * 4, len, align)) return false;
+        if (l.weight_dtype == RRL_DTYPE_INT8 && !blob_fits(l.scale_offset, n * 4, len, align))
+            return false;
+        if (!floats_ok(elems(l.out_dims))) return false;
+        net.max_act = std::max(net.max_act, static_cast<size_t>(elems(l.out_dims)));
+        prev = l.out_dims;
+    }
+    net.out_elems = static_cast<size_t>(elems(prev));
+    if (h.output_kind == RRL_POLICY_OUT_ARGMAX)          net.act_bytes = sizeof(int32_t);
+    else if (h.output_kind == RRL_POLICY_OUT_CONTINUOUS) net.act_bytes = net.out_elems * sizeof(float);
+    else return false;
+    return true;
+}
+
+//──────────────────── GEMM: Y = X·W + b ─────────────────────
+#if defined(RRL_SIMD_NEON)
+
+struct Vec {
+    using T = float32x4_t;
+    static constexpr size_t W = 4;
+    static T    zero ()                       { return vdupq_n_f32(0.f); }
+    static T    load (const float* p)         { return vld1q_f32(p); }
+    static T    bcast(const float* p)         { return vld1q_dup_f32(p); }
+#  if defined(__aarch64__)
+    static T    fma  (T a, T b, T acc)        { return vfmaq_f32(acc, a, b); }
+#  else
+    static T    fma  (T a, T b, T acc)        { return vmlaq_f32(acc, a, b); }
+#  endif
+    static T    add  (T a, T b)               { return vaddq_f32(a, b); }
+    static void store(float* p, T v)          { vst1q_f32(p, v); }
+
+    static T load(const int8_t* p)
+    {
+        int32_t four;                          // exactly W bytes, never past the blob
+        std::memcpy(&four, p, sizeof(four));
+        const int16x8_t w16 = vmovl_s8(vreinterpret_s8_s32(vdup_n_s32(four)));
+        return vcvtq_f32_s32(vmovl_s16(vget_low_s16(w16)));
+    }
+#  if defined(__aarch64__)
+    static T load(const half_t* p)
+    {
+        return vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(p)));
+    }
+#  endif
+};
+
+template <typename Wt>
+void gemm(const float* X, size_t M, size_t K, const Wt* W, const float* scale,
+          const float* b, float* Y, size_t N)
+{
+    gemm_vec<Vec>(X, M, K, W, scale, b, Y, N);
+}
+
+#else  // AVX2 when the CPU has it; else row‑wise AXPY the compiler can auto‑vectorise
+
+template <typename Wt>
+void gemm(const float* X, size_t M, size_t K, const Wt* W, const float* scale,
+          const float* b, float* Y, size_t N)
+{
+#if defined(RRL_HAVE_AVX2_KERNELS)
+    if (cpu_has_avx2()) return gemm_avx2(X, M, K, W, scale, b, Y, N);
+#endif
+    for (size_t i = 0; i < M; ++i) {
+        float* y = Y + i * N;
+        std::fill(y, y + N, 0.f);
+        for (size_t k = 0; k < K; ++k) {
+            const float x = X[i * K + k];
+            const Wt*   w = W + k * N;
+            for (size_t j = 0; j < N; ++j) y[j] += x * weight_at(w + j);
+        }
+        for (size_t j = 0; j < N; ++j) y[j] = finish(y[j], scale, b, j);
+    }
+}
+
+#endif
+
+// Runs one layer's GEMM with the weight type the file declares.
+void gemm_layer(const Net& net, const RRL_PolicyLayer& l, const float* X, size_t M, float* Y)
+{
+    const size_t K = static_cast<size_t>(k_of(l)), N = l.out_dims[2];   // K·N fit the blob
+    const void*  W = net.base + l.weight_offset;
+    const float* b = f32_at(net, l.bias_offset);
+    switch (l.weight_dtype) {
+    case RRL_DTYPE_FLOAT16:
+        gemm(X, M, K, static_cast<const half_t*>(W), nullptr, b, Y, N);
+        break;
+    case RRL_DTYPE_INT8:
+        gemm(X, M, K, static_cast<const int8_t*>(W), f32_at(net, l.scale_offset), b, Y, N);
+        break;
+    default:
+        gemm(X, M, K, static_cast<const float*>(W), nullptr, b, Y, N);
+        break;
+    }
+}
+
+void activate(float* y, size_t n, uint32_t act)
+{
+    if (act == RRL_ACT_RELU) {
+        for (size_t i = 0; i < n; ++i) y[i] = y[i] > 0.f ? y[i] : 0.f;
+    } else if (act == RRL_ACT_TANH) {
+        for (size_t i = 0; i < n; ++i) y[i] = std::tanh(y[i]);
+    }
+}
+
+// HWC im2col for `count` samples: one row per output pixel, columns
+// ordered (ky, kx, c) so each kernel row is a single contiguous copy.
+void im2col(const float* in, size_t count, const RRL_PolicyLayer& l, float* cols)
+{
+    const size_t H = l.in_dims[0], Wd = l.in_dims[1], C = l.in_dims[2];
+    const size_t k = l.kernel, s = l.stride;
+    const size_t oh = l.out_dims[0], ow = l.out_dims[1];
+    const size_t run = k * C;
+    for (size_t n = 0; n < count; ++n) {
+        const float* img = in + n * H * Wd * C;
+        for (size_t oy = 0; oy < oh; ++oy)
+            for (size_t ox = 0; ox < ow; ++ox)
+                for (size_t ky = 0; ky < k; ++ky) {
+                    std::memcpy(cols, img + ((oy * s + ky) * Wd + ox * s) * C, run * sizeof(float));
+                    cols += run;
+                }
+    }
+}
+
+struct Scratch {
+    std::vector<float> a, b, cols;
+};
+thread_local Scratch t_scratch;   // grows once, reused every frame
+
+void load_input(const Net& net, const void* obs, size_t count, float* dst)
+{
+    const size_t total = count * net.in_elems;
+    const float scale = net.hdr->input_scale, offset = net.hdr->input_offset;
+    if (net.hdr->input_dtype == RRL_DTYPE_UINT8) {
+        const uint8_t* src = static_cast<const uint8_t*>(obs);
+        for (size_t i = 0; i < total; ++i) dst[i] = src[i] * scale + offset;
+    } else {
+        const float* src = static_cast<const float*>(obs);
+        if (scale == 1.f && offset == 0.f) std::memcpy(dst, src, total * sizeof(float));
+        else for (size_t i = 0; i < total; ++i) dst[i] = src[i] * scale + offset;
+    }
+}
+
+void store_actions(const Net& net, const float* y, size_t count, void* actions)
+{
+    const size_t N = net.out_elems;
+    if (net.hdr->output_kind == RRL_POLICY_OUT_CONTINUOUS) {
+        std::memcpy(actions, y, count * N * sizeof(float));
+        return;
+    }
+    int32_t* out = static_cast<int32_t*>(actions);
+    for (size_t i = 0; i < count; ++i) {
+        const float* row = y + i * N;
+        out[i] = static_cast<int32_t>(std::max_element(row, row + N) - row);
+    }
+}
+
+// Scratch may throw std::bad_alloc / std::length_error (a model whose
+// single-env activations do not fit); callers catch at the C boundary.
+void forward(const Net& net, size_t n, const void* obs, void* actions)
+{
+    Scratch& sc = t_scratch;
+    const size_t per_env = std::max(net.max_act, net.max_cols);
+    const size_t chunk   = std::max<size_t>(1, std::min(n, kScratchFloats / per_env));
+    sc.a.resize(chunk * net.max_act);
+    sc.b.resize(chunk * net.max_act);
+    sc.cols.resize(chunk * net.max_cols);
+
+    const uint8_t* in  = static_cast<const uint8_t*>(obs);
+    uint8_t*       out = static_cast<uint8_t*>(actions);
+    for (size_t done = 0; done < n; done += chunk) {
+        const size_t m = std::min(chunk, n - done);
+        float* x = sc.a.data();
+        float* y = sc.b.data();
+        load_input(net, in + done * net.in_bytes, m, x);
+        for (uint32_t i = 0; i < net.hdr->num_layers; ++i) {
+            const RRL_PolicyLayer& l = net.layers[i];
+            if (l.kind == RRL_LAYER_CONV2D) {
+                im2col(x, m, l, sc.cols.data());
+                gemm_layer(net, l, sc.cols.data(), m * l.out_dims[0] * l.out_dims[1], y);
+            } else {
+                gemm_layer(net, l, x, m, y);
+            }
+            activate(y, m * static_cast<size_t>(elems(l.out_dims)), l.activation);
+            std::swap(x, y);
+        }
+        store_actions(net, x, m, out + done * net.act_bytes);
+    }
+}
+
+int policy_net(RRLPolicy policy, Net& net, const char* who)
+{
+    size_t len = 0;
+    const void* data = rrl_policy_data(policy, &len, nullptr);
+    if (!parse(data, len, net)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, who);
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    return RRL_SUCCESS;
+}
+
+// rrl_act_batch() on the built‑in engine.  The common case is one
+// shared policy, which runs straight on the caller's arrays; mixed
+// batches gather per policy.  Scratch may throw, as in forward().
+int act_local(const RRLHandle* handles, size_t n, const void* obs, void* actions)
+{
+    thread_local std::vector<RRLPolicy> pols;
+    pols.resize(n);
+    bool mixed = false;
+    for (size_t i = 0; i < n; ++i) {
+        pols[i] = bound_policy(handles[i]);
+        if (!pols[i]) {
+            set_error(RRL_ERR_INVALID_HANDLE, "rrl_act_batch: handle has no bound policy");
+            return RRL_ERR_INVALID_HANDLE;
+        }
+        mixed |= pols[i] != pols[0];
+    }
+    Net net;
+    int rc = policy_net(pols[0], net, "rrl_act_batch: not an rrl_policy_format model");
+    if (rc != RRL_SUCCESS) return rc;
+    if (!mixed) {
+        forward(net, n, obs, actions);
+        return RRL_SUCCESS;
+    }
+
+    const size_t ob = net.in_bytes, ab = net.act_bytes;
+    thread_local std::vector<uint8_t> obs_g, act_g;
+    thread_local std::vector<size_t>  rows;
+    const uint8_t* src = static_cast<const uint8_t*>(obs);
+    uint8_t*       dst = static_cast<uint8_t*>(actions);
+    for (size_t first = 0; first < n; ++first) {
+        RRLPolicy p = pols[first];
+        if (!p) continue;                           // already served
+        Net pn;
+        if ((rc = policy_net(p, pn, "rrl_act_batch: not an rrl_policy_format model")) != RRL_SUCCESS)
+            return rc;
+        if (pn.in_bytes != ob || pn.act_bytes != ab) {
+            set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_act_batch: bound policies differ in obs/action size");
+            return RRL_ERR_INVALID_ARGUMENT;
+        }
+        rows.clear();
+        for (size_t i = first; i < n; ++i)
+            if (pols[i] == p) { rows.push_back(i); pols[i] = nullptr; }
+        obs_g.resize(rows.size() * ob);
+        act_g.resize(rows.size() * ab);
+        for (size_t r = 0; r < rows.size(); ++r)
+            std::memcpy(obs_g.data() + r * ob, src + rows[r] * ob, ob);
+        forward(pn, rows.size(), obs_g.data(), act_g.data());
+        for (size_t r = 0; r < rows.size(); ++r)
+            std::memcpy(dst + rows[r] * ab, act_g.data() + r * ab, ab);
+    }
+    return RRL_SUCCESS;
+}
+
+} // namespace (anonymous)
+
+namespace rrl { namespace detail {
+
+bool policy_blob_valid(const void* data, size_t len)
+{
+    Net net;
+    return parse(data, len, net);
+}
+
+}} // namespace rrl::detail
+
+extern "C" {
+
+int rrl_policy_io(RRLPolicy policy, size_t* obs_bytes, size_t* action_bytes)
+{
+    if (!policy) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_policy_io: null policy");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    EpochGuard pin;
+    Net net;
+    int rc = policy_net(policy, net, "rrl_policy_io: not an rrl_policy_format model");
+    if (rc != RRL_SUCCESS) return rc;
+    if (obs_bytes)    *obs_bytes    = net.in_bytes;
+    if (action_bytes) *action_bytes = net.act_bytes;
+    return RRL_SUCCESS;
+}
+
+int rrl_policy_act(RRLPolicy policy, size_t n, const void* obs, void* actions)
+{
+    RRL_TRACE_SCOPE(RRL_SPAN_POLICY_ACT, nullptr);
+    if (!policy || (n && (!obs || !actions))) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_policy_act: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    EpochGuard pin;   // weights stay alive even if updated meanwhile
+    Net net;
+    int rc = policy_net(policy, net, "rrl_policy_act: not an rrl_policy_format model");
+    if (rc != RRL_SUCCESS) return rc;
+    if (!n) return RRL_SUCCESS;
+    try {
+        forward(net, n, obs, actions);
+    } catch (const std::exception&) {   // bad_alloc / length_error: scratch
+        set_error(RRL_ERR_NO_MEMORY, "rrl_policy_act: out of memory for activations");
+        return RRL_ERR_NO_MEMORY;
+    }
+    return RRL_SUCCESS;
+}
+
+int RRL_WEAK rrl_act_batch(const RRLHandle* handles, size_t n,
+                           const void* obs, void* actions)
+{
+    RRL_TRACE_SCOPE(RRL_SPAN_POLICY_ACT, n == 1 && handles ? handles[0] : nullptr);
+    if (n && (!handles || !obs || !actions)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_act_batch: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (n == 0) return RRL_SUCCESS;
+    BackendGuard be;
+    if (auto act = be->ext.act_batch) {
+        int rc = act(handles, n, obs, actions);
+        if (rc != RRL_SUCCESS) set_error(rc, "rrl_act_batch: backend error");
+        return rc;
+    }
+
+    try {
+        return act_local(handles, n, obs, actions);
+    } catch (const std::exception&) {   // bad_alloc / length_error: scratch
+        set_error(RRL_ERR_NO_MEMORY, "rrl_act_batch: out of memory for activations");
+        return RRL_ERR_NO_MEMORY;
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,58 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_infer_avx2.cpp  —  AVX2+FMA GEMM kernels for rrl_infer
+//
+//  • The only inference TU built with -mavx2 -mfma -mf16c
+//    (/arch:AVX2); rrl_infer.cpp calls into it only when
+//    cpu_has_avx2(), so the library still runs on baseline x86.
+//  • Not built at all with RRL_ENABLE_AVX2=OFF or off x86.
+//─────────────────────────────────────────────────────────────
+#include "rrl_gemm.hpp"
+
+#include <immintrin.h>
+
+namespace rrl { namespace detail {
+
+namespace {
+
+struct VecAvx2 {
+    using T = __m256;
+    static constexpr size_t W = 8;
+    static T    zero ()                       { return _mm256_setzero_ps(); }
+    static T    load (const float* p)         { return _mm256_loadu_ps(p); }
+    static T    bcast(const float* p)         { return _mm256_broadcast_ss(p); }
+    static T    fma  (T a, T b, T acc)        { return _mm256_fmadd_ps(a, b, acc); }
+    static T    add  (T a, T b)               { return _mm256_add_ps(a, b); }
+    static void store(float* p, T v)          { _mm256_storeu_ps(p, v); }
+
+    static T load(const int8_t* p)
+    {
+        const __m128i q = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(q));
+    }
+    static T load(const half_t* p)
+    {
+        return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+};
+
+} // namespace (anonymous)
+
+void gemm_avx2(const float* X, size_t M, size_t K, const float* W, const float* scale,
+               const float* b, float* Y, size_t N)
+{
+    gemm_vec<VecAvx2>(X, M, K, W, scale, b, Y, N);
+}
+
+void gemm_avx2(const float* X, size_t M, size_t K, const half_t* W, const float* scale,
+               const float* b, float* Y, size_t N)
+{
+    gemm_vec<VecAvx2>(X, M, K, W, scale, b, Y, N);
+}
+
+void gemm_avx2(const float* X, size_t M, size_t K, const int8_t* W, const float* scale,
+               const float* b, float* Y, size_t N)
+{
+    gemm_vec<VecAvx2>(X, M, K, W, scale, b, Y, N);
+}
+
+}} // namespace rrl::detail
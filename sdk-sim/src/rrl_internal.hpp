@@ -0,0 +1,330 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_internal.hpp  —  Private glue shared by the open‑part
+//  translation units (not installed, not part of the ABI).
+//─────────────────────────────────────────────────────────────
+#ifndef RRL_INTERNAL_HPP
+#define RRL_INTERNAL_HPP
+
+#include "rrl_env.h"
+
+#if defined(_MSC_VER)
+#  include <intrin.h> // _InterlockedExchangeAdd64, __rdtsc
+#elif defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h> // __rdtsc
+#endif
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//─────────────────────────────────────────────────────────────
+//  Portable weak‑symbol attribute
+//─────────────────────────────────────────────────────────────
+#if defined(__GNUC__) || defined(__clang__)
+#  define RRL_WEAK __attribute__((weak))
+#elif defined(_MSC_VER)
+#  define RRL_WEAK __declspec(selectany)
+#else
+#  define RRL_WEAK  /* weak not available → link‑time override only */
+#endif
+
+// Weak aliases (ELF only): `RRL_OVERRIDDEN(f)` is true when the
+// application linked its own `f` over the SDK's alias of `f##_default`.
+// Without aliases it is always true, i.e. callers go through the export.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__ELF__)
+#  define RRL_HAVE_WEAK_ALIAS 1
+#  define RRL_OVERRIDDEN(f) (&f != &f##_default)
+#else
+#  define RRL_HAVE_WEAK_ALIAS 0
+#  define RRL_OVERRIDDEN(f) true
+#endif
+
+namespace rrl { namespace detail {
+
+// Record an error for the calling thread (see rrl_last_error).
+void set_error(int code, const char* msg);
+
+// Runtime‑switchable backend table.  Registration copies the caller's
+// hooks into an immutable snapshot and publishes it with one atomic
+// store; the hot path only does an acquire load.  Replaced snapshots
+// are retired epoch‑style: each thread announces the epoch it entered
+// in, and a snapshot is freed only once no thread can still hold it.
+struct BackendTable {
+    RRL_BackendHooks    base{};
+    RRL_BackendHooksExt ext{};   // normalised: struct_size == sizeof, tail zeroed
+};
+
+extern const BackendTable              g_stub_table;
+extern std::atomic<const BackendTable*> g_table;
+extern std::atomic<uint64_t>            g_epoch;
+
+// One slot per live thread that ever entered a backend call.  Slots
+// are never freed, only recycled, so readers can walk the list freely.
+struct ReaderSlot {
+    std::atomic<uint64_t> epoch{0};   // 0 = quiescent
+    std::atomic<bool>     in_use{true};
+    ReaderSlot*           next = nullptr;
+};
+extern std::atomic<ReaderSlot*> g_readers;
+
+ReaderSlot* acquire_slot();
+
+struct ThreadReader {
+    ReaderSlot* slot  = acquire_slot();
+    unsigned    depth = 0;            // hooks may re-enter the C API
+    ~ThreadReader() { slot->in_use.store(false, std::memory_order_release); }
+};
+inline ThreadReader& thread_reader()
+{
+    static thread_local ThreadReader reader;   // one per thread, all TUs
+    return reader;
+}
+
+// Marks the calling thread as a reader: anything it loads from an
+// epoch‑protected atomic stays alive until the guard goes away.
+class EpochGuard {
+public:
+    EpochGuard() {
+        ThreadReader& tr = thread_reader();
+        if (tr.depth++ == 0)
+            tr.slot->epoch.store(g_epoch.load(std::memory_order_relaxed),
+                                 std::memory_order_seq_cst);
+    }
+    ~EpochGuard() {
+        ThreadReader& tr = thread_reader();
+        if (--tr.depth == 0)
+            tr.slot->epoch.store(0, std::memory_order_release);
+    }
+    EpochGuard(const EpochGuard&)            = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+// Publishes `next` as one snapshot, copying the table it replaces to
+// `prev`; with `if_poll`, only while base.poll is still `if_poll`
+// (false and nothing published otherwise).  rrl_env_public.cpp.
+bool replace_backend(const BackendTable& next, BackendTable* prev, int (*if_poll)(RRLHandle));
+
+// Free `p` once no EpochGuard that might have seen it is still alive.
+// `p` must already be unreachable from shared state.
+void retire(void* p, void (*deleter)(void*));
+
+// Pins the current snapshot for the duration of one public call.
+class BackendGuard : EpochGuard {
+public:
+    BackendGuard() : table_(g_table.load(std::memory_order_seq_cst)) {}
+
+    const BackendTable* operator->() const noexcept { return table_; }
+
+private:
+    const BackendTable* table_;
+};
+
+// Handle → policy table used by the built‑in inference engine
+// (rrl_policy.cpp).  bind_local() retains `policy` (NULL unbinds) and
+// fails only with RRL_ERR_NO_MEMORY; bound_policy() must run under an
+// EpochGuard.
+int       bind_local  (RRLHandle handle, RRLPolicy policy);
+RRLPolicy bound_policy(RRLHandle handle);
+
+// A new reference to the policy already serving these bytes / this
+// mapping, or a fresh one (NULL if out of memory); backend‑less loads
+// into many handles share one copy this way.
+RRLPolicy shared_policy(const void* bytes, size_t len);
+RRLPolicy shared_policy(RRLMappedFile file);
+
+// rrl_load_policy_mapped() for backends without a mapped hook: the
+// bytes through rrl_load_policy(), or a shared_policy() bound locally
+// when nothing serves that (rrl_env_public.cpp).
+int       load_policy_mapped_fallback(RRLHandle handle, RRLMappedFile file);
+
+// True if rrl_load_policy() reaches a real loader: `hook` (the
+// backend has a load_policy hook) or an application's own export
+// (rrl_env_public.cpp, where RRL_OVERRIDDEN can see the default).
+bool      load_policy_served(bool hook);
+
+// True if `data` is a well‑formed rrl_policy_format.h model (rrl_infer.cpp).
+bool      policy_blob_valid(const void* data, size_t len);
+
+// Detaches the rrl_set_preprocess() pipeline of `handle` (rrl_preproc.cpp).
+void      preproc_forget(RRLHandle handle);
+
+// Stops every RRLMetrics exporter tracking `handle` (rrl_metrics.cpp).
+void      metrics_forget(RRLHandle handle);
+
+// Unbinds the RRLReplay bound to `handle`, if any (rrl_wire_resume.cpp).
+void      replay_forget (RRLHandle handle);
+
+// Exclusive upper bound (µs) of RRL_LatencyHist bucket `idx`; the
+// last bucket is open‑ended (UINT64_MAX).
+uint64_t  hist_bucket_end(int idx);
+
+// Registered RRLHotState (rrl_hot.cpp).  Each returns false if none is
+// registered or it does not cover the handle; run under an EpochGuard.
+bool      hot_poll      (RRLHandle handle, int& ready);
+bool      hot_poll_many (const RRLHandle* handles, size_t n,
+                         uint64_t* ready_mask, size_t* ready_idx, int& ready);
+bool      hot_stats     (RRLHandle handle, RRL_StatsV2& out);
+
+// Adds reconnects / downtime of the RRLReplay bound to `handle`
+// (rrl_wire_resume.cpp); false if none is bound.
+bool      replay_stats  (RRLHandle handle, RRL_StatsV2& out);
+
+// True if the CPU and OS run the *_avx2.cpp kernels (AVX2, FMA, F16C
+// and saved YMM state); checked once, then a load and a branch.
+// Always false in builds without them (RRL_ENABLE_AVX2=OFF, non‑x86).
+inline bool cpu_has_avx2()
+{
+#if defined(RRL_HAVE_AVX2_KERNELS) && defined(_MSC_VER)
+    static const bool yes = [] {
+        int r[4];
+        __cpuid(r, 0);
+        if (r[0] < 7) return false;
+        __cpuid(r, 1);
+        const int need = (1 << 12) | (1 << 27) | (1 << 29);   // FMA, OSXSAVE, F16C
+        if ((r[2] & need) != need || (_xgetbv(0) & 6) != 6) return false;
+        __cpuidex(r, 7, 0);
+        return (r[1] & (1 << 5)) != 0;                       // AVX2
+    }();
+    return yes;
+#elif defined(RRL_HAVE_AVX2_KERNELS)
+    static const bool yes = [] {
+        __builtin_cpu_init();   // may run before libgcc's constructor
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+               __builtin_cpu_supports("f16c");
+    }();
+    return yes;
+#else
+    return false;
+#endif
+}
+
+// Span timestamps (rrl_trace.cpp).  Raw TSC / virtual counter ticks
+// where available, calibrated against steady_clock only when spans
+// are exported; steady_clock nanoseconds elsewhere.
+inline uint64_t trace_ticks()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t t;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Non-zero while the tracer or trace hooks are active.
+extern std::atomic<unsigned> g_trace_mode;
+
+void trace_record(int kind, RRLHandle handle, uint64_t begin, uint64_t end);
+
+// One span around the rest of the enclosing scope; a relaxed load and
+// a branch while nothing is tracing.
+class TraceScope {
+public:
+    TraceScope(int kind, RRLHandle handle) noexcept
+        : begin_(g_trace_mode.load(std::memory_order_relaxed) ? trace_ticks() : 0),
+          kind_(kind), handle_(handle) {}
+    ~TraceScope() { if (begin_) trace_record(kind_, handle_, begin_, trace_ticks()); }
+    TraceScope(const TraceScope&)            = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    uint64_t  begin_;
+    int       kind_;
+    RRLHandle handle_;
+};
+
+#if defined(RRL_NO_TRACING)
+#  define RRL_TRACE_SCOPE(kind, handle) ((void)0)
+#else
+#  define RRL_TRACE_SCOPE(kind, handle) ::rrl::detail::TraceScope rrl_trace_scope_((kind), (handle))
+#endif
+
+// Lock‑free counters on plain C structs (RRL_LatencyHist lives in C).
+inline void atomic_add(uint64_t* p, uint64_t v)
+{
+#if defined(_MSC_VER)
+    _InterlockedExchangeAdd64(reinterpret_cast<volatile long long*>(p), static_cast<long long>(v));
+#else
+    __atomic_fetch_add(p, v, __ATOMIC_RELAXED);
+#endif
+}
+
+inline uint64_t atomic_read(const uint64_t* p)
+{
+#if defined(_MSC_VER)
+    return static_cast<uint64_t>(*reinterpret_cast<const volatile long long*>(p));
+#else
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+#endif
+}
+
+inline void atomic_or(uint64_t* p, uint64_t v)
+{
+#if defined(_MSC_VER)
+    _InterlockedOr64(reinterpret_cast<volatile long long*>(p), static_cast<long long>(v));
+#else
+    __atomic_fetch_or(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+inline void atomic_and(uint64_t* p, uint64_t v)
+{
+#if defined(_MSC_VER)
+    _InterlockedAnd64(reinterpret_cast<volatile long long*>(p), static_cast<long long>(v));
+#else
+    __atomic_fetch_and(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+// Single‑writer update: a plain store other threads may read racily.
+inline void atomic_write(uint64_t* p, uint64_t v)
+{
+#if defined(_MSC_VER)
+    *reinterpret_cast<volatile long long*>(p) = static_cast<long long>(v);
+#else
+    __atomic_store_n(p, v, __ATOMIC_RELAXED);
+#endif
+}
+
+inline void atomic_max(uint64_t* p, uint64_t v)
+{
+    uint64_t cur = atomic_read(p);
+    while (cur < v) {
+#if defined(_MSC_VER)
+        long long seen = _InterlockedCompareExchange64(reinterpret_cast<volatile long long*>(p),
+                                                       static_cast<long long>(v),
+                                                       static_cast<long long>(cur));
+        if (static_cast<uint64_t>(seen) == cur) break;
+        cur = static_cast<uint64_t>(seen);
+#else
+        if (__atomic_compare_exchange_n(p, &cur, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+#endif
+    }
+}
+
+// Index of the lowest set bit; `v` must be non‑zero.
+inline int ctz64(uint64_t v)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return static_cast<int>(i);
+#elif defined(_MSC_VER)
+    unsigned long i;
+    if (_BitScanForward(&i, static_cast<unsigned long>(v))) return static_cast<int>(i);
+    _BitScanForward(&i, static_cast<unsigned long>(v >> 32));
+    return static_cast<int>(i) + 32;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+}} // namespace rrl::detail
+
+#endif /* RRL_INTERNAL_HPP */
@@ -0,0 +1,573 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_loopback.cpp  —  Ghost trainer backend
+//
+//  • Handles are the loopback's own Env objects.  A submitted step
+//    goes into one min‑heap keyed by its due time; trainer threads
+//    sleep until the earliest is due, fill its action and flip the
+//    handle to ready.  Latency therefore costs no thread, service
+//    time does — which is what `concurrency` bounds.
+//  • The handle's state word is the only thing the hot path reads:
+//    rrl_poll is one acquire load.  Everything a trainer thread
+//    writes for a step is published by the release store of READY.
+//  • Each handle draws jitter and random actions from its own
+//    generator, so its action sequence does not depend on which
+//    thread served it.
+//  • Installing swaps in one backend snapshot and keeps the one it
+//    replaced; uninstalling (or destroying) puts that back unless
+//    someone registered another backend since.  Hooks look a handle
+//    up in the installed loopback's sorted index of the envs it
+//    opened (replaced whole on open, retired like the backend table)
+//    and never dereference one it does not contain.
+//─────────────────────────────────────────────────────────────
+#include "rrl_loopback.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace rrl::detail;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr unsigned kMaxThreads = 256;
+
+enum State { kIdle = 0, kPending = 1, kReady = 2 };
+
+struct LoopbackEnv;
+
+struct Due {
+    Clock::time_point at;
+    uint64_t          order;   // FIFO among equal due times
+    LoopbackEnv*      env;
+    bool operator>(const Due& o) const { return at != o.at ? at > o.at : order > o.order; }
+};
+
+// splitmix64: tiny, seedable, good enough for synthetic actions
+inline uint64_t next_rand(uint64_t& s)
+{
+    uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline float uniform_pm1(uint64_t& s)
+{
+    return static_cast<float>(next_rand(s) >> 40) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+// Normal-range float → IEEE half, truncating; enough for [-1, 1].
+inline uint16_t to_half(float f)
+{
+    uint32_t b;
+    std::memcpy(&b, &f, 4);
+    const uint16_t sign = static_cast<uint16_t>((b >> 16) & 0x8000u);
+    const int exp = static_cast<int>((b >> 23) & 0xFF) - 127 + 15;
+    if (exp <= 0) return sign;
+    return static_cast<uint16_t>(sign | (exp << 10) | ((b >> 13) & 0x3FFu));
+}
+
+} // namespace (anonymous)
+
+struct RRLLoopbackImpl;
+
+namespace {
+
+struct LoopbackEnv {
+    RRLLoopbackImpl*   lb = nullptr;
+    RRL_SpaceDesc      action_space{};
+    size_t             action_bytes = 0;
+    size_t             obs_bytes    = 0;
+    size_t             stream_len   = 0;   // recorded actions for this space; 0 = random
+
+    std::atomic<int>   state{kIdle};
+    std::atomic<bool>  rewind{false};
+    void*              act = nullptr;      // bound act buffer
+    std::vector<unsigned char> own;        // action when unbound
+
+    // Written by the submitter, read by the trainer thread that pops it
+    unsigned char*     target = nullptr;
+    Clock::time_point  submitted{};
+    Clock::time_point  last_due{};
+    uint64_t           rng = 0;
+    size_t             cursor = 0;
+
+    // Stats, written by trainer threads (one step in flight per env)
+    uint64_t           steps = 0;
+    uint64_t           latency_sum = 0;
+    RRL_LatencyHist    hist{};
+
+    std::mutex         fps_mtx;
+    uint64_t           win_steps = 0;
+    Clock::time_point  win_start = Clock::now();
+    double             fps = 0.0;
+};
+
+// Addresses of a loopback's envs, ascending.
+using EnvIndex = std::vector<uintptr_t>;
+
+void delete_index(void* p) { delete static_cast<EnvIndex*>(p); }
+
+} // namespace (anonymous)
+
+struct RRLLoopbackImpl {
+    RRL_LoopbackConfig cfg{};
+    RRL_SpaceDesc      action_space{}, observation_space{};
+    std::vector<unsigned char> recorded;
+    RRLMappedFile      mapped   = nullptr;
+    const unsigned char* stream = nullptr;
+    size_t             stream_bytes = 0;
+    std::chrono::nanoseconds period{0};
+
+    std::mutex         mtx;
+    std::condition_variable work_cv;   // trainer threads: new or earlier step
+    std::condition_variable done_cv;   // wait_any / vec_step: a step finished
+    std::vector<Due>   heap;       // min-heap on (at, order)
+    uint64_t           order   = 0;
+    unsigned           waiters = 0;
+    bool               stop    = false;
+    std::vector<std::unique_ptr<LoopbackEnv>> envs;
+    std::atomic<EnvIndex*> index{nullptr};   // envs, for lookups under an EpochGuard
+    std::vector<std::thread> threads;
+    BackendTable       prev{};     // what install replaced, restored on uninstall
+
+    ~RRLLoopbackImpl() {
+        delete index.load(std::memory_order_relaxed);
+        if (mapped) rrl_mapped_release(mapped);
+    }
+};
+
+namespace {
+
+std::mutex                    g_install_mtx;   // install / uninstall
+std::atomic<RRLLoopbackImpl*> g_installed{nullptr};
+
+void delete_loopback(void* p) { delete static_cast<RRLLoopbackImpl*>(p); }
+
+// `h`'s env if `lb` opened it, else nullptr; other handles are only
+// compared, never read.  Runs under an EpochGuard (hooks do).
+LoopbackEnv* find(const RRLLoopbackImpl& lb, RRLHandle h)
+{
+    const EnvIndex* idx = lb.index.load(std::memory_order_acquire);
+    if (!idx || !h) return nullptr;
+    const uintptr_t key = reinterpret_cast<uintptr_t>(h);
+    const auto it = std::lower_bound(idx->begin(), idx->end(), key);
+    return it != idx->end() && *it == key ? reinterpret_cast<LoopbackEnv*>(key) : nullptr;
+}
+
+// The installed loopback's env for `h`, or nullptr.
+LoopbackEnv* env_of(RRLHandle h)
+{
+    const RRLLoopbackImpl* lb = g_installed.load(std::memory_order_acquire);
+    return lb ? find(*lb, h) : nullptr;
+}
+
+inline bool ready(const LoopbackEnv& e) { return e.state.load(std::memory_order_acquire) == kReady; }
+
+void fill_random(LoopbackEnv& e, unsigned char* out)
+{
+    const int32_t high = e.lb->cfg.action_high > 0 ? e.lb->cfg.action_high : 2;
+    RRL_SpaceDesc one = e.action_space;
+    one.ndim = 1;
+    one.shape[0] = 1;
+    const size_t elem = rrl_space_bytes(&one);
+    const size_t count = elem ? e.action_bytes / elem : 0;
+    for (size_t i = 0; i < count; ++i) {
+        unsigned char* p = out + i * elem;
+        switch (e.action_space.dtype) {
+        case RRL_DTYPE_FLOAT32: { const float v = uniform_pm1(e.rng); std::memcpy(p, &v, 4); break; }
+        case RRL_DTYPE_FLOAT64: { const double v = uniform_pm1(e.rng); std::memcpy(p, &v, 8); break; }
+        case RRL_DTYPE_FLOAT16: { const uint16_t v = to_half(uniform_pm1(e.rng)); std::memcpy(p, &v, 2); break; }
+        case RRL_DTYPE_BOOL:    *p = static_cast<unsigned char>(next_rand(e.rng) & 1u); break;
+        default: {
+            const uint64_t v = next_rand(e.rng) % static_cast<uint64_t>(high);
+            std::memcpy(p, &v, elem);   // little-endian: low bytes first
+            break;
+        }
+        }
+    }
+}
+
+void deliver(LoopbackEnv& e)
+{
+    if (e.rewind.exchange(false, std::memory_order_relaxed)) e.cursor = 0;
+    if (e.stream_len) {
+        std::memcpy(e.target, e.lb->stream + e.cursor * e.action_bytes, e.action_bytes);
+        if (++e.cursor == e.stream_len) e.cursor = 0;
+    } else {
+        fill_random(e, e.target);
+    }
+    const uint64_t us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - e.submitted).count());
+    atomic_write(&e.steps, atomic_read(&e.steps) + 1);
+    atomic_write(&e.latency_sum, atomic_read(&e.latency_sum) + us);
+    rrl_hist_record(&e.hist, us);
+    e.state.store(kReady, std::memory_order_release);
+}
+
+void serve(RRLLoopbackImpl* lb)
+{
+    const auto service = std::chrono::microseconds(lb->cfg.service_us);
+    std::unique_lock<std::mutex> lk(lb->mtx);
+    while (!lb->stop) {
+        if (lb->heap.empty()) { lb->work_cv.wait(lk); continue; }
+        const Clock::time_point at = lb->heap.front().at;
+        if (Clock::now() < at) { lb->work_cv.wait_until(lk, at); continue; }
+        LoopbackEnv* e = lb->heap.front().env;
+        std::pop_heap(lb->heap.begin(), lb->heap.end(), std::greater<Due>());
+        lb->heap.pop_back();
+        lk.unlock();
+        if (service.count()) std::this_thread::sleep_for(service);
+        deliver(*e);
+        lk.lock();
+        if (lb->waiters) lb->done_cv.notify_all();
+    }
+}
+
+int submit(LoopbackEnv& e, unsigned char* target)
+{
+    if (e.state.load(std::memory_order_acquire) == kPending) return RRL_ERR_INVALID_ARGUMENT;
+    RRLLoopbackImpl& lb = *e.lb;
+    const Clock::time_point now = Clock::now();
+    Clock::time_point due = now + std::chrono::microseconds(lb.cfg.latency_us);
+    if (lb.cfg.jitter_us)
+        due += std::chrono::microseconds(next_rand(e.rng) % (uint64_t(lb.cfg.jitter_us) + 1));
+    if (lb.period.count()) due = std::max(due, e.last_due + lb.period);
+    e.last_due  = due;
+    e.submitted = now;
+    e.target    = target;
+    e.state.store(kPending, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lk(lb.mtx);
+    lb.heap.push_back(Due{due, lb.order++, &e});   // reserved for every env at open
+    std::push_heap(lb.heap.begin(), lb.heap.end(), std::greater<Due>());
+    lb.work_cv.notify_one();
+    return RRL_SUCCESS;
+}
+
+// Sleep on done_cv until `done()` holds, the loopback stops or the deadline passes.
+template <class Done>
+bool wait_done(RRLLoopbackImpl& lb, int64_t timeout_us, Done done)
+{
+    const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(std::max<int64_t>(timeout_us, 0));
+    std::unique_lock<std::mutex> lk(lb.mtx);
+    for (;;) {
+        if (done()) return true;
+        if (lb.stop || timeout_us == 0) return false;
+        ++lb.waiters;
+        if (timeout_us < 0) lb.done_cv.wait(lk);
+        else                lb.done_cv.wait_until(lk, deadline);
+        --lb.waiters;
+        if (timeout_us > 0 && Clock::now() >= deadline) return done();
+    }
+}
+
+//──────────────────── Hooks ─────────────────────────────────
+int lb_poll(RRLHandle h)
+{
+    const LoopbackEnv* e = env_of(h);
+    if (!e) return RRL_ERR_INVALID_HANDLE;
+    return ready(*e) ? 1 : 0;
+}
+
+void snapshot(LoopbackEnv& e, RRL_StatsV2& out)
+{
+    const uint64_t steps = atomic_read(&e.steps);
+    {
+        std::lock_guard<std::mutex> lk(e.fps_mtx);
+        const Clock::time_point now = Clock::now();
+        const double dt = std::chrono::duration<double>(now - e.win_start).count();
+        if (dt >= 1.0) {
+            e.fps       = static_cast<double>(steps - e.win_steps) / dt;
+            e.win_steps = steps;
+            e.win_start = now;
+        }
+        out.base.fps = e.fps;
+    }
+    out.base.latency_ms = steps ? static_cast<double>(atomic_read(&e.latency_sum)) /
+                                  static_cast<double>(steps) / 1000.0 : 0.0;
+    out.base.steps = static_cast<unsigned long>(steps);
+    out.bytes_in   = steps * e.action_bytes;
+    out.bytes_out  = steps * e.obs_bytes;
+    out.queue_depth = e.state.load(std::memory_order_relaxed) == kPending ? 1u : 0u;
+    for (int i = 0; i < RRL_HIST_BUCKETS; ++i) out.latency.counts[i] = atomic_read(&e.hist.counts[i]);
+    out.latency.total  = atomic_read(&e.hist.total);
+    out.latency.max_us = atomic_read(&e.hist.max_us);
+    out.pipeline_depth = out.pipeline_depth_max = 1;
+}
+
+int lb_get_stats(RRLHandle h, RRL_Stats* out)
+{
+    LoopbackEnv* e = env_of(h);
+    if (!e) return RRL_ERR_INVALID_HANDLE;
+    RRL_StatsV2 full{};
+    snapshot(*e, full);
+    *out = full.base;
+    return RRL_SUCCESS;
+}
+
+int lb_get_stats_v2(RRLHandle h, RRL_StatsV2* out)
+{
+    LoopbackEnv* e = env_of(h);
+    if (!e) return RRL_ERR_INVALID_HANDLE;
+    snapshot(*e, *out);
+    return RRL_SUCCESS;
+}
+
+int lb_bind_buffers(RRLHandle h, void* /*obs*/, size_t /*obs_bytes*/, void* act, size_t /*act_bytes*/)
+{
+    // Sizes were checked by rrl_bind_buffers; takes effect from the next submit.
+    LoopbackEnv* e = env_of(h);
+    if (!e) return RRL_ERR_INVALID_HANDLE;
+    e->act = act;
+    return RRL_SUCCESS;
+}
+
+int lb_wait_any(const RRLHandle* handles, size_t n, int64_t timeout_us)
+{
+    if (!n) return RRL_ERR_TIMEOUT;
+    // Null entries are skipped here as below (rrl_wait_any refuses them first).
+    RRLLoopbackImpl* lb = g_installed.load(std::memory_order_acquire);
+    if (!lb) return RRL_ERR_INVALID_HANDLE;
+    for (size_t i = 0; i < n; ++i)
+        if (handles[i] && !find(*lb, handles[i])) return RRL_ERR_INVALID_HANDLE;
+    int found = -1;
+    const bool ok = wait_done(*lb, timeout_us, [&] {
+        for (size_t i = 0; i < n; ++i)
+            if (handles[i] && ready(*find(*lb, handles[i]))) { found = static_cast<int>(i); return true; }
+        return false;
+    });
+    return ok ? found : RRL_ERR_TIMEOUT;
+}
+
+int lb_vec_step(const RRLHandle* envs, size_t k, const RRL_VecBuffers* bufs, int64_t timeout_us)
+{
+    if (!k) return RRL_SUCCESS;
+    RRLLoopbackImpl* lb = g_installed.load(std::memory_order_acquire);
+    if (!lb) return RRL_ERR_INVALID_HANDLE;
+    for (size_t i = 0; i < k; ++i)
+        if (!find(*lb, envs[i])) return RRL_ERR_INVALID_HANDLE;
+    for (size_t i = 0; i < k; ++i) {
+        LoopbackEnv& e = *find(*lb, envs[i]);
+        if (e.action_bytes > bufs->action_bytes) return RRL_ERR_INVALID_ARGUMENT;
+        // A sub-env still in flight from a timed-out call keeps its step.
+        if (e.state.load(std::memory_order_acquire) != kPending)
+            submit(e, static_cast<unsigned char*>(bufs->actions) + i * bufs->action_stride);
+    }
+    const bool ok = wait_done(*lb, timeout_us, [&] {
+        for (size_t i = 0; i < k; ++i)
+            if (!ready(*find(*lb, envs[i]))) return false;
+        return true;
+    });
+    return ok ? RRL_SUCCESS : RRL_ERR_TIMEOUT;
+}
+
+int lb_open(const RRL_OpenConfig* /*cfg*/, RRLHandle* out)
+{
+    RRLLoopbackImpl* lb = g_installed.load(std::memory_order_acquire);
+    if (!lb) return RRL_ERR_NO_BACKEND;
+    std::unique_ptr<LoopbackEnv> e(new (std::nothrow) LoopbackEnv);
+    if (!e) return RRL_ERR_NO_MEMORY;
+    const RRLHandle h = reinterpret_cast<RRLHandle>(e.get());
+    e->lb = lb;
+    if (lb->cfg.action_space) e->action_space = lb->action_space;
+    else if (const int rc = rrl_action_space(h, &e->action_space)) return rc;
+    e->action_bytes = rrl_space_bytes(&e->action_space);
+    if (!e->action_bytes) return RRL_ERR_INVALID_ARGUMENT;
+    RRL_SpaceDesc obs{};
+    if (lb->cfg.observation_space) obs = lb->observation_space;
+    else if (rrl_observation_space(h, &obs) != RRL_SUCCESS) obs = RRL_SpaceDesc{};
+    e->obs_bytes = rrl_space_bytes(&obs);
+    if (lb->stream) {
+        if (lb->stream_bytes % e->action_bytes) return RRL_ERR_INVALID_ARGUMENT;
+        e->stream_len = lb->stream_bytes / e->action_bytes;
+    }
+    EnvIndex* old = nullptr;
+    try {
+        e->own.resize(e->action_bytes);
+        std::lock_guard<std::mutex> lk(lb->mtx);
+        old = lb->index.load(std::memory_order_relaxed);
+        std::unique_ptr<EnvIndex> next(old ? new EnvIndex(*old) : new EnvIndex);
+        const uintptr_t key = reinterpret_cast<uintptr_t>(h);
+        next->insert(std::upper_bound(next->begin(), next->end(), key), key);
+        e->rng = lb->cfg.seed ^ (0xD1B54A32D192ED03ull * (lb->envs.size() + 1));
+        lb->heap.reserve(lb->envs.size() + 1);   // one step per env: submit never allocates
+        lb->envs.push_back(std::move(e));
+        lb->index.store(next.release(), std::memory_order_seq_cst);
+    } catch (const std::bad_alloc&) {
+        return RRL_ERR_NO_MEMORY;
+    }
+    if (old) retire(old, delete_index);
+    *out = h;
+    return RRL_SUCCESS;
+}
+
+int lb_reset(RRLHandle h)
+{
+    LoopbackEnv* e = env_of(h);
+    if (!e) return RRL_ERR_INVALID_HANDLE;
+    e->rewind.store(true, std::memory_order_relaxed);
+    return RRL_SUCCESS;
+}
+
+// Caller holds g_install_mtx.
+void uninstall()
+{
+    RRLLoopbackImpl* cur = g_installed.load(std::memory_order_relaxed);
+    if (!cur) return;
+    replace_backend(cur->prev, nullptr, lb_poll);   // unless replaced since
+    g_installed.store(nullptr, std::memory_order_release);
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLLoopback rrl_loopback_create(const RRL_LoopbackConfig* cfg)
+{
+    if (!cfg || cfg->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_loopback_create: null config or bad struct_size");
+        return nullptr;
+    }
+    std::unique_ptr<RRLLoopbackImpl> lb(new (std::nothrow) RRLLoopbackImpl);
+    if (!lb) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_loopback_create: out of memory");
+        return nullptr;
+    }
+    std::memcpy(&lb->cfg, cfg, std::min(cfg->struct_size, sizeof(lb->cfg)));
+    lb->cfg.struct_size = sizeof(lb->cfg);
+    RRL_LoopbackConfig& c = lb->cfg;
+    if (c.concurrency > kMaxThreads || c.rate_hz < 0.0 || c.action_high < 0 ||
+        (c.actions && c.actions_path) || (c.actions && !c.actions_bytes)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_loopback_create: bad config");
+        return nullptr;
+    }
+    if (c.action_space && !rrl_space_bytes(c.action_space)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_loopback_create: bad action_space");
+        return nullptr;
+    }
+    // Borrowed pointers are not kept past this call.
+    if (c.action_space)      { lb->action_space      = *c.action_space;      c.action_space      = &lb->action_space; }
+    if (c.observation_space) { lb->observation_space = *c.observation_space; c.observation_space = &lb->observation_space; }
+    if (c.rate_hz > 0.0)
+        lb->period = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / c.rate_hz));
+    try {
+        if (c.actions) {
+            const auto* p = static_cast<const unsigned char*>(c.actions);
+            lb->recorded.assign(p, p + c.actions_bytes);
+            lb->stream       = lb->recorded.data();
+            lb->stream_bytes = lb->recorded.size();
+        } else if (c.actions_path) {
+            lb->mapped = rrl_map_file(c.actions_path);
+            if (!lb->mapped) return nullptr;   // last_error set by rrl_map_file
+            lb->stream = static_cast<const unsigned char*>(rrl_mapped_data(lb->mapped, &lb->stream_bytes));
+            if (!lb->stream_bytes) {
+                set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_loopback_create: empty action recording");
+                return nullptr;
+            }
+        }
+        c.actions      = nullptr;
+        c.actions_path = nullptr;
+        const unsigned threads = c.concurrency ? c.concurrency : 1;
+        RRLLoopbackImpl* raw = lb.get();
+        for (unsigned i = 0; i < threads; ++i) lb->threads.emplace_back([raw] { serve(raw); });
+    } catch (const std::exception&) {
+        {
+            std::lock_guard<std::mutex> lk(lb->mtx);
+            lb->stop = true;
+        }
+        lb->work_cv.notify_all();
+        for (std::thread& t : lb->threads) t.join();
+        set_error(RRL_ERR_NO_MEMORY, "rrl_loopback_create: out of memory or threads");
+        return nullptr;
+    }
+    return lb.release();
+}
+
+void rrl_loopback_destroy(RRLLoopback lb)
+{
+    if (!lb) return;
+    {
+        std::lock_guard<std::mutex> lk(g_install_mtx);
+        if (g_installed.load(std::memory_order_relaxed) == lb) uninstall();
+    }
+    {
+        std::lock_guard<std::mutex> lk(lb->mtx);
+        lb->stop = true;
+    }
+    lb->work_cv.notify_all();
+    lb->done_cv.notify_all();
+    for (std::thread& t : lb->threads) t.join();
+    for (auto& e : lb->envs) rrl_handle_closed(reinterpret_cast<RRLHandle>(e.get()));
+    // Hooks entered before the uninstall may still be using it.
+    retire(lb, delete_loopback);
+}
+
+int rrl_loopback_install(RRLLoopback lb)
+{
+    std::lock_guard<std::mutex> lk(g_install_mtx);
+    if (!lb) {
+        uninstall();
+        return RRL_SUCCESS;
+    }
+    RRLLoopbackImpl* cur = g_installed.load(std::memory_order_relaxed);
+    if (cur == lb) return RRL_SUCCESS;
+    BackendTable next{};
+    next.base = RRL_BackendHooks{lb_poll, lb_get_stats, nullptr};
+    next.ext.struct_size  = sizeof(next.ext);
+    next.ext.bind_buffers = lb_bind_buffers;
+    next.ext.get_stats_v2 = lb_get_stats_v2;
+    next.ext.wait_any     = lb_wait_any;
+    next.ext.vec_step     = lb_vec_step;
+    next.ext.open         = lb_open;
+    next.ext.reset        = lb_reset;
+    g_installed.store(lb, std::memory_order_release);   // before lb_open can run
+    BackendTable prev{};
+    try {
+        replace_backend(next, &prev, nullptr);
+    } catch (const std::bad_alloc&) {
+        g_installed.store(cur, std::memory_order_release);
+        set_error(RRL_ERR_NO_MEMORY, "rrl_loopback_install: out of memory");
+        return RRL_ERR_NO_MEMORY;
+    }
+    // Over another loopback: restore what that one replaced.
+    lb->prev = cur && prev.base.poll == lb_poll ? cur->prev : prev;
+    return RRL_SUCCESS;
+}
+
+int rrl_loopback_submit(RRLHandle handle)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_loopback_submit: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    EpochGuard pin;
+    LoopbackEnv* le = env_of(handle);
+    if (!le) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_loopback_submit: not opened by the installed loopback");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    LoopbackEnv& e = *le;
+    void* act = e.act;
+    const int rc = submit(e, act ? static_cast<unsigned char*>(act) : e.own.data());
+    if (rc != RRL_SUCCESS) set_error(rc, "rrl_loopback_submit: a step is already in flight");
+    return rc;
+}
+
+const void* rrl_loopback_action(RRLHandle handle, size_t* out_len)
+{
+    EpochGuard pin;
+    LoopbackEnv* e = env_of(handle);
+    if (out_len) *out_len = e && !e->act ? e->action_bytes : 0;
+    return e && !e->act ? e->own.data() : nullptr;
+}
+
+} // extern "C"
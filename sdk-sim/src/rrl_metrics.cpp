@@ -0,0 +1,707 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_metrics.cpp  —  Prometheus exporter (scrape endpoint / push)
+//
+//  • Each render reads rrl_get_stats_v2() for every tracked handle
+//    and folds it into the process‑wide group plus one group per
+//    label; latency histograms are merged bucket by bucket, so the
+//    quantiles of a group are exact to the histogram's resolution.
+//  • Histogram buckets are exported at power‑of‑two microsecond
+//    bounds, which RRL_LatencyHist buckets never straddle; `_sum` is
+//    each handle's mean latency times its sample count.
+//  • A render reads stats under the exporter's lock, and
+//    rrl_handle_closed() takes that lock to drop the handle, so a
+//    closed handle is never read once it returns.  Its last counters
+//    (steps, bytes, reconnects, downtime, latency histogram) are kept
+//    in a retired group, as are an untracked handle's, so no exported
+//    counter goes backwards.
+//  • One background thread serves GET /metrics (HTTP/1.1, one request
+//    per connection) and/or PUTs to a Pushgateway on an interval.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#  include <windows.h>
+#else
+#  include <netdb.h>
+#  include <netinet/in.h>
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <sys/time.h>
+#  include <unistd.h>
+#endif
+
+using namespace rrl::detail;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr unsigned kDefaultPushMs = 10000;
+constexpr int      kTickMs        = 100;    // shutdown latency of the worker
+constexpr int      kIoTimeoutMs   = 2000;
+constexpr size_t   kMaxRequest    = 8192;
+
+//──── Sockets ──────────────────────────────────────────────//
+#if defined(_WIN32)
+using Socket = SOCKET;
+const Socket kNoSocket = INVALID_SOCKET;
+void close_socket(Socket s) { closesocket(s); }
+int  poll_one(Socket s, int timeout_ms)
+{
+    WSAPOLLFD p{s, POLLRDNORM, 0};
+    return WSAPoll(&p, 1, timeout_ms);
+}
+void set_timeouts(Socket s)
+{
+    DWORD ms = kIoTimeoutMs;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&ms), sizeof(ms));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&ms), sizeof(ms));
+}
+bool net_init()
+{
+    static const bool ok = [] { WSADATA d; return WSAStartup(MAKEWORD(2, 2), &d) == 0; }();
+    return ok;
+}
+#else
+using Socket = int;
+const Socket kNoSocket = -1;
+void close_socket(Socket s) { ::close(s); }
+int  poll_one(Socket s, int timeout_ms)
+{
+    pollfd p{s, POLLIN, 0};
+    return ::poll(&p, 1, timeout_ms);
+}
+void set_timeouts(Socket s)
+{
+    timeval tv{kIoTimeoutMs / 1000, (kIoTimeoutMs % 1000) * 1000};
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+bool net_init() { return true; }
+#endif
+
+bool send_all(Socket s, const char* p, size_t n)
+{
+    while (n) {
+        const int chunk = static_cast<int>(std::min<size_t>(n, 1 << 20));
+#if defined(MSG_NOSIGNAL)
+        const auto sent = ::send(s, p, chunk, MSG_NOSIGNAL);
+#else
+        const auto sent = ::send(s, p, chunk, 0);
+#endif
+        if (sent <= 0) return false;
+        p += sent;
+        n -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// "host:port", "[v6]:port" or ":port"; empty host = any / localhost.
+bool split_host_port(const std::string& in, std::string& host, std::string& port)
+{
+    size_t colon;
+    if (!in.empty() && in[0] == '[') {
+        const size_t close = in.find(']');
+        if (close == std::string::npos || close + 1 >= in.size() || in[close + 1] != ':') return false;
+        host  = in.substr(1, close - 1);
+        colon = close + 1;
+    } else {
+        colon = in.rfind(':');
+        if (colon == std::string::npos) return false;
+        host = in.substr(0, colon);
+    }
+    port = in.substr(colon + 1);
+    if (host == "*") host.clear();
+    return !port.empty() && port.find_first_not_of("0123456789") == std::string::npos;
+}
+
+Socket open_listener(const std::string& host, const std::string& port, int& bound)
+{
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_PASSIVE;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &res) != 0) return kNoSocket;
+    Socket s = kNoSocket;
+    for (addrinfo* a = res; a && s == kNoSocket; a = a->ai_next) {
+        s = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (s == kNoSocket) continue;
+        const int one = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+        if (::bind(s, a->ai_addr, static_cast<int>(a->ai_addrlen)) != 0 || ::listen(s, 16) != 0) {
+            close_socket(s);
+            s = kNoSocket;
+        }
+    }
+    freeaddrinfo(res);
+    if (s == kNoSocket) return s;
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    getsockname(s, reinterpret_cast<sockaddr*>(&addr), &len);
+    bound = addr.ss_family == AF_INET6 ? ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port)
+                                       : ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+    return s;
+}
+
+Socket connect_to(const std::string& host, const std::string& port)
+{
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0) return kNoSocket;
+    Socket s = kNoSocket;
+    for (addrinfo* a = res; a && s == kNoSocket; a = a->ai_next) {
+        s = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (s == kNoSocket) continue;
+        set_timeouts(s);
+        if (::connect(s, a->ai_addr, static_cast<int>(a->ai_addrlen)) != 0) {
+            close_socket(s);
+            s = kNoSocket;
+        }
+    }
+    freeaddrinfo(res);
+    return s;
+}
+
+//──── Text helpers ─────────────────────────────────────────//
+std::vector<std::string> parse_labels(const char* csv)
+{
+    std::vector<std::string> out;
+    if (!csv) return out;
+    const std::string s(csv);
+    size_t i = 0;
+    while (i <= s.size()) {
+        size_t j = s.find(',', i);
+        if (j == std::string::npos) j = s.size();
+        size_t b = i, e = j;
+        while (b < e && (s[b] == ' ' || s[b] == '\t')) ++b;
+        while (e > b && (s[e - 1] == ' ' || s[e - 1] == '\t')) --e;
+        if (e > b) out.emplace_back(s, b, e - b);
+        i = j + 1;
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+void escape_into(std::string& out, const std::string& v)
+{
+    for (char c : v) {
+        if (c == '\\' || c == '"') { out += '\\'; out += c; }
+        else if (c == '\n')        out += "\\n";
+        else                       out += c;
+    }
+}
+
+std::string url_escape(const std::string& v)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : v) {
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '.' || c == '_' || c == '~') {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+    return out;
+}
+
+std::string default_node()
+{
+    char host[256] = "unknown";
+#if defined(_WIN32)
+    DWORD n = sizeof(host);
+    GetComputerNameA(host, &n);
+    const unsigned long pid = GetCurrentProcessId();
+#else
+    gethostname(host, sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
+    const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    return std::string(host) + "-" + std::to_string(pid);
+}
+
+//──── Aggregation ──────────────────────────────────────────//
+struct Tracked {
+    RRLHandle                handle;
+    std::vector<std::string> labels;
+};
+
+struct Group {
+    size_t          envs = 0;
+    double          fps  = 0.0;
+    uint64_t        steps = 0, bytes_in = 0, bytes_out = 0, reconnects = 0, downtime_us = 0, queue = 0;
+    RRL_LatencyHist hist{};
+    double          latency_s = 0.0;   // sum of the samples in `hist`
+
+    void add(const RRL_StatsV2& s) {
+        ++envs;
+        fps   += s.base.fps;
+        queue += s.queue_depth;
+        add_counters(s);
+    }
+    // Counters only: what a closed handle leaves behind.
+    void add_counters(const RRL_StatsV2& s) {
+        steps       += s.base.steps;
+        bytes_in    += s.bytes_in;
+        bytes_out   += s.bytes_out;
+        reconnects  += s.reconnects;
+        downtime_us += s.downtime_us;
+        for (int i = 0; i < RRL_HIST_BUCKETS; ++i) hist.counts[i] += s.latency.counts[i];
+        hist.total  += s.latency.total;
+        hist.max_us  = std::max(hist.max_us, s.latency.max_us);
+        latency_s   += s.base.latency_ms / 1000.0 * static_cast<double>(s.latency.total);
+    }
+};
+
+constexpr int kFirstLe = 7, kLastLe = 26;   // 128 µs … 67 s
+const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999, 1.0};
+
+} // namespace (anonymous)
+
+struct RRLMetricsImpl {
+    std::string              node;
+    std::vector<std::string> labels;
+
+    std::mutex                   mtx;   // also held across a render's stats reads
+    std::vector<Tracked>         tracked;
+    Group                        retired;   // counters of closed handles
+    std::map<std::string, Group> retired_by_label;
+
+    Socket      listener = kNoSocket;
+    int         port     = 0;
+    std::string push_host, push_port, push_path;
+    unsigned    push_ms  = 0;
+
+    std::atomic<bool> stop{false};
+    std::thread       worker;
+};
+
+namespace {
+
+// Live exporters, for rrl_handle_closed().  Taken before any m->mtx.
+std::mutex                   g_metrics_mtx;
+std::vector<RRLMetricsImpl*> g_metrics;
+
+// Keep `last`, what `t` has counted so far, once `t` is dropped.
+// Caller holds m.mtx.
+void retire_counters(RRLMetricsImpl& m, const Tracked& t, const RRL_StatsV2& last)
+{
+    m.retired.add_counters(last);
+    try {
+        for (const std::string& l : t.labels) m.retired_by_label[l].add_counters(last);
+    } catch (const std::bad_alloc&) {}   // label groups lose it, the process keeps it
+}
+
+struct Writer {
+    std::string& out;
+    const std::string& node;
+
+    // {node="…"[,label="…"][,extra]}
+    void series(const char* name, const std::string* label, const char* extra, const char* value) {
+        out += name;
+        out += "{node=\"";
+        escape_into(out, node);
+        out += '"';
+        if (label) { out += ",label=\""; escape_into(out, *label); out += '"'; }
+        if (extra) { out += ','; out += extra; }
+        out += "} ";
+        out += value;
+        out += '\n';
+    }
+    void family(const char* name, const char* type, const char* help) {
+        out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+        out += "# TYPE "; out += name; out += ' '; out += type; out += '\n';
+    }
+};
+
+std::string u64s(uint64_t v) { return std::to_string(v); }
+std::string dbls(double v)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", v);
+    return buf;
+}
+
+std::string render(RRLMetricsImpl& m)
+{
+    Group process;
+    std::map<std::string, Group> by_label;
+    {
+        // Held across the reads: metrics_forget() waits for them.
+        std::lock_guard<std::mutex> lk(m.mtx);
+        process  = m.retired;
+        by_label = m.retired_by_label;
+        for (const Tracked& t : m.tracked) {
+            RRL_StatsV2 s{};
+            s.struct_size = sizeof(s);
+            if (rrl_get_stats_v2(t.handle, &s) != RRL_SUCCESS) continue;   // counted once it reports
+            process.add(s);
+            for (const std::string& l : t.labels) by_label[l].add(s);
+        }
+    }
+
+    std::string out;
+    Writer w{out, m.node};
+    auto each = [&](auto&& emit) {
+        emit(static_cast<const std::string*>(nullptr), process);
+        for (const auto& kv : by_label) emit(&kv.first, kv.second);
+    };
+    auto scalar = [&](const char* name, const char* type, const char* help, auto value) {
+        w.family(name, type, help);
+        each([&](const std::string* label, const Group& g) { w.series(name, label, nullptr, value(g).c_str()); });
+    };
+
+    scalar("rrl_envs", "gauge", "Env handles reporting stats.",
+           [](const Group& g) { return u64s(g.envs); });
+    scalar("rrl_fps", "gauge", "Simulator frames per second.",
+           [](const Group& g) { return dbls(g.fps); });
+    scalar("rrl_steps_total", "counter", "Environment steps taken.",
+           [](const Group& g) { return u64s(g.steps); });
+    scalar("rrl_received_bytes_total", "counter", "Wire bytes received.",
+           [](const Group& g) { return u64s(g.bytes_in); });
+    scalar("rrl_sent_bytes_total", "counter", "Wire bytes sent.",
+           [](const Group& g) { return u64s(g.bytes_out); });
+    scalar("rrl_reconnects_total", "counter", "Transport sessions re-opened.",
+           [](const Group& g) { return u64s(g.reconnects); });
+    scalar("rrl_downtime_seconds_total", "counter", "Time spent without a transport session.",
+           [](const Group& g) { return dbls(static_cast<double>(g.downtime_us) / 1e6); });
+    scalar("rrl_queue_depth", "gauge", "Steps currently queued.",
+           [](const Group& g) { return u64s(g.queue); });
+
+    w.family("rrl_step_latency_seconds", "histogram", "Step round-trip latency.");
+    each([&](const std::string* label, const Group& g) {
+        uint64_t cum = 0;
+        int idx = 0;
+        for (int k = kFirstLe; k <= kLastLe; ++k) {
+            const uint64_t bound = uint64_t(1) << k;
+            for (; idx < RRL_HIST_BUCKETS && hist_bucket_end(idx) <= bound; ++idx) cum += g.hist.counts[idx];
+            const std::string le = "le=\"" + dbls(static_cast<double>(bound) / 1e6) + "\"";
+            w.series("rrl_step_latency_seconds_bucket", label, le.c_str(), u64s(cum).c_str());
+        }
+        w.series("rrl_step_latency_seconds_bucket", label, "le=\"+Inf\"", u64s(g.hist.total).c_str());
+        w.series("rrl_step_latency_seconds_sum", label, nullptr, dbls(g.latency_s).c_str());
+        w.series("rrl_step_latency_seconds_count", label, nullptr, u64s(g.hist.total).c_str());
+    });
+
+    w.family("rrl_step_latency_quantile_seconds", "gauge",
+             "Step round-trip latency quantiles (1 = max) over this process's envs.");
+    each([&](const std::string* label, const Group& g) {
+        for (double q : kQuantiles) {
+            const std::string qs = "quantile=\"" + dbls(q) + "\"";
+            w.series("rrl_step_latency_quantile_seconds", label, qs.c_str(),
+                     dbls(rrl_hist_percentile(&g.hist, q) / 1e6).c_str());
+        }
+    });
+    return out;
+}
+
+void serve_one(RRLMetricsImpl& m)
+{
+    Socket c = ::accept(m.listener, nullptr, nullptr);
+    if (c == kNoSocket) return;
+    set_timeouts(c);
+    std::string req;
+    char buf[1024];
+    while (req.size() < kMaxRequest && req.find("\r\n\r\n") == std::string::npos) {
+        const auto n = ::recv(c, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        req.append(buf, static_cast<size_t>(n));
+    }
+    const bool ok = req.compare(0, 13, "GET /metrics ") == 0 || req.compare(0, 14, "GET /metrics? ") == 0 ||
+                    req.compare(0, 6, "GET / ") == 0;
+    std::string body;
+    try {
+        body = ok ? render(m) : std::string("not found\n");
+    } catch (const std::bad_alloc&) {
+        close_socket(c);   // the scraper retries
+        return;
+    }
+    char head[256];
+    std::snprintf(head, sizeof(head),
+                  "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                  ok ? "200 OK" : "404 Not Found",
+                  ok ? "text/plain; version=0.0.4; charset=utf-8" : "text/plain", body.size());
+    if (send_all(c, head, std::strlen(head))) send_all(c, body.data(), body.size());
+    close_socket(c);
+}
+
+void push_once(RRLMetricsImpl& m)
+{
+    const std::string body = render(m);
+    Socket s = connect_to(m.push_host, m.push_port);
+    if (s == kNoSocket) return;   // retried next interval
+    const std::string head =
+        "PUT " + m.push_path + "/metrics/job/remoterl/instance/" + url_escape(m.node) + " HTTP/1.1\r\n"
+        "Host: " + m.push_host + ":" + m.push_port + "\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n\r\n";
+    if (send_all(s, head.data(), head.size()) && send_all(s, body.data(), body.size())) {
+        char buf[512];
+        while (::recv(s, buf, sizeof(buf), 0) > 0) {}   // drain the reply until the server closes
+    }
+    close_socket(s);
+}
+
+void run(RRLMetricsImpl* m)
+{
+    Clock::time_point next_push = Clock::now();
+    while (!m->stop.load(std::memory_order_acquire)) {
+        int wait = kTickMs;
+        if (!m->push_host.empty()) {
+            const auto now = Clock::now();
+            if (now >= next_push) {
+                try {
+                    push_once(*m);
+                } catch (const std::bad_alloc&) {}   // retried next interval
+                next_push = now + std::chrono::milliseconds(m->push_ms);
+            }
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(next_push - Clock::now()).count();
+            wait = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(wait, left)));
+        }
+        if (m->listener != kNoSocket) {
+            if (poll_one(m->listener, wait) > 0) serve_one(*m);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(wait));
+        }
+    }
+}
+
+void free_metrics(RRLMetricsImpl* m)
+{
+    {
+        std::lock_guard<std::mutex> lk(g_metrics_mtx);
+        g_metrics.erase(std::remove(g_metrics.begin(), g_metrics.end(), m), g_metrics.end());
+    }
+    if (m->worker.joinable()) {
+        m->stop.store(true, std::memory_order_release);
+        m->worker.join();
+    }
+    if (m->listener != kNoSocket) close_socket(m->listener);
+    delete m;
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLMetrics rrl_metrics_create(const RRL_MetricsConfig* cfg)
+{
+    if (!cfg || cfg->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_metrics_create: null config or bad struct_size");
+        return nullptr;
+    }
+    RRL_MetricsConfig c{};
+    std::memcpy(&c, cfg, std::min(cfg->struct_size, sizeof(c)));
+
+    auto* m = new (std::nothrow) RRLMetricsImpl;
+    if (!m) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_metrics_create: out of memory");
+        return nullptr;
+    }
+    try {
+        m->node   = c.node && *c.node ? c.node : default_node();
+        m->labels = parse_labels(c.labels);
+    } catch (const std::bad_alloc&) {
+        delete m;
+        set_error(RRL_ERR_NO_MEMORY, "rrl_metrics_create: out of memory");
+        return nullptr;
+    }
+    m->push_ms = c.push_interval_ms ? c.push_interval_ms : kDefaultPushMs;
+
+    if ((c.listen || c.push_url) && !net_init()) {
+        delete m;
+        set_error(RRL_ERR_IO, "rrl_metrics_create: socket layer unavailable");
+        return nullptr;
+    }
+    if (c.push_url) {
+        try {
+            std::string url = c.push_url;
+            if (url.compare(0, 7, "http://") != 0) {
+                delete m;
+                set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_metrics_create: push_url must be http://host[:port][/path]");
+                return nullptr;
+            }
+            url.erase(0, 7);
+            const size_t slash = url.find('/');
+            std::string authority = url.substr(0, slash);
+            m->push_path = slash == std::string::npos ? "" : url.substr(slash);
+            while (!m->push_path.empty() && m->push_path.back() == '/') m->push_path.pop_back();
+            const size_t v6 = authority.find(']');
+            if (authority.find(':', v6 == std::string::npos ? 0 : v6) == std::string::npos)
+                authority += ":9091";   // Pushgateway default
+            if (!split_host_port(authority, m->push_host, m->push_port) ||
+                m->push_host.empty()) {
+                delete m;
+                set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_metrics_create: bad push_url host");
+                return nullptr;
+            }
+        } catch (const std::bad_alloc&) {
+            delete m;
+            set_error(RRL_ERR_NO_MEMORY, "rrl_metrics_create: out of memory");
+            return nullptr;
+        }
+    }
+    if (c.listen) {
+        try {
+            std::string host, port;
+            if (!split_host_port(c.listen, host, port)) {
+                delete m;
+                set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_metrics_create: listen must be [host]:port");
+                return nullptr;
+            }
+            m->listener = open_listener(host, port, m->port);
+            if (m->listener == kNoSocket) {
+                delete m;
+                set_error(RRL_ERR_IO, "rrl_metrics_create: cannot listen on the requested address");
+                return nullptr;
+            }
+        } catch (const std::bad_alloc&) {
+            delete m;
+            set_error(RRL_ERR_NO_MEMORY, "rrl_metrics_create: out of memory");
+            return nullptr;
+        }
+    }
+    if (c.listen || c.push_url) {
+        try {
+            m->worker = std::thread(run, m);
+        } catch (const std::system_error&) {
+            free_metrics(m);
+            set_error(RRL_ERR_IO, "rrl_metrics_create: cannot start the exporter thread");
+            return nullptr;
+        }
+    }
+    try {
+        std::lock_guard<std::mutex> lk(g_metrics_mtx);
+        g_metrics.push_back(m);
+    } catch (const std::bad_alloc&) {
+        free_metrics(m);
+        set_error(RRL_ERR_NO_MEMORY, "rrl_metrics_create: out of memory");
+        return nullptr;
+    }
+    return m;
+}
+
+void rrl_metrics_destroy(RRLMetrics m)
+{
+    if (m) free_metrics(m);
+}
+
+int rrl_metrics_track(RRLMetrics m, RRLHandle handle, const char* labels)
+{
+    if (!m || !handle) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_metrics_track: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    try {
+        Tracked t{handle, labels ? parse_labels(labels) : m->labels};
+        std::lock_guard<std::mutex> lk(m->mtx);
+        auto it = std::find_if(m->tracked.begin(), m->tracked.end(),
+                               [&](const Tracked& e) { return e.handle == handle; });
+        if (it != m->tracked.end()) *it = std::move(t);   // re-track = relabel
+        else                        m->tracked.push_back(std::move(t));
+    } catch (const std::bad_alloc&) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_metrics_track: out of memory");
+        return RRL_ERR_NO_MEMORY;
+    }
+    return RRL_SUCCESS;
+}
+
+int rrl_metrics_untrack(RRLMetrics m, RRLHandle handle)
+{
+    if (!m || !handle) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_metrics_untrack: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    std::lock_guard<std::mutex> lk(m->mtx);
+    auto it = std::find_if(m->tracked.begin(), m->tracked.end(),
+                           [&](const Tracked& e) { return e.handle == handle; });
+    if (it == m->tracked.end()) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_metrics_untrack: handle not tracked");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    RRL_StatsV2 last{};
+    last.struct_size = sizeof(last);
+    if (rrl_get_stats_v2(handle, &last) == RRL_SUCCESS) retire_counters(*m, *it, last);
+    m->tracked.erase(it);
+    return RRL_SUCCESS;
+}
+
+size_t rrl_metrics_render(RRLMetrics m, char* out, size_t cap)
+{
+    if (!m || (cap && !out)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_metrics_render: null arg");
+        return 0;
+    }
+    std::string text;
+    try {
+        text = render(*m);
+    } catch (const std::bad_alloc&) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_metrics_render: out of memory");
+        return 0;
+    }
+    if (cap) {
+        const size_t n = std::min(text.size(), cap - 1);
+        std::memcpy(out, text.data(), n);
+        out[n] = '\0';
+    }
+    return text.size();
+}
+
+int rrl_metrics_port(RRLMetrics m)
+{
+    return m ? m->port : 0;
+}
+
+} // extern "C"
+
+namespace rrl { namespace detail {
+
+void metrics_forget(RRLHandle handle)
+{
+    RRL_StatsV2 last{};
+    bool read = false, reported = false;
+    std::lock_guard<std::mutex> lk(g_metrics_mtx);
+    for (RRLMetricsImpl* m : g_metrics) {
+        std::lock_guard<std::mutex> mk(m->mtx);   // after any render in flight
+        auto it = std::find_if(m->tracked.begin(), m->tracked.end(),
+                               [&](const Tracked& t) { return t.handle == handle; });
+        if (it == m->tracked.end()) continue;
+        if (!read) {   // once, while the handle is still open
+            last.struct_size = sizeof(last);
+            reported = rrl_get_stats_v2(handle, &last) == RRL_SUCCESS;
+            read = true;
+        }
+        if (reported) retire_counters(*m, *it, last);
+        m->tracked.erase(it);
+    }
+}
+
+}} // namespace rrl::detail
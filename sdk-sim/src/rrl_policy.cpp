@@ -0,0 +1,380 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_policy.cpp  —  Shared policy objects
+//
+//  • An RRLPolicy is a refcounted slot; its current weights live
+//    behind one atomic pointer, so updating the slot retargets every
+//    bound handle at once.
+//  • Replaced weights are retired through the same epoch scheme as
+//    backend tables: readers inside an rrl_* call never see them freed.
+//  • Bindings live in per‑handle slots, so binding one handle never
+//    copies the others'; rrl_handle_closed() drops a handle's slot.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_internal.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+using namespace rrl::detail;
+
+namespace {
+
+// One immutable version of a policy's weights.
+struct PolicyModel {
+    const void*                data = nullptr;
+    size_t                     len  = 0;
+    uint64_t                   version = 0;
+    RRLMappedFile              file = nullptr;   // set when mapped
+    std::vector<unsigned char> owned;            // set when copied
+
+    ~PolicyModel() { rrl_mapped_release(file); }
+};
+
+void delete_model(void* p) { delete static_cast<PolicyModel*>(p); }
+
+PolicyModel* make_model(const void* bytes, size_t len)
+{
+    auto* m = new (std::nothrow) PolicyModel;
+    if (!m) return nullptr;
+    try {
+        m->owned.assign(static_cast<const unsigned char*>(bytes),
+                        static_cast<const unsigned char*>(bytes) + len);
+    } catch (const std::bad_alloc&) {
+        delete m;
+        return nullptr;
+    }
+    m->data = m->owned.data();
+    m->len  = len;
+    return m;
+}
+
+PolicyModel* make_model(RRLMappedFile file)
+{
+    auto* m = new (std::nothrow) PolicyModel;
+    if (!m) return nullptr;
+    rrl_mapped_retain(file);
+    m->file = file;
+    m->data = rrl_mapped_data(file, &m->len);
+    return m;
+}
+
+} // namespace (anonymous)
+
+struct RRLPolicyImpl {
+    std::atomic<long>               refs{1};
+    std::atomic<uint64_t>           next_version{1};
+    std::atomic<const PolicyModel*> model{nullptr};
+    bool                            shared = false;   // in g_shared (below)
+    uintptr_t                       share_key = 0;
+};
+
+namespace {
+
+void swap_model(RRLPolicy p, PolicyModel* m)
+{
+    m->version = p->next_version.fetch_add(1, std::memory_order_relaxed);
+    const PolicyModel* old = p->model.exchange(m, std::memory_order_seq_cst);
+    if (old) retire(const_cast<PolicyModel*>(old), delete_model);
+}
+
+RRLPolicy make_policy(PolicyModel* m)
+{
+    auto* p = m ? new (std::nothrow) RRLPolicyImpl : nullptr;
+    if (!p) {
+        delete m;
+        return nullptr;
+    }
+    swap_model(p, m);
+    return p;
+}
+
+// Handle → policy bindings seen by the built‑in engine: an open‑
+// addressing table of per‑handle slots.  Lookups (every act batch)
+// are lock‑free; a bind takes the writer mutex and touches one slot.
+// Keys are never cleared, so an unbound handle leaves a tombstone
+// (val == NULL) that a rebind of it reuses; the table is rebuilt into
+// a fresh one, tombstones dropped, once keys fill half of it.
+struct BindSlot {
+    std::atomic<RRLHandle> key{nullptr};
+    std::atomic<RRLPolicy> val{nullptr};
+};
+
+struct BindTable {
+    size_t                      mask = 0;
+    size_t                      keys = 0;   // writer only
+    std::unique_ptr<BindSlot[]> slots;
+};
+
+constexpr size_t kMinBindSlots = 16;
+
+std::mutex              g_bind_mtx;
+std::atomic<BindTable*> g_bindings{nullptr};
+
+void delete_bindings(void* p) { delete static_cast<BindTable*>(p); }
+void release_policy(void* p)  { rrl_policy_release(static_cast<RRLPolicy>(p)); }
+
+inline size_t bind_hash(RRLHandle h)
+{
+    uint64_t x = reinterpret_cast<uintptr_t>(h);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
+}
+
+// The slot holding `h`, or the empty slot that ends its probe run.
+BindSlot& probe(const BindTable& t, RRLHandle h)
+{
+    for (size_t i = bind_hash(h) & t.mask;; i = (i + 1) & t.mask) {
+        RRLHandle k = t.slots[i].key.load(std::memory_order_acquire);
+        if (k == h || !k) return t.slots[i];
+    }
+}
+
+// A table sized for `live` handles plus room to grow; NULL if out of memory.
+BindTable* make_table(size_t live)
+{
+    size_t n = kMinBindSlots;
+    while (n < live * 4) n *= 2;
+    auto* t = new (std::nothrow) BindTable;
+    if (t) t->slots.reset(new (std::nothrow) BindSlot[n]);
+    if (!t || !t->slots) {
+        delete t;
+        return nullptr;
+    }
+    t->mask = n - 1;
+    return t;
+}
+
+// One policy per blob / mapping for backend‑less loads.  The table
+// holds no reference: a policy drops its entry when its last one goes.
+std::mutex                                g_shared_mtx;
+std::unordered_map<uintptr_t, RRLPolicy>  g_shared;
+
+uintptr_t blob_key(const void* bytes, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ull ^ len;   // FNV‑1a
+    for (size_t i = 0; i < len; ++i)
+        h = (h ^ static_cast<const unsigned char*>(bytes)[i]) * 0x100000001b3ull;
+    return static_cast<uintptr_t>(h) | 1;   // odd: never a mapping's address
+}
+
+bool retain_live(RRLPolicy p)
+{
+    long r = p->refs.load(std::memory_order_relaxed);
+    while (r > 0)
+        if (p->refs.compare_exchange_weak(r, r + 1, std::memory_order_relaxed)) return true;
+    return false;
+}
+
+template <class Match, class Make>
+RRLPolicy share(uintptr_t key, Match match, Make make)
+{
+    std::lock_guard<std::mutex> lk(g_shared_mtx);
+    auto it = g_shared.find(key);
+    if (it != g_shared.end() && match(it->second) && retain_live(it->second)) return it->second;
+    RRLPolicy p = make();
+    if (!p) return nullptr;
+    try {
+        g_shared[key] = p;   // replaces a dying or mismatched entry
+        p->shared    = true;
+        p->share_key = key;
+    } catch (const std::bad_alloc&) {
+        // Served unshared.
+    }
+    return p;
+}
+
+} // namespace (anonymous)
+
+namespace rrl { namespace detail {
+
+int bind_local(RRLHandle handle, RRLPolicy policy)
+{
+    std::lock_guard<std::mutex> lk(g_bind_mtx);
+    BindTable* t = g_bindings.load(std::memory_order_relaxed);
+    if (!t) {
+        if (!policy) return RRL_SUCCESS;
+        if (!(t = make_table(0))) return RRL_ERR_NO_MEMORY;
+        g_bindings.store(t, std::memory_order_release);
+    }
+    BindSlot* slot = &probe(*t, handle);
+    if (!slot->key.load(std::memory_order_relaxed)) {
+        if (!policy) return RRL_SUCCESS;
+        if ((t->keys + 1) * 2 > t->mask + 1) {
+            size_t live = 0;
+            for (size_t i = 0; i <= t->mask; ++i)
+                live += t->slots[i].val.load(std::memory_order_relaxed) != nullptr;
+            BindTable* next = make_table(live + 1);
+            if (!next) return RRL_ERR_NO_MEMORY;
+            for (size_t i = 0; i <= t->mask; ++i) {
+                RRLPolicy p = t->slots[i].val.load(std::memory_order_relaxed);
+                if (!p) continue;
+                BindSlot& s = probe(*next, t->slots[i].key.load(std::memory_order_relaxed));
+                s.val.store(p, std::memory_order_relaxed);
+                s.key.store(t->slots[i].key.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                ++next->keys;
+            }
+            // The old table keeps its (now shared) pointers until readers leave.
+            g_bindings.store(next, std::memory_order_seq_cst);
+            retire(t, delete_bindings);
+            t = next;
+            slot = &probe(*t, handle);
+        }
+        ++t->keys;
+        rrl_policy_retain(policy);
+        slot->val.store(policy, std::memory_order_relaxed);
+        slot->key.store(handle, std::memory_order_release);
+        return RRL_SUCCESS;
+    }
+    rrl_policy_retain(policy);
+    RRLPolicy old = slot->val.exchange(policy, std::memory_order_seq_cst);
+    // Readers may still use `old`; drop our ref once they are done.
+    if (old) retire(old, release_policy);
+    return RRL_SUCCESS;
+}
+
+RRLPolicy bound_policy(RRLHandle handle)
+{
+    const BindTable* t = g_bindings.load(std::memory_order_acquire);
+    return t ? probe(*t, handle).val.load(std::memory_order_acquire) : nullptr;
+}
+
+RRLPolicy shared_policy(const void* bytes, size_t len)
+{
+    EpochGuard pin;   // candidates' weights are compared in place
+    return share(blob_key(bytes, len),
+                 [&](RRLPolicy p) {
+                     size_t n = 0;
+                     const void* d = rrl_policy_data(p, &n, nullptr);
+                     return n == len && std::memcmp(d, bytes, len) == 0;
+                 },
+                 [&] { return make_policy(make_model(bytes, len)); });
+}
+
+RRLPolicy shared_policy(RRLMappedFile file)
+{
+    return share(reinterpret_cast<uintptr_t>(file),
+                 [&](RRLPolicy p) {
+                     const PolicyModel* m = p->model.load(std::memory_order_acquire);
+                     return m && m->file == file;
+                 },
+                 [&] { return make_policy(make_model(file)); });
+}
+
+}} // namespace rrl::detail
+
+extern "C" {
+
+RRLPolicy rrl_policy_create(const void* bytes, size_t len)
+{
+    if (!bytes || len == 0) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_policy_create: empty blob");
+        return nullptr;
+    }
+    RRLPolicy p = make_policy(make_model(bytes, len));
+    if (!p) set_error(RRL_ERR_NO_MEMORY, "rrl_policy_create: out of memory");
+    return p;
+}
+
+RRLPolicy rrl_policy_create_mapped(RRLMappedFile file)
+{
+    if (!file) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_policy_create_mapped: null file");
+        return nullptr;
+    }
+    RRLPolicy p = make_policy(make_model(file));
+    if (!p) set_error(RRL_ERR_NO_MEMORY, "rrl_policy_create_mapped: out of memory");
+    return p;
+}
+
+int rrl_policy_update(RRLPolicy policy, const void* bytes, size_t len)
+{
+    if (!policy || !bytes || len == 0) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_policy_update: null policy or empty blob");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    PolicyModel* m = make_model(bytes, len);
+    if (!m) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_policy_update: out of memory");
+        return RRL_ERR_NO_MEMORY;
+    }
+    swap_model(policy, m);
+    return RRL_SUCCESS;
+}
+
+int rrl_policy_update_mapped(RRLPolicy policy, RRLMappedFile file)
+{
+    if (!policy || !file) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_policy_update_mapped: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    PolicyModel* m = make_model(file);
+    if (!m) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_policy_update_mapped: out of memory");
+        return RRL_ERR_NO_MEMORY;
+    }
+    swap_model(policy, m);
+    return RRL_SUCCESS;
+}
+
+void rrl_policy_retain(RRLPolicy policy)
+{
+    if (policy) policy->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void rrl_policy_release(RRLPolicy policy)
+{
+    if (!policy || policy->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    if (policy->shared) {
+        std::lock_guard<std::mutex> lk(g_shared_mtx);
+        auto it = g_shared.find(policy->share_key);
+        if (it != g_shared.end() && it->second == policy) g_shared.erase(it);
+    }
+    const PolicyModel* last = policy->model.exchange(nullptr, std::memory_order_seq_cst);
+    if (last) retire(const_cast<PolicyModel*>(last), delete_model);
+    delete policy;
+}
+
+const void* rrl_policy_data(RRLPolicy policy, size_t* out_len, uint64_t* out_version)
+{
+    // Pins the model while its fields are read; the data pointer itself
+    // outlives this only under the caller's own guard (a hook's call).
+    EpochGuard pin;
+    const PolicyModel* m = policy ? policy->model.load(std::memory_order_acquire) : nullptr;
+    if (out_len)     *out_len     = m ? m->len : 0;
+    if (out_version) *out_version = m ? m->version : 0;
+    return m ? m->data : nullptr;
+}
+
+int RRL_WEAK rrl_bind_policy(RRLHandle handle, RRLPolicy policy)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_bind_policy: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    BackendGuard be;
+    int rc = RRL_SUCCESS;
+    if (auto bind = be->ext.bind_policy) {
+        rc = bind(handle, policy);
+    } else if (policy && load_policy_served(be->base.load_policy != nullptr)) {
+        size_t len = 0;
+        const void* data = rrl_policy_data(policy, &len, nullptr);
+        rc = rrl_load_policy(handle, data, len);   // an application's export outranks the hook
+    }
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, "rrl_bind_policy: backend error");
+        return rc;
+    }
+    // Recorded only once the backend took it; policy may be NULL (unbind).
+    if ((rc = bind_local(handle, policy)) != RRL_SUCCESS)
+        set_error(rc, "rrl_bind_policy: out of memory");
+    return rc;
+}
+
+} // extern "C"
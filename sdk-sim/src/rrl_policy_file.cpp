@@ -0,0 +1,239 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_policy_file.cpp  —  Memory‑mapped policy loading
+//
+//  • rrl_map_file() maps an exported model read‑only and shares the
+//    mapping between every caller that asks for the same file, so
+//    loading one policy into hundreds of handles keeps one resident
+//    copy and needs no up‑front read.
+//  • Mappings are refcounted; the last rrl_mapped_release() unmaps.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_internal.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define RRL_HAVE_MMAP 1
+#else
+#  include <cstdio>
+#  include <vector>
+#endif
+
+using namespace rrl::detail;
+
+struct RRLMappedFileImpl {
+    std::atomic<long> refs{1};
+    std::string       key;            // identity in the share table
+    const void*       data = nullptr;
+    size_t            len  = 0;
+#if defined(_WIN32)
+    HANDLE            file    = INVALID_HANDLE_VALUE;
+    HANDLE            mapping = nullptr;
+#elif !defined(RRL_HAVE_MMAP)
+    std::vector<unsigned char> heap;  // no mmap on this target: read once
+#endif
+};
+
+namespace {
+
+// Share table: lookups and the final release are serialised, which is
+// fine because both happen at load/unload time, never per step.
+std::mutex                                          g_map_mtx;
+std::unordered_map<std::string, RRLMappedFileImpl*> g_maps;
+
+// Identify the file itself (not the spelling of its path) so that
+// different paths to one file share a mapping, and a rewritten file
+// gets a fresh one.
+bool file_key(const char* path, std::string& key)
+{
+#if defined(_WIN32)
+    char full[MAX_PATH];
+    DWORD n = GetFullPathNameA(path, MAX_PATH, full, nullptr);
+    if (n == 0 || n >= MAX_PATH) return false;
+    key.assign(full, n);
+    return true;
+#elif defined(RRL_HAVE_MMAP)
+    struct stat st;
+    if (::stat(path, &st) != 0) return false;
+    key = std::to_string(st.st_dev) + ':' + std::to_string(st.st_ino) + ':' +
+          std::to_string(st.st_size) + ':' + std::to_string(st.st_mtime);
+    return true;
+#else
+    key = path;
+    return true;
+#endif
+}
+
+bool map_into(const char* path, RRLMappedFileImpl& m)
+{
+#if defined(_WIN32)
+    m.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m.file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m.file, &size) || size.QuadPart == 0) return false;
+    m.mapping = CreateFileMappingA(m.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m.mapping) return false;
+    m.data = MapViewOfFile(m.mapping, FILE_MAP_READ, 0, 0, 0);
+    m.len  = static_cast<size_t>(size.QuadPart);
+    return m.data != nullptr;
+#elif defined(RRL_HAVE_MMAP)
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+    void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);   // the mapping keeps the file referenced
+    if (p == MAP_FAILED) return false;
+    m.data = p;
+    m.len  = static_cast<size_t>(st.st_size);
+    return true;
+#else
+    std::FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+    unsigned char chunk[1 << 16];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0)
+        m.heap.insert(m.heap.end(), chunk, chunk + n);
+    std::fclose(f);
+    m.data = m.heap.data();
+    m.len  = m.heap.size();
+    return m.len != 0;
+#endif
+}
+
+void unmap(RRLMappedFileImpl& m)
+{
+#if defined(_WIN32)
+    if (m.data)    UnmapViewOfFile(m.data);
+    if (m.mapping) CloseHandle(m.mapping);
+    if (m.file != INVALID_HANDLE_VALUE) CloseHandle(m.file);
+#elif defined(RRL_HAVE_MMAP)
+    if (m.data) ::munmap(const_cast<void*>(m.data), m.len);
+#endif
+    m.data = nullptr;
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLMappedFile rrl_map_file(const char* path)
+{
+    if (!path || !*path) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_map_file: empty path");
+        return nullptr;
+    }
+    std::string key;
+    try {
+        if (!file_key(path, key)) {
+            set_error(RRL_ERR_IO, "rrl_map_file: cannot stat file");
+            return nullptr;
+        }
+    } catch (const std::bad_alloc&) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_map_file: out of memory");
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lk(g_map_mtx);
+    auto it = g_maps.find(key);
+    if (it != g_maps.end()) {
+        it->second->refs.fetch_add(1, std::memory_order_relaxed);
+        return it->second;
+    }
+    auto* m = new (std::nothrow) RRLMappedFileImpl;
+    if (!m) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_map_file: out of memory");
+        return nullptr;
+    }
+    bool mapped = false;
+    try {
+        mapped = map_into(path, *m);   // reads into a vector without mmap
+        if (mapped) {
+            m->key = std::move(key);
+            g_maps.emplace(m->key, m);
+        }
+    } catch (const std::bad_alloc&) {
+        // Not shared, so not handed out: release would erase by its key.
+        unmap(*m);
+        delete m;
+        set_error(RRL_ERR_NO_MEMORY, "rrl_map_file: out of memory");
+        return nullptr;
+    }
+    if (!mapped) {
+        unmap(*m);
+        delete m;
+        set_error(RRL_ERR_IO, "rrl_map_file: cannot map file (missing or empty?)");
+        return nullptr;
+    }
+    return m;
+}
+
+const void* rrl_mapped_data(RRLMappedFile file, size_t* out_len)
+{
+    if (out_len) *out_len = file ? file->len : 0;
+    return file ? file->data : nullptr;
+}
+
+void rrl_mapped_retain(RRLMappedFile file)
+{
+    // Caller already holds a reference, so this never revives a zero count.
+    if (file) file->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void rrl_mapped_release(RRLMappedFile file)
+{
+    if (!file) return;
+    std::lock_guard<std::mutex> lk(g_map_mtx);
+    if (file->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    g_maps.erase(file->key);
+    unmap(*file);
+    delete file;
+}
+
+int RRL_WEAK rrl_load_policy_mapped(RRLHandle handle, RRLMappedFile file)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_load_policy_mapped: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    if (!file) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_load_policy_mapped: null file");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    BackendGuard be;
+    if (auto mapped = be->ext.load_policy_mapped) {
+        int rc = mapped(handle, file);
+        if (rc != RRL_SUCCESS) set_error(rc, "rrl_load_policy_mapped: backend error");
+        return rc;
+    }
+    // Plain backends copy what they need during the call.
+    return load_policy_mapped_fallback(handle, file);
+}
+
+int RRL_WEAK rrl_load_policy_file(RRLHandle handle, const char* path)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_load_policy_file: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    RRLMappedFile file = rrl_map_file(path);
+    if (!file) return rrl_last_error();
+    int rc = rrl_load_policy_mapped(handle, file);
+    rrl_mapped_release(file);   // backend retained it if it kept it
+    return rc;
+}
+
+} // extern "C"
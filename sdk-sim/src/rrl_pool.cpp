@@ -0,0 +1,263 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_pool.cpp  —  Preallocated handle pools
+//
+//  • One aligned allocation holds the pool header, a cache‑line‑
+//    aligned slot per handle (buffers, free‑list link), a sorted
+//    handle → slot index and every obs / action buffer; it is sized
+//    from the first handle's spaces and never grows.
+//  • The free list is a Treiber stack of slot indices whose head
+//    carries a generation tag against ABA, so acquire / release are a
+//    CAS each and never block.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <new>
+
+using namespace rrl::detail;
+
+namespace {
+
+constexpr size_t round_up(size_t v) { return (v + RRL_BUFFER_ALIGN - 1) / RRL_BUFFER_ALIGN * RRL_BUFFER_ALIGN; }
+
+struct alignas(RRL_BUFFER_ALIGN) Slot {
+    RRLHandle             handle = nullptr;
+    unsigned char*        obs    = nullptr;
+    unsigned char*        act    = nullptr;
+    std::atomic<uint32_t> next{0};          // free list: index + 1, 0 = end
+    std::atomic<bool>     in_use{false};
+    bool                  bound  = false;
+};
+
+struct Lookup {
+    RRLHandle handle;
+    uint32_t  index;
+};
+
+bool same_space(const RRL_SpaceDesc& a, const RRL_SpaceDesc& b)
+{
+    if (a.ndim != b.ndim || a.dtype != b.dtype) return false;
+    for (int d = 0; d < a.ndim && d < 8; ++d)
+        if (a.shape[d] != b.shape[d]) return false;
+    return true;
+}
+
+} // namespace (anonymous)
+
+struct alignas(RRL_BUFFER_ALIGN) RRLPoolImpl {
+    size_t  capacity   = 0;
+    size_t  obs_bytes  = 0, act_bytes = 0;
+    Slot*   slots      = nullptr;
+    Lookup* lookup     = nullptr;           // sorted by handle
+
+    alignas(RRL_BUFFER_ALIGN) std::atomic<uint64_t> head{0};   // tag << 32 | (index + 1)
+    alignas(RRL_BUFFER_ALIGN) std::atomic<size_t>   available{0};
+};
+
+namespace {
+
+void push_free(RRLPoolImpl* p, uint32_t index)
+{
+    uint64_t head = p->head.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        p->slots[index].next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        next = (((head >> 32) + 1) << 32) | (index + 1);
+    } while (!p->head.compare_exchange_weak(head, next, std::memory_order_release,
+                                            std::memory_order_relaxed));
+    p->available.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Slot index + 1, or 0 if the stack is empty.
+uint32_t pop_free(RRLPoolImpl* p)
+{
+    uint64_t head = p->head.load(std::memory_order_acquire);
+    for (;;) {
+        const uint32_t top = static_cast<uint32_t>(head);
+        if (!top) return 0;
+        const uint32_t next = p->slots[top - 1].next.load(std::memory_order_relaxed);
+        if (p->head.compare_exchange_weak(head, (((head >> 32) + 1) << 32) | next,
+                                          std::memory_order_acquire, std::memory_order_acquire)) {
+            p->available.fetch_sub(1, std::memory_order_relaxed);
+            return top;
+        }
+    }
+}
+
+Slot* find_slot(RRLPoolImpl* p, RRLHandle h)
+{
+    const Lookup* begin = p->lookup;
+    const Lookup* end   = begin + p->capacity;
+    const Lookup* it    = std::lower_bound(begin, end, h, [](const Lookup& l, RRLHandle v) {
+        return std::less<RRLHandle>()(l.handle, v);
+    });
+    return it != end && it->handle == h ? &p->slots[it->index] : nullptr;
+}
+
+void free_pool(RRLPoolImpl* p, size_t opened)
+{
+    for (size_t i = 0; i < opened; ++i) rrl_close(p->slots[i].handle);
+    for (size_t i = 0; i < p->capacity; ++i) p->slots[i].~Slot();
+    p->~RRLPoolImpl();
+    ::operator delete(static_cast<void*>(p), std::align_val_t{RRL_BUFFER_ALIGN});
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLPool rrl_pool_create(size_t capacity, const RRL_OpenConfig* cfg)
+{
+    if (capacity == 0 || capacity >= UINT32_MAX || !cfg) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pool_create: bad capacity or null config");
+        return nullptr;
+    }
+    // The first handle fixes the spaces, hence the buffer sizes.
+    RRLHandle first = rrl_open(cfg);
+    if (!first) return nullptr;   // rrl_open recorded the error
+    RRL_SpaceDesc obs{}, act{};
+    int rc = rrl_observation_space(first, &obs);
+    if (rc == RRL_SUCCESS) rc = rrl_action_space(first, &act);
+    const size_t obs_bytes = rc == RRL_SUCCESS ? rrl_space_bytes(&obs) : 0;
+    const size_t act_bytes = rc == RRL_SUCCESS ? rrl_space_bytes(&act) : 0;
+    if (!obs_bytes || !act_bytes) {
+        rrl_close(first);
+        set_error(rc != RRL_SUCCESS ? rc : RRL_ERR_INVALID_ARGUMENT, "rrl_pool_create: space query failed");
+        return nullptr;
+    }
+
+    // header | slots | lookup | per-slot obs, action buffers
+    const size_t obs_stride = round_up(obs_bytes), act_stride = round_up(act_bytes);
+    const size_t off_slots  = round_up(sizeof(RRLPoolImpl));
+    const size_t off_lookup = off_slots + capacity * sizeof(Slot);
+    const size_t off_bufs   = off_lookup + round_up(capacity * sizeof(Lookup));
+    if ((SIZE_MAX - off_bufs) / capacity < obs_stride + act_stride) {
+        rrl_close(first);
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pool_create: arena too large");
+        return nullptr;
+    }
+    const size_t total      = off_bufs + capacity * (obs_stride + act_stride);
+    void* arena = ::operator new(total, std::align_val_t{RRL_BUFFER_ALIGN}, std::nothrow);
+    if (!arena) {
+        rrl_close(first);
+        set_error(RRL_ERR_NO_MEMORY, "rrl_pool_create: out of memory");
+        return nullptr;
+    }
+    auto* base = static_cast<unsigned char*>(arena);
+    std::memset(base + off_bufs, 0, total - off_bufs);
+    auto* p = new (base) RRLPoolImpl;
+    p->capacity  = capacity;
+    p->obs_bytes = obs_bytes;
+    p->act_bytes = act_bytes;
+    p->slots     = reinterpret_cast<Slot*>(base + off_slots);
+    p->lookup    = reinterpret_cast<Lookup*>(base + off_lookup);
+    for (size_t i = 0; i < capacity; ++i) {
+        Slot* s = new (&p->slots[i]) Slot;
+        s->obs = base + off_bufs + i * (obs_stride + act_stride);
+        s->act = s->obs + obs_stride;
+    }
+
+    // Open the rest up front: the only point where the core may allocate.
+    size_t opened = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        Slot& s = p->slots[i];
+        s.handle = i == 0 ? first : rrl_open(cfg);
+        if (!s.handle) { free_pool(p, opened); return nullptr; }
+        ++opened;
+        RRL_SpaceDesc o{}, a{};
+        if (i > 0 && (rrl_observation_space(s.handle, &o) != RRL_SUCCESS ||
+                      rrl_action_space(s.handle, &a) != RRL_SUCCESS ||
+                      !same_space(o, obs) || !same_space(a, act))) {
+            free_pool(p, opened);
+            set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pool_create: handles differ in obs/action space");
+            return nullptr;
+        }
+        rc = rrl_bind_buffers(s.handle, s.obs, obs_bytes, s.act, act_bytes);
+        if (rc != RRL_SUCCESS && rc != RRL_ERR_UNSUPPORTED) {
+            free_pool(p, opened);
+            set_error(rc, "rrl_pool_create: rrl_bind_buffers failed");
+            return nullptr;
+        }
+        s.bound = rc == RRL_SUCCESS;
+        p->lookup[i] = Lookup{s.handle, static_cast<uint32_t>(i)};
+    }
+    std::sort(p->lookup, p->lookup + capacity, [](const Lookup& a, const Lookup& b) {
+        return std::less<RRLHandle>()(a.handle, b.handle);
+    });
+    for (size_t i = capacity; i-- > 0;) push_free(p, static_cast<uint32_t>(i));   // slot 0 on top
+    return p;
+}
+
+void rrl_pool_destroy(RRLPool pool)
+{
+    if (pool) free_pool(pool, pool->capacity);
+}
+
+RRLHandle rrl_pool_acquire(RRLPool pool)
+{
+    if (!pool) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pool_acquire: null pool");
+        return nullptr;
+    }
+    const uint32_t top = pop_free(pool);
+    if (!top) {
+        set_error(RRL_ERR_EXHAUSTED, "rrl_pool_acquire: every handle is in use");
+        return nullptr;
+    }
+    Slot& s = pool->slots[top - 1];
+    s.in_use.store(true, std::memory_order_relaxed);
+    return s.handle;
+}
+
+int rrl_pool_release(RRLPool pool, RRLHandle handle)
+{
+    if (!pool || !handle) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pool_release: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    // Claim the release first, so a racing second release fails here
+    // instead of resetting a handle that may already be re-acquired.
+    Slot* s = find_slot(pool, handle);
+    if (!s || !s->in_use.exchange(false, std::memory_order_acq_rel)) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_pool_release: handle not acquired from this pool");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    const int rc = rrl_reset(handle);
+    if (rc != RRL_SUCCESS) {
+        s->in_use.store(true, std::memory_order_release);   // stays acquired
+        return rc;                                          // rrl_reset recorded the error
+    }
+    push_free(pool, static_cast<uint32_t>(s - pool->slots));
+    return RRL_SUCCESS;
+}
+
+int rrl_pool_slot(RRLPool pool, RRLHandle handle, RRL_PoolSlot* out)
+{
+    if (!pool || !out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pool_slot: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    Slot* s = handle ? find_slot(pool, handle) : nullptr;
+    if (!s) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_pool_slot: handle not from this pool");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    out->index        = static_cast<size_t>(s - pool->slots);
+    out->obs          = s->obs;
+    out->obs_bytes    = pool->obs_bytes;
+    out->actions      = s->act;
+    out->action_bytes = pool->act_bytes;
+    out->bound        = s->bound ? 1 : 0;
+    return RRL_SUCCESS;
+}
+
+size_t rrl_pool_available(RRLPool pool)
+{
+    return pool ? pool->available.load(std::memory_order_relaxed) : 0;
+}
+
+} // extern "C"
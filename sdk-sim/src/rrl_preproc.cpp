@@ -0,0 +1,647 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_preproc.cpp  —  Observation preprocessing pipelines
+//
+//  • Stages run in a fixed order: grayscale, area resize (separable:
+//    rows are accumulated in float, then columns), frame stack,
+//    normalize.  The resized frame is written straight into the
+//    stack's ring slot; stacking then reads each slot once while
+//    interleaving into the output, so frames never move.
+//  • Normalize, running‑stat and row‑accumulate kernels
+//    (rrl_preproc_kernels.hpp) use AArch64 NEON, or AVX2+FMA picked at
+//    run time on x86 CPUs that have it (rrl_preproc_avx2.cpp), plain
+//    C++ otherwise; the N = 4, one‑byte‑channel stack (Atari style)
+//    has a dedicated NEON / SSE2 interleave.
+//  • Per‑handle pipelines live in a copy‑on‑write map; replaced
+//    pipelines are retired, not freed in place.  A replacement that
+//    normalizes the same way shares the running stats of the one it
+//    replaces, so steps still landing on the old pipeline are not
+//    lost; the stats lock serialises them.
+//    rrl_handle_closed() detaches a closed handle's pipeline.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_internal.hpp"
+#include "rrl_preproc_kernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+#  include <arm_neon.h>
+#  define RRL_SIMD_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define RRL_SIMD_SSE2 1   // baseline on x86‑64: the interleave needs nothing newer
+#endif
+
+using namespace rrl::detail;
+
+namespace {
+
+constexpr float kClip     = 10.f;
+constexpr int   kMaxStack = 64;
+
+// One input contribution to an output row / column of the resize.
+struct Tap { int src; float w; };
+
+// RRL_NORM_RUNNING state; shared by a pipeline and its replacements.
+struct RunningStats {
+    std::mutex         mtx;                // apply, get / set stats
+    std::vector<float> mean, var;          // out_elems each
+    uint64_t           count = 0;
+};
+
+} // namespace (anonymous)
+
+struct RRLPreprocImpl {
+    RRL_SpaceDesc     in{}, out{};
+    RRL_PreprocConfig cfg{};
+    bool   u8    = true;       // input dtype uint8, else float32
+    size_t esize = 1;
+
+    // Input as H×W×C (vectors: 1×1×F) and the frame after gray / resize
+    int    h = 1, w = 1, c = 1;
+    int    fh = 1, fw = 1, fc = 1;
+    size_t frame_bytes = 0;
+    size_t out_elems   = 0;
+    int    stack       = 1;
+    float  scale = 1.f, offset = 0.f, clip = kClip;
+
+    std::vector<unsigned char> gray;       // gray frame ahead of a resize
+    std::vector<Tap>           xtaps, ytaps;
+    std::vector<size_t>        xbeg, ybeg; // taps of output col / row i: [beg[i], beg[i+1])
+    std::vector<float>         acc;        // one vertically resampled row
+
+    std::vector<unsigned char> ring;       // `stack` frames
+    int                        head   = 0; // slot the next frame goes to
+    int                        filled = 0; // frames since reset, ≤ stack
+    std::vector<unsigned char> stacked;    // interleaved frames ahead of normalize
+
+    std::shared_ptr<RunningStats> stats;  // RRL_NORM_RUNNING only
+};
+
+namespace {
+
+//──────────────────── SIMD kernels ──────────────────────────
+#if defined(RRL_SIMD_NEON)
+struct Vec {
+    using T = float32x4_t;
+    static constexpr size_t W = 4;
+    static T    set  (float v)                { return vdupq_n_f32(v); }
+    static T    load (const float* p)         { return vld1q_f32(p); }
+    static T    load (const uint8_t* p)       // exactly W bytes
+    {
+        uint32_t four;
+        std::memcpy(&four, p, sizeof(four));
+        const uint16x8_t w16 = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(four)));
+        return vcvtq_f32_u32(vmovl_u16(vget_low_u16(w16)));
+    }
+    static void store(float* p, T v)          { vst1q_f32(p, v); }
+    static T    add  (T a, T b)               { return vaddq_f32(a, b); }
+    static T    sub  (T a, T b)               { return vsubq_f32(a, b); }
+    static T    mul  (T a, T b)               { return vmulq_f32(a, b); }
+    static T    div  (T a, T b)               { return vdivq_f32(a, b); }
+    static T    fma  (T a, T b, T acc)        { return vfmaq_f32(acc, a, b); }
+    static T    sqrt (T a)                    { return vsqrtq_f32(a); }
+    static T    clamp(T a, T lo, T hi)        { return vminq_f32(vmaxq_f32(a, lo), hi); }
+};
+#else
+using Vec = VecScalar;
+#endif
+
+// Kernel entry points: the AVX2 build when the CPU has it, else Vec.
+template <typename Src>
+void to_float(const Src* s, float* d, size_t n, float a, float b)
+{
+#if defined(RRL_HAVE_AVX2_KERNELS)
+    if (cpu_has_avx2()) return to_float_avx2(s, d, n, a, b);
+#endif
+    rrl::detail::to_float<Vec>(s, d, n, a, b);
+}
+
+template <typename Src>
+void accumulate(float* acc, const Src* s, size_t n, float w)
+{
+#if defined(RRL_HAVE_AVX2_KERNELS)
+    if (cpu_has_avx2()) return accumulate_avx2(acc, s, n, w);
+#endif
+    rrl::detail::accumulate<Vec>(acc, s, n, w);
+}
+
+void running_update(const float* x, float* mean, float* var, size_t n, float inv_count)
+{
+#if defined(RRL_HAVE_AVX2_KERNELS)
+    if (cpu_has_avx2()) return running_update_avx2(x, mean, var, n, inv_count);
+#endif
+    rrl::detail::running_update<Vec>(x, mean, var, n, inv_count);
+}
+
+void running_apply(float* x, const float* mean, const float* var, size_t n, float clip)
+{
+#if defined(RRL_HAVE_AVX2_KERNELS)
+    if (cpu_has_avx2()) return running_apply_avx2(x, mean, var, n, clip);
+#endif
+    rrl::detail::running_apply<Vec>(x, mean, var, n, clip);
+}
+
+// out[p][j][·] = planes[j][p][·] for `px` pixels of `cb` bytes each.
+void interleave(const unsigned char* const* planes, int n, size_t px, size_t cb, unsigned char* out)
+{
+    size_t p = 0;
+    if (cb == 1 && n == 4) {
+        const unsigned char *a = planes[0], *b = planes[1], *c = planes[2], *d = planes[3];
+#if defined(RRL_SIMD_SSE2)
+        for (; p + 16 <= px; p += 16) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + p));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + p));
+            const __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + p));
+            const __m128i vd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + p));
+            const __m128i ab_lo = _mm_unpacklo_epi8(va, vb), ab_hi = _mm_unpackhi_epi8(va, vb);
+            const __m128i cd_lo = _mm_unpacklo_epi8(vc, vd), cd_hi = _mm_unpackhi_epi8(vc, vd);
+            auto* o = reinterpret_cast<__m128i*>(out + 4 * p);
+            _mm_storeu_si128(o + 0, _mm_unpacklo_epi16(ab_lo, cd_lo));
+            _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(ab_lo, cd_lo));
+            _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(ab_hi, cd_hi));
+            _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(ab_hi, cd_hi));
+        }
+#elif defined(RRL_SIMD_NEON)
+        for (; p + 16 <= px; p += 16) {
+            uint8x16x4_t v;
+            v.val[0] = vld1q_u8(a + p);
+            v.val[1] = vld1q_u8(b + p);
+            v.val[2] = vld1q_u8(c + p);
+            v.val[3] = vld1q_u8(d + p);
+            vst4q_u8(out + 4 * p, v);
+        }
+#endif
+        for (; p < px; ++p) {
+            out[4 * p + 0] = a[p]; out[4 * p + 1] = b[p];
+            out[4 * p + 2] = c[p]; out[4 * p + 3] = d[p];
+        }
+        return;
+    }
+    if (cb == 1) {
+        for (; p < px; ++p)
+            for (int j = 0; j < n; ++j) *out++ = planes[j][p];
+        return;
+    }
+    for (; p < px; ++p)
+        for (int j = 0; j < n; ++j) {
+            std::memcpy(out, planes[j] + p * cb, cb);
+            out += cb;
+        }
+}
+
+//──────────────────── Scalar stages ─────────────────────────
+void to_gray(const RRLPreprocImpl& pp, const void* src, void* dst)
+{
+    const size_t px = static_cast<size_t>(pp.h) * pp.w;
+    if (pp.u8) {
+        auto* s = static_cast<const uint8_t*>(src);
+        auto* d = static_cast<uint8_t*>(dst);
+        for (size_t i = 0; i < px; ++i, s += 3)   // BT.601, weights sum to 256
+            d[i] = static_cast<uint8_t>((77u * s[0] + 150u * s[1] + 29u * s[2] + 128u) >> 8);
+    } else {
+        auto* s = static_cast<const float*>(src);
+        auto* d = static_cast<float*>(dst);
+        for (size_t i = 0; i < px; ++i, s += 3)
+            d[i] = 0.299f * s[0] + 0.587f * s[1] + 0.114f * s[2];
+    }
+}
+
+// Area weights mapping `in` samples onto `out`: output i covers
+// [i·in/out, (i+1)·in/out) and weighs each input by its overlap.
+void build_taps(int in, int out, std::vector<Tap>& taps, std::vector<size_t>& beg)
+{
+    const double s = static_cast<double>(in) / out;
+    taps.clear();
+    beg.assign(static_cast<size_t>(out) + 1, 0);
+    for (int o = 0; o < out; ++o) {
+        beg[o] = taps.size();
+        const double lo = o * s, hi = (o + 1) * s;
+        for (int i = static_cast<int>(lo); i < in && i < hi; ++i) {
+            const double ov = std::min<double>(hi, i + 1) - std::max<double>(lo, i);
+            if (ov > 1e-9) taps.push_back({i, static_cast<float>(ov / s)});
+        }
+    }
+    beg[out] = taps.size();
+}
+
+template <typename T>
+void resize_area(RRLPreprocImpl& pp, const T* src, T* dst)
+{
+    const int    c   = pp.fc;
+    const size_t row = static_cast<size_t>(pp.w) * c;   // one input row
+    float* acc = pp.acc.data();
+    for (int oy = 0; oy < pp.fh; ++oy) {
+        std::fill(pp.acc.begin(), pp.acc.end(), 0.f);
+        for (size_t t = pp.ybeg[oy]; t < pp.ybeg[oy + 1]; ++t)
+            accumulate(acc, src + pp.ytaps[t].src * row, row, pp.ytaps[t].w);
+        T* d = dst + static_cast<size_t>(oy) * pp.fw * c;
+        for (int ox = 0; ox < pp.fw; ++ox)
+            for (int ch = 0; ch < c; ++ch) {
+                float v = 0.f;
+                for (size_t t = pp.xbeg[ox]; t < pp.xbeg[ox + 1]; ++t)
+                    v += pp.xtaps[t].w * acc[pp.xtaps[t].src * c + ch];
+                if constexpr (std::is_same<T, uint8_t>::value)
+                    *d++ = static_cast<uint8_t>(std::min(std::max(v + 0.5f, 0.f), 255.f));
+                else
+                    *d++ = v;
+            }
+    }
+}
+
+bool space_ok(const RRL_SpaceDesc& s) { return s.ndim >= 1 && s.ndim <= 8 && rrl_space_bytes(&s) != 0; }
+
+//──────────────────── Per‑handle pipelines ──────────────────
+struct Attached {
+    RRLPreproc    pp;
+    RRL_SpaceDesc native;    // env's own observation space
+};
+using PreprocMap = std::unordered_map<RRLHandle, Attached>;
+
+std::mutex                     g_pp_mtx;
+std::atomic<const PreprocMap*> g_pipelines{nullptr};
+
+void delete_pipelines(void* p) { delete static_cast<const PreprocMap*>(p); }
+void destroy_preproc(void* p)  { rrl_preproc_destroy(static_cast<RRLPreproc>(p)); }
+
+// Must run under an EpochGuard.
+const Attached* attached(RRLHandle handle)
+{
+    const PreprocMap* m = g_pipelines.load(std::memory_order_acquire);
+    if (!m) return nullptr;
+    auto it = m->find(handle);
+    return it != m->end() ? &it->second : nullptr;
+}
+
+// A replacement that normalizes the same elements with running stats
+// shares the stats of the pipeline it replaces: a step still running
+// on the old one updates them too, under the same lock.
+void carry_stats(const RRLPreproc from, RRLPreproc to)
+{
+    if (from->cfg.normalize != RRL_NORM_RUNNING || to->cfg.normalize != RRL_NORM_RUNNING ||
+        from->out_elems != to->out_elems)
+        return;
+    to->stats = from->stats;
+}
+
+// Publishes `pp` for `handle` (NULL detaches it); RRL_ERR_NO_MEMORY if
+// the new map cannot be built, in which case nothing changes.
+int attach(RRLHandle handle, RRLPreproc pp, const RRL_SpaceDesc& native)
+{
+    std::lock_guard<std::mutex> lk(g_pp_mtx);
+    const PreprocMap* cur = g_pipelines.load(std::memory_order_relaxed);
+    const bool present = cur && cur->count(handle);
+    if (!pp && !present) return RRL_SUCCESS;
+    PreprocMap* next = nullptr;
+    RRLPreproc  old  = nullptr;
+    try {
+        next = cur ? new PreprocMap(*cur) : new PreprocMap;
+        auto it = next->find(handle);
+        if (it != next->end()) {
+            old = it->second.pp;
+            if (pp) { carry_stats(old, pp); it->second.pp = pp; }
+            else    next->erase(it);
+        } else {
+            next->emplace(handle, Attached{pp, native});
+        }
+    } catch (const std::bad_alloc&) {
+        delete next;
+        return RRL_ERR_NO_MEMORY;
+    }
+    g_pipelines.store(next, std::memory_order_seq_cst);
+    if (cur) retire(const_cast<PreprocMap*>(cur), delete_pipelines);
+    if (old) retire(old, destroy_preproc);
+    return RRL_SUCCESS;
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLPreproc rrl_preproc_create(const RRL_SpaceDesc* in, const RRL_PreprocConfig* cfg)
+{
+    if (!in || !cfg || cfg->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preproc_create: null arg or bad struct_size");
+        return nullptr;
+    }
+    RRL_PreprocConfig c{};
+    std::memcpy(&c, cfg, std::min(cfg->struct_size, sizeof(c)));
+    c.struct_size = sizeof(c);
+
+    if (!space_ok(*in) || (in->dtype != RRL_DTYPE_UINT8 && in->dtype != RRL_DTYPE_FLOAT32)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preproc_create: input must be a uint8 or float32 space");
+        return nullptr;
+    }
+    const bool image  = in->ndim == 2 || in->ndim == 3;
+    const int  stack  = std::max(c.frame_stack, 1);
+    const bool resize = c.resize_h || c.resize_w;
+    if ((c.grayscale && (in->ndim != 3 || in->shape[2] != 3)) ||
+        (resize && (!image || c.resize_h <= 0 || c.resize_w <= 0)) ||
+        (stack > 1 && in->ndim > 3) || c.frame_stack < 0 || stack > kMaxStack ||
+        c.normalize < RRL_NORM_NONE || c.normalize > RRL_NORM_RUNNING || c.clip < 0.f) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preproc_create: config does not fit the input space");
+        return nullptr;
+    }
+
+    auto* pp = new (std::nothrow) RRLPreprocImpl;
+    if (!pp) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_preproc_create: out of memory");
+        return nullptr;
+    }
+    pp->in    = *in;
+    pp->cfg   = c;
+    pp->u8    = in->dtype == RRL_DTYPE_UINT8;
+    pp->esize = pp->u8 ? 1 : sizeof(float);
+    pp->stack = stack;
+    if (image) {
+        pp->h = in->shape[0];
+        pp->w = in->shape[1];
+        pp->c = in->ndim == 3 ? in->shape[2] : 1;
+    } else {
+        // Vectors (or rank > 3, normalize only): one "pixel" of all elements
+        pp->c = static_cast<int>(std::min<size_t>(rrl_space_bytes(in) / pp->esize, INT_MAX));
+    }
+    pp->fh = resize ? c.resize_h : pp->h;
+    pp->fw = resize ? c.resize_w : pp->w;
+    pp->fc = c.grayscale ? 1 : pp->c;
+
+    RRL_SpaceDesc out = *in;
+    if (image) {
+        out.shape[0] = pp->fh;
+        out.shape[1] = pp->fw;
+        if (in->ndim == 3) out.shape[2] = pp->fc * stack;
+        else if (stack > 1) { out.ndim = 3; out.shape[2] = stack; }
+    } else if (stack > 1) {
+        if (in->shape[0] > INT_MAX / stack) {
+            delete pp;
+            set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preproc_create: stacked space too large");
+            return nullptr;
+        }
+        out.shape[0] = in->shape[0] * stack;
+    }
+    if (c.normalize != RRL_NORM_NONE) out.dtype = RRL_DTYPE_FLOAT32;
+    const size_t out_bytes = rrl_space_bytes(&out);
+    if (!out_bytes) {
+        delete pp;
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preproc_create: output space too large");
+        return nullptr;
+    }
+    pp->out         = out;
+    pp->out_elems   = out_bytes / (c.normalize != RRL_NORM_NONE ? sizeof(float) : pp->esize);
+    pp->frame_bytes = static_cast<size_t>(pp->fh) * pp->fw * pp->fc * pp->esize;
+    if (!image) pp->frame_bytes = rrl_space_bytes(in);
+
+    if (c.normalize == RRL_NORM_SCALE) {
+        const bool unset = c.scale == 0.f && c.offset == 0.f;
+        pp->scale  = unset ? (pp->u8 ? 1.f / 255.f : 1.f) : c.scale;
+        pp->offset = unset ? 0.f : c.offset;
+    }
+    if (c.clip > 0.f) pp->clip = c.clip;
+
+    try {
+        if (c.grayscale && resize) pp->gray.resize(static_cast<size_t>(pp->h) * pp->w * pp->esize);
+        if (resize) {
+            build_taps(pp->w, pp->fw, pp->xtaps, pp->xbeg);
+            build_taps(pp->h, pp->fh, pp->ytaps, pp->ybeg);
+            pp->acc.resize(static_cast<size_t>(pp->w) * pp->fc);
+        }
+        if (c.grayscale || resize || stack > 1) pp->ring.resize(pp->frame_bytes * stack);
+        if (stack > 1 && c.normalize != RRL_NORM_NONE) pp->stacked.resize(pp->frame_bytes * stack);
+        if (c.normalize == RRL_NORM_RUNNING) {
+            pp->stats = std::make_shared<RunningStats>();
+            pp->stats->mean.assign(pp->out_elems, 0.f);
+            pp->stats->var.assign(pp->out_elems, 1.f);
+        }
+    } catch (const std::bad_alloc&) {
+        delete pp;
+        set_error(RRL_ERR_NO_MEMORY, "rrl_preproc_create: out of memory");
+        return nullptr;
+    }
+    return pp;
+}
+
+void rrl_preproc_destroy(RRLPreproc pp)
+{
+    delete pp;
+}
+
+int rrl_preproc_output_space(RRLPreproc pp, RRL_SpaceDesc* out_space)
+{
+    if (!pp || !out_space) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preproc_output_space: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    *out_space = pp->out;
+    return RRL_SUCCESS;
+}
+
+int rrl_preproc_apply(RRLPreproc pp, const void* raw, void* out)
+{
+    if (!pp || !raw || !out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preproc_apply: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    const RRL_PreprocConfig& c = pp->cfg;
+    const bool resize = !pp->xbeg.empty();
+
+    // 1. Frame into its ring slot (or used in place when nothing changes it)
+    const unsigned char* frame = static_cast<const unsigned char*>(raw);
+    if (!pp->ring.empty()) {
+        unsigned char* slot = pp->ring.data() + pp->head * pp->frame_bytes;
+        if (c.grayscale) {
+            unsigned char* g = resize ? pp->gray.data() : slot;
+            to_gray(*pp, frame, g);
+            frame = g;
+        }
+        if (resize) {
+            if (pp->u8) resize_area(*pp, frame, slot);
+            else        resize_area(*pp, reinterpret_cast<const float*>(frame), reinterpret_cast<float*>(slot));
+        } else if (frame != slot) {
+            std::memcpy(slot, frame, pp->frame_bytes);
+        }
+        frame = slot;
+    }
+
+    // 2. Stack: newest frame last; ages past what we have repeat the oldest
+    const bool   norm   = c.normalize != RRL_NORM_NONE;
+    const size_t elems  = pp->out_elems;
+    const unsigned char* src = frame;
+    if (pp->stack > 1) {
+        pp->filled = std::min(pp->filled + 1, pp->stack);
+        const unsigned char* planes[kMaxStack];
+        for (int j = 0; j < pp->stack; ++j) {
+            const int age  = std::min(pp->stack - 1 - j, pp->filled - 1);
+            const int slot = (pp->head - age + pp->stack) % pp->stack;
+            planes[j] = pp->ring.data() + slot * pp->frame_bytes;
+        }
+        unsigned char* dst = norm ? pp->stacked.data() : static_cast<unsigned char*>(out);
+        const size_t px = static_cast<size_t>(pp->fh) * pp->fw;
+        interleave(planes, pp->stack, px, pp->frame_bytes / px, dst);
+        src = dst;
+    }
+    if (!pp->ring.empty()) pp->head = (pp->head + 1) % pp->stack;
+
+    // 3. Normalize
+    if (!norm) {
+        if (src != out) std::memcpy(out, src, elems * pp->esize);
+        return RRL_SUCCESS;
+    }
+    auto* y = static_cast<float*>(out);
+    const float a = c.normalize == RRL_NORM_SCALE ? pp->scale  : 1.f;
+    const float b = c.normalize == RRL_NORM_SCALE ? pp->offset : 0.f;
+    if (pp->u8) to_float(src, y, elems, a, b);
+    else        to_float(reinterpret_cast<const float*>(src), y, elems, a, b);
+    if (c.normalize == RRL_NORM_RUNNING) {
+        RunningStats& st = *pp->stats;
+        std::lock_guard<std::mutex> lk(st.mtx);
+        if (!c.freeze_stats) {
+            ++st.count;
+            running_update(y, st.mean.data(), st.var.data(), elems, 1.f / static_cast<float>(st.count));
+        }
+        running_apply(y, st.mean.data(), st.var.data(), elems, pp->clip);
+    }
+    return RRL_SUCCESS;
+}
+
+void rrl_preproc_reset(RRLPreproc pp)
+{
+    if (pp) pp->filled = 0;
+}
+
+int rrl_preproc_get_stats(RRLPreproc pp, float* mean, float* var, uint64_t* count)
+{
+    if (!pp) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preproc_get_stats: null pipeline");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (pp->cfg.normalize != RRL_NORM_RUNNING) {
+        set_error(RRL_ERR_UNSUPPORTED, "rrl_preproc_get_stats: pipeline has no running stats");
+        return RRL_ERR_UNSUPPORTED;
+    }
+    RunningStats& st = *pp->stats;
+    std::lock_guard<std::mutex> lk(st.mtx);
+    if (mean)  std::memcpy(mean, st.mean.data(), pp->out_elems * sizeof(float));
+    if (var)   std::memcpy(var,  st.var.data(),  pp->out_elems * sizeof(float));
+    if (count) *count = st.count;
+    return RRL_SUCCESS;
+}
+
+int rrl_preproc_set_stats(RRLPreproc pp, const float* mean, const float* var, uint64_t count)
+{
+    if (!pp || !mean || !var) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preproc_set_stats: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (pp->cfg.normalize != RRL_NORM_RUNNING) {
+        set_error(RRL_ERR_UNSUPPORTED, "rrl_preproc_set_stats: pipeline has no running stats");
+        return RRL_ERR_UNSUPPORTED;
+    }
+    RunningStats& st = *pp->stats;
+    std::lock_guard<std::mutex> lk(st.mtx);
+    std::memcpy(st.mean.data(), mean, pp->out_elems * sizeof(float));
+    std::memcpy(st.var.data(),  var,  pp->out_elems * sizeof(float));
+    st.count = count;
+    return RRL_SUCCESS;
+}
+
+int RRL_WEAK rrl_set_preprocess(RRLHandle handle, const RRL_PreprocConfig* cfg)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_set_preprocess: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    // The core reports the transformed space once a pipeline is on, so
+    // a replacement is built from the space recorded at first attach.
+    RRL_SpaceDesc native{};
+    bool had;
+    {
+        EpochGuard g;
+        const Attached* a = attached(handle);
+        had = a != nullptr;
+        if (a) native = a->native;
+    }
+    if (!had) {
+        if (!cfg) return RRL_SUCCESS;
+        int rc = rrl_observation_space(handle, &native);
+        if (rc != RRL_SUCCESS) {
+            set_error(rc, "rrl_set_preprocess: observation_space failed");
+            return rc;
+        }
+    }
+    RRLPreproc pp = nullptr;
+    if (cfg && !(pp = rrl_preproc_create(&native, cfg)))
+        return rrl_last_error();   // message from rrl_preproc_create
+
+    int rc;
+    {
+        BackendGuard be;
+        auto set = be->ext.set_observation_space;
+        rc = set ? set(handle, pp ? &pp->out : nullptr) : RRL_ERR_UNSUPPORTED;
+        if (rc != RRL_SUCCESS)
+            set_error(rc, set ? "rrl_set_preprocess: backend error"
+                              : "rrl_set_preprocess: backend cannot change the observation space");
+    }
+    if (rc != RRL_SUCCESS) {
+        rrl_preproc_destroy(pp);
+        return rc;
+    }
+    rc = attach(handle, pp, native);
+    if (rc != RRL_SUCCESS) {
+        rrl_preproc_destroy(pp);
+        set_error(rc, "rrl_set_preprocess: out of memory");
+    }
+    return rc;
+}
+
+int rrl_preprocess(RRLHandle handle, const void* raw, void* out)
+{
+    RRL_TRACE_SCOPE(RRL_SPAN_PREPROCESS, handle);
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_preprocess: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    EpochGuard g;
+    const Attached* a = attached(handle);
+    if (!a) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preprocess: no pipeline on this handle");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    return rrl_preproc_apply(a->pp, raw, out);
+}
+
+int rrl_preprocess_reset(RRLHandle handle)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_preprocess_reset: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    EpochGuard g;
+    const Attached* a = attached(handle);
+    if (!a) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_preprocess_reset: no pipeline on this handle");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    rrl_preproc_reset(a->pp);
+    return RRL_SUCCESS;
+}
+
+} // extern "C"
+
+namespace rrl { namespace detail {
+
+void preproc_forget(RRLHandle handle)
+{
+    attach(handle, nullptr, RRL_SpaceDesc{});   // a detach OOM leaves the entry; nothing to report to
+}
+
+}} // namespace rrl::detail
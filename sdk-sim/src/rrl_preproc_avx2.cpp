@@ -0,0 +1,68 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_preproc_avx2.cpp  —  AVX2+FMA kernels for rrl_preproc
+//
+//  • Built with -mavx2 -mfma (/arch:AVX2) like rrl_infer_avx2.cpp;
+//    rrl_preproc.cpp calls into it only when cpu_has_avx2().
+//  • Not built at all with RRL_ENABLE_AVX2=OFF or off x86.
+//─────────────────────────────────────────────────────────────
+#include "rrl_preproc_kernels.hpp"
+
+#include <immintrin.h>
+
+namespace rrl { namespace detail {
+
+namespace {
+
+struct VecAvx2 {
+    using T = __m256;
+    static constexpr size_t W = 8;
+    static T    set  (float v)                { return _mm256_set1_ps(v); }
+    static T    load (const float* p)         { return _mm256_loadu_ps(p); }
+    static T    load (const uint8_t* p)       // exactly W bytes
+    {
+        const __m128i q = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(q));
+    }
+    static void store(float* p, T v)          { _mm256_storeu_ps(p, v); }
+    static T    add  (T a, T b)               { return _mm256_add_ps(a, b); }
+    static T    sub  (T a, T b)               { return _mm256_sub_ps(a, b); }
+    static T    mul  (T a, T b)               { return _mm256_mul_ps(a, b); }
+    static T    div  (T a, T b)               { return _mm256_div_ps(a, b); }
+    static T    fma  (T a, T b, T acc)        { return _mm256_fmadd_ps(a, b, acc); }
+    static T    sqrt (T a)                    { return _mm256_sqrt_ps(a); }
+    static T    clamp(T a, T lo, T hi)        { return _mm256_min_ps(_mm256_max_ps(a, lo), hi); }
+};
+
+} // namespace (anonymous)
+
+void to_float_avx2(const uint8_t* s, float* d, size_t n, float a, float b)
+{
+    to_float<VecAvx2>(s, d, n, a, b);
+}
+
+void to_float_avx2(const float* s, float* d, size_t n, float a, float b)
+{
+    to_float<VecAvx2>(s, d, n, a, b);
+}
+
+void accumulate_avx2(float* acc, const uint8_t* s, size_t n, float w)
+{
+    accumulate<VecAvx2>(acc, s, n, w);
+}
+
+void accumulate_avx2(float* acc, const float* s, size_t n, float w)
+{
+    accumulate<VecAvx2>(acc, s, n, w);
+}
+
+void running_update_avx2(const float* x, float* mean, float* var, size_t n, float inv_count)
+{
+    running_update<VecAvx2>(x, mean, var, n, inv_count);
+}
+
+void running_apply_avx2(float* x, const float* mean, const float* var, size_t n, float clip)
+{
+    running_apply<VecAvx2>(x, mean, var, n, clip);
+}
+
+}} // namespace rrl::detail
@@ -0,0 +1,114 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_preproc_kernels.hpp  —  Vector‑width‑generic preproc kernels
+//
+//  • Convert, resize‑accumulate and running‑stat loops over a `V`
+//    vector type: included by rrl_preproc.cpp (NEON, or VecScalar)
+//    and by rrl_preproc_avx2.cpp, which alone is built with AVX2
+//    flags.
+//  • Internal linkage throughout, as in rrl_gemm.hpp, and no std::
+//    templates: nothing compiled for AVX2 can be merged into the
+//    baseline build.
+//─────────────────────────────────────────────────────────────
+#ifndef RRL_PREPROC_KERNELS_HPP
+#define RRL_PREPROC_KERNELS_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace rrl { namespace detail {
+
+// Runtime‑selected x86 kernels (rrl_preproc_avx2.cpp); only call them
+// when cpu_has_avx2().
+#if defined(RRL_HAVE_AVX2_KERNELS)
+void to_float_avx2      (const uint8_t* s, float* d, size_t n, float a, float b);
+void to_float_avx2      (const float*   s, float* d, size_t n, float a, float b);
+void accumulate_avx2    (float* acc, const uint8_t* s, size_t n, float w);
+void accumulate_avx2    (float* acc, const float*   s, size_t n, float w);
+void running_update_avx2(const float* x, float* mean, float* var, size_t n, float inv_count);
+void running_apply_avx2 (float* x, const float* mean, const float* var, size_t n, float clip);
+#endif
+
+namespace {
+
+constexpr float kVarEps = 1e-8f;
+
+// One lane: the portable path, left to the compiler to vectorise.
+struct VecScalar {
+    using T = float;
+    static constexpr size_t W = 1;
+    static T    set  (float v)                { return v; }
+    static T    load (const float* p)         { return *p; }
+    static T    load (const uint8_t* p)       { return static_cast<float>(*p); }
+    static void store(float* p, T v)          { *p = v; }
+    static T    add  (T a, T b)               { return a + b; }
+    static T    sub  (T a, T b)               { return a - b; }
+    static T    mul  (T a, T b)               { return a * b; }
+    static T    div  (T a, T b)               { return a / b; }
+    static T    fma  (T a, T b, T acc)        { return a * b + acc; }
+    static T    sqrt (T a)                    { return sqrtf(a); }
+    static T    clamp(T a, T lo, T hi)        { return a < lo ? lo : a > hi ? hi : a; }
+};
+
+// d = s * a + b
+template <class V, typename Src>
+void to_float(const Src* s, float* d, size_t n, float a, float b)
+{
+    size_t i = 0;
+    const auto va = V::set(a), vb = V::set(b);
+    for (; i + V::W <= n; i += V::W) V::store(d + i, V::fma(V::load(s + i), va, vb));
+    for (; i < n; ++i) d[i] = static_cast<float>(s[i]) * a + b;
+}
+
+// acc += s * w  (one tap of the vertical resize pass)
+template <class V, typename Src>
+void accumulate(float* acc, const Src* s, size_t n, float w)
+{
+    size_t i = 0;
+    const auto vw = V::set(w);
+    for (; i + V::W <= n; i += V::W) V::store(acc + i, V::fma(V::load(s + i), vw, V::load(acc + i)));
+    for (; i < n; ++i) acc[i] += static_cast<float>(s[i]) * w;
+}
+
+// Welford with the variance kept normalised (not as M2), so float
+// stays accurate over long runs:  m' = m + d/n,  v' = v + (d·(x−m') − v)/n
+template <class V>
+void running_update(const float* x, float* mean, float* var, size_t n, float inv_count)
+{
+    size_t i = 0;
+    const auto vinv = V::set(inv_count);
+    for (; i + V::W <= n; i += V::W) {
+        const auto xv = V::load(x + i), m = V::load(mean + i), v = V::load(var + i);
+        const auto d  = V::sub(xv, m);
+        const auto m2 = V::fma(d, vinv, m);
+        V::store(mean + i, m2);
+        V::store(var + i, V::fma(V::sub(V::mul(d, V::sub(xv, m2)), v), vinv, v));
+    }
+    for (; i < n; ++i) {
+        const float d  = x[i] - mean[i];
+        const float m2 = mean[i] + d * inv_count;
+        mean[i] = m2;
+        var[i] += (d * (x[i] - m2) - var[i]) * inv_count;
+    }
+}
+
+// x = clamp((x − mean) / √(var + ε), ±clip)
+template <class V>
+void running_apply(float* x, const float* mean, const float* var, size_t n, float clip)
+{
+    size_t i = 0;
+    const auto eps = V::set(kVarEps), lo = V::set(-clip), hi = V::set(clip);
+    for (; i + V::W <= n; i += V::W) {
+        const auto z = V::div(V::sub(V::load(x + i), V::load(mean + i)),
+                              V::sqrt(V::add(V::load(var + i), eps)));
+        V::store(x + i, V::clamp(z, lo, hi));
+    }
+    for (; i < n; ++i)
+        x[i] = VecScalar::clamp((x[i] - mean[i]) / sqrtf(var[i] + kVarEps), -clip, clip);
+}
+
+} // namespace (anonymous)
+
+}} // namespace rrl::detail
+
+#endif // RRL_PREPROC_KERNELS_HPP
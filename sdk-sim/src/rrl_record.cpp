@@ -0,0 +1,558 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_record.cpp  —  Trajectory recorder
+//
+//  • Each recording thread gets a lane: `chunks_per_thread` chunk
+//    blocks allocated on its first row, each holding the five
+//    columns for rows_per_chunk rows.  A row is five memcpys into
+//    the lane's current chunk under the lane's own mutex, which only
+//    the flush thread (returning a written chunk) ever contends.
+//  • The flush thread owns the file: it compresses each column of a
+//    full chunk into reused scratch, appends the chunk and hands the
+//    block back to its lane.
+//  • Lanes live as long as the recorder in a map keyed by thread id;
+//    threads find theirs through a small thread-local cache keyed by
+//    a per-recorder serial (a recorder at a reused address never
+//    matches) and fall back to the map, so a thread that records into
+//    more recorders than the cache holds never gets a second lane.
+//─────────────────────────────────────────────────────────────
+#include "rrl_record.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if !defined(_WIN32)
+#  include <limits>
+#  include <sys/types.h>   // off_t
+#endif
+
+#if defined(RRL_HAVE_ZSTD)
+#  include <zstd.h>
+#endif
+#if defined(RRL_HAVE_LZ4)
+#  include <lz4.h>
+#endif
+
+using namespace rrl::detail;
+
+namespace {
+
+constexpr uint32_t kDefaultRows   = 1024;
+constexpr uint32_t kDefaultChunks = 4;
+
+constexpr size_t align_up(size_t n) { return (n + RRL_RECORD_ALIGN - 1) / RRL_RECORD_ALIGN * RRL_RECORD_ALIGN; }
+
+struct Lane;
+
+struct Chunk {
+    unsigned char* block = nullptr;   // columns at RRLRecorderImpl::col_off
+    uint32_t       rows  = 0;
+    Lane*          lane  = nullptr;
+    Chunk*         next  = nullptr;   // flush queue link
+    ~Chunk() { if (block) ::operator delete(block, std::align_val_t{RRL_RECORD_ALIGN}); }
+};
+
+struct Lane {
+    std::mutex                          mtx;
+    Chunk*                              cur = nullptr;
+    std::vector<Chunk*>                 free;   // capacity = all chunks: push never allocates
+    std::vector<std::unique_ptr<Chunk>> owned;
+};
+
+std::atomic<uint64_t> g_serial{1};
+
+struct LaneRef {
+    uint64_t serial;
+    Lane*    lane;
+};
+constexpr size_t kLaneCache = 8;
+thread_local LaneRef t_lanes[kLaneCache] = {};
+thread_local size_t  t_next = 0;
+
+} // namespace (anonymous)
+
+struct RRLRecorderImpl {
+    uint64_t          serial = g_serial.fetch_add(1, std::memory_order_relaxed);
+    RRL_RecordHeader  header{};
+    uint32_t          rows_per_chunk = kDefaultRows;
+    uint32_t          chunks = kDefaultChunks;
+    int               compression = RRL_WIRE_COMP_NONE;
+    int               level = 1;
+    size_t            elem[RRL_RECORD_COLUMNS] = {};
+    size_t            col_off[RRL_RECORD_COLUMNS] = {};
+    size_t            block_bytes = 0;
+
+    std::FILE*        file = nullptr;
+
+    std::mutex lanes_mtx;
+    std::unordered_map<std::thread::id, std::unique_ptr<Lane>> lanes;
+
+    std::mutex              q_mtx;
+    std::condition_variable q_cv;      // flush thread: work or stop
+    std::condition_variable idle_cv;   // rrl_recorder_flush: queue drained
+    Chunk*                  head = nullptr;   // flush queue, oldest first
+    Chunk*                  tail = nullptr;
+    bool                    writing = false;
+    bool                    stop    = false;
+    std::thread             flusher;
+
+    std::atomic<uint64_t> rows{0}, dropped{0}, bytes{0};
+    std::atomic<int>      io_error{RRL_SUCCESS};
+
+    // Flush thread only
+    std::vector<unsigned char> scratch[RRL_RECORD_COLUMNS];
+#if defined(RRL_HAVE_ZSTD)
+    ZSTD_CCtx* cctx = nullptr;
+#endif
+
+    ~RRLRecorderImpl() {
+        if (file) std::fclose(file);
+#if defined(RRL_HAVE_ZSTD)
+        ZSTD_freeCCtx(cctx);
+#endif
+    }
+};
+
+namespace {
+
+size_t compress_bound(const RRLRecorderImpl& r, size_t n)
+{
+    (void)n;
+    switch (r.compression) {
+#if defined(RRL_HAVE_ZSTD)
+    case RRL_WIRE_COMP_ZSTD: return ZSTD_compressBound(n);
+#endif
+#if defined(RRL_HAVE_LZ4)
+    case RRL_WIRE_COMP_LZ4:
+        return n <= static_cast<size_t>(LZ4_MAX_INPUT_SIZE) ? static_cast<size_t>(LZ4_compressBound(static_cast<int>(n))) : 0;
+#endif
+    default: return 0;
+    }
+}
+
+// Compressed size, or 0 if it failed or would not shrink.
+size_t compress(RRLRecorderImpl& r, const unsigned char* src, size_t n, unsigned char* dst, size_t cap)
+{
+    (void)src; (void)n; (void)dst; (void)cap;
+    switch (r.compression) {
+#if defined(RRL_HAVE_ZSTD)
+    case RRL_WIRE_COMP_ZSTD: {
+        const size_t c = ZSTD_compressCCtx(r.cctx, dst, cap, src, n, r.level);
+        return ZSTD_isError(c) || c >= n ? 0 : c;
+    }
+#endif
+#if defined(RRL_HAVE_LZ4)
+    case RRL_WIRE_COMP_LZ4: {
+        if (n > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) return 0;
+        const int cap_i = cap > static_cast<size_t>(INT32_MAX) ? INT32_MAX : static_cast<int>(cap);
+        const int c = LZ4_compress_default(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst),
+                                           static_cast<int>(n), cap_i);
+        return c <= 0 || static_cast<size_t>(c) >= n ? 0 : static_cast<size_t>(c);
+    }
+#endif
+    default: return 0;
+    }
+}
+
+bool write_all(std::FILE* f, const void* p, size_t n)
+{
+    return std::fwrite(p, 1, n, f) == n;
+}
+
+bool write_chunk(RRLRecorderImpl& r, const Chunk& c)
+{
+    static const unsigned char zeros[RRL_RECORD_ALIGN] = {};
+    RRL_RecordChunk h{};
+    h.magic = RRL_RECORD_CHUNK;
+    h.rows  = c.rows;
+    const void* data[RRL_RECORD_COLUMNS];
+    uint64_t off = sizeof(h);
+    for (int k = 0; k < RRL_RECORD_COLUMNS; ++k) {
+        const unsigned char* src = c.block + r.col_off[k];
+        const size_t raw = c.rows * r.elem[k];
+        RRL_RecordColumn& col = h.column[k];
+        col.offset = off;
+        col.bytes  = raw;
+        data[k]    = src;
+        if (r.compression != RRL_WIRE_COMP_NONE) {
+            std::vector<unsigned char>& s = r.scratch[k];
+            const size_t n = compress(r, src, raw, s.data(), s.size());
+            if (n) {
+                col.bytes       = n;
+                col.compression = static_cast<uint32_t>(r.compression);
+                data[k]         = s.data();
+            }
+        }
+        off = align_up(off + col.bytes);
+    }
+    h.chunk_bytes = off;
+    if (!write_all(r.file, &h, sizeof(h))) return false;
+    for (int k = 0; k < RRL_RECORD_COLUMNS; ++k) {
+        const size_t n = static_cast<size_t>(h.column[k].bytes);
+        if (!write_all(r.file, data[k], n) || !write_all(r.file, zeros, align_up(n) - n)) return false;
+    }
+    // One flush per chunk: readers mapping the file see whole chunks.
+    if (std::fflush(r.file) != 0) return false;
+    r.rows.fetch_add(c.rows, std::memory_order_relaxed);
+    r.bytes.fetch_add(h.chunk_bytes, std::memory_order_relaxed);
+    return true;
+}
+
+void flush_loop(RRLRecorderImpl* r)
+{
+    std::unique_lock<std::mutex> lk(r->q_mtx);
+    for (;;) {
+        r->q_cv.wait(lk, [r] { return r->stop || r->head; });
+        if (!r->head) return;   // stop, and nothing left to write
+        Chunk* c = r->head;
+        if (!(r->head = c->next)) r->tail = nullptr;
+        c->next = nullptr;
+        r->writing = true;
+        lk.unlock();
+        if (r->io_error.load(std::memory_order_relaxed) == RRL_SUCCESS && !write_chunk(*r, *c))
+            r->io_error.store(RRL_ERR_IO, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> ll(c->lane->mtx);
+            c->rows = 0;
+            c->lane->free.push_back(c);
+        }
+        lk.lock();
+        r->writing = false;
+        if (!r->head) r->idle_cv.notify_all();
+    }
+}
+
+void enqueue(RRLRecorderImpl& r, Chunk* c)
+{
+    {
+        std::lock_guard<std::mutex> lk(r.q_mtx);
+        (r.tail ? r.tail->next : r.head) = c;
+        r.tail = c;
+    }
+    r.q_cv.notify_one();
+}
+
+// The calling thread's lane, created (and its chunks allocated) on first use.
+Lane* lane_for(RRLRecorderImpl& r)
+{
+    for (const LaneRef& ref : t_lanes)
+        if (ref.serial == r.serial) return ref.lane;
+    const std::thread::id self = std::this_thread::get_id();
+    Lane* l = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(r.lanes_mtx);
+        auto it = r.lanes.find(self);
+        if (it != r.lanes.end()) l = it->second.get();
+    }
+    if (l) {
+        t_lanes[t_next++ % kLaneCache] = LaneRef{r.serial, l};
+        return l;
+    }
+    try {
+        std::unique_ptr<Lane> lane(new Lane);
+        lane->owned.reserve(r.chunks);
+        lane->free.reserve(r.chunks);
+        for (uint32_t i = 0; i < r.chunks; ++i) {
+            std::unique_ptr<Chunk> c(new Chunk);
+            c->block = static_cast<unsigned char*>(::operator new(r.block_bytes, std::align_val_t{RRL_RECORD_ALIGN}));
+            c->lane  = lane.get();
+            lane->free.push_back(c.get());
+            lane->owned.push_back(std::move(c));
+        }
+        l = lane.get();
+        std::lock_guard<std::mutex> lk(r.lanes_mtx);
+        r.lanes.emplace(self, std::move(lane));   // only this thread adds its own id
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+    t_lanes[t_next++ % kLaneCache] = LaneRef{r.serial, l};
+    return l;
+}
+
+// Caller holds lane.mtx.  Row slot in the current chunk, or nullptr if none is free.
+Chunk* current(Lane& lane)
+{
+    if (!lane.cur && !lane.free.empty()) {
+        lane.cur = lane.free.back();
+        lane.free.pop_back();
+    }
+    return lane.cur;
+}
+
+void put_row(RRLRecorderImpl& r, Chunk& c, uint32_t env, const void* obs, const void* action,
+             float reward, uint8_t done)
+{
+    const size_t i = c.rows;
+    std::memcpy(c.block + r.col_off[RRL_RECORD_ENV]    + i * 4, &env, 4);
+    std::memcpy(c.block + r.col_off[RRL_RECORD_OBS]    + i * r.elem[RRL_RECORD_OBS], obs, r.elem[RRL_RECORD_OBS]);
+    std::memcpy(c.block + r.col_off[RRL_RECORD_ACTION] + i * r.elem[RRL_RECORD_ACTION], action, r.elem[RRL_RECORD_ACTION]);
+    std::memcpy(c.block + r.col_off[RRL_RECORD_REWARD] + i * 4, &reward, 4);
+    c.block[r.col_off[RRL_RECORD_DONE] + i] = done;
+}
+
+// Caller holds lane.mtx: ship the current chunk if it is full (or `any` rows and `force`).
+void retire_current(RRLRecorderImpl& r, Lane& lane, bool force)
+{
+    Chunk* c = lane.cur;
+    if (!c || !c->rows || (!force && c->rows < r.rows_per_chunk)) return;
+    lane.cur = nullptr;
+    enqueue(r, c);
+}
+
+bool same_space(const RRL_WireSpace& a, const RRL_WireSpace& b)
+{
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// fseek() takes a long, 32 bits on Windows: recordings grow past 2 GB.
+bool seek_to(std::FILE* f, uint64_t pos)
+{
+#if defined(_WIN32)
+    return pos <= static_cast<uint64_t>(INT64_MAX) && _fseeki64(f, static_cast<__int64>(pos), SEEK_SET) == 0;
+#else
+    return pos <= static_cast<uint64_t>(std::numeric_limits<off_t>::max()) &&
+           fseeko(f, static_cast<off_t>(pos), SEEK_SET) == 0;
+#endif
+}
+
+// Open `path` for appending after its last whole chunk, or start it
+// if it is missing or empty (`existed` stays false: no header yet).
+// Nothing else is truncated: a file that is not a recording of the
+// same spaces is refused.
+int open_append(RRLRecorderImpl& r, const char* path, bool& existed)
+{
+    existed = false;
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec == std::errc::no_such_file_or_directory) {
+        r.file = std::fopen(path, "wbx");   // fails if it appeared meanwhile
+        return r.file ? RRL_SUCCESS : RRL_ERR_IO;
+    }
+    if (ec) return RRL_ERR_IO;
+    if (size == 0) {
+        r.file = std::fopen(path, "r+b");
+        return r.file ? RRL_SUCCESS : RRL_ERR_IO;
+    }
+    std::FILE* f = std::fopen(path, "rb");
+    if (!f) return RRL_ERR_IO;
+    RRL_RecordHeader h{};
+    const bool ours = std::fread(&h, sizeof(h), 1, f) == 1 && h.magic == RRL_RECORD_MAGIC;
+    const bool same = ours && h.version == RRL_RECORD_VERSION && h.columns == RRL_RECORD_COLUMNS &&
+                      h.obs_bytes == r.header.obs_bytes && h.action_bytes == r.header.action_bytes &&
+                      same_space(h.obs, r.header.obs) && same_space(h.action, r.header.action);
+    uint64_t end = sizeof(h), rows = 0;
+    RRL_RecordChunk c;
+    while (same && std::fread(&c, sizeof(c), 1, f) == 1 && c.magic == RRL_RECORD_CHUNK &&
+           c.chunk_bytes >= sizeof(c) && c.chunk_bytes <= size - end) {   // else a torn tail
+        end  += c.chunk_bytes;
+        rows += c.rows;
+        if (!seek_to(f, end)) break;
+    }
+    std::fclose(f);
+    if (!same) return RRL_ERR_INVALID_ARGUMENT;
+    std::filesystem::resize_file(path, end, ec);
+    if (ec || !(r.file = std::fopen(path, "ab"))) return RRL_ERR_IO;
+    r.rows.store(rows, std::memory_order_relaxed);
+    r.bytes.store(end, std::memory_order_relaxed);
+    existed = true;
+    return RRL_SUCCESS;
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLRecorder rrl_recorder_create(const char* path, const RRL_RecorderConfig* cfg)
+{
+    if (!path || !*path || !cfg || cfg->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_recorder_create: null path / config or bad struct_size");
+        return nullptr;
+    }
+    RRL_RecorderConfig c{};
+    std::memcpy(&c, cfg, std::min(cfg->struct_size, sizeof(c)));
+    RRL_WireSchema schema;
+    if (!c.obs_space || !c.action_space || rrl_wire_schema(c.obs_space, c.action_space, &schema) != RRL_SUCCESS) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_recorder_create: missing or invalid space");
+        return nullptr;
+    }
+    if (c.compression != RRL_WIRE_COMP_NONE && !rrl_wire_codec_available(c.compression)) {
+        set_error(RRL_ERR_UNSUPPORTED, "rrl_recorder_create: compression not built in");
+        return nullptr;
+    }
+    std::unique_ptr<RRLRecorderImpl> r(new (std::nothrow) RRLRecorderImpl);
+    if (!r) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_recorder_create: out of memory");
+        return nullptr;
+    }
+    RRL_RecordHeader& h = r->header;
+    h.magic        = RRL_RECORD_MAGIC;
+    h.version      = RRL_RECORD_VERSION;
+    h.columns      = RRL_RECORD_COLUMNS;
+    h.obs_bytes    = schema.obs_bytes;
+    h.action_bytes = schema.action_bytes;
+    h.obs          = schema.obs;
+    h.action       = schema.action;
+    r->rows_per_chunk = c.rows_per_chunk ? c.rows_per_chunk : kDefaultRows;
+    r->chunks         = c.chunks_per_thread ? c.chunks_per_thread : kDefaultChunks;
+    r->compression    = c.compression;
+    r->level          = c.level ? c.level : 1;
+    r->elem[RRL_RECORD_ENV]    = 4;
+    r->elem[RRL_RECORD_OBS]    = schema.obs_bytes;
+    r->elem[RRL_RECORD_ACTION] = schema.action_bytes;
+    r->elem[RRL_RECORD_REWARD] = 4;
+    r->elem[RRL_RECORD_DONE]   = 1;
+    for (int k = 0; k < RRL_RECORD_COLUMNS; ++k) {
+        r->col_off[k] = r->block_bytes;
+        r->block_bytes = align_up(r->block_bytes + r->rows_per_chunk * r->elem[k]);
+    }
+
+    try {
+        for (int k = 0; k < RRL_RECORD_COLUMNS; ++k)
+            r->scratch[k].resize(compress_bound(*r, r->rows_per_chunk * r->elem[k]));
+    } catch (const std::bad_alloc&) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_recorder_create: out of memory");
+        return nullptr;
+    }
+#if defined(RRL_HAVE_ZSTD)
+    if (r->compression == RRL_WIRE_COMP_ZSTD && !(r->cctx = ZSTD_createCCtx())) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_recorder_create: out of memory");
+        return nullptr;
+    }
+#endif
+
+    bool existed = false;
+    if (c.append) {
+        const int rc = open_append(*r, path, existed);
+        if (rc != RRL_SUCCESS) {
+            set_error(rc, rc == RRL_ERR_IO ? "rrl_recorder_create: cannot open the recording"
+                                           : "rrl_recorder_create: not a recording with these spaces");
+            return nullptr;
+        }
+    } else {
+        r->file = std::fopen(path, "wb");
+    }
+    if (!existed) {
+        if (!r->file || !write_all(r->file, &h, sizeof(h)) || std::fflush(r->file) != 0) {
+            set_error(RRL_ERR_IO, "rrl_recorder_create: cannot create the file");
+            return nullptr;
+        }
+        r->bytes.store(sizeof(h), std::memory_order_relaxed);
+    }
+    try {
+        RRLRecorderImpl* raw = r.get();
+        r->flusher = std::thread([raw] { flush_loop(raw); });
+    } catch (const std::exception&) {
+        set_error(RRL_ERR_IO, "rrl_recorder_create: cannot start the flush thread");
+        return nullptr;
+    }
+    return r.release();
+}
+
+void rrl_recorder_destroy(RRLRecorder rec)
+{
+    if (!rec) return;
+    rrl_recorder_flush(rec);
+    {
+        std::lock_guard<std::mutex> lk(rec->q_mtx);
+        rec->stop = true;
+    }
+    rec->q_cv.notify_all();
+    rec->flusher.join();
+    delete rec;
+}
+
+int rrl_record(RRLRecorder rec, uint32_t env, const void* obs, const void* action,
+               float reward, uint8_t done)
+{
+    return rrl_record_batch(rec, env, 1, obs, 0, action, 0, &reward, &done);
+}
+
+int rrl_record_batch(RRLRecorder rec, uint32_t first_env, size_t count,
+                     const void* obs, size_t obs_stride,
+                     const void* actions, size_t action_stride,
+                     const float* rewards, const uint8_t* dones)
+{
+    if (!rec || (count && (!obs || !actions))) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_record: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (rec->io_error.load(std::memory_order_relaxed) != RRL_SUCCESS) {
+        set_error(RRL_ERR_IO, "rrl_record: writing the recording failed");
+        return RRL_ERR_IO;
+    }
+    Lane* lane = lane_for(*rec);
+    if (!lane) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_record: out of memory for this thread's chunks");
+        return RRL_ERR_NO_MEMORY;
+    }
+    const size_t os = obs_stride ? obs_stride : rec->elem[RRL_RECORD_OBS];
+    const size_t as = action_stride ? action_stride : rec->elem[RRL_RECORD_ACTION];
+    size_t lost = 0;
+    {
+        std::lock_guard<std::mutex> lk(lane->mtx);
+        for (size_t i = 0; i < count; ++i) {
+            Chunk* c = current(*lane);
+            if (!c) { lost = count - i; break; }
+            put_row(*rec, *c, first_env + static_cast<uint32_t>(i),
+                    static_cast<const unsigned char*>(obs) + i * os,
+                    static_cast<const unsigned char*>(actions) + i * as,
+                    rewards ? rewards[i] : 0.0f, dones ? dones[i] : uint8_t(0));
+            ++c->rows;
+            retire_current(*rec, *lane, false);
+        }
+    }
+    if (lost) {
+        rec->dropped.fetch_add(lost, std::memory_order_relaxed);
+        set_error(RRL_ERR_EXHAUSTED, "rrl_record: every chunk of this thread is waiting to be written");
+        return RRL_ERR_EXHAUSTED;
+    }
+    return RRL_SUCCESS;
+}
+
+int rrl_recorder_flush(RRLRecorder rec)
+{
+    if (!rec) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_recorder_flush: null recorder");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    {
+        std::lock_guard<std::mutex> lk(rec->lanes_mtx);
+        for (const auto& kv : rec->lanes) {
+            std::lock_guard<std::mutex> ll(kv.second->mtx);
+            retire_current(*rec, *kv.second, true);
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lk(rec->q_mtx);
+        rec->idle_cv.wait(lk, [rec] { return !rec->head && !rec->writing; });
+    }
+    const int rc = rec->io_error.load(std::memory_order_relaxed);
+    if (rc != RRL_SUCCESS) set_error(rc, "rrl_recorder_flush: writing the recording failed");
+    return rc;
+}
+
+int rrl_recorder_stats(RRLRecorder rec, RRL_RecorderStats* out)
+{
+    if (!rec || !out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_recorder_stats: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    out->rows    = rec->rows.load(std::memory_order_relaxed);
+    out->dropped = rec->dropped.load(std::memory_order_relaxed);
+    out->bytes   = rec->bytes.load(std::memory_order_relaxed);
+    return RRL_SUCCESS;
+}
+
+} // extern "C"
@@ -0,0 +1,297 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_sched.cpp  —  Decision-rate scheduler
+//
+//  • A schedule is plain per-handle state touched only by the game
+//    thread: the held action (and the one it eases from), the reward
+//    sum of the open interval and whether a step is in flight.
+//  • While a step is in flight each tick makes one rrl_poll(); the
+//    first 1 copies the action out of the bound act buffer.
+//  • k is re-derived at every decision, so rrl_get_stats_v2() runs at
+//    the decision rate, not the frame rate, on the game thread: it is
+//    the one call whose cost is the backend's (a hook may take a
+//    lock), and `fixed` never makes it.  Without stats (stub or
+//    backend error) the round trip this schedule saw itself, from
+//    decision to delivered action, is used instead.
+//─────────────────────────────────────────────────────────────
+#include "rrl_sched.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+using namespace rrl::detail;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr double   kDefaultHz   = 20.0;
+constexpr unsigned kDefaultMax  = 32;
+constexpr double   kRttHeadroom = 1.25;   // one round trip plus a quarter
+constexpr double   kTickAlpha   = 1.0 / 16;
+
+} // namespace (anonymous)
+
+struct RRLSchedImpl {
+    RRLHandle       handle = nullptr;
+    RRL_SchedConfig cfg{};
+    RRL_SpaceDesc   space{};
+    size_t          action_bytes = 0;
+    bool            lerp = false;
+
+    std::vector<unsigned char> target;     // last delivered action
+    std::vector<unsigned char> from;       // LERP: what was applied when it arrived
+    std::vector<unsigned char> applied;    // LERP: last frame's action
+    unsigned ramp_len = 1, ramp_pos = 0;
+    bool     have_action = false;
+
+    // Open interval
+    bool     started   = false;
+    bool     in_flight = false;
+    bool     late_hit  = false;            // this interval already counted late
+    bool     done      = false;
+    uint32_t frames    = 0;
+    float    reward    = 0.f;
+    float    discount  = 1.f;
+    uint64_t decided_at = 0;               // tick count of the last decision
+
+    // Sizing k
+    unsigned   interval = 1;
+    unsigned   extra    = 0;               // frames added for late actions
+    double     tick_hz  = 0.0;
+    double     tick_dt  = 0.0;             // EWMA of the frame time (s)
+    Clock::time_point last_tick{};
+    double     rtt_ms   = 0.0;
+    double     seen_rtt_ms = 0.0;          // decision → action, as polled
+    bool       stats_ok = true;
+
+    uint64_t ticks = 0, decisions = 0, late = 0;
+};
+
+namespace {
+
+template <typename T>
+void ease(T* out, const T* a, const T* b, size_t n, double t)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = static_cast<T>(a[i] + (b[i] - a[i]) * t);
+}
+
+void apply_action(RRLSchedImpl& s, void* action)
+{
+    if (!s.lerp || s.ramp_pos >= s.ramp_len) {
+        std::memcpy(action, s.target.data(), s.action_bytes);
+        if (s.lerp) std::memcpy(s.applied.data(), s.target.data(), s.action_bytes);
+        return;
+    }
+    const double t = static_cast<double>(++s.ramp_pos) / s.ramp_len;
+    if (s.space.dtype == RRL_DTYPE_FLOAT32)
+        ease(reinterpret_cast<float*>(s.applied.data()), reinterpret_cast<const float*>(s.from.data()),
+             reinterpret_cast<const float*>(s.target.data()), s.action_bytes / sizeof(float), t);
+    else
+        ease(reinterpret_cast<double*>(s.applied.data()), reinterpret_cast<const double*>(s.from.data()),
+             reinterpret_cast<const double*>(s.target.data()), s.action_bytes / sizeof(double), t);
+    std::memcpy(action, s.applied.data(), s.action_bytes);
+}
+
+void measure_tick(RRLSchedImpl& s)
+{
+    if (s.cfg.tick_hz > 0) return;
+    const Clock::time_point now = Clock::now();
+    if (s.ticks > 1) {
+        const double dt = std::chrono::duration<double>(now - s.last_tick).count();
+        s.tick_dt = s.tick_dt > 0 ? s.tick_dt + (dt - s.tick_dt) * kTickAlpha : dt;
+        if (s.tick_dt > 0) s.tick_hz = 1.0 / s.tick_dt;
+    }
+    s.last_tick = now;
+}
+
+// k for the interval the decision being made now opens.
+void resize(RRLSchedImpl& s)
+{
+    const unsigned lo = s.cfg.min_skip ? s.cfg.min_skip : 1;
+    const unsigned hi = std::max(lo, s.cfg.max_skip ? s.cfg.max_skip : kDefaultMax);
+    const double   hz = s.cfg.decision_hz > 0 ? s.cfg.decision_hz : kDefaultHz;
+    double k = s.tick_hz > 0 ? std::round(s.tick_hz / hz) : 1.0;
+    if (!s.cfg.fixed) {
+        double rtt = 0.0;
+        if (s.stats_ok) {
+            RRL_StatsV2 st{};
+            st.struct_size = sizeof(st);
+            if (rrl_get_stats_v2(s.handle, &st) == RRL_SUCCESS)
+                rtt = st.latency_p90_ms > 0 ? st.latency_p90_ms : st.base.latency_ms;
+            else
+                s.stats_ok = false;   // not asked again
+        }
+        if (rtt <= 0) rtt = s.seen_rtt_ms;
+        s.rtt_ms = rtt;
+        if (s.tick_hz > 0) k = std::max(k, std::ceil(rtt / 1000.0 * kRttHeadroom * s.tick_hz));
+        k += s.extra;
+    }
+    s.interval = static_cast<unsigned>(std::clamp(k, static_cast<double>(lo), static_cast<double>(hi)));
+}
+
+void deliver(RRLSchedImpl& s)
+{
+    s.in_flight = false;
+    const uint64_t waited = s.ticks - s.decided_at;   // frames, this one included
+    if (s.tick_hz > 0) s.seen_rtt_ms = static_cast<double>(waited) * 1000.0 / s.tick_hz;
+    // Back with a frame to spare: give one back of what lateness added.
+    if (waited + 1 < s.interval && s.extra) --s.extra;
+    if (s.lerp) {
+        // The first action is applied at once: there is nothing to ease from.
+        std::memcpy(s.from.data(), s.applied.data(), s.action_bytes);
+        s.ramp_len = s.cfg.ramp ? s.cfg.ramp : s.interval;
+        s.ramp_pos = s.have_action ? 0 : s.ramp_len;
+    }
+    s.have_action = true;
+    std::memcpy(s.target.data(), s.cfg.act, s.action_bytes);
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLSched rrl_sched_create(RRLHandle handle, const RRL_SchedConfig* cfg)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_sched_create: null handle");
+        return nullptr;
+    }
+    if (!cfg || cfg->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_sched_create: null config or bad struct_size");
+        return nullptr;
+    }
+    RRL_SchedConfig c{};
+    std::memcpy(&c, cfg, std::min(cfg->struct_size, sizeof(c)));
+    if (!c.act || c.decision_hz < 0 || c.tick_hz < 0 || c.gamma < 0 || c.gamma > 1 ||
+        (c.hold != RRL_SCHED_REPEAT && c.hold != RRL_SCHED_LERP)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_sched_create: missing act buffer or bad rate / gamma / hold");
+        return nullptr;
+    }
+    RRL_SpaceDesc space{};
+    int rc = rrl_action_space(handle, &space);
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, "rrl_sched_create: action_space failed");
+        return nullptr;
+    }
+    const size_t bytes = rrl_space_bytes(&space);
+    if (!bytes) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_sched_create: invalid action space");
+        return nullptr;
+    }
+    const bool lerp = c.hold == RRL_SCHED_LERP;
+    if (lerp && space.dtype != RRL_DTYPE_FLOAT32 && space.dtype != RRL_DTYPE_FLOAT64) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_sched_create: RRL_SCHED_LERP needs float actions");
+        return nullptr;
+    }
+
+    std::unique_ptr<RRLSchedImpl> s(new (std::nothrow) RRLSchedImpl);
+    if (!s) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_sched_create: out of memory");
+        return nullptr;
+    }
+    s->handle       = handle;
+    s->cfg          = c;
+    s->space        = space;
+    s->action_bytes = bytes;
+    s->lerp         = lerp;
+    s->tick_hz      = c.tick_hz;
+    if (s->cfg.gamma == 0) s->cfg.gamma = 1.f;
+    try {
+        s->target.assign(bytes, 0);
+        if (lerp) {
+            s->from.assign(bytes, 0);
+            s->applied.assign(bytes, 0);
+        }
+    } catch (const std::bad_alloc&) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_sched_create: out of memory");
+        return nullptr;
+    }
+    return s.release();
+}
+
+void rrl_sched_destroy(RRLSched sched)
+{
+    delete sched;
+}
+
+int rrl_sched_tick(RRLSched sched, float reward, uint8_t done, void* action, RRL_SchedTick* out)
+{
+    if (!sched) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_sched_tick: null schedule");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    if (!action || !out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_sched_tick: null action / out");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRLSchedImpl& s = *sched;
+    ++s.ticks;
+    measure_tick(s);
+
+    *out = RRL_SchedTick{};
+    if (s.in_flight) {
+        const int ready = rrl_poll(s.handle);
+        if (ready < 0) return ready;   // error already recorded
+        if (ready) {
+            deliver(s);
+            out->fresh = 1;
+        }
+    }
+    apply_action(s, action);
+
+    s.reward   += s.discount * reward;
+    s.discount *= s.cfg.gamma;
+    ++s.frames;
+    s.done = s.done || done;
+
+    if (s.started && !s.done && s.frames < s.interval) return RRL_SCHED_HOLD;
+    if (s.in_flight) {
+        // Due, but the trainer has not answered: keep the frame going.
+        if (!s.late_hit) {
+            s.late_hit = true;
+            ++s.late;
+            if (!s.cfg.fixed) ++s.extra;
+        }
+        return RRL_SCHED_HOLD;
+    }
+
+    out->reward   = s.reward;
+    out->discount = s.discount;
+    out->frames   = s.frames;
+    out->done     = s.done ? 1 : 0;
+    s.started    = true;
+    s.in_flight  = true;
+    s.late_hit   = false;
+    s.done       = false;
+    s.frames     = 0;
+    s.reward     = 0.f;
+    s.discount   = 1.f;
+    s.decided_at = s.ticks;
+    ++s.decisions;
+    resize(s);
+    return RRL_SCHED_DECIDE;
+}
+
+int rrl_sched_stats(RRLSched sched, RRL_SchedStats* out)
+{
+    if (!sched || !out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_sched_stats: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    out->ticks     = sched->ticks;
+    out->decisions = sched->decisions;
+    out->late      = sched->late;
+    out->interval  = sched->interval;
+    out->tick_hz   = sched->tick_hz;
+    out->rtt_ms    = sched->rtt_ms;
+    return RRL_SUCCESS;
+}
+
+} // extern "C"
@@ -0,0 +1,545 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_shm.cpp  —  Same‑host shared‑memory transport
+//
+//  • Each ring has one producer and one consumer, so head and tail
+//    are plain atomic stores by their owner; each side also caches
+//    the other's counter and re‑reads it only when the cached value
+//    says the ring is empty / full.
+//  • Sleeping is a futex on the ring's seq word, guarded by a wait
+//    flag: the fast path (peer awake) never enters the kernel.  The
+//    seq word closes the race between "flag set" and "go to sleep".
+//  • Claiming a segment as trainer is an flock on its descriptor,
+//    which the kernel drops if the trainer dies.
+//─────────────────────────────────────────────────────────────
+#include "rrl_shm.h"
+#include "rrl_wire.h"
+#include "rrl_internal.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#  include <cerrno>
+#  include <climits>
+#  include <fcntl.h>
+#  include <signal.h>
+#  include <sys/file.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  if defined(__linux__)
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <time.h>
+#  endif
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#endif
+
+using namespace rrl::detail;
+
+static_assert(sizeof(RRL_ShmHeader) == 64 && sizeof(RRL_ShmRingCtl) == 128 &&
+              sizeof(RRL_ShmRecord) == 16, "rrl_shm.h layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory counters must be address-free");
+
+#if !defined(_WIN32)
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t  kRecord       = sizeof(RRL_ShmRecord);
+constexpr size_t  kCtl          = sizeof(RRL_ShmRingCtl);
+constexpr size_t  kDefaultRing  = size_t(1) << 20;
+constexpr size_t  kMinRing      = 4096;
+constexpr size_t  kMaxRing      = size_t(1) << 30;
+constexpr int     kSpins        = 200;          // ≈ a few µs before sleeping
+constexpr int64_t kBackoffMaxUs = 1000;         // without futexes
+
+constexpr size_t pad(size_t n) { return (n + RRL_WIRE_ALIGN - 1) / RRL_WIRE_ALIGN * RRL_WIRE_ALIGN; }
+
+template <class T> std::atomic<T>& at(T& v) { return *reinterpret_cast<std::atomic<T>*>(&v); }
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+void futex_wake(uint32_t* word)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, nullptr, nullptr, 0);   // shared: no FUTEX_PRIVATE_FLAG
+#else
+    (void)word;
+#endif
+}
+
+// Sleeps while *word == seen, at most `us` (< 0: no limit).
+void futex_wait(uint32_t* word, uint32_t seen, int64_t us, int64_t& backoff_us)
+{
+#if defined(__linux__)
+    (void)backoff_us;
+    timespec ts{};
+    if (us >= 0) {
+        ts.tv_sec  = static_cast<time_t>(us / 1000000);
+        ts.tv_nsec = static_cast<long>(us % 1000000) * 1000;
+    }
+    syscall(SYS_futex, word, FUTEX_WAIT, seen, us >= 0 ? &ts : nullptr, nullptr, 0);
+#else
+    (void)word; (void)seen;
+    int64_t d = backoff_us;
+    if (us >= 0 && us < d) d = us;
+    std::this_thread::sleep_for(std::chrono::microseconds(d));
+    backoff_us = backoff_us * 2 > kBackoffMaxUs ? kBackoffMaxUs : backoff_us * 2;
+#endif
+}
+
+// Waits until `ready()`; false on timeout.
+template <class Ready>
+bool wait_for(uint32_t& seq, uint32_t& waiting, int64_t timeout_us, Ready ready)
+{
+    if (ready()) return true;
+    if (timeout_us == 0) return false;
+    for (int i = 0; i < kSpins; ++i) {
+        cpu_relax();
+        if (ready()) return true;
+    }
+    const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(timeout_us < 0 ? 0 : timeout_us);
+    int64_t backoff = 50;
+    for (;;) {
+        const uint32_t seen = at(seq).load(std::memory_order_acquire);
+        at(waiting).store(1, std::memory_order_seq_cst);
+        if (ready()) break;
+        int64_t left = -1;
+        if (timeout_us > 0) {
+            left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now()).count();
+            if (left <= 0) {
+                at(waiting).store(0, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        futex_wait(&seq, seen, left, backoff);
+        at(waiting).store(0, std::memory_order_relaxed);
+        if (ready()) return true;
+    }
+    at(waiting).store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void notify_peer(uint32_t& seq, uint32_t& waiting)
+{
+    at(seq).fetch_add(1, std::memory_order_seq_cst);
+    if (at(waiting).load(std::memory_order_seq_cst)) futex_wake(&seq);
+}
+
+bool pid_alive(int32_t pid)
+{
+    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+struct Out {              // this process's produce side of one ring
+    uint64_t head       = 0;
+    uint64_t tail_seen  = 0;
+    size_t   skip       = 0;   // pending reserve(): SKIP bytes before it
+    size_t   cap        = 0;   //                    and its frame capacity
+    bool     reserved   = false;
+};
+
+struct In {               // this process's consume side of one ring
+    uint64_t tail       = 0;   // past the held frame's SKIP, if any
+    uint64_t head_seen  = 0;
+    size_t   held       = 0;   // bytes to release, SKIP included
+};
+
+} // namespace (anonymous)
+
+struct RRLShmImpl {
+    std::string    name;
+    bool           creator  = false;
+    int            fd       = -1;
+    unsigned char* base     = nullptr;
+    size_t         size     = 0;
+    uint32_t       channels = 0;
+    uint32_t       ring     = 0;
+    uint64_t       stride   = 0;
+    std::vector<Out> out;
+    std::vector<In>  in;
+
+    RRL_ShmHeader* header() const { return reinterpret_cast<RRL_ShmHeader*>(base); }
+    RRL_ShmRingCtl* ctl(uint32_t ch, int dir) const {
+        return reinterpret_cast<RRL_ShmRingCtl*>(base + RRL_SHM_HEADER_BYTES + ch * stride + size_t(dir) * (kCtl + ring));
+    }
+    unsigned char* data(RRL_ShmRingCtl* c) const { return reinterpret_cast<unsigned char*>(c) + kCtl; }
+    int out_dir() const { return creator ? RRL_SHM_UP : RRL_SHM_DOWN; }
+    int in_dir()  const { return creator ? RRL_SHM_DOWN : RRL_SHM_UP; }
+};
+
+namespace {
+
+void free_shm(RRLShmImpl* s)
+{
+    if (s->base) ::munmap(s->base, s->size);
+    if (s->fd >= 0) ::close(s->fd);
+    delete s;
+}
+
+bool bad_channel(const RRLShmImpl* s, uint32_t ch, const char* fn)
+{
+    if (s && ch < s->channels) return false;
+    std::string msg = std::string(fn) + (s ? ": channel out of range" : ": null shm");
+    set_error(s ? RRL_ERR_INVALID_ARGUMENT : RRL_ERR_INVALID_HANDLE, msg.c_str());
+    return true;
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+int rrl_shm_name(const char* key, int pid, char* out, size_t cap)
+{
+    if (!out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_shm_name: null out");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    uint64_t h = 14695981039346656037ull;   // FNV-1a 64, as shm_transport.py
+    for (const char* p = key ? key : ""; *p; ++p) h = (h ^ static_cast<unsigned char>(*p)) * 1099511628211ull;
+    const int n = std::snprintf(out, cap, "/rrl-%u-%016" PRIx64 "-%d",
+                                static_cast<unsigned>(::getuid()), h, pid ? pid : static_cast<int>(::getpid()));
+    if (n < 0 || static_cast<size_t>(n) >= cap) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_shm_name: buffer too small");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    return RRL_SUCCESS;
+}
+
+RRLShm rrl_shm_create(const char* name, uint32_t channels, size_t ring_bytes)
+{
+    if (!name || name[0] != '/' || channels == 0 || channels > 65536 || ring_bytes > kMaxRing) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_shm_create: bad name, channel count or ring size");
+        return nullptr;
+    }
+    size_t ring = kMinRing;
+    while (ring < (ring_bytes ? ring_bytes : kDefaultRing)) ring <<= 1;
+    auto* s = new (std::nothrow) RRLShmImpl;
+    if (!s) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_shm_create: out of memory");
+        return nullptr;
+    }
+    s->creator  = true;
+    s->channels = channels;
+    s->ring     = static_cast<uint32_t>(ring);
+    s->stride   = 2 * (kCtl + ring);
+    s->size     = RRL_SHM_HEADER_BYTES + channels * s->stride;
+    try {
+        s->name = name;
+        s->out.resize(channels);
+        s->in.resize(channels);
+    } catch (const std::bad_alloc&) {
+        delete s;
+        set_error(RRL_ERR_NO_MEMORY, "rrl_shm_create: out of memory");
+        return nullptr;
+    }
+    ::shm_unlink(name);   // a crashed simulator's segment
+    const int fd = ::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(s->size)) != 0) {
+        if (fd >= 0) { ::close(fd); ::shm_unlink(name); }
+        delete s;
+        set_error(RRL_ERR_IO, "rrl_shm_create: cannot create the segment");
+        return nullptr;
+    }
+    void* p = ::mmap(nullptr, s->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);   // the mapping keeps it; trainers lock their own descriptor
+    if (p == MAP_FAILED) {
+        ::shm_unlink(name);
+        delete s;
+        set_error(RRL_ERR_IO, "rrl_shm_create: cannot map the segment");
+        return nullptr;
+    }
+    s->base = static_cast<unsigned char*>(p);   // zero-filled by ftruncate
+    RRL_ShmHeader* h = s->header();
+    h->version       = RRL_SHM_VERSION;
+    h->channels      = channels;
+    h->ring_bytes    = s->ring;
+    h->channel_bytes = s->stride;
+    h->sim_pid       = static_cast<int32_t>(::getpid());
+    at(h->magic).store(RRL_SHM_MAGIC, std::memory_order_release);
+    return s;
+}
+
+RRLShm rrl_shm_attach(const char* name)
+{
+    if (!name) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_shm_attach: null name");
+        return nullptr;
+    }
+    const int fd = ::shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        set_error(RRL_ERR_IO, "rrl_shm_attach: no such segment");
+        return nullptr;
+    }
+    if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        ::close(fd);
+        set_error(RRL_ERR_EXHAUSTED, "rrl_shm_attach: another trainer is attached");
+        return nullptr;
+    }
+    struct stat st{};
+    auto* s = new (std::nothrow) RRLShmImpl;
+    if (!s || ::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < RRL_SHM_HEADER_BYTES) {
+        ::close(fd);
+        delete s;
+        set_error(RRL_ERR_IO, "rrl_shm_attach: segment unreadable");
+        return nullptr;
+    }
+    s->fd   = fd;
+    s->size = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, s->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        s->base = nullptr;
+        free_shm(s);
+        set_error(RRL_ERR_IO, "rrl_shm_attach: cannot map the segment");
+        return nullptr;
+    }
+    s->base = static_cast<unsigned char*>(p);
+    RRL_ShmHeader* h = s->header();
+    const bool ok = at(h->magic).load(std::memory_order_acquire) == RRL_SHM_MAGIC &&
+                    h->version == RRL_SHM_VERSION && h->channels &&
+                    h->ring_bytes >= kMinRing && (h->ring_bytes & (h->ring_bytes - 1)) == 0 &&
+                    h->channel_bytes == 2 * (kCtl + h->ring_bytes) &&
+                    RRL_SHM_HEADER_BYTES + h->channels * h->channel_bytes <= s->size;
+    if (!ok || !pid_alive(h->sim_pid)) {
+        free_shm(s);
+        set_error(RRL_ERR_IO, ok ? "rrl_shm_attach: simulator is gone" : "rrl_shm_attach: not an RRL segment");
+        return nullptr;
+    }
+    s->channels = h->channels;
+    s->ring     = h->ring_bytes;
+    s->stride   = h->channel_bytes;
+    try {
+        s->name = name;
+        s->out.resize(s->channels);
+        s->in.resize(s->channels);
+    } catch (const std::bad_alloc&) {
+        free_shm(s);
+        set_error(RRL_ERR_NO_MEMORY, "rrl_shm_attach: out of memory");
+        return nullptr;
+    }
+    // Pick up where an earlier trainer stopped.
+    for (uint32_t ch = 0; ch < s->channels; ++ch) {
+        RRL_ShmRingCtl* o = s->ctl(ch, s->out_dir());
+        RRL_ShmRingCtl* i = s->ctl(ch, s->in_dir());
+        s->out[ch].head = s->out[ch].tail_seen = at(o->head).load(std::memory_order_acquire);
+        s->in[ch].tail  = s->in[ch].head_seen  = at(i->tail).load(std::memory_order_acquire);
+    }
+    at(h->trainer_pid).store(static_cast<int32_t>(::getpid()), std::memory_order_release);
+    return s;
+}
+
+void rrl_shm_close(RRLShm shm)
+{
+    if (!shm) return;
+    if (shm->creator) ::shm_unlink(shm->name.c_str());
+    else              at(shm->header()->trainer_pid).store(0, std::memory_order_release);
+    free_shm(shm);
+}
+
+uint32_t rrl_shm_channels(RRLShm shm)
+{
+    return shm ? shm->channels : 0;
+}
+
+int rrl_shm_peer_alive(RRLShm shm)
+{
+    if (!shm) return 0;
+    RRL_ShmHeader* h = shm->header();
+    return pid_alive(at(shm->creator ? h->trainer_pid : h->sim_pid).load(std::memory_order_acquire)) ? 1 : 0;
+}
+
+void* rrl_shm_reserve(RRLShm shm, uint32_t channel, size_t cap, int64_t timeout_us)
+{
+    if (bad_channel(shm, channel, "rrl_shm_reserve")) return nullptr;
+    Out& o = shm->out[channel];
+    const size_t need = kRecord + pad(cap);
+    if (!cap || need > shm->ring / 2 || o.reserved) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, o.reserved ? "rrl_shm_reserve: previous reserve not committed"
+                                                       : "rrl_shm_reserve: frame empty or over half the ring");
+        return nullptr;
+    }
+    RRL_ShmRingCtl* c = shm->ctl(channel, shm->out_dir());
+    const size_t pos  = static_cast<size_t>(o.head & (shm->ring - 1));
+    const size_t skip = shm->ring - pos < need ? shm->ring - pos : 0;
+    const uint64_t total = skip + need;
+    auto room = [&] {
+        if (shm->ring - (o.head - o.tail_seen) >= total) return true;
+        o.tail_seen = at(c->tail).load(std::memory_order_seq_cst);
+        return shm->ring - (o.head - o.tail_seen) >= total;
+    };
+    if (!wait_for(c->space_seq, c->space_wait, timeout_us, room)) {
+        set_error(RRL_ERR_TIMEOUT, "rrl_shm_reserve: ring full (trainer not draining)");
+        return nullptr;
+    }
+    unsigned char* d = shm->data(c);
+    if (skip) {
+        RRL_ShmRecord r{};
+        r.bytes = RRL_SHM_SKIP;
+        std::memcpy(d + pos, &r, sizeof(r));
+    }
+    o.skip     = skip;
+    o.cap      = cap;
+    o.reserved = true;
+    return d + (skip ? 0 : pos) + kRecord;
+}
+
+int rrl_shm_commit(RRLShm shm, uint32_t channel, size_t len)
+{
+    if (bad_channel(shm, channel, "rrl_shm_commit")) return shm ? RRL_ERR_INVALID_ARGUMENT : RRL_ERR_INVALID_HANDLE;
+    Out& o = shm->out[channel];
+    if (!o.reserved || !len || len > o.cap) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_shm_commit: nothing reserved or len over the reservation");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRL_ShmRingCtl* c = shm->ctl(channel, shm->out_dir());
+    const size_t at_pos = o.skip ? 0 : static_cast<size_t>(o.head & (shm->ring - 1));
+    RRL_ShmRecord r{};
+    r.bytes = static_cast<uint32_t>(len);
+    std::memcpy(shm->data(c) + at_pos, &r, sizeof(r));
+    o.head    += o.skip + kRecord + pad(len);
+    o.reserved = false;
+    at(c->head).store(o.head, std::memory_order_seq_cst);
+    notify_peer(c->data_seq, c->data_wait);
+    return RRL_SUCCESS;
+}
+
+int rrl_shm_write(RRLShm shm, uint32_t channel, const void* frame, size_t len, int64_t timeout_us)
+{
+    if (!frame) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_shm_write: null frame");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    void* dst = rrl_shm_reserve(shm, channel, len, timeout_us);
+    if (!dst) return rrl_last_error();
+    std::memcpy(dst, frame, len);
+    return rrl_shm_commit(shm, channel, len);
+}
+
+int rrl_shm_read(RRLShm shm, uint32_t channel, const void** frame, size_t* len, int64_t timeout_us)
+{
+    if (bad_channel(shm, channel, "rrl_shm_read")) return shm ? RRL_ERR_INVALID_ARGUMENT : RRL_ERR_INVALID_HANDLE;
+    In& i = shm->in[channel];
+    if (!frame || !len || i.held) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, i.held ? "rrl_shm_read: previous frame not released"
+                                                   : "rrl_shm_read: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRL_ShmRingCtl* c = shm->ctl(channel, shm->in_dir());
+    auto any = [&] {
+        if (i.head_seen != i.tail) return true;
+        i.head_seen = at(c->head).load(std::memory_order_seq_cst);
+        return i.head_seen != i.tail;
+    };
+    if (!wait_for(c->data_seq, c->data_wait, timeout_us, any)) {
+        set_error(RRL_ERR_TIMEOUT, "rrl_shm_read: no frame");
+        return RRL_ERR_TIMEOUT;
+    }
+    const unsigned char* d = shm->data(c);
+    size_t pos = static_cast<size_t>(i.tail & (shm->ring - 1));
+    RRL_ShmRecord r;
+    std::memcpy(&r, d + pos, sizeof(r));
+    size_t skipped = 0;
+    if (r.bytes == RRL_SHM_SKIP) {   // published together with the record after it
+        skipped = shm->ring - pos;
+        pos = 0;
+        std::memcpy(&r, d, sizeof(r));
+    }
+    if (r.bytes == 0 || r.bytes == RRL_SHM_SKIP || kRecord + pad(r.bytes) > shm->ring - pos) {
+        set_error(RRL_ERR_IO, "rrl_shm_read: corrupt ring");
+        return RRL_ERR_IO;
+    }
+    i.held = skipped + kRecord + pad(r.bytes);
+    *frame = d + pos + kRecord;
+    *len   = r.bytes;
+    return RRL_SUCCESS;
+}
+
+int rrl_shm_release(RRLShm shm, uint32_t channel)
+{
+    if (bad_channel(shm, channel, "rrl_shm_release")) return shm ? RRL_ERR_INVALID_ARGUMENT : RRL_ERR_INVALID_HANDLE;
+    In& i = shm->in[channel];
+    if (!i.held) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_shm_release: no frame held");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRL_ShmRingCtl* c = shm->ctl(channel, shm->in_dir());
+    i.tail += i.held;
+    i.held  = 0;
+    at(c->tail).store(i.tail, std::memory_order_seq_cst);
+    notify_peer(c->space_seq, c->space_wait);
+    return RRL_SUCCESS;
+}
+
+} // extern "C"
+
+#else  // _WIN32: no shared-memory transport; the relay is used
+
+extern "C" {
+
+int rrl_shm_name(const char*, int, char*, size_t)
+{
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_shm_name: POSIX hosts only");
+    return RRL_ERR_UNSUPPORTED;
+}
+RRLShm rrl_shm_create(const char*, uint32_t, size_t)
+{
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_shm_create: POSIX hosts only");
+    return nullptr;
+}
+RRLShm rrl_shm_attach(const char*)
+{
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_shm_attach: POSIX hosts only");
+    return nullptr;
+}
+void rrl_shm_close(RRLShm) {}
+uint32_t rrl_shm_channels(RRLShm) { return 0; }
+int rrl_shm_peer_alive(RRLShm) { return 0; }
+void* rrl_shm_reserve(RRLShm, uint32_t, size_t, int64_t)
+{
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_shm_reserve: POSIX hosts only");
+    return nullptr;
+}
+int rrl_shm_commit(RRLShm, uint32_t, size_t)
+{
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_shm_commit: POSIX hosts only");
+    return RRL_ERR_UNSUPPORTED;
+}
+int rrl_shm_write(RRLShm, uint32_t, const void*, size_t, int64_t)
+{
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_shm_write: POSIX hosts only");
+    return RRL_ERR_UNSUPPORTED;
+}
+int rrl_shm_read(RRLShm, uint32_t, const void**, size_t*, int64_t)
+{
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_shm_read: POSIX hosts only");
+    return RRL_ERR_UNSUPPORTED;
+}
+int rrl_shm_release(RRLShm, uint32_t)
+{
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_shm_release: POSIX hosts only");
+    return RRL_ERR_UNSUPPORTED;
+}
+
+} // extern "C"
+
+#endif
@@ -0,0 +1,96 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_thread.cpp  —  Thread placement helpers
+//
+//  • rrl_pin_thread() keeps OS affinity calls out of the public
+//    headers (rrl_runner.hpp pins its workers through it).
+//  • rrl_allowed_cores() reports the CPUs the process may use, so
+//    callers pin inside a taskset / cpuset instead of onto cores the
+//    kernel will refuse.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_internal.hpp"
+
+#if defined(_WIN32)
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#elif defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+using namespace rrl::detail;
+
+extern "C" int rrl_pin_thread(unsigned core)
+{
+#if defined(_WIN32)
+    // Processor groups are not handled: cores ≥ 64 are rejected.
+    if (core >= sizeof(DWORD_PTR) * 8) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pin_thread: core out of range");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (!SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pin_thread: SetThreadAffinityMask failed");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    return RRL_SUCCESS;
+#elif defined(__linux__)
+    if (core >= CPU_SETSIZE) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pin_thread: core out of range");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_pin_thread: core not available");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    return RRL_SUCCESS;
+#else
+    (void)core;
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_pin_thread: no thread affinity on this platform");
+    return RRL_ERR_UNSUPPORTED;
+#endif
+}
+
+extern "C" int rrl_allowed_cores(unsigned* cores, size_t cap)
+{
+    if (!cores && cap) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_allowed_cores: null array");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+#if defined(_WIN32)
+    DWORD_PTR proc = 0, sys = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &proc, &sys)) {
+        set_error(RRL_ERR_UNSUPPORTED, "rrl_allowed_cores: GetProcessAffinityMask failed");
+        return RRL_ERR_UNSUPPORTED;
+    }
+    int n = 0;
+    for (unsigned c = 0; c < sizeof(DWORD_PTR) * 8; ++c) {
+        if (!(proc & (DWORD_PTR(1) << c))) continue;
+        if (size_t(n) < cap) cores[n] = c;
+        ++n;
+    }
+    return n;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        set_error(RRL_ERR_UNSUPPORTED, "rrl_allowed_cores: sched_getaffinity failed");
+        return RRL_ERR_UNSUPPORTED;
+    }
+    int n = 0;
+    for (unsigned c = 0; c < CPU_SETSIZE; ++c) {
+        if (!CPU_ISSET(c, &set)) continue;
+        if (size_t(n) < cap) cores[n] = c;
+        ++n;
+    }
+    return n;
+#else
+    (void)cores; (void)cap;
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_allowed_cores: no thread affinity on this platform");
+    return RRL_ERR_UNSUPPORTED;
+#endif
+}
@@ -0,0 +1,442 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_trace.cpp  —  Span tracing (hooks + built‑in ring tracer)
+//
+//  • Recording a span is two counter reads, four relaxed stores into
+//    the calling thread's own ring and one release store of its head;
+//    no locks, no allocation after the thread's first span.
+//  • Rings are written seqlock‑style, so rrl_trace_write() can run
+//    while tracing: it copies each ring, then drops every entry the
+//    owner may have overwritten meanwhile.
+//  • Rings of exited threads keep their spans and are reused by the
+//    next thread that starts recording, as ReaderSlots are.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace rrl::detail;
+
+namespace rrl { namespace detail {
+std::atomic<unsigned> g_trace_mode{0};
+}} // namespace rrl::detail
+
+namespace {
+
+constexpr unsigned kRing  = 1;   // g_trace_mode bits
+constexpr unsigned kHooks = 2;
+
+constexpr size_t kMaxSpans = size_t(1) << 26;
+
+const char* const kSpanNames[RRL_SPAN_KINDS] = {
+    "poll", "serialize", "send", "recv", "deserialize", "policy_act", "callback", "preprocess",
+};
+
+//──── Clock ────────────────────────────────────────────────//
+uint64_t steady_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+const uint64_t g_origin_tick = trace_ticks();
+const uint64_t g_origin_ns   = steady_ns();
+
+// Ticks → steady ns, by the rate observed between library load and
+// the moment of conversion.
+struct Calibration {
+    uint64_t tick0, ns0;
+    double   ns_per_tick;
+
+    static Calibration now() {
+        const uint64_t t = trace_ticks(), ns = steady_ns();
+        const double rate = t > g_origin_tick && ns > g_origin_ns
+            ? static_cast<double>(ns - g_origin_ns) / static_cast<double>(t - g_origin_tick) : 1.0;
+        return Calibration{t, ns, rate};
+    }
+    uint64_t ns(uint64_t tick) const {
+        const double d = (static_cast<double>(tick) - static_cast<double>(tick0)) * ns_per_tick;
+        return static_cast<uint64_t>(static_cast<double>(ns0) + d);
+    }
+};
+
+//──── Rings ────────────────────────────────────────────────//
+struct Span {
+    uint64_t begin, end, handle, kind_tid;   // kind | tid << 32
+};
+
+struct Ring {
+    alignas(RRL_BUFFER_ALIGN) std::atomic<uint64_t> head{0};   // spans ever written
+    size_t            mask  = 0;
+    Span*             spans = nullptr;
+    std::atomic<bool> in_use{true};
+    Ring*             next  = nullptr;
+};
+
+std::atomic<Ring*>    g_rings{nullptr};     // push‑only, never freed
+std::atomic<size_t>   g_capacity{0};
+std::atomic<uint64_t> g_since{0};           // ticks at rrl_trace_start
+std::atomic<uint32_t> g_next_tid{1};
+
+Ring* claim_ring(size_t capacity)
+{
+    for (Ring* r = g_rings.load(std::memory_order_acquire); r; r = r->next) {
+        bool idle = false;
+        if (r->mask + 1 == capacity &&
+            r->in_use.compare_exchange_strong(idle, true, std::memory_order_acquire))
+            return r;
+    }
+    auto* r = new (std::nothrow) Ring;
+    Span* spans = r ? new (std::nothrow) Span[capacity]() : nullptr;
+    if (!spans) { delete r; return nullptr; }
+    r->mask  = capacity - 1;
+    r->spans = spans;
+    r->next  = g_rings.load(std::memory_order_relaxed);
+    while (!g_rings.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                          std::memory_order_relaxed)) {}
+    return r;
+}
+
+struct ThreadRing {
+    Ring*    ring = nullptr;
+    uint64_t tid  = 0;
+    ~ThreadRing() { if (ring) ring->in_use.store(false, std::memory_order_release); }
+};
+
+ThreadRing& thread_ring()
+{
+    static thread_local ThreadRing tr;
+    if (!tr.ring) {
+        const size_t cap = g_capacity.load(std::memory_order_relaxed);
+        if (cap && (tr.ring = claim_ring(cap)))
+            tr.tid = g_next_tid.fetch_add(1, std::memory_order_relaxed);
+    }
+    return tr;
+}
+
+//──── Hooks ────────────────────────────────────────────────//
+std::mutex                          g_hooks_mtx;
+std::atomic<const RRL_TraceHooks*>  g_hooks{nullptr};
+
+#if !defined(RRL_NO_TRACING)
+void delete_hooks(void* p) { delete static_cast<const RRL_TraceHooks*>(p); }
+#endif
+
+//──── Export ───────────────────────────────────────────────//
+struct Event {
+    uint64_t begin, end;     // steady ns
+    uint64_t handle;
+    uint32_t kind, tid;
+};
+
+// Every ring's spans since rrl_trace_start(), begin‑ordered per thread.
+std::vector<Event> collect()
+{
+    std::vector<Event> out;
+    std::vector<Span>  copy;
+    const uint64_t since = g_since.load(std::memory_order_acquire);
+    const Calibration cal = Calibration::now();
+    for (Ring* r = g_rings.load(std::memory_order_acquire); r; r = r->next) {
+        const uint64_t cap = r->mask + 1;
+        const uint64_t h1  = r->head.load(std::memory_order_acquire);
+        const uint64_t lo  = h1 > cap ? h1 - cap : 0;
+        copy.resize(static_cast<size_t>(h1 - lo));
+        for (uint64_t i = lo; i < h1; ++i) {
+            const Span& s = r->spans[i & r->mask];
+            copy[i - lo] = Span{atomic_read(&s.begin), atomic_read(&s.end),
+                                atomic_read(&s.handle), atomic_read(&s.kind_tid)};
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Entries below h2 - cap + 1 may have been (or be being) rewritten.
+        const uint64_t h2    = r->head.load(std::memory_order_relaxed);
+        const uint64_t valid = h2 + 1 > cap ? h2 + 1 - cap : 0;
+        for (uint64_t i = std::max(lo, valid); i < h1; ++i) {
+            const Span& s = copy[i - lo];
+            const uint32_t kind = static_cast<uint32_t>(s.kind_tid);
+            if (s.begin < since || s.end < s.begin || kind >= RRL_SPAN_KINDS) continue;
+            out.push_back(Event{cal.ns(s.begin), cal.ns(s.end), s.handle, kind,
+                                static_cast<uint32_t>(s.kind_tid >> 32)});
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Event& a, const Event& b) {
+        if (a.tid != b.tid)     return a.tid < b.tid;
+        if (a.begin != b.begin) return a.begin < b.begin;
+        return a.end > b.end;   // enclosing span first
+    });
+    return out;
+}
+
+void append(std::string& s, const char* fmt, ...)
+{
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    const int n = std::vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n > 0) s.append(buf, std::min(static_cast<size_t>(n), sizeof(buf) - 1));
+}
+
+std::string chrome_json(const std::vector<Event>& ev)
+{
+    std::string s = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    uint32_t tid = 0;
+    for (const Event& e : ev) {
+        if (e.tid != tid) {
+            tid = e.tid;
+            append(s, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu32
+                      ",\"args\":{\"name\":\"rrl-%" PRIu32 "\"}}", first ? "" : ",", tid, tid);
+            first = false;
+        }
+        append(s, ",{\"name\":\"%s\",\"cat\":\"rrl\",\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu32
+                  ",\"ts\":%" PRIu64 ".%03u,\"dur\":%" PRIu64 ".%03u,\"args\":{\"handle\":\"0x%" PRIx64 "\"}}",
+               kSpanNames[e.kind], e.tid, e.begin / 1000, static_cast<unsigned>(e.begin % 1000),
+               (e.end - e.begin) / 1000, static_cast<unsigned>((e.end - e.begin) % 1000), e.handle);
+    }
+    s += "]}\n";
+    return s;
+}
+
+// Minimal protobuf writer for the few perfetto.protos.Trace fields used.
+struct Proto {
+    std::string b;
+
+    void varint(uint64_t v) {
+        while (v >= 0x80) { b += static_cast<char>((v & 0x7F) | 0x80); v >>= 7; }
+        b += static_cast<char>(v);
+    }
+    void u64(unsigned field, uint64_t v)  { varint(uint64_t(field) << 3); varint(v); }
+    void bytes(unsigned field, const char* p, size_t n) {
+        varint(uint64_t(field) << 3 | 2); varint(n); b.append(p, n);
+    }
+    void str(unsigned field, const char* p)         { bytes(field, p, std::strlen(p)); }
+    void msg(unsigned field, const Proto& m)        { bytes(field, m.b.data(), m.b.size()); }
+};
+
+// TracePacket / TrackDescriptor / ThreadDescriptor / TrackEvent /
+// DebugAnnotation field numbers (perfetto/trace/*.proto).
+enum : unsigned {
+    kTracePacket = 1,
+    kPktTimestamp = 8, kPktSequenceId = 10, kPktTrackEvent = 11, kPktSequenceFlags = 13,
+    kPktTrackDescriptor = 60,
+    kTdUuid = 1, kTdName = 2, kTdThread = 4,
+    kThPid = 1, kThTid = 2, kThName = 5,
+    kTeDebug = 4, kTeType = 9, kTeTrackUuid = 11, kTeCategories = 22, kTeName = 23,
+    kDaPointer = 7, kDaName = 10,
+};
+constexpr uint64_t kSliceBegin = 1, kSliceEnd = 2;
+constexpr uint64_t kSequenceId = 1;
+
+void packet(Proto& trace, uint64_t ts, unsigned kind, const Proto& body)
+{
+    Proto p;
+    if (ts) p.u64(kPktTimestamp, ts);
+    p.u64(kPktSequenceId, kSequenceId);
+    p.msg(kind, body);
+    trace.msg(kTracePacket, p);
+}
+
+void slice(Proto& trace, uint64_t ts, uint64_t type, uint64_t track, const Event* e)
+{
+    Proto te;
+    te.u64(kTeType, type);
+    te.u64(kTeTrackUuid, track);
+    if (e) {
+        te.str(kTeCategories, "rrl");
+        te.str(kTeName, kSpanNames[e->kind]);
+        Proto da;
+        da.str(kDaName, "handle");
+        da.u64(kDaPointer, e->handle);
+        te.msg(kTeDebug, da);
+    }
+    packet(trace, ts, kPktTrackEvent, te);
+}
+
+std::string perfetto(const std::vector<Event>& ev)
+{
+    Proto trace;
+    {
+        Proto p;   // fresh sequence: no interned state to inherit
+        p.u64(kPktSequenceId, kSequenceId);
+        p.u64(kPktSequenceFlags, 1);
+        trace.msg(kTracePacket, p);
+    }
+    std::vector<uint64_t> open;   // end times of the enclosing slices
+    for (size_t i = 0; i < ev.size();) {
+        const uint32_t tid = ev[i].tid;
+        const uint64_t track = tid;
+        char name[32];
+        std::snprintf(name, sizeof(name), "rrl-%" PRIu32, tid);
+        Proto th, td;
+        th.u64(kThPid, 1);
+        th.u64(kThTid, tid);
+        th.str(kThName, name);
+        td.u64(kTdUuid, track);
+        td.str(kTdName, name);
+        td.msg(kTdThread, th);
+        packet(trace, 0, kPktTrackDescriptor, td);
+
+        // Spans are begin‑ordered, enclosing first; one that overlaps
+        // its parent without nesting is clamped to the parent's end.
+        open.clear();
+        for (; i < ev.size() && ev[i].tid == tid; ++i) {
+            const Event& e = ev[i];
+            while (!open.empty() && open.back() <= e.begin) {
+                slice(trace, open.back(), kSliceEnd, track, nullptr);
+                open.pop_back();
+            }
+            slice(trace, e.begin, kSliceBegin, track, &e);
+            open.push_back(open.empty() ? e.end : std::min(e.end, open.back()));
+        }
+        while (!open.empty()) {
+            slice(trace, open.back(), kSliceEnd, track, nullptr);
+            open.pop_back();
+        }
+    }
+    return trace.b;
+}
+
+} // namespace (anonymous)
+
+namespace rrl { namespace detail {
+
+void trace_record(int kind, RRLHandle handle, uint64_t begin, uint64_t end)
+{
+    const unsigned mode = g_trace_mode.load(std::memory_order_relaxed);
+    if (mode & kRing) {
+        ThreadRing& tr = thread_ring();
+        if (Ring* r = tr.ring) {
+            const uint64_t i = r->head.load(std::memory_order_relaxed);
+            // Orders the previous head store before this slot's stores
+            // (see collect()).
+            std::atomic_thread_fence(std::memory_order_release);
+            Span& s = r->spans[i & r->mask];
+            atomic_write(&s.begin,    begin);
+            atomic_write(&s.end,      end);
+            atomic_write(&s.handle,   static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle)));
+            atomic_write(&s.kind_tid, static_cast<uint32_t>(kind) | tr.tid << 32);
+            r->head.store(i + 1, std::memory_order_release);
+        }
+    }
+    static thread_local bool in_hook = false;   // SDK calls made by the hook
+    if ((mode & kHooks) && !in_hook) {
+        EpochGuard pin;
+        const RRL_TraceHooks* h = g_hooks.load(std::memory_order_acquire);
+        if (h && h->span) {
+            const Calibration cal = Calibration::now();
+            in_hook = true;
+            h->span(h->user, kind, handle, cal.ns(begin), cal.ns(end));
+            in_hook = false;
+        }
+    }
+}
+
+}} // namespace rrl::detail
+
+extern "C" {
+
+int rrl_register_trace_hooks(const RRL_TraceHooks* hooks)
+{
+#if defined(RRL_NO_TRACING)
+    (void)hooks;
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_register_trace_hooks: built with RRL_ENABLE_TRACING=OFF");
+    return RRL_ERR_UNSUPPORTED;
+#else
+    if (hooks && hooks->struct_size < sizeof(size_t)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_register_trace_hooks: bad struct_size");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRL_TraceHooks* copy = nullptr;
+    if (hooks) {
+        copy = new (std::nothrow) RRL_TraceHooks{};
+        if (!copy) {
+            set_error(RRL_ERR_NO_MEMORY, "rrl_register_trace_hooks: out of memory");
+            return RRL_ERR_NO_MEMORY;
+        }
+        std::memcpy(copy, hooks, std::min(hooks->struct_size, sizeof(*copy)));
+        copy->struct_size = sizeof(*copy);
+        if (!copy->span) { delete copy; copy = nullptr; }
+    }
+    std::lock_guard<std::mutex> lk(g_hooks_mtx);
+    const RRL_TraceHooks* old = g_hooks.exchange(copy, std::memory_order_acq_rel);
+    if (copy) g_trace_mode.fetch_or(kHooks, std::memory_order_relaxed);
+    else      g_trace_mode.fetch_and(~kHooks, std::memory_order_relaxed);
+    if (old) retire(const_cast<RRL_TraceHooks*>(old), delete_hooks);
+    return RRL_SUCCESS;
+#endif
+}
+
+int rrl_trace_start(size_t spans_per_thread)
+{
+#if defined(RRL_NO_TRACING)
+    (void)spans_per_thread;
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_trace_start: built with RRL_ENABLE_TRACING=OFF");
+    return RRL_ERR_UNSUPPORTED;
+#else
+    if (spans_per_thread == 0 || spans_per_thread > kMaxSpans) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_trace_start: spans_per_thread out of range");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    size_t cap = 1;
+    while (cap < spans_per_thread) cap <<= 1;
+    g_capacity.store(cap, std::memory_order_relaxed);
+    g_since.store(trace_ticks(), std::memory_order_release);
+    g_trace_mode.fetch_or(kRing, std::memory_order_relaxed);
+    return RRL_SUCCESS;
+#endif
+}
+
+void rrl_trace_stop(void)
+{
+    g_trace_mode.fetch_and(~kRing, std::memory_order_relaxed);
+}
+
+int rrl_trace_write(const char* path, int format)
+{
+    if (!path || (format != RRL_TRACE_CHROME_JSON && format != RRL_TRACE_PERFETTO)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_trace_write: null path or unknown format");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    std::string out;
+    try {
+        const std::vector<Event> ev = collect();
+        out = format == RRL_TRACE_PERFETTO ? perfetto(ev) : chrome_json(ev);
+    } catch (const std::bad_alloc&) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_trace_write: out of memory");
+        return RRL_ERR_NO_MEMORY;
+    }
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        set_error(RRL_ERR_IO, "rrl_trace_write: cannot open file");
+        return RRL_ERR_IO;
+    }
+    const bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    if (std::fclose(f) != 0 || !ok) {
+        set_error(RRL_ERR_IO, "rrl_trace_write: write failed");
+        return RRL_ERR_IO;
+    }
+    return RRL_SUCCESS;
+}
+
+uint64_t rrl_trace_begin(void)
+{
+    return g_trace_mode.load(std::memory_order_relaxed) ? trace_ticks() : 0;
+}
+
+void rrl_trace_end(int kind, RRLHandle handle, uint64_t begin)
+{
+    if (!begin || kind < 0 || kind >= RRL_SPAN_KINDS) return;
+    trace_record(kind, handle, begin, trace_ticks());
+}
+
+} // extern "C"
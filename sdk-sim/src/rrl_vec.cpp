@@ -0,0 +1,256 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_vec.cpp  —  Vectorized env handles
+//
+//  • An RRLVecHandle groups K handles that share observation and
+//    action spaces behind one struct‑of‑arrays buffer block, so a
+//    backend's vec_step hook can ship one frame per K steps.
+//  • Without that hook the sub‑envs are bound to their slices with
+//    rrl_bind_buffers() and rrl_vec_step() just waits for all of
+//    them, so the layout is the same on either path.
+//  • An attached RRLRecorder (rrl_vec_set_recorder) gets every
+//    completed step as one rrl_record_batch() of K rows.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_record.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <vector>
+
+using namespace rrl::detail;
+
+struct RRLVecHandleImpl {
+    std::vector<RRLHandle> envs;
+    RRL_VecBuffers         bufs{};
+    void*                  block = nullptr;   // one aligned allocation
+    bool                   bound = false;     // slices bound per sub-env
+    std::atomic<RRLRecorder> recorder{nullptr};
+    uint32_t               record_env = 0;
+
+    // rrl_vec_step() scratch for the fallback path
+    std::vector<RRLHandle> pending;
+    std::vector<size_t>    ready;
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t round_up(size_t v) { return (v + RRL_BUFFER_ALIGN - 1) / RRL_BUFFER_ALIGN * RRL_BUFFER_ALIGN; }
+
+bool same_space(const RRL_SpaceDesc& a, const RRL_SpaceDesc& b)
+{
+    if (a.ndim != b.ndim || a.dtype != b.dtype) return false;
+    for (int d = 0; d < a.ndim && d < 8; ++d)
+        if (a.shape[d] != b.shape[d]) return false;
+    return true;
+}
+
+void free_vec(RRLVecHandleImpl* v)
+{
+    if (v->bound)
+        for (RRLHandle h : v->envs) rrl_bind_buffers(h, nullptr, 0, nullptr, 0);
+    if (v->block) ::operator delete(v->block, std::align_val_t{RRL_BUFFER_ALIGN});
+    delete v;
+}
+
+// A drop or write error is counted by the recorder, not reported here.
+int record_step(RRLVecHandleImpl* v, int rc)
+{
+    RRLRecorder rec = v->recorder.load(std::memory_order_acquire);
+    if (rc == RRL_SUCCESS && rec) {
+        const RRL_VecBuffers& b = v->bufs;
+        rrl_record_batch(rec, v->record_env, b.num_envs, b.obs, b.obs_stride,
+                         b.actions, b.action_stride, b.rewards, b.dones);
+    }
+    return rc;
+}
+
+// Shrink v->pending to the sub-envs not yet ready; 0 once all are.
+int still_pending(RRLVecHandleImpl* v)
+{
+    int n = rrl_poll_many(v->pending.data(), v->pending.size(), nullptr, v->ready.data());
+    if (n < 0) return n;
+    // Ready indices ascend: swap-remove from the back.
+    for (int k = n - 1; k >= 0; --k) {
+        v->pending[v->ready[k]] = v->pending.back();
+        v->pending.pop_back();
+    }
+    return static_cast<int>(v->pending.size());
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLVecHandle rrl_vec_create(const RRLHandle* envs, size_t k)
+{
+    if (!envs || k == 0 || k > static_cast<size_t>(INT_MAX)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_vec_create: bad handle array");
+        return nullptr;
+    }
+    RRL_SpaceDesc obs0{}, act0{};
+    for (size_t i = 0; i < k; ++i) {
+        if (!envs[i]) {
+            set_error(RRL_ERR_INVALID_HANDLE, "rrl_vec_create: null handle");
+            return nullptr;
+        }
+        RRL_SpaceDesc obs{}, act{};
+        int rc = rrl_observation_space(envs[i], &obs);
+        if (rc == RRL_SUCCESS) rc = rrl_action_space(envs[i], &act);
+        if (rc != RRL_SUCCESS) {
+            set_error(rc, "rrl_vec_create: space query failed");
+            return nullptr;
+        }
+        if (i == 0) { obs0 = obs; act0 = act; continue; }
+        if (!same_space(obs, obs0) || !same_space(act, act0)) {
+            set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_vec_create: sub-envs differ in obs/action space");
+            return nullptr;
+        }
+    }
+    const size_t obs_bytes = rrl_space_bytes(&obs0);
+    const size_t act_bytes = rrl_space_bytes(&act0);
+    if (!obs_bytes || !act_bytes) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_vec_create: invalid space descriptor");
+        return nullptr;
+    }
+
+    // obs | actions | rewards | dones, each array aligned
+    const size_t obs_stride = round_up(obs_bytes), act_stride = round_up(act_bytes);
+    const size_t obs_total = obs_stride * k, act_total = act_stride * k;
+    const size_t rew_total = round_up(k * sizeof(float));
+    const size_t total     = obs_total + act_total + rew_total + round_up(k);
+
+    auto* v = new (std::nothrow) RRLVecHandleImpl;
+    if (v) v->block = ::operator new(total, std::align_val_t{RRL_BUFFER_ALIGN}, std::nothrow);
+    try {
+        if (v && v->block) v->envs.assign(envs, envs + k);
+    } catch (const std::bad_alloc&) {
+        free_vec(v);
+        v = nullptr;
+    }
+    if (!v || !v->block) {
+        if (v) free_vec(v);
+        set_error(RRL_ERR_NO_MEMORY, "rrl_vec_create: out of memory");
+        return nullptr;
+    }
+    std::memset(v->block, 0, total);
+    auto* base = static_cast<unsigned char*>(v->block);
+    v->bufs.num_envs      = k;
+    v->bufs.obs           = base;
+    v->bufs.obs_bytes     = obs_bytes;
+    v->bufs.obs_stride    = obs_stride;
+    v->bufs.actions       = base + obs_total;
+    v->bufs.action_bytes  = act_bytes;
+    v->bufs.action_stride = act_stride;
+    v->bufs.rewards       = reinterpret_cast<float*>(base + obs_total + act_total);
+    v->bufs.dones         = base + obs_total + act_total + rew_total;
+
+    bool has_hook;
+    {
+        BackendGuard be;
+        has_hook = be->ext.vec_step != nullptr;
+    }
+    if (!has_hook) {
+        for (size_t i = 0; i < k; ++i) {
+            int rc = rrl_bind_buffers(envs[i],
+                                      base + i * obs_stride, obs_bytes,
+                                      base + obs_total + i * act_stride, act_bytes);
+            if (rc != RRL_SUCCESS) {
+                for (size_t j = 0; j < i; ++j) rrl_bind_buffers(envs[j], nullptr, 0, nullptr, 0);
+                free_vec(v);
+                set_error(rc, "rrl_vec_create: no vec_step hook and rrl_bind_buffers failed");
+                return nullptr;
+            }
+        }
+        v->bound = true;
+    }
+    return v;
+}
+
+void rrl_vec_destroy(RRLVecHandle vec)
+{
+    if (vec) free_vec(vec);
+}
+
+int rrl_vec_buffers(RRLVecHandle vec, RRL_VecBuffers* out)
+{
+    if (!vec || !out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_vec_buffers: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    *out = vec->bufs;
+    return RRL_SUCCESS;
+}
+
+const RRLHandle* rrl_vec_envs(RRLVecHandle vec, size_t* out_k)
+{
+    if (!vec) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_vec_envs: null vec");
+        if (out_k) *out_k = 0;
+        return nullptr;
+    }
+    if (out_k) *out_k = vec->envs.size();
+    return vec->envs.data();
+}
+
+int RRL_WEAK rrl_vec_step(RRLVecHandle vec, int64_t timeout_us)
+{
+    if (!vec) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_vec_step: null vec");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    {
+        // May block for the whole timeout, like rrl_wait_any's hook.
+        BackendGuard be;
+        if (auto step = be->ext.vec_step) {
+            int rc = step(vec->envs.data(), vec->envs.size(), &vec->bufs, timeout_us);
+            if (rc != RRL_SUCCESS)
+                set_error(rc, rc == RRL_ERR_TIMEOUT ? "rrl_vec_step: timed out"
+                                                    : "rrl_vec_step: backend error");
+            return record_step(vec, rc);
+        }
+    }
+    if (!vec->bound) {
+        set_error(RRL_ERR_UNSUPPORTED, "rrl_vec_step: vec_step hook removed and buffers not bound");
+        return RRL_ERR_UNSUPPORTED;
+    }
+
+    // Fallback: actions land in the bound slices; wait for all of them.
+    const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(std::max<int64_t>(timeout_us, 0));
+    vec->pending = vec->envs;
+    vec->ready.resize(vec->pending.size());
+    for (;;) {
+        int left = still_pending(vec);
+        if (left <= 0) return record_step(vec, left);   // 0 = RRL_SUCCESS, or error already recorded
+        int64_t wait = -1;
+        if (timeout_us >= 0) {
+            wait = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now()).count();
+            if (wait <= 0) {
+                set_error(RRL_ERR_TIMEOUT, "rrl_vec_step: timed out");
+                return RRL_ERR_TIMEOUT;
+            }
+        }
+        int rc = rrl_wait_any(vec->pending.data(), vec->pending.size(), wait);
+        if (rc < 0 && rc != RRL_ERR_TIMEOUT) return rc;
+    }
+}
+
+int rrl_vec_set_recorder(RRLVecHandle vec, RRLRecorder rec, uint32_t first_env)
+{
+    if (!vec) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_vec_set_recorder: null vec");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    // Set between steps (one thread at a time per vec, like rrl_vec_step).
+    vec->record_env = first_env;
+    vec->recorder.store(rec, std::memory_order_release);
+    return RRL_SUCCESS;
+}
+
+} // extern "C"
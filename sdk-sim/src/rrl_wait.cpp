@@ -0,0 +1,212 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_wait.cpp  —  Event‑driven readiness
+//
+//  • rrl_get_wait_handle() exposes the backend's OS readiness object
+//    (eventfd / kqueue fd / Windows event) so callers can block in
+//    their own epoll / kevent / WaitForMultipleObjects loop.
+//  • rrl_wait_any() blocks on those objects itself when every handle
+//    has one, and falls back to polling with a bounded back‑off
+//    otherwise.  Either way readiness is re‑checked through
+//    rrl_poll_many(), so spurious wake‑ups are harmless.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#elif defined(__APPLE__)
+#  include <sys/event.h>
+#  include <unistd.h>
+#elif defined(__unix__)
+#  include <poll.h>
+#  include <time.h>
+#endif
+
+using namespace rrl::detail;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int64_t kBackoffStartUs = 50;
+constexpr int64_t kBackoffMaxUs   = 1000;   // bounds added latency without a wait handle
+
+struct WaitScratch {
+    std::vector<uint64_t>      mask;
+    std::vector<RRLWaitHandle> waits;
+};
+thread_local WaitScratch t_wait;   // grows once, reused every call
+
+// Lowest ready index, -1 if none, or a negative RRL_ERR_* (< -1).
+int first_ready(const RRLHandle* handles, size_t n, std::vector<uint64_t>& mask)
+{
+    mask.resize(RRL_MASK_WORDS(n));
+    int rc = rrl_poll_many(handles, n, mask.data(), nullptr);
+    if (rc < 0) return rc;
+    if (rc == 0) return -1;
+    for (size_t w = 0; w < mask.size(); ++w)
+        if (mask[w]) return static_cast<int>(w * 64) + ctz64(mask[w]);
+    return -1;
+}
+
+// Snapshot every handle's wait object; false if any has none.
+bool gather_waits(const RRLHandle* handles, size_t n, std::vector<RRLWaitHandle>& out)
+{
+    BackendGuard be;
+    auto get = be->ext.get_wait_handle;
+    if (!get) return false;
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        RRLWaitHandle w = RRL_INVALID_WAIT_HANDLE;
+        if (get(handles[i], &w) != RRL_SUCCESS || w == RRL_INVALID_WAIT_HANDLE) return false;
+        out[i] = w;
+    }
+    return true;
+}
+
+// Block until some wait object fires or `us` elapses (negative =
+// forever).  False if the objects cannot be waited on, so the caller
+// switches to back‑off polling.
+bool os_wait(const std::vector<RRLWaitHandle>& waits, int64_t us)
+{
+#if defined(_WIN32)
+    if (waits.size() > MAXIMUM_WAIT_OBJECTS) return false;
+    std::vector<HANDLE> hs(waits.size());
+    for (size_t i = 0; i < waits.size(); ++i) hs[i] = reinterpret_cast<HANDLE>(waits[i]);
+    const DWORD ms = us < 0 ? INFINITE : static_cast<DWORD>(std::min<int64_t>((us + 999) / 1000, INFINITE - 1));
+    const DWORD rc = WaitForMultipleObjects(static_cast<DWORD>(hs.size()), hs.data(), FALSE, ms);
+    return rc != WAIT_FAILED;
+#elif defined(__APPLE__)
+    // One kqueue per thread, rebuilt only when the set of objects
+    // changes so none stays registered from an earlier call.  EV_ADD
+    // on every call re-registers an fd number reused since.
+    struct KQueue {
+        int fd = -1;
+        std::vector<RRLWaitHandle> waits;
+        std::vector<struct kevent> evs;
+        ~KQueue() { if (fd >= 0) close(fd); }
+    };
+    thread_local KQueue kq;
+    try {
+        if (kq.fd < 0 || kq.waits != waits) {
+            if (kq.fd >= 0) close(kq.fd);
+            if ((kq.fd = kqueue()) < 0) return false;
+            kq.waits = waits;
+        }
+        kq.evs.resize(waits.size());
+    } catch (const std::bad_alloc&) {
+        close(kq.fd);
+        kq.fd = -1;
+        return false;
+    }
+    for (size_t i = 0; i < waits.size(); ++i)
+        EV_SET(&kq.evs[i], static_cast<uintptr_t>(waits[i]), EVFILT_READ, EV_ADD, 0, 0, nullptr);
+    struct timespec ts{ static_cast<time_t>(us / 1000000), static_cast<long>(us % 1000000) * 1000 };
+    struct kevent fired{};
+    const int rc = kevent(kq.fd, kq.evs.data(), static_cast<int>(kq.evs.size()), &fired, 1, us < 0 ? nullptr : &ts);
+    return rc >= 0 && !(rc == 1 && (fired.flags & EV_ERROR));
+#elif defined(__unix__)
+    thread_local std::vector<struct pollfd> fds;
+    fds.resize(waits.size());
+    for (size_t i = 0; i < waits.size(); ++i)
+        fds[i] = pollfd{ static_cast<int>(waits[i]), POLLIN, 0 };
+#  if defined(__linux__)
+    struct timespec ts{ static_cast<time_t>(us / 1000000), static_cast<long>(us % 1000000) * 1000 };
+    const int rc = ppoll(fds.data(), fds.size(), us < 0 ? nullptr : &ts, nullptr);
+#  else
+    const int ms = us < 0 ? -1 : static_cast<int>(std::min<int64_t>((us + 999) / 1000, INT_MAX));
+    const int rc = poll(fds.data(), fds.size(), ms);
+#  endif
+    if (rc < 0) return errno == EINTR;
+    for (const pollfd& p : fds)
+        if (p.revents & POLLNVAL) return false;
+    return true;
+#else
+    (void)waits; (void)us;
+    return false;
+#endif
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLWaitHandle RRL_WEAK rrl_get_wait_handle(RRLHandle handle)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_get_wait_handle: null handle");
+        return RRL_INVALID_WAIT_HANDLE;
+    }
+    BackendGuard be;
+    RRLWaitHandle w = RRL_INVALID_WAIT_HANDLE;
+    auto get = be->ext.get_wait_handle;
+    int rc = get ? get(handle, &w) : RRL_ERR_UNSUPPORTED;
+    if (rc == RRL_SUCCESS && w == RRL_INVALID_WAIT_HANDLE) rc = RRL_ERR_UNSUPPORTED;
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, "rrl_get_wait_handle: backend has no wait handle");
+        return RRL_INVALID_WAIT_HANDLE;
+    }
+    return w;
+}
+
+int RRL_WEAK rrl_wait_any(const RRLHandle* handles, size_t n, int64_t timeout_us)
+{
+    if (!handles || n == 0 || n > static_cast<size_t>(INT_MAX)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wait_any: bad handle array");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (!handles[i]) {
+            set_error(RRL_ERR_INVALID_HANDLE, "rrl_wait_any: null handle");
+            return RRL_ERR_INVALID_HANDLE;
+        }
+    }
+
+    {
+        // The hook may block for the whole timeout; holding the guard
+        // only delays reclamation of a swapped‑out table.
+        BackendGuard be;
+        if (auto wait = be->ext.wait_any) {
+            int rc = wait(handles, n, timeout_us);
+            if (rc < 0) set_error(rc, rc == RRL_ERR_TIMEOUT ? "rrl_wait_any: timed out"
+                                                            : "rrl_wait_any: backend error");
+            return rc;
+        }
+    }
+
+    WaitScratch& sc = t_wait;
+    const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(std::max<int64_t>(timeout_us, 0));
+    bool    use_os  = gather_waits(handles, n, sc.waits);
+    int64_t backoff = kBackoffStartUs;
+    for (;;) {
+        const int idx = first_ready(handles, n, sc.mask);
+        if (idx >= 0 || idx < -1) return idx;   // ready, or error already recorded
+
+        int64_t left = -1;
+        if (timeout_us >= 0) {
+            left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now()).count();
+            if (left <= 0) {
+                set_error(RRL_ERR_TIMEOUT, "rrl_wait_any: timed out");
+                return RRL_ERR_TIMEOUT;
+            }
+        }
+        if (use_os && os_wait(sc.waits, left)) continue;
+        use_os = false;
+        const int64_t nap = left < 0 ? backoff : std::min(backoff, left);
+        std::this_thread::sleep_for(std::chrono::microseconds(nap));
+        backoff = std::min(backoff * 2, kBackoffMaxUs);
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,245 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_wire.cpp  —  Binary step frames (layout in rrl_wire.h)
+//
+//  • The schema is derived from the handle's RRL_SpaceDesc pair,
+//    so per‑step frames carry nothing the peer cannot compute.
+//  • Encoding is a header store plus memcpy of the tensors;
+//    decoding only validates sizes and returns pointers.
+//─────────────────────────────────────────────────────────────
+#include "rrl_wire.h"
+#include "rrl_internal.hpp"
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+using namespace rrl::detail;
+
+static_assert(sizeof(RRL_WireSpace)  == 40,  "RRL_WireSpace layout");
+static_assert(sizeof(RRL_WireSchema) == 112, "RRL_WireSchema layout");
+static_assert(sizeof(RRL_WireHeader) == 16,  "RRL_WireHeader layout");
+
+namespace {
+
+constexpr size_t kHeader = sizeof(RRL_WireHeader);
+
+constexpr size_t align_up(size_t v) { return (v + RRL_WIRE_ALIGN - 1) / RRL_WIRE_ALIGN * RRL_WIRE_ALIGN; }
+
+bool to_wire(const RRL_SpaceDesc& d, RRL_WireSpace& w, uint32_t& bytes)
+{
+    const size_t n = rrl_space_bytes(&d);
+    if (n == 0 || n > UINT32_MAX) return false;
+    w = RRL_WireSpace{};
+    w.dtype = d.dtype;
+    w.ndim  = static_cast<uint32_t>(d.ndim);
+    for (int i = 0; i < d.ndim; ++i) w.shape[i] = static_cast<uint32_t>(d.shape[i]);
+    bytes = static_cast<uint32_t>(n);
+    return true;
+}
+
+// Recompute a received space's size; false if malformed or inconsistent.
+bool check_wire(const RRL_WireSpace& w, uint32_t bytes)
+{
+    if (w.ndim == 0 || w.ndim > 8) return false;
+    RRL_SpaceDesc d{};
+    d.ndim  = static_cast<int>(w.ndim);
+    d.dtype = w.dtype;
+    for (uint32_t i = 0; i < w.ndim; ++i) {
+        if (w.shape[i] > static_cast<uint32_t>(INT_MAX)) return false;
+        d.shape[i] = static_cast<int>(w.shape[i]);
+    }
+    return rrl_space_bytes(&d) == bytes;
+}
+
+// Offsets of a STEP frame's arrays; false on size_t overflow.
+bool step_layout(const RRL_WireSchema& s, size_t count, size_t& dones, size_t& tensors, size_t& total)
+{
+    if (count > (SIZE_MAX - 2 * RRL_WIRE_ALIGN - kHeader) / 5) return false;
+    dones   = kHeader + count * sizeof(float);
+    tensors = align_up(dones + count);
+    if (s.obs_bytes && count > (SIZE_MAX - tensors) / s.obs_bytes) return false;
+    total = tensors + count * s.obs_bytes;
+    return true;
+}
+
+bool valid_schema(const RRL_WireSchema* s)
+{
+    return s && s->magic == RRL_WIRE_MAGIC && s->kind == RRL_WIRE_SCHEMA &&
+           s->obs_bytes != 0 && s->action_bytes != 0;
+}
+
+void put_header(void* out, uint16_t kind, uint32_t seq, size_t count)
+{
+    RRL_WireHeader h{};
+    h.kind  = kind;
+    h.seq   = seq;
+    h.count = static_cast<uint32_t>(count);
+    std::memcpy(out, &h, sizeof(h));
+}
+
+// Copy `count` tensors of `bytes` each, read every `stride` bytes.
+void gather(unsigned char* dst, const void* src, size_t count, size_t bytes, size_t stride)
+{
+    if (stride == 0 || stride == bytes) {
+        std::memcpy(dst, src, count * bytes);
+        return;
+    }
+    auto* s = static_cast<const unsigned char*>(src);
+    for (size_t i = 0; i < count; ++i) std::memcpy(dst + i * bytes, s + i * stride, bytes);
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+int rrl_wire_schema(const RRL_SpaceDesc* obs, const RRL_SpaceDesc* action, RRL_WireSchema* out)
+{
+    if (!obs || !action || !out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_schema: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRL_WireSchema s{};
+    s.magic   = RRL_WIRE_MAGIC;
+    s.version = RRL_WIRE_VERSION;
+    s.kind    = RRL_WIRE_SCHEMA;
+    if (!to_wire(*obs, s.obs, s.obs_bytes) || !to_wire(*action, s.action, s.action_bytes)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_schema: invalid or oversized space");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    *out = s;
+    return RRL_SUCCESS;
+}
+
+int rrl_wire_read_schema(const void* frame, size_t len, RRL_WireSchema* out)
+{
+    if (!frame || !out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_read_schema: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRL_WireSchema s;
+    if (len != sizeof(s)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_read_schema: wrong frame size");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    std::memcpy(&s, frame, sizeof(s));
+    if (s.magic != RRL_WIRE_MAGIC || s.kind != RRL_WIRE_SCHEMA) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_read_schema: not a schema frame");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (s.version != RRL_WIRE_VERSION) {
+        set_error(RRL_ERR_UNSUPPORTED, "rrl_wire_read_schema: unsupported wire version");
+        return RRL_ERR_UNSUPPORTED;
+    }
+    if (!check_wire(s.obs, s.obs_bytes) || !check_wire(s.action, s.action_bytes)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_read_schema: space and size disagree");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    *out = s;
+    return RRL_SUCCESS;
+}
+
+size_t rrl_wire_frame_bytes(const RRL_WireSchema* schema, int kind, size_t count)
+{
+    if (!valid_schema(schema) || count == 0 || count > UINT32_MAX) return 0;
+    if (kind == RRL_WIRE_STEP) {
+        size_t dones, tensors, total;
+        return step_layout(*schema, count, dones, tensors, total) ? total : 0;
+    }
+    if (kind == RRL_WIRE_ACTION) {
+        if (count > (SIZE_MAX - kHeader) / schema->action_bytes) return 0;
+        return kHeader + count * schema->action_bytes;
+    }
+    return 0;
+}
+
+size_t rrl_wire_write_step(const RRL_WireSchema* schema, uint32_t seq, size_t count,
+                           const void* obs, size_t obs_stride,
+                           const float* rewards, const uint8_t* dones,
+                           void* out, size_t cap)
+{
+    RRL_TRACE_SCOPE(RRL_SPAN_SERIALIZE, nullptr);
+    size_t off_dones = 0, off_tensors = 0, total = 0;
+    if (!valid_schema(schema) || count == 0 || count > UINT32_MAX ||
+        !step_layout(*schema, count, off_dones, off_tensors, total) ||
+        !obs || !out || (obs_stride && obs_stride < schema->obs_bytes)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_write_step: bad schema or arg");
+        return 0;
+    }
+    if (cap < total) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_write_step: output buffer too small");
+        return 0;
+    }
+    auto* p = static_cast<unsigned char*>(out);
+    put_header(p, RRL_WIRE_STEP, seq, count);
+    if (rewards) std::memcpy(p + kHeader, rewards, count * sizeof(float));
+    else         std::memset(p + kHeader, 0, count * sizeof(float));
+    if (dones)   std::memcpy(p + off_dones, dones, count);
+    else         std::memset(p + off_dones, 0, count);
+    std::memset(p + off_dones + count, 0, off_tensors - off_dones - count);
+    gather(p + off_tensors, obs, count, schema->obs_bytes, obs_stride);
+    return total;
+}
+
+size_t rrl_wire_write_action(const RRL_WireSchema* schema, uint32_t seq, size_t count,
+                             const void* actions, size_t action_stride,
+                             void* out, size_t cap)
+{
+    RRL_TRACE_SCOPE(RRL_SPAN_SERIALIZE, nullptr);
+    const size_t total = rrl_wire_frame_bytes(schema, RRL_WIRE_ACTION, count);
+    if (!total || !actions || !out || (action_stride && action_stride < schema->action_bytes)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_write_action: bad schema or arg");
+        return 0;
+    }
+    if (cap < total) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_write_action: output buffer too small");
+        return 0;
+    }
+    auto* p = static_cast<unsigned char*>(out);
+    put_header(p, RRL_WIRE_ACTION, seq, count);
+    gather(p + kHeader, actions, count, schema->action_bytes, action_stride);
+    return total;
+}
+
+int rrl_wire_parse(const RRL_WireSchema* schema, const void* frame, size_t len, RRL_WireFrame* out)
+{
+    RRL_TRACE_SCOPE(RRL_SPAN_DESERIALIZE, nullptr);
+    if (!valid_schema(schema) || !frame || !out || len < kHeader) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_parse: bad schema or arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (reinterpret_cast<uintptr_t>(frame) % alignof(float) != 0) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_parse: frame not 4-byte aligned");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRL_WireFrame f{};
+    std::memcpy(&f.header, frame, kHeader);
+    if (f.header.kind != RRL_WIRE_STEP && f.header.kind != RRL_WIRE_ACTION) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_parse: not a step or action frame");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (f.header.flags != 0) {
+        set_error(RRL_ERR_UNSUPPORTED, "rrl_wire_parse: encoded frame (use rrl_wire_codec_read)");
+        return RRL_ERR_UNSUPPORTED;
+    }
+    if (rrl_wire_frame_bytes(schema, f.header.kind, f.header.count) != len) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_parse: frame size does not match schema");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    auto* p = static_cast<const unsigned char*>(frame);
+    if (f.header.kind == RRL_WIRE_STEP) {
+        size_t off_dones = 0, off_tensors = 0, total = 0;
+        if (!step_layout(*schema, f.header.count, off_dones, off_tensors, total)) {
+            set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_parse: frame size does not match schema");
+            return RRL_ERR_INVALID_ARGUMENT;
+        }
+        f.rewards = reinterpret_cast<const float*>(p + kHeader);
+        f.dones   = p + off_dones;
+        f.tensors = p + off_tensors;
+    } else {
+        f.tensors = p + kHeader;
+    }
+    *out = f;
+    return RRL_SUCCESS;
+}
+
+} // extern "C"
@@ -0,0 +1,459 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_wire_codec.cpp  —  Per‑stream XOR‑delta + LZ4 / zstd
+//
+//  • Writer: encode the plain STEP frame, XOR its observations with
+//    the previous frame's, then compress everything after the header
+//    (rewards / dones are tiny; the observations dominate).
+//  • Reader: the exact inverse; it keeps the last reconstructed
+//    observations, so frames must arrive in order (one codec per
+//    stream and direction).
+//  • LZ4 / zstd are compiled in with RRL_HAVE_LZ4 / RRL_HAVE_ZSTD
+//    (CMake finds them); without them only delta‑free plain frames
+//    and RRL_WIRE_COMP_NONE configs are accepted.
+//─────────────────────────────────────────────────────────────
+#include "rrl_wire.h"
+#include "rrl_internal.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#if defined(RRL_HAVE_ZSTD)
+#  include <zstd.h>
+#  include <zdict.h>
+#endif
+#if defined(RRL_HAVE_LZ4)
+#  include <lz4.h>
+#endif
+
+using namespace rrl::detail;
+
+struct RRLWireCodecImpl {
+    RRL_WireSchema             schema{};
+    int                        compression = RRL_WIRE_COMP_NONE;
+    int                        level       = 1;
+    bool                       delta       = false;
+    uint32_t                   keyframe_interval = 0;
+    std::vector<unsigned char> dict;
+    uint32_t                   dict_id = 0;
+
+    // Delta state: last observations written (writer) or rebuilt (reader)
+    std::vector<unsigned char> prev;
+    size_t                     prev_count = 0;   // 0 = next frame is a keyframe
+    uint32_t                   since_key  = 0;
+
+    std::vector<unsigned char> plain;            // one decoded / pre-compression frame
+
+#if defined(RRL_HAVE_ZSTD)
+    ZSTD_CCtx*  cctx  = nullptr;
+    ZSTD_DCtx*  dctx  = nullptr;
+    ZSTD_CDict* cdict = nullptr;
+    ZSTD_DDict* ddict = nullptr;
+#endif
+#if defined(RRL_HAVE_LZ4)
+    LZ4_stream_t* lz4 = nullptr;
+#endif
+
+    ~RRLWireCodecImpl() {
+#if defined(RRL_HAVE_ZSTD)
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+#endif
+#if defined(RRL_HAVE_LZ4)
+        if (lz4) LZ4_freeStream(lz4);
+#endif
+    }
+};
+
+namespace {
+
+constexpr size_t kHeader = sizeof(RRL_WireHeader);
+
+// FNV-1a, never 0 (0 means "no dictionary" on the wire).
+uint32_t dict_hash(const unsigned char* p, size_t n)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 16777619u;
+    return h ? h : 1;
+}
+
+// Offset of the observation tensors inside a STEP frame of `count`.
+size_t tensor_offset(size_t count)
+{
+    const size_t dones = kHeader + count * sizeof(float);
+    return (dones + count + RRL_WIRE_ALIGN - 1) / RRL_WIRE_ALIGN * RRL_WIRE_ALIGN;
+}
+
+// Writer: `cur` becomes cur ^ prev and `prev` becomes the old `cur`.
+void xor_swap(unsigned char* cur, unsigned char* prev, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t c, p;
+        std::memcpy(&c, cur + i, 8);
+        std::memcpy(&p, prev + i, 8);
+        const uint64_t d = c ^ p;
+        std::memcpy(cur + i, &d, 8);
+        std::memcpy(prev + i, &c, 8);
+    }
+    for (; i < n; ++i) {
+        const unsigned char c = cur[i];
+        cur[i] ^= prev[i];
+        prev[i] = c;
+    }
+}
+
+// Reader: `cur` (a delta) becomes cur ^ prev, and `prev` follows it.
+void xor_apply(unsigned char* cur, unsigned char* prev, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t c, p;
+        std::memcpy(&c, cur + i, 8);
+        std::memcpy(&p, prev + i, 8);
+        const uint64_t r = c ^ p;
+        std::memcpy(cur + i, &r, 8);
+        std::memcpy(prev + i, &r, 8);
+    }
+    for (; i < n; ++i) prev[i] = cur[i] ^= prev[i];
+}
+
+size_t compress_bound(const RRLWireCodecImpl& c, size_t n)
+{
+    switch (c.compression) {
+#if defined(RRL_HAVE_ZSTD)
+    case RRL_WIRE_COMP_ZSTD: return ZSTD_compressBound(n);
+#endif
+#if defined(RRL_HAVE_LZ4)
+    case RRL_WIRE_COMP_LZ4:
+        return n <= static_cast<size_t>(LZ4_MAX_INPUT_SIZE) ? static_cast<size_t>(LZ4_compressBound(static_cast<int>(n))) : 0;
+#endif
+    default: return n;
+    }
+}
+
+// Compress `n` bytes; 0 if it failed or would not shrink.
+size_t compress(RRLWireCodecImpl& c, const unsigned char* src, size_t n, unsigned char* dst, size_t cap)
+{
+    (void)src; (void)n; (void)dst; (void)cap;
+    switch (c.compression) {
+#if defined(RRL_HAVE_ZSTD)
+    case RRL_WIRE_COMP_ZSTD: {
+        const size_t r = c.cdict ? ZSTD_compress_usingCDict(c.cctx, dst, cap, src, n, c.cdict)
+                                 : ZSTD_compressCCtx(c.cctx, dst, cap, src, n, c.level);
+        return ZSTD_isError(r) || r >= n ? 0 : r;
+    }
+#endif
+#if defined(RRL_HAVE_LZ4)
+    case RRL_WIRE_COMP_LZ4: {
+        if (n > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) return 0;
+        const int cap_i = cap > static_cast<size_t>(INT32_MAX) ? INT32_MAX : static_cast<int>(cap);
+        // Each frame stands alone: reload the dictionary, no history carried over.
+        LZ4_loadDict(c.lz4, reinterpret_cast<const char*>(c.dict.data()), static_cast<int>(c.dict.size()));
+        const int r = LZ4_compress_fast_continue(c.lz4, reinterpret_cast<const char*>(src),
+                                                 reinterpret_cast<char*>(dst),
+                                                 static_cast<int>(n), cap_i, c.level);
+        return r <= 0 || static_cast<size_t>(r) >= n ? 0 : static_cast<size_t>(r);
+    }
+#endif
+    default: return 0;
+    }
+}
+
+// Decompress into exactly `n` bytes.
+bool decompress(RRLWireCodecImpl& c, unsigned flag, const unsigned char* src, size_t len,
+                unsigned char* dst, size_t n)
+{
+    (void)c; (void)src; (void)len; (void)dst; (void)n;
+#if defined(RRL_HAVE_ZSTD)
+    if (flag == RRL_WIRE_F_ZSTD) {
+        if (!c.dctx && !(c.dctx = ZSTD_createDCtx())) return false;
+        const size_t r = c.ddict ? ZSTD_decompress_usingDDict(c.dctx, dst, n, src, len, c.ddict)
+                                 : ZSTD_decompressDCtx(c.dctx, dst, n, src, len);
+        return !ZSTD_isError(r) && r == n;
+    }
+#endif
+#if defined(RRL_HAVE_LZ4)
+    if (flag == RRL_WIRE_F_LZ4) {
+        if (len > static_cast<size_t>(INT32_MAX) || n > static_cast<size_t>(INT32_MAX)) return false;
+        const int r = LZ4_decompress_safe_usingDict(reinterpret_cast<const char*>(src),
+                                                    reinterpret_cast<char*>(dst),
+                                                    static_cast<int>(len), static_cast<int>(n),
+                                                    reinterpret_cast<const char*>(c.dict.data()),
+                                                    static_cast<int>(c.dict.size()));
+        return r >= 0 && static_cast<size_t>(r) == n;
+    }
+#endif
+    (void)flag;
+    return false;
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+int rrl_wire_codec_available(int compression)
+{
+    switch (compression) {
+    case RRL_WIRE_COMP_NONE: return 1;
+#if defined(RRL_HAVE_LZ4)
+    case RRL_WIRE_COMP_LZ4:  return 1;
+#endif
+#if defined(RRL_HAVE_ZSTD)
+    case RRL_WIRE_COMP_ZSTD: return 1;
+#endif
+    default:                 return 0;
+    }
+}
+
+RRLWireCodec rrl_wire_codec_create(const RRL_WireSchema* schema, const RRL_WireCodecConfig* cfg)
+{
+    if (!schema || !rrl_wire_frame_bytes(schema, RRL_WIRE_STEP, 1) || !cfg ||
+        cfg->struct_size < sizeof(RRL_WireCodecConfig)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_create: bad schema or config");
+        return nullptr;
+    }
+    if (!rrl_wire_codec_available(cfg->compression)) {
+        set_error(RRL_ERR_UNSUPPORTED, "rrl_wire_codec_create: compression not built in");
+        return nullptr;
+    }
+    if (cfg->delta && cfg->compression == RRL_WIRE_COMP_NONE) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_create: delta needs compression");
+        return nullptr;
+    }
+    if ((cfg->dict_len && !cfg->dict) || cfg->dict_len > static_cast<size_t>(INT32_MAX)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_create: bad dictionary");
+        return nullptr;
+    }
+
+    auto* c = new (std::nothrow) RRLWireCodecImpl;
+    if (!c) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_wire_codec_create: out of memory");
+        return nullptr;
+    }
+    c->schema            = *schema;
+    c->compression       = cfg->compression;
+    c->level             = cfg->level > 0 ? cfg->level : 1;
+    c->delta             = cfg->delta != 0;
+    c->keyframe_interval = cfg->keyframe_interval;
+    if (cfg->dict_len) {
+        auto* d = static_cast<const unsigned char*>(cfg->dict);
+        try {
+            c->dict.assign(d, d + cfg->dict_len);
+        } catch (const std::bad_alloc&) {
+            delete c;
+            set_error(RRL_ERR_NO_MEMORY, "rrl_wire_codec_create: out of memory");
+            return nullptr;
+        }
+        c->dict_id = dict_hash(d, cfg->dict_len);
+    }
+
+    bool ok = true;
+#if defined(RRL_HAVE_ZSTD)
+    if (c->compression == RRL_WIRE_COMP_ZSTD) {
+        ok = (c->cctx = ZSTD_createCCtx()) != nullptr;
+        // Digest the dictionary once, not per frame.
+        if (ok && !c->dict.empty())
+            ok = (c->cdict = ZSTD_createCDict(c->dict.data(), c->dict.size(), c->level)) != nullptr &&
+                 (c->ddict = ZSTD_createDDict(c->dict.data(), c->dict.size())) != nullptr;
+    }
+#endif
+#if defined(RRL_HAVE_LZ4)
+    if (c->compression == RRL_WIRE_COMP_LZ4)
+        ok = (c->lz4 = LZ4_createStream()) != nullptr;
+#endif
+    if (!ok) {
+        delete c;
+        set_error(RRL_ERR_NO_MEMORY, "rrl_wire_codec_create: compressor init failed");
+        return nullptr;
+    }
+    return c;
+}
+
+void rrl_wire_codec_destroy(RRLWireCodec codec)
+{
+    delete codec;
+}
+
+void rrl_wire_codec_reset(RRLWireCodec codec)
+{
+    if (codec) codec->prev_count = 0;
+}
+
+size_t rrl_wire_codec_bound(RRLWireCodec codec, size_t count)
+{
+    if (!codec) return 0;
+    const size_t plain = rrl_wire_frame_bytes(&codec->schema, RRL_WIRE_STEP, count);
+    if (!plain) return 0;
+    const size_t packed = compress_bound(*codec, plain - kHeader);
+    return kHeader + (packed > plain - kHeader ? packed : plain - kHeader);
+}
+
+size_t rrl_wire_codec_write_step(RRLWireCodec codec, uint32_t seq, size_t count,
+                                 const void* obs, size_t obs_stride,
+                                 const float* rewards, const uint8_t* dones,
+                                 void* out, size_t cap)
+{
+    RRL_TRACE_SCOPE(RRL_SPAN_SERIALIZE, nullptr);
+    if (!codec || !out) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_write_step: null arg");
+        return 0;
+    }
+    RRLWireCodecImpl& c = *codec;
+    if (c.compression == RRL_WIRE_COMP_NONE)   // no transform: write straight out
+        return rrl_wire_write_step(&c.schema, seq, count, obs, obs_stride, rewards, dones, out, cap);
+
+    const size_t plain = rrl_wire_frame_bytes(&c.schema, RRL_WIRE_STEP, count);
+    c.plain.resize(plain);
+    if (!plain || !rrl_wire_write_step(&c.schema, seq, count, obs, obs_stride, rewards, dones,
+                                       c.plain.data(), plain))
+        return 0;   // error already recorded
+
+    RRL_WireHeader h;
+    std::memcpy(&h, c.plain.data(), kHeader);
+    h.dict_id = c.dict_id;
+    if (c.delta) {
+        const size_t off = tensor_offset(count), n = plain - off;
+        const bool key = c.prev_count != count ||
+                         (c.keyframe_interval && c.since_key + 1 >= c.keyframe_interval);
+        if (key) {
+            c.prev.assign(c.plain.begin() + static_cast<std::ptrdiff_t>(off), c.plain.end());
+            c.prev_count = count;
+            c.since_key  = 0;
+        } else {
+            xor_swap(c.plain.data() + off, c.prev.data(), n);
+            h.flags |= RRL_WIRE_F_DELTA;
+            ++c.since_key;
+        }
+    }
+
+    auto* dst = static_cast<unsigned char*>(out);
+    size_t body = cap > kHeader
+        ? compress(c, c.plain.data() + kHeader, plain - kHeader, dst + kHeader, cap - kHeader) : 0;
+    if (body) {
+        h.flags |= c.compression == RRL_WIRE_COMP_ZSTD ? RRL_WIRE_F_ZSTD : RRL_WIRE_F_LZ4;
+    } else {
+        // Incompressible: ship the (possibly delta-coded) payload as is.
+        body = plain - kHeader;
+        if (cap < plain) {
+            if (c.delta) c.prev_count = 0;   // the peer never sees this frame
+            set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_write_step: output buffer too small");
+            return 0;
+        }
+        std::memcpy(dst + kHeader, c.plain.data() + kHeader, body);
+    }
+    if (!h.flags) h.dict_id = 0;
+    std::memcpy(dst, &h, kHeader);
+    return kHeader + body;
+}
+
+int rrl_wire_codec_read(RRLWireCodec codec, const void* frame, size_t len, RRL_WireFrame* out)
+{
+    RRL_TRACE_SCOPE(RRL_SPAN_DESERIALIZE, nullptr);
+    if (!codec || !frame || !out || len < kHeader) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_read: bad arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRLWireCodecImpl& c = *codec;
+    RRL_WireHeader h;
+    std::memcpy(&h, frame, kHeader);
+
+    // Plain frames with no delta state to track are parsed in place.
+    if (h.flags == 0 && (h.kind != RRL_WIRE_STEP || !c.delta))
+        return rrl_wire_parse(&c.schema, frame, len, out);
+
+    const unsigned comp = h.flags & (RRL_WIRE_F_LZ4 | RRL_WIRE_F_ZSTD);
+    if (h.kind != RRL_WIRE_STEP || (h.flags & ~(RRL_WIRE_F_DELTA | RRL_WIRE_F_LZ4 | RRL_WIRE_F_ZSTD)) ||
+        comp == (RRL_WIRE_F_LZ4 | RRL_WIRE_F_ZSTD)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_read: bad frame flags");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (comp && h.dict_id != c.dict_id) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_read: dictionary mismatch");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    const size_t plain = rrl_wire_frame_bytes(&c.schema, RRL_WIRE_STEP, h.count);
+    if (!plain) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_read: bad count");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    c.plain.resize(plain);
+    auto* src = static_cast<const unsigned char*>(frame);
+    if (comp) {
+        if (!decompress(c, comp, src + kHeader, len - kHeader, c.plain.data() + kHeader, plain - kHeader)) {
+            set_error(rrl_wire_codec_available(comp == RRL_WIRE_F_ZSTD ? RRL_WIRE_COMP_ZSTD : RRL_WIRE_COMP_LZ4)
+                          ? RRL_ERR_IO : RRL_ERR_UNSUPPORTED,
+                      "rrl_wire_codec_read: decompression failed");
+            return rrl_last_error();
+        }
+    } else {
+        if (len != plain) {
+            set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_read: frame size does not match schema");
+            return RRL_ERR_INVALID_ARGUMENT;
+        }
+        std::memcpy(c.plain.data() + kHeader, src + kHeader, plain - kHeader);
+    }
+
+    const size_t off = tensor_offset(h.count), n = plain - off;
+    if (h.flags & RRL_WIRE_F_DELTA) {
+        if (!c.delta || c.prev_count != h.count) {
+            set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_codec_read: delta frame without keyframe");
+            return RRL_ERR_INVALID_ARGUMENT;
+        }
+        xor_apply(c.plain.data() + off, c.prev.data(), n);
+    } else if (c.delta) {
+        c.prev.assign(c.plain.begin() + static_cast<std::ptrdiff_t>(off), c.plain.end());
+        c.prev_count = h.count;
+    }
+
+    h.flags = 0;
+    h.dict_id = 0;
+    std::memcpy(c.plain.data(), &h, kHeader);
+    return rrl_wire_parse(&c.schema, c.plain.data(), plain, out);
+}
+
+size_t rrl_wire_train_dict(const void* samples, const size_t* sample_sizes, unsigned n,
+                           void* dict, size_t dict_cap)
+{
+    if (!samples || !sample_sizes || !n || !dict || !dict_cap) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_train_dict: null arg");
+        return 0;
+    }
+#if defined(RRL_HAVE_ZSTD)
+    const size_t r = ZDICT_trainFromBuffer(dict, dict_cap, samples, sample_sizes, n);
+    if (ZDICT_isError(r)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_train_dict: training failed (too few samples?)");
+        return 0;
+    }
+    return r;
+#else
+    set_error(RRL_ERR_UNSUPPORTED, "rrl_wire_train_dict: built without zstd");
+    return 0;
+#endif
+}
+
+int RRL_WEAK rrl_set_wire_codec(RRLHandle handle, const RRL_WireCodecConfig* cfg)
+{
+    if (!handle) {
+        set_error(RRL_ERR_INVALID_HANDLE, "rrl_set_wire_codec: null handle");
+        return RRL_ERR_INVALID_HANDLE;
+    }
+    if (cfg && cfg->struct_size < sizeof(RRL_WireCodecConfig)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_set_wire_codec: bad struct_size");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    const bool plain = !cfg || (cfg->compression == RRL_WIRE_COMP_NONE && !cfg->delta);
+    BackendGuard be;
+    auto set = be->ext.set_wire_codec;
+    int rc = set ? set(handle, cfg) : plain ? RRL_SUCCESS : RRL_ERR_UNSUPPORTED;
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, set ? "rrl_set_wire_codec: backend error"
+                          : "rrl_set_wire_codec: backend sends plain frames only");
+    }
+    return rc;
+}
+
+} // extern "C"
@@ -0,0 +1,330 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_wire_mux.cpp  —  Many streams over few connections
+//
+//  • Writers append records to their connection's pending batch
+//    under a short per‑connection lock (one memcpy); the batch that
+//    is being sent sits in a second buffer, so a slow send never
+//    blocks writers of the next batch.
+//  • A batch leaves when it reaches max_batch_bytes (on the writer
+//    that filled it) or when its oldest record is flush_us old (on
+//    the flush thread, Nagle‑style, or on a writer that notices).
+//  • The flush thread sleeps until the earliest batch deadline and
+//    is woken only when a connection starts a new batch.
+//─────────────────────────────────────────────────────────────
+#include "rrl_wire.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace rrl::detail;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t kDefaultFlushUs   = 500;
+constexpr size_t   kDefaultBatch     = 64 * 1024;
+constexpr size_t   kMaxFrame         = size_t(1) << 30;   // keeps RRL_WireMuxHeader.bytes in range
+constexpr size_t   kHeader           = sizeof(RRL_WireMuxHeader);
+constexpr size_t   kRecord           = sizeof(RRL_WireMuxRecord);
+
+constexpr size_t pad(size_t n) { return (n + RRL_WIRE_ALIGN - 1) / RRL_WIRE_ALIGN * RRL_WIRE_ALIGN; }
+
+int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+struct Conn {
+    std::mutex                 mtx;        // pending, records, error
+    std::vector<unsigned char> pending;    // header space | records
+    uint32_t                   records = 0;
+    int                        error   = RRL_SUCCESS;
+    std::atomic<int64_t>       first_ns{0};   // oldest pending record, 0 = empty
+
+    std::mutex                 send_mtx;   // sending, seq; one send at a time
+    std::vector<unsigned char> sending;
+    uint32_t                   seq = 0;
+};
+
+} // namespace (anonymous)
+
+struct RRLMuxImpl {
+    RRL_MuxSend send = nullptr;
+    void*       user = nullptr;
+    int64_t     flush_ns  = 0;
+    size_t      max_batch = 0;
+    std::vector<std::unique_ptr<Conn>> conns;
+
+    std::mutex              wake_mtx;
+    std::condition_variable wake;
+    bool                    woken = false;
+    bool                    stop  = false;
+    std::thread             flusher;
+};
+
+namespace {
+
+// Ships connection `idx`'s pending batch, if any; the send's result.
+int flush_conn(RRLMuxImpl& m, unsigned idx)
+{
+    Conn& c = *m.conns[idx];
+    std::lock_guard<std::mutex> sl(c.send_mtx);
+    {
+        std::lock_guard<std::mutex> lk(c.mtx);
+        if (!c.records) return RRL_SUCCESS;
+        c.sending.swap(c.pending);
+        c.pending.resize(kHeader);   // keeps the last batch's capacity
+        RRL_WireMuxHeader h{};
+        h.kind  = RRL_WIRE_MUX;
+        h.seq   = c.seq++;
+        h.count = c.records;
+        h.bytes = static_cast<uint32_t>(c.sending.size());
+        std::memcpy(c.sending.data(), &h, sizeof(h));
+        c.records = 0;
+        c.first_ns.store(0, std::memory_order_relaxed);
+    }
+    return m.send(m.user, idx, c.sending.data(), c.sending.size());
+}
+
+// Flushes with no caller to tell keep the failure for the next one.
+void flush_deferred(RRLMuxImpl& m, unsigned idx)
+{
+    const int rc = flush_conn(m, idx);
+    if (rc == RRL_SUCCESS) return;
+    Conn& c = *m.conns[idx];
+    std::lock_guard<std::mutex> lk(c.mtx);
+    c.error = rc;
+}
+
+// The failure kept for connection `idx`, cleared.
+int take_error(Conn& c)
+{
+    std::lock_guard<std::mutex> lk(c.mtx);
+    const int rc = c.error;
+    c.error = RRL_SUCCESS;
+    return rc;
+}
+
+void run(RRLMuxImpl* m)
+{
+    for (;;) {
+        const int64_t now = now_ns();
+        int64_t next = 0;
+        for (unsigned i = 0; i < m->conns.size(); ++i) {
+            const int64_t first = m->conns[i]->first_ns.load(std::memory_order_relaxed);
+            if (!first) continue;
+            if (now - first >= m->flush_ns) flush_deferred(*m, i);
+            else if (!next || first + m->flush_ns < next) next = first + m->flush_ns;
+        }
+        std::unique_lock<std::mutex> lk(m->wake_mtx);
+        auto woken = [m] { return m->woken || m->stop; };
+        if (next) m->wake.wait_for(lk, std::chrono::nanoseconds(next - now_ns()), woken);
+        else      m->wake.wait(lk, woken);
+        if (m->stop) return;
+        m->woken = false;
+    }
+}
+
+} // namespace (anonymous)
+
+extern "C" {
+
+RRLMux rrl_mux_create(const RRL_MuxConfig* cfg, RRL_MuxSend send, void* user)
+{
+    if (!send || (cfg && cfg->struct_size < sizeof(size_t))) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_mux_create: null send or bad struct_size");
+        return nullptr;
+    }
+    RRL_MuxConfig c{};
+    if (cfg) std::memcpy(&c, cfg, std::min(cfg->struct_size, sizeof(c)));
+    if (c.connections > 1024) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_mux_create: too many connections");
+        return nullptr;
+    }
+    auto* m = new (std::nothrow) RRLMuxImpl;
+    if (!m) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_mux_create: out of memory");
+        return nullptr;
+    }
+    m->send      = send;
+    m->user      = user;
+    m->flush_ns  = int64_t(c.flush_us ? c.flush_us : kDefaultFlushUs) * 1000;
+    m->max_batch = std::min(c.max_batch_bytes ? c.max_batch_bytes : kDefaultBatch, kMaxFrame);
+    try {
+        const unsigned n = c.connections ? c.connections : 1;
+        m->conns.reserve(n);
+        for (unsigned i = 0; i < n; ++i) {
+            std::unique_ptr<Conn> conn(new Conn);
+            conn->pending.reserve(m->max_batch + RRL_WIRE_ALIGN);
+            conn->pending.resize(kHeader);
+            conn->sending.reserve(kHeader);   // swapped in by flush_conn: never allocates there
+            m->conns.push_back(std::move(conn));
+        }
+        m->flusher = std::thread(run, m);
+    } catch (const std::bad_alloc&) {
+        delete m;
+        set_error(RRL_ERR_NO_MEMORY, "rrl_mux_create: out of memory");
+        return nullptr;
+    } catch (const std::system_error&) {
+        delete m;
+        set_error(RRL_ERR_IO, "rrl_mux_create: cannot start the flush thread");
+        return nullptr;
+    }
+    return m;
+}
+
+void rrl_mux_destroy(RRLMux mux)
+{
+    if (!mux) return;
+    {
+        std::lock_guard<std::mutex> lk(mux->wake_mtx);
+        mux->stop = true;
+    }
+    mux->wake.notify_one();
+    mux->flusher.join();
+    for (unsigned i = 0; i < mux->conns.size(); ++i) flush_conn(*mux, i);   // nobody left to report to
+    delete mux;
+}
+
+int rrl_mux_write(RRLMux mux, uint32_t stream, const void* frame, size_t len)
+{
+    if (!mux || !frame || !len) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_mux_write: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (len > kMaxFrame) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_mux_write: frame larger than 1 GiB");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    const unsigned idx = stream % static_cast<unsigned>(mux->conns.size());
+    Conn& c = *mux->conns[idx];
+    int rc = take_error(c);
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, "rrl_mux_write: an earlier batch on this connection failed to send");
+        return rc;
+    }
+    bool started = false, due = false;
+    for (;;) {
+        std::unique_lock<std::mutex> lk(c.mtx);
+        // A big frame ships the current batch first, so none outgrows kMaxFrame.
+        if (c.records && c.pending.size() + kRecord + pad(len) > kMaxFrame) {
+            lk.unlock();
+            if ((rc = flush_conn(*mux, idx)) != RRL_SUCCESS) break;
+            continue;
+        }
+        const size_t at = c.pending.size();
+        try {
+            c.pending.resize(at + kRecord + pad(len));   // strong guarantee: unchanged on throw
+        } catch (const std::bad_alloc&) {
+            rc = RRL_ERR_NO_MEMORY;
+            break;
+        }
+        RRL_WireMuxRecord r{};
+        r.stream = stream;
+        r.bytes  = static_cast<uint32_t>(len);
+        std::memcpy(c.pending.data() + at, &r, sizeof(r));
+        std::memcpy(c.pending.data() + at + kRecord, frame, len);
+        std::memset(c.pending.data() + at + kRecord + len, 0, pad(len) - len);
+        const int64_t now = now_ns();
+        if (!c.records++) {
+            c.first_ns.store(now, std::memory_order_relaxed);
+            started = true;
+        }
+        due = c.pending.size() >= mux->max_batch ||
+              now - c.first_ns.load(std::memory_order_relaxed) >= mux->flush_ns;
+        break;
+    }
+    if (rc == RRL_SUCCESS && due) rc = flush_conn(*mux, idx);
+    else if (started) {
+        {
+            std::lock_guard<std::mutex> lk(mux->wake_mtx);
+            mux->woken = true;
+        }
+        mux->wake.notify_one();
+    }
+    if (rc != RRL_SUCCESS)
+        set_error(rc, rc == RRL_ERR_NO_MEMORY ? "rrl_mux_write: out of memory" : "rrl_mux_write: send failed");
+    return rc;
+}
+
+int rrl_mux_flush(RRLMux mux)
+{
+    if (!mux) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_mux_flush: null mux");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    int first = RRL_SUCCESS;
+    for (unsigned i = 0; i < mux->conns.size(); ++i) {
+        int rc = take_error(*mux->conns[i]);
+        if (rc == RRL_SUCCESS) rc = flush_conn(*mux, i);
+        if (first == RRL_SUCCESS) first = rc;
+    }
+    if (first != RRL_SUCCESS) set_error(first, "rrl_mux_flush: send failed");
+    return first;
+}
+
+int rrl_wire_mux_next(const void* mux, size_t len, size_t* offset,
+                      uint32_t* stream, const void** frame, size_t* frame_len)
+{
+    if (!mux || !offset || !stream || !frame || !frame_len) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_mux_next: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    RRL_WireMuxHeader h;
+    if (len < kHeader) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_mux_next: frame too short");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    std::memcpy(&h, mux, sizeof(h));
+    if (h.kind != RRL_WIRE_MUX || h.bytes != len || len % RRL_WIRE_ALIGN) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_mux_next: not a MUX frame");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    size_t off = *offset ? *offset : kHeader;
+    if (off == len) return 0;
+    RRL_WireMuxRecord r;
+    if (off < kHeader || off > len - kRecord) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_mux_next: bad offset");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    const unsigned char* p = static_cast<const unsigned char*>(mux) + off;
+    std::memcpy(&r, p, sizeof(r));
+    if (r.bytes == 0 || pad(r.bytes) > len - off - kRecord) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_wire_mux_next: record overruns the frame");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    *stream    = r.stream;
+    *frame     = p + kRecord;
+    *frame_len = r.bytes;
+    *offset    = off + kRecord + pad(r.bytes);
+    return 1;
+}
+
+int RRL_WEAK rrl_set_mux(const RRL_MuxConfig* cfg)
+{
+    if (cfg && cfg->struct_size < sizeof(RRL_MuxConfig)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_set_mux: bad struct_size");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    BackendGuard be;
+    auto set = be->ext.set_mux;
+    int rc = set ? set(cfg) : cfg ? RRL_ERR_UNSUPPORTED : RRL_SUCCESS;
+    if (rc != RRL_SUCCESS) {
+        set_error(rc, set ? "rrl_set_mux: backend error"
+                          : "rrl_set_mux: backend opens one session per handle");
+    }
+    return rc;
+}
+
+} // extern "C"
@@ -0,0 +1,293 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_wire_resume.cpp  —  Replay buffer for session resume
+//
+//  • Frames are copied into one fixed byte ring in send order, each
+//    kept contiguous (a frame that does not fit before the end starts
+//    over at offset 0); acknowledgements free from the front.  Its
+//    size is fixed at rrl_replay_create(), which is what bounds it.
+//  • Seqs compare as serial numbers (RFC 1982), so a stream may run
+//    past 2^32 steps.
+//  • Reconnects / downtime are kept here too, and reach
+//    rrl_get_stats_v2() through a handle → replay table that
+//    rrl_handle_closed() clears for a closed handle.
+//─────────────────────────────────────────────────────────────
+#include "rrl_wire.h"
+#include "rrl_internal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace rrl::detail;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kDefaultCapacity = size_t(1) << 20;
+
+struct Entry {
+    uint32_t seq;
+    size_t   off;
+    size_t   len;
+};
+
+// a after b, modulo 2^32
+inline bool seq_after(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) > 0; }
+
+} // namespace (anonymous)
+
+struct RRLReplayImpl {
+    std::mutex                 mtx;
+    std::vector<unsigned char> ring;
+    std::deque<Entry>          frames;   // oldest first
+    uint8_t                    token[RRL_RESUME_TOKEN] = {};
+
+    bool              down       = false;
+    Clock::time_point down_since{};
+    uint64_t          reconnects = 0;
+    uint64_t          downtime_us = 0;
+};
+
+namespace {
+
+std::mutex                                    g_bind_mtx;
+std::vector<std::pair<RRLHandle, RRLReplay>>  g_bound;
+
+void unbind(RRLReplay r)
+{
+    std::lock_guard<std::mutex> lk(g_bind_mtx);
+    g_bound.erase(std::remove_if(g_bound.begin(), g_bound.end(),
+                                 [r](const std::pair<RRLHandle, RRLReplay>& e) { return e.second == r; }),
+                  g_bound.end());
+}
+
+// Where a `len`-byte frame goes next, or false if the ring is full.
+bool place(const RRLReplayImpl& r, size_t len, size_t& off)
+{
+    const size_t cap = r.ring.size();
+    if (r.frames.empty()) { off = 0; return len <= cap; }
+    const size_t head = r.frames.front().off;
+    const size_t tail = r.frames.back().off + r.frames.back().len;
+    if (r.frames.back().off >= head) {          // live bytes are [head, tail)
+        if (cap - tail >= len) { off = tail; return true; }
+        if (head >= len)       { off = 0;    return true; }
+        return false;
+    }
+    if (head - tail >= len) { off = tail; return true; }   // wrapped: [head, cap) + [0, tail)
+    return false;
+}
+
+} // namespace (anonymous)
+
+namespace rrl { namespace detail {
+
+bool replay_stats(RRLHandle handle, RRL_StatsV2& out)
+{
+    std::lock_guard<std::mutex> lk(g_bind_mtx);
+    for (const auto& e : g_bound) {
+        if (e.first != handle) continue;
+        RRLReplayImpl& r = *e.second;
+        std::lock_guard<std::mutex> rl(r.mtx);
+        out.reconnects  = r.reconnects;
+        out.downtime_us = r.downtime_us;
+        if (r.down)   // the current gap counts too
+            out.downtime_us += static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - r.down_since).count());
+        return true;
+    }
+    return false;
+}
+
+void replay_forget(RRLHandle handle)
+{
+    std::lock_guard<std::mutex> lk(g_bind_mtx);
+    g_bound.erase(std::remove_if(g_bound.begin(), g_bound.end(),
+                                 [handle](const std::pair<RRLHandle, RRLReplay>& e) { return e.first == handle; }),
+                  g_bound.end());
+}
+
+}} // namespace rrl::detail
+
+extern "C" {
+
+RRLReplay rrl_replay_create(size_t capacity)
+{
+    auto* r = new (std::nothrow) RRLReplayImpl;
+    if (!r) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_replay_create: out of memory");
+        return nullptr;
+    }
+    try {
+        r->ring.resize(capacity ? capacity : kDefaultCapacity);
+        std::random_device rd;
+        for (size_t i = 0; i < RRL_RESUME_TOKEN; i += 4) {
+            const uint32_t v = rd();
+            std::memcpy(r->token + i, &v, 4);
+        }
+    } catch (const std::bad_alloc&) {
+        delete r;
+        set_error(RRL_ERR_NO_MEMORY, "rrl_replay_create: out of memory");
+        return nullptr;
+    } catch (const std::exception&) {
+        delete r;
+        set_error(RRL_ERR_IO, "rrl_replay_create: no random source for the token");
+        return nullptr;
+    }
+    return r;
+}
+
+void rrl_replay_destroy(RRLReplay replay)
+{
+    if (!replay) return;
+    unbind(replay);
+    delete replay;
+}
+
+void rrl_replay_token(RRLReplay replay, uint8_t* out)
+{
+    if (!replay || !out) return;
+    std::lock_guard<std::mutex> lk(replay->mtx);   // rrl_replay_set_token may run meanwhile
+    std::memcpy(out, replay->token, RRL_RESUME_TOKEN);
+}
+
+void rrl_replay_set_token(RRLReplay replay, const uint8_t* token)
+{
+    if (!replay || !token) return;
+    std::lock_guard<std::mutex> lk(replay->mtx);
+    std::memcpy(replay->token, token, RRL_RESUME_TOKEN);
+}
+
+int rrl_replay_push(RRLReplay replay, uint32_t seq, const void* frame, size_t len)
+{
+    if (!replay || !frame || !len) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_replay_push: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    std::lock_guard<std::mutex> lk(replay->mtx);
+    if (len > replay->ring.size()) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_replay_push: frame larger than the buffer");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    if (!replay->frames.empty() && !seq_after(seq, replay->frames.back().seq)) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_replay_push: seq not after the last one");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    size_t off;
+    if (!place(*replay, len, off)) {
+        set_error(RRL_ERR_EXHAUSTED, "rrl_replay_push: buffer full of unacknowledged frames");
+        return RRL_ERR_EXHAUSTED;
+    }
+    try {
+        replay->frames.push_back(Entry{seq, off, len});
+    } catch (const std::bad_alloc&) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_replay_push: out of memory");
+        return RRL_ERR_NO_MEMORY;
+    }
+    std::memcpy(replay->ring.data() + off, frame, len);
+    return RRL_SUCCESS;
+}
+
+void rrl_replay_ack(RRLReplay replay, uint32_t seq)
+{
+    if (!replay) return;
+    std::lock_guard<std::mutex> lk(replay->mtx);
+    while (!replay->frames.empty() && !seq_after(replay->frames.front().seq, seq))
+        replay->frames.pop_front();
+}
+
+int rrl_replay_resend(RRLReplay replay, uint32_t peer_seq, RRL_ReplaySend send, void* user)
+{
+    if (!replay || !send) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_replay_resend: null arg");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    // Copied out: `send` runs unlocked, so it may push / ack meanwhile.
+    std::vector<unsigned char> bytes;
+    std::vector<size_t>        lens;
+    {
+        std::lock_guard<std::mutex> lk(replay->mtx);
+        while (!replay->frames.empty() && !seq_after(replay->frames.front().seq, peer_seq))
+            replay->frames.pop_front();
+        try {
+            size_t total = 0;
+            for (const Entry& e : replay->frames) total += e.len;
+            bytes.reserve(total);
+            lens.reserve(replay->frames.size());
+            for (const Entry& e : replay->frames) {
+                const unsigned char* p = replay->ring.data() + e.off;
+                bytes.insert(bytes.end(), p, p + e.len);
+                lens.push_back(e.len);
+            }
+        } catch (const std::bad_alloc&) {
+            set_error(RRL_ERR_NO_MEMORY, "rrl_replay_resend: out of memory");
+            return RRL_ERR_NO_MEMORY;
+        }
+    }
+    int sent = 0;
+    size_t at = 0;
+    for (const size_t len : lens) {
+        const int rc = send(user, bytes.data() + at, len);
+        if (rc != RRL_SUCCESS) {
+            set_error(rc, "rrl_replay_resend: send failed");
+            return rc;
+        }
+        at += len;
+        ++sent;
+    }
+    return sent;
+}
+
+void rrl_replay_reset(RRLReplay replay)
+{
+    if (!replay) return;
+    std::lock_guard<std::mutex> lk(replay->mtx);
+    replay->frames.clear();
+}
+
+void rrl_replay_link(RRLReplay replay, int up)
+{
+    if (!replay) return;
+    std::lock_guard<std::mutex> lk(replay->mtx);
+    const Clock::time_point now = Clock::now();
+    if (!up && !replay->down) {
+        replay->down       = true;
+        replay->down_since = now;
+    } else if (up && replay->down) {
+        replay->down = false;
+        ++replay->reconnects;
+        replay->downtime_us += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - replay->down_since).count());
+    }
+}
+
+int rrl_replay_bind(RRLReplay replay, RRLHandle handle)
+{
+    if (!replay) {
+        set_error(RRL_ERR_INVALID_ARGUMENT, "rrl_replay_bind: null replay");
+        return RRL_ERR_INVALID_ARGUMENT;
+    }
+    unbind(replay);
+    if (!handle) return RRL_SUCCESS;
+    std::lock_guard<std::mutex> lk(g_bind_mtx);
+    for (const auto& e : g_bound)
+        if (e.first == handle) {
+            set_error(RRL_ERR_INVALID_HANDLE, "rrl_replay_bind: handle already has a replay buffer");
+            return RRL_ERR_INVALID_HANDLE;
+        }
+    try {
+        g_bound.emplace_back(handle, replay);
+    } catch (const std::bad_alloc&) {
+        set_error(RRL_ERR_NO_MEMORY, "rrl_replay_bind: out of memory");
+        return RRL_ERR_NO_MEMORY;
+    }
+    return RRL_SUCCESS;
+}
+
+} // extern "C"
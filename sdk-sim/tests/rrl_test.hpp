@@ -0,0 +1,39 @@
+//─────────────────────────────────────────────────────────────
+//  rrl_test.hpp  —  Check macros for the ctest suite
+//
+//  • Each test is its own executable: RRL_CHECK logs a failed
+//    condition and keeps going, main() returns rrl_test::failures().
+//  • Linked with test_core.cpp, the stand-in for the closed core.
+//─────────────────────────────────────────────────────────────
+#ifndef RRL_TEST_HPP
+#define RRL_TEST_HPP
+
+#include <cstdint>
+#include <cstdio>
+
+namespace rrl_test {
+
+// The one handle test_core.cpp gives int32[4] actions, for refusals
+// of float-only features.
+constexpr uintptr_t kIntActions = 0xA000;
+
+inline int& failures()
+{
+    static int n = 0;
+    return n;
+}
+
+inline void fail(const char* file, int line, const char* what)
+{
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+    ++failures();
+}
+
+} // namespace rrl_test
+
+#define RRL_CHECK(cond) \
+    ((cond) ? (void)0 : ::rrl_test::fail(__FILE__, __LINE__, #cond))
+#define RRL_CHECK_EQ(a, b) \
+    (((a) == (b)) ? (void)0 : ::rrl_test::fail(__FILE__, __LINE__, #a " == " #b))
+
+#endif // RRL_TEST_HPP
@@ -0,0 +1,109 @@
+//─────────────────────────────────────────────────────────────
+//  test_backend.cpp  —  Backend swaps while calls are in flight
+//
+//  • An rrl_poll_many() blocked inside a hook finishes on the table
+//    it started with after another backend has been registered.
+//  • Pollers hammer rrl_poll / rrl_get_stats_v2 while the main
+//    thread keeps swapping between two backends: no call ever lands
+//    on the stubs or loses its hook.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+std::atomic<bool>     g_entered{false}, g_release{false};
+std::atomic<unsigned> g_calls{0};
+
+// Blocks on handle 0 until released.
+int gated_poll(RRLHandle h)
+{
+    if (h == fake(0)) {
+        g_entered.store(true);
+        while (!g_release.load()) std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return 1;
+}
+
+int never_ready(RRLHandle) { return 0; }
+
+template <int Fps>
+int ready(RRLHandle) { g_calls.fetch_add(1, std::memory_order_relaxed); return 1; }
+
+template <int Fps>
+int stats_v2(RRLHandle, RRL_StatsV2* s)
+{
+    g_calls.fetch_add(1, std::memory_order_relaxed);
+    s->base.fps = Fps;
+    return RRL_SUCCESS;
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    // In-flight call keeps its table.
+    RRL_BackendHooks gated{};
+    gated.poll = gated_poll;
+    rrl_register_backend(&gated);
+    RRLHandle hs[4] = { fake(0), fake(1), fake(2), fake(3) };
+    int ready_n = -1;
+    std::thread caller([&] { ready_n = rrl_poll_many(hs, 4, nullptr, nullptr); });
+    while (!g_entered.load()) std::this_thread::yield();
+    RRL_BackendHooks none{};
+    none.poll = never_ready;
+    rrl_register_backend(&none);
+    RRL_CHECK_EQ(rrl_poll(fake(1)), 0);
+    g_release.store(true);
+    caller.join();
+    RRL_CHECK_EQ(ready_n, 4);
+
+    // Swap both tables under load.
+    RRL_BackendHooks    base_a{}, base_b{};
+    RRL_BackendHooksExt ext_a{},  ext_b{};
+    base_a.poll = ready<1>;
+    base_b.poll = ready<2>;
+    ext_a.struct_size  = ext_b.struct_size = sizeof(RRL_BackendHooksExt);
+    ext_a.get_stats_v2 = stats_v2<1>;
+    ext_b.get_stats_v2 = stats_v2<2>;
+    rrl_register_backends(&base_a, &ext_a);
+
+    constexpr int kThreads = 4, kRounds = 20000;
+    std::atomic<int>  wrong{0};
+    std::atomic<bool> done{false};
+    std::vector<std::thread> pollers;
+    for (int t = 0; t < kThreads; ++t) {
+        pollers.emplace_back([&] {
+            for (int i = 0; i < kRounds; ++i) {
+                if (rrl_poll(fake(i % 8)) != 1) ++wrong;
+                RRL_StatsV2 st{};
+                st.struct_size = sizeof(st);
+                if (rrl_get_stats_v2(fake(i % 8), &st) != RRL_SUCCESS ||
+                    (st.base.fps != 1.0 && st.base.fps != 2.0)) ++wrong;
+            }
+        });
+    }
+    std::thread swapper([&] {
+        for (unsigned i = 0; !done.load(); ++i) {
+            if (i % 2) rrl_register_backends(&base_a, &ext_a);
+            else       rrl_register_backends(&base_b, &ext_b);
+        }
+    });
+    for (auto& p : pollers) p.join();
+    done.store(true);
+    swapper.join();
+    RRL_CHECK_EQ(wrong.load(), 0);
+    RRL_CHECK_EQ(g_calls.load(), unsigned(2 * kThreads * kRounds));
+
+    rrl_register_backends(nullptr, nullptr);
+    RRL_CHECK_EQ(rrl_poll(fake(1)), 0);
+    return rrl_test::failures();
+}
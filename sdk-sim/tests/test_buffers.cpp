@@ -0,0 +1,73 @@
+//─────────────────────────────────────────────────────────────
+//  test_buffers.cpp  —  rrl_bind_buffers checks and routing
+//
+//  • Misaligned, short or absent-space buffers are refused by the
+//    SDK before the backend sees them; without a bind_buffers hook
+//    the call is RRL_ERR_UNSUPPORTED.
+//  • Valid buffers reach the hook unchanged, and (NULL, 0) unbinds.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <cstdint>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+// test_core.cpp: float32[16] observations, float32[4] actions.
+constexpr size_t kObsBytes = 64, kActBytes = 16;
+
+struct Bound { RRLHandle h; void* obs; size_t obs_bytes; void* act; size_t act_bytes; int calls; };
+Bound g_bound{};
+
+int record_bind(RRLHandle h, void* obs, size_t obs_bytes, void* act, size_t act_bytes)
+{
+    g_bound = Bound{h, obs, obs_bytes, act, act_bytes, g_bound.calls + 1};
+    return RRL_SUCCESS;
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    alignas(RRL_BUFFER_ALIGN) static unsigned char obs[2 * RRL_BUFFER_ALIGN + kObsBytes];
+    alignas(RRL_BUFFER_ALIGN) static unsigned char act[RRL_BUFFER_ALIGN];
+
+    // No hook: valid buffers, but nothing to hand them to.
+    RRL_CHECK_EQ(rrl_bind_buffers(fake(0), obs, kObsBytes, act, kActBytes), RRL_ERR_UNSUPPORTED);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_UNSUPPORTED);
+
+    RRL_BackendHooksExt ext{};
+    ext.struct_size  = sizeof(ext);
+    ext.bind_buffers = record_bind;
+    RRL_CHECK_EQ(rrl_register_backend_ext(&ext), RRL_SUCCESS);
+
+    // Refused by the SDK: the hook is never called.
+    RRL_CHECK_EQ(rrl_bind_buffers(nullptr, obs, kObsBytes, act, kActBytes), RRL_ERR_INVALID_HANDLE);
+    RRL_CHECK_EQ(rrl_bind_buffers(fake(0), obs + 4, kObsBytes, act, kActBytes), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK_EQ(rrl_bind_buffers(fake(0), obs, kObsBytes - 1, act, kActBytes), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK_EQ(rrl_bind_buffers(fake(0), obs, kObsBytes, act, kActBytes - 4), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK_EQ(rrl_bind_buffers(fake(0), nullptr, 8, act, kActBytes), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK_EQ(g_bound.calls, 0);
+
+    // Accepted: larger than needed is fine, pointers pass through as given.
+    RRL_CHECK_EQ(rrl_bind_buffers(fake(1), obs + RRL_BUFFER_ALIGN, kObsBytes + 32, act, kActBytes),
+                 RRL_SUCCESS);
+    RRL_CHECK_EQ(g_bound.calls, 1);
+    RRL_CHECK(g_bound.h == fake(1));
+    RRL_CHECK(g_bound.obs == obs + RRL_BUFFER_ALIGN);
+    RRL_CHECK_EQ(g_bound.obs_bytes, kObsBytes + 32);
+    RRL_CHECK(g_bound.act == act);
+    RRL_CHECK_EQ(g_bound.act_bytes, kActBytes);
+
+    // Only one side, then unbinding both.
+    RRL_CHECK_EQ(rrl_bind_buffers(fake(1), nullptr, 0, act, kActBytes), RRL_SUCCESS);
+    RRL_CHECK(g_bound.obs == nullptr);
+    RRL_CHECK_EQ(rrl_bind_buffers(fake(1), nullptr, 0, nullptr, 0), RRL_SUCCESS);
+    RRL_CHECK_EQ(g_bound.calls, 3);
+    RRL_CHECK(g_bound.act == nullptr);
+
+    rrl_register_backend_ext(nullptr);
+    return rrl_test::failures();
+}
@@ -0,0 +1,171 @@
+//─────────────────────────────────────────────────────────────
+//  test_codec.cpp  —  XOR-delta + LZ4 / zstd STEP round trips
+//
+//  • For each compression built in (the others are skipped, and
+//    must refuse to create): a run of slowly changing frames, with
+//    and without delta, decodes to exactly what was written and
+//    packs well below the plain size.
+//  • Keyframes: the first frame, every keyframe_interval-th and the
+//    one after rrl_wire_codec_reset(); a reader that missed the
+//    keyframe refuses the deltas.
+//  • Incompressible frames travel plain; a dictionary mismatch is
+//    refused.
+//─────────────────────────────────────────────────────────────
+#include "rrl_wire.h"
+#include "rrl_test.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t   kCount = 2, kSide = 64, kObs = kSide * kSide;
+constexpr uint32_t kKeyEvery = 5;
+
+// A frame of a slowly scrolling game screen: most bytes repeat.
+void render(uint32_t t, size_t env, unsigned char* obs)
+{
+    for (size_t y = 0; y < kSide; ++y)
+        for (size_t x = 0; x < kSide; ++x)
+            obs[y * kSide + x] = static_cast<unsigned char>(((x + t) / 8 + y / 8 + env) % 4 * 60);
+    obs[(t * 7) % kObs] = 255;   // a moving sprite
+}
+
+uint16_t flags_of(const std::vector<unsigned char>& frame)
+{
+    RRL_WireHeader h;
+    std::memcpy(&h, frame.data(), sizeof(h));
+    return h.flags;
+}
+
+struct Stream {
+    RRLWireCodec w = nullptr, r = nullptr;
+    ~Stream() { rrl_wire_codec_destroy(w); rrl_wire_codec_destroy(r); }
+};
+
+void round_trip(const RRL_WireSchema& schema, int comp, bool delta)
+{
+    RRL_WireCodecConfig cfg{};
+    cfg.struct_size       = sizeof(cfg);
+    cfg.compression       = comp;
+    cfg.delta             = delta;
+    cfg.keyframe_interval = kKeyEvery;
+    Stream s;
+    s.w = rrl_wire_codec_create(&schema, &cfg);
+    s.r = rrl_wire_codec_create(&schema, &cfg);
+    RRL_CHECK(s.w && s.r);
+    if (!s.w || !s.r) return;
+
+    const size_t plain = rrl_wire_frame_bytes(&schema, RRL_WIRE_STEP, kCount);
+    std::vector<unsigned char> obs(kCount * kObs), frame(rrl_wire_codec_bound(s.w, kCount));
+    const float   rewards[kCount] = {1.f, -0.5f};
+    const uint8_t dones[kCount]   = {0, 1};
+    size_t packed = 0;
+    for (uint32_t t = 0; t < 3 * kKeyEvery; ++t) {
+        if (t == 12) rrl_wire_codec_reset(s.w);
+        for (size_t e = 0; e < kCount; ++e) render(t, e, obs.data() + e * kObs);
+        const size_t n = rrl_wire_codec_write_step(s.w, t, kCount, obs.data(), 0, rewards, dones,
+                                                   frame.data(), frame.size());
+        RRL_CHECK(n > sizeof(RRL_WireHeader));
+        packed += n;
+        const uint16_t f = flags_of(frame);
+        const bool key = t % kKeyEvery == 0 || t == 12;
+        RRL_CHECK(f & (comp == RRL_WIRE_COMP_LZ4 ? RRL_WIRE_F_LZ4 : RRL_WIRE_F_ZSTD));
+        RRL_CHECK_EQ((f & RRL_WIRE_F_DELTA) != 0, delta && !key);
+
+        RRL_WireFrame out{};
+        RRL_CHECK_EQ(rrl_wire_codec_read(s.r, frame.data(), n, &out), RRL_SUCCESS);
+        RRL_CHECK_EQ(out.header.seq, t);
+        RRL_CHECK_EQ(out.header.flags, 0);
+        RRL_CHECK(std::memcmp(out.tensors, obs.data(), obs.size()) == 0);
+        RRL_CHECK(std::memcmp(out.rewards, rewards, sizeof(rewards)) == 0);
+        RRL_CHECK(std::memcmp(out.dones, dones, sizeof(dones)) == 0);
+
+        // A reader that joins after a keyframe cannot rebuild a delta.
+        if (delta && t == 1) {
+            Stream late;
+            late.r = rrl_wire_codec_create(&schema, &cfg);
+            RRL_CHECK_EQ(rrl_wire_codec_read(late.r, frame.data(), n, &out), RRL_ERR_INVALID_ARGUMENT);
+        }
+    }
+    RRL_CHECK(packed * 4 < plain * 3 * kKeyEvery);
+
+    // Noise does not compress: the frame goes out plain and still decodes.
+    uint32_t x = 12345;
+    for (auto& b : obs) { x = x * 1664525u + 1013904223u; b = static_cast<unsigned char>(x >> 24); }
+    const size_t n = rrl_wire_codec_write_step(s.w, 99, kCount, obs.data(), 0, nullptr, nullptr,
+                                               frame.data(), frame.size());
+    RRL_CHECK_EQ(n, plain);
+    RRL_CHECK_EQ(flags_of(frame) & (RRL_WIRE_F_LZ4 | RRL_WIRE_F_ZSTD), 0);
+    RRL_WireFrame out{};
+    RRL_CHECK_EQ(rrl_wire_codec_read(s.r, frame.data(), n, &out), RRL_SUCCESS);
+    RRL_CHECK(std::memcmp(out.tensors, obs.data(), obs.size()) == 0);
+}
+
+void dictionary(const RRL_WireSchema& schema, int comp)
+{
+    std::vector<unsigned char> dict(kObs), other(kObs);
+    render(0, 0, dict.data());
+    render(3, 1, other.data());
+    RRL_WireCodecConfig cfg{};
+    cfg.struct_size = sizeof(cfg);
+    cfg.compression = comp;
+    cfg.dict        = dict.data();
+    cfg.dict_len    = dict.size();
+    Stream s;
+    s.w = rrl_wire_codec_create(&schema, &cfg);
+    s.r = rrl_wire_codec_create(&schema, &cfg);
+    cfg.dict = other.data();
+    Stream wrong;
+    wrong.r = rrl_wire_codec_create(&schema, &cfg);
+    RRL_CHECK(s.w && s.r && wrong.r);
+    if (!s.w || !s.r || !wrong.r) return;
+
+    std::vector<unsigned char> obs(kCount * kObs), frame(rrl_wire_codec_bound(s.w, kCount));
+    for (size_t e = 0; e < kCount; ++e) render(1, e, obs.data() + e * kObs);
+    const size_t n = rrl_wire_codec_write_step(s.w, 1, kCount, obs.data(), 0, nullptr, nullptr,
+                                               frame.data(), frame.size());
+    RRL_CHECK(n > 0);
+    RRL_WireFrame out{};
+    RRL_CHECK_EQ(rrl_wire_codec_read(s.r, frame.data(), n, &out), RRL_SUCCESS);
+    RRL_CHECK(std::memcmp(out.tensors, obs.data(), obs.size()) == 0);
+    RRL_CHECK_EQ(rrl_wire_codec_read(wrong.r, frame.data(), n, &out), RRL_ERR_INVALID_ARGUMENT);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    RRL_SpaceDesc obs{}, act{};
+    obs.dtype = RRL_DTYPE_UINT8;
+    obs.ndim  = 2;
+    obs.shape[0] = obs.shape[1] = kSide;
+    act.dtype = RRL_DTYPE_INT32;
+    act.ndim  = 1;
+    act.shape[0] = 1;
+    RRL_WireSchema schema{};
+    RRL_CHECK_EQ(rrl_wire_schema(&obs, &act, &schema), RRL_SUCCESS);
+
+    RRL_WireCodecConfig cfg{};
+    cfg.struct_size = sizeof(cfg);
+    cfg.delta       = 1;
+    RRL_CHECK(rrl_wire_codec_create(&schema, &cfg) == nullptr);   // delta needs compression
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_ARGUMENT);
+
+    for (int comp : {RRL_WIRE_COMP_LZ4, RRL_WIRE_COMP_ZSTD}) {
+        const char* name = comp == RRL_WIRE_COMP_LZ4 ? "lz4" : "zstd";
+        if (!rrl_wire_codec_available(comp)) {
+            cfg.compression = comp;
+            RRL_CHECK(rrl_wire_codec_create(&schema, &cfg) == nullptr);
+            RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_UNSUPPORTED);
+            std::printf("%s: not built in, skipped\n", name);
+            continue;
+        }
+        round_trip(schema, comp, false);
+        round_trip(schema, comp, true);
+        dictionary(schema, comp);
+    }
+    return rrl_test::failures();
+}
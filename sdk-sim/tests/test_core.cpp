@@ -0,0 +1,36 @@
+//─────────────────────────────────────────────────────────────
+//  test_core.cpp  —  Stand-in for the closed core (tests only)
+//
+//  • Any non-null handle has a float32[16] observation space and a
+//    float32[4] action space, like bench/bench_core.cpp, except
+//    rrl_test::kIntActions, whose actions are int32[4].
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+extern "C" {
+
+int rrl_action_space(RRLHandle handle, RRL_SpaceDesc* out_space)
+{
+    if (!handle || !out_space) return RRL_ERR_INVALID_ARGUMENT;
+    *out_space = RRL_SpaceDesc{};
+    out_space->ndim = 1;
+    out_space->shape[0] = 4;
+    out_space->dtype = reinterpret_cast<uintptr_t>(handle) == rrl_test::kIntActions ? RRL_DTYPE_INT32
+                                                                                    : RRL_DTYPE_FLOAT32;
+    return RRL_SUCCESS;
+}
+
+int rrl_observation_space(RRLHandle handle, RRL_SpaceDesc* out_space)
+{
+    if (!handle || !out_space) return RRL_ERR_INVALID_ARGUMENT;
+    *out_space = RRL_SpaceDesc{};
+    out_space->ndim = 1;
+    out_space->shape[0] = 16;
+    out_space->dtype = RRL_DTYPE_FLOAT32;
+    return RRL_SUCCESS;
+}
+
+void rrl_close(RRLHandle handle) { rrl_handle_closed(handle); }
+
+} // extern "C"
@@ -0,0 +1,142 @@
+//─────────────────────────────────────────────────────────────
+//  test_coro.cpp  —  rrl::coro::Executor against a flag backend
+//
+//  • Coroutines resume only once their env reports ready, and an
+//    already-ready env does not suspend at all.
+//  • A handle whose poll fails resumes its coroutine with an
+//    exception, whether it fails before or while parked, instead of
+//    leaving run_once() spinning on it.
+//  • run_once() with nothing ready returns after its timeout.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env_coro.hpp"
+#include "rrl_test.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+constexpr int kEnvs = 4;
+int g_state[kEnvs];   // 1 ready, 0 not yet, RRL_ERR_* dead
+
+int index_of(RRLHandle h) { return int((reinterpret_cast<uintptr_t>(h) - 0x1000) / 64); }
+
+int flag_poll(RRLHandle h) { return g_state[index_of(h)]; }
+
+// Waits for env `i` `steps` times, consuming each ready edge.
+rrl::coro::Task stepper(int i, int steps, int& done)
+{
+    for (int s = 0; s < steps; ++s) {
+        co_await rrl::coro::NextAction{fake(i)};
+        g_state[i] = 0;
+        ++done;
+    }
+}
+
+rrl::coro::Task catcher(int i, std::string& what)
+{
+    try {
+        co_await rrl::coro::NextAction{fake(i)};
+        what = "resumed";
+    } catch (const std::runtime_error& e) {
+        what = e.what();
+    }
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    RRL_BackendHooks hooks{};
+    hooks.poll = flag_poll;
+    rrl_register_backend(&hooks);
+
+    // Resume on readiness only.
+    {
+        rrl::coro::Executor ex;
+        int a = 0, b = 0;
+        ex.spawn(stepper(0, 2, a));
+        ex.spawn(stepper(1, 1, b));
+        RRL_CHECK(ex.run_once(0));
+        RRL_CHECK_EQ(ex.suspended(), size_t(2));
+        RRL_CHECK(ex.run_once(0));
+        RRL_CHECK_EQ(a + b, 0);
+
+        g_state[1] = 1;
+        ex.run_once(0);           // collects env 1
+        ex.run_once(0);           // resumes it; its task finishes
+        RRL_CHECK_EQ(b, 1);
+        RRL_CHECK_EQ(a, 0);
+        RRL_CHECK_EQ(ex.tasks(), size_t(1));
+
+        g_state[0] = 1;           // ready before the next co_await: no suspension
+        ex.run_once(0);
+        ex.run_once(0);
+        RRL_CHECK_EQ(a, 1);
+        g_state[0] = 1;
+        ex.run();
+        RRL_CHECK_EQ(a, 2);
+        RRL_CHECK_EQ(ex.tasks(), size_t(0));
+    }
+
+    // Dead while parked: the co_await throws, the loop ends.
+    {
+        rrl::coro::Executor ex;
+        std::string what;
+        int alive = 0;
+        g_state[0] = 0;
+        ex.spawn(catcher(2, what));
+        ex.spawn(stepper(0, 1, alive));
+        ex.run_once(0);
+        RRL_CHECK_EQ(ex.suspended(), size_t(2));
+
+        g_state[2] = RRL_ERR_IO;
+        int rounds = 0;
+        while (what.empty() && rounds < 10) { ex.run_once(0); ++rounds; }
+        RRL_CHECK(rounds < 10);
+        RRL_CHECK(what.find("[" + std::to_string(RRL_ERR_IO) + "]") != std::string::npos);
+        RRL_CHECK_EQ(ex.suspended(), size_t(1));   // the healthy env keeps waiting
+
+        g_state[0] = 1;
+        ex.run();
+        RRL_CHECK_EQ(alive, 1);
+    }
+
+    // Dead before the co_await: no suspension, same exception.
+    {
+        rrl::coro::Executor ex;
+        std::string what;
+        g_state[3] = RRL_ERR_INVALID_HANDLE;
+        ex.spawn(catcher(3, what));
+        RRL_CHECK(!ex.run_once(0));
+        RRL_CHECK(what.find("[" + std::to_string(RRL_ERR_INVALID_HANDLE) + "]") != std::string::npos);
+    }
+
+    // Uncaught: the failure escapes run_once().
+    {
+        rrl::coro::Executor ex;
+        int n = 0;
+        ex.spawn(stepper(3, 1, n));
+        bool threw = false;
+        try { ex.run(); } catch (const std::runtime_error&) { threw = true; }
+        RRL_CHECK(threw);
+        RRL_CHECK_EQ(n, 0);
+    }
+
+    // Nothing ready: run_once() gives up after its timeout.
+    {
+        rrl::coro::Executor ex;
+        int n = 0;
+        g_state[1] = 0;
+        ex.spawn(stepper(1, 1, n));
+        RRL_CHECK(ex.run_once(0));
+        RRL_CHECK(ex.run_once(2000));
+        RRL_CHECK_EQ(n, 0);
+        RRL_CHECK_EQ(ex.suspended(), size_t(1));
+    }
+
+    return rrl_test::failures();
+}
@@ -0,0 +1,57 @@
+//─────────────────────────────────────────────────────────────
+//  test_error.cpp  —  Per-thread last error
+//
+//  • Errors raised on one thread never show on another, and the
+//    string from rrl_last_error_msg() is not overwritten by other
+//    threads failing at the same time.
+//  • Overlong messages are truncated, not overrun.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    // A failing call records its own code and message.
+    RRL_CHECK_EQ(rrl_last_error(), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_poll(nullptr), 0);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_HANDLE);
+    const char* mine = rrl_last_error_msg();
+    RRL_CHECK(std::strstr(mine, "rrl_poll") != nullptr);
+
+    // Other threads start clean and keep to themselves.
+    constexpr int kThreads = 8, kRounds = 20000;
+    std::atomic<int> wrong{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+        workers.emplace_back([t, &wrong] {
+            if (rrl_last_error() != RRL_SUCCESS || rrl_last_error_msg()[0] != '\0') ++wrong;
+            const std::string msg = "worker " + std::to_string(t);
+            const char* seen = rrl_last_error_msg();
+            for (int i = 0; i < kRounds; ++i) {
+                rrl_set_last_error(-100 - t, msg.c_str());
+                if (rrl_last_error() != -100 - t || msg != seen) ++wrong;
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    RRL_CHECK_EQ(wrong.load(), 0);
+
+    // Ours is untouched.
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_HANDLE);
+    RRL_CHECK(rrl_last_error_msg() == mine);
+    RRL_CHECK(std::strstr(mine, "rrl_poll") != nullptr);
+
+    const std::string longer(1000, 'x');
+    rrl_set_last_error(RRL_ERR_IO, longer.c_str());
+    const size_t len = std::strlen(rrl_last_error_msg());
+    RRL_CHECK(len > 0 && len < longer.size());
+    rrl_set_last_error(RRL_SUCCESS, nullptr);
+    RRL_CHECK_EQ(rrl_last_error_msg()[0], '\0');
+    return rrl_test::failures();
+}
@@ -0,0 +1,33 @@
+//─────────────────────────────────────────────────────────────
+//  test_hist.cpp  —  RRL_LatencyHist recording and percentiles
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+int main()
+{
+    RRL_LatencyHist h{};
+    RRL_CHECK_EQ(rrl_hist_percentile(&h, 0.5), 0.0);
+
+    // Values below 8 µs have exact buckets.
+    for (int i = 0; i < 99; ++i) rrl_hist_record(&h, 1);
+    rrl_hist_record(&h, 5);
+    RRL_CHECK_EQ(h.total, 100u);
+    RRL_CHECK_EQ(h.max_us, 5u);
+    RRL_CHECK_EQ(rrl_hist_percentile(&h, 0.99), 1.0);   // nearest rank 99, not the max
+    RRL_CHECK_EQ(rrl_hist_percentile(&h, 0.995), 5.0);
+    RRL_CHECK_EQ(rrl_hist_percentile(&h, 1.0), 5.0);
+    RRL_CHECK_EQ(rrl_hist_percentile(&h, 0.0), 1.0);
+
+    RRL_LatencyHist g{};
+    for (uint64_t v = 0; v < 4; ++v) rrl_hist_record(&g, v);   // 0 1 2 3
+    RRL_CHECK_EQ(rrl_hist_percentile(&g, 0.5), 1.0);
+    RRL_CHECK_EQ(rrl_hist_percentile(&g, 0.75), 2.0);
+
+    // Larger values land in a bucket whose midpoint is capped at the max.
+    RRL_LatencyHist w{};
+    rrl_hist_record(&w, 1000);
+    const double p = rrl_hist_percentile(&w, 0.5);
+    RRL_CHECK(p >= 900.0 && p <= 1000.0);
+    return rrl_test::failures();
+}
@@ -0,0 +1,123 @@
+//─────────────────────────────────────────────────────────────
+//  test_hot.cpp  —  RRLHotState readiness and counters
+//
+//  • rrl_poll_many over rrl_hot_handles() copies the bitmap: bits at
+//    word edges, past all‑zero 256‑handle runs, and a prefix `n` that
+//    ends mid‑word all come back as set, nothing else does.
+//  • Any other handle order goes per handle and lands in the caller's
+//    positions; rrl_poll agrees, and cleared bits drop out.
+//  • rrl_get_stats_v2 sums the writers' columns.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+constexpr size_t kN = 600;   // ten words: a zero run of four, a partial last word
+
+// Compares a poll_many result against the expected set of positions.
+bool matches(const std::vector<uint64_t>& mask, const size_t* idx, int ready,
+             size_t n, const std::set<size_t>& expect)
+{
+    if (ready != static_cast<int>(expect.size())) return false;
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const bool bit = (mask[i / 64] >> (i % 64)) & 1u;
+        if (bit != (expect.count(i) != 0)) return false;
+        if (bit && idx[k++] != i) return false;   // ascending
+    }
+    for (size_t i = n; i < mask.size() * 64; ++i)
+        if ((mask[i / 64] >> (i % 64)) & 1u) return false;
+    return true;
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    std::vector<RRLHandle> handles(kN);
+    for (size_t i = 0; i < kN; ++i) handles[i] = fake(i);
+
+    RRLHotState hot = rrl_hot_create(handles.data(), kN, 2);
+    RRL_CHECK(hot != nullptr);
+    if (!hot) return rrl_test::failures();
+    RRL_CHECK_EQ(rrl_hot_register(hot), RRL_SUCCESS);
+
+    // Refusals.
+    RRLHandle dup[2] = {fake(1), fake(1)};
+    RRL_CHECK(rrl_hot_create(dup, 2, 1) == nullptr);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK(rrl_hot_create(handles.data(), kN, 0) == nullptr);
+
+    size_t n = 0;
+    const RRLHandle* order = rrl_hot_handles(hot, &n);
+    RRL_CHECK_EQ(n, kN);
+
+    // Words 1–4 stay empty; 63/64 straddle a word, 599 is the last bit.
+    const std::set<size_t> ready = {0, 63, 64, 127, 320, 383, 512, 575, 599};
+    for (size_t i : ready) rrl_hot_set_ready(hot, i, 1);
+    rrl_hot_set_ready(hot, kN, 1);   // out of range: ignored
+
+    std::vector<uint64_t> mask(RRL_MASK_WORDS(kN), ~uint64_t(0));
+    std::vector<size_t>   idx(kN);
+    int r = rrl_poll_many(order, kN, mask.data(), idx.data());
+    RRL_CHECK(matches(mask, idx.data(), r, kN, ready));
+
+    // Prefix ending mid‑word: bits at or past n are not reported.
+    std::set<size_t> head;
+    for (size_t i : ready) if (i < 100) head.insert(i);
+    std::fill(mask.begin(), mask.end(), ~uint64_t(0));
+    r = rrl_poll_many(order, 100, mask.data(), idx.data());
+    mask.resize(RRL_MASK_WORDS(100));
+    RRL_CHECK(matches(mask, idx.data(), r, 100, head));
+    mask.resize(RRL_MASK_WORDS(kN));
+
+    // Count only.
+    RRL_CHECK_EQ(rrl_poll_many(order, kN, nullptr, nullptr), static_cast<int>(ready.size()));
+
+    // Reversed copy, plus an unknown handle: positions are the caller's.
+    std::vector<RRLHandle> rev(handles.rbegin(), handles.rend());
+    rev.push_back(fake(5000));
+    std::set<size_t> rev_ready;
+    for (size_t i : ready) rev_ready.insert(kN - 1 - i);
+    std::vector<uint64_t> rmask(RRL_MASK_WORDS(rev.size()));
+    std::vector<size_t>   ridx(rev.size());
+    r = rrl_poll_many(rev.data(), rev.size(), rmask.data(), ridx.data());
+    RRL_CHECK(matches(rmask, ridx.data(), r, rev.size(), rev_ready));
+
+    // Single polls, and clearing.
+    RRL_CHECK_EQ(rrl_poll(fake(63)), 1);
+    RRL_CHECK_EQ(rrl_poll(fake(62)), 0);
+    rrl_hot_set_ready(hot, 63, 0);
+    rrl_hot_set_ready(hot, 599, 0);
+    RRL_CHECK_EQ(rrl_poll(fake(63)), 0);
+    std::set<size_t> left = ready;
+    left.erase(63);
+    left.erase(599);
+    r = rrl_poll_many(order, kN, mask.data(), idx.data());
+    RRL_CHECK(matches(mask, idx.data(), r, kN, left));
+
+    // Counters: two writers on one handle.
+    rrl_hot_record(hot, 0, 7, 100, 10, 1);
+    rrl_hot_record(hot, 1, 7, 300, 20, 2);
+    rrl_hot_record(hot, 1, 7, 200, 30, 3);
+    rrl_hot_record(hot, 2, 7, 999, 1, 1);    // no such writer: ignored
+    RRL_StatsV2 s{};
+    s.struct_size = sizeof(s);
+    RRL_CHECK_EQ(rrl_get_stats_v2(fake(7), &s), RRL_SUCCESS);
+    RRL_CHECK_EQ(s.base.steps, 3ul);
+    RRL_CHECK_EQ(s.bytes_in, uint64_t(60));
+    RRL_CHECK_EQ(s.bytes_out, uint64_t(6));
+    RRL_CHECK_EQ(s.latency.max_us, uint64_t(300));
+    RRL_CHECK(s.base.latency_ms > 0.199 && s.base.latency_ms < 0.201);
+
+    rrl_hot_destroy(hot);
+    return rrl_test::failures();
+}
@@ -0,0 +1,210 @@
+//─────────────────────────────────────────────────────────────
+//  test_infer.cpp  —  Built-in engine against a reference forward
+//
+//  • A random dense 37 → 19 → 5 MLP (ReLU, then linear) run through
+//    rrl_policy_act at batch sizes that hit the 4-row and single-row
+//    kernels and the vector / scalar column tails; whichever kernel
+//    the CPU gets (AVX2, NEON, portable) must match a double-precision
+//    reference, with float32, float16 and int8 weights.
+//  • A 1-input layer fed 1.0 outputs its weights as stored, which
+//    checks float16 decoding (subnormals, ±0, extremes) and int8
+//    column scales exactly.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_policy_format.h"
+#include "rrl_test.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kIn = 37, kHidden = 19, kOut = 5;
+
+// Weights as stored (`raw`) and as the reference sees them (`w`).
+struct Layer {
+    uint32_t in, out, act;
+    int32_t  dtype;
+    std::vector<unsigned char> raw;
+    std::vector<float> w, b, scale;
+};
+
+size_t round_up(size_t v) { return (v + RRL_POLICY_ALIGN - 1) / RRL_POLICY_ALIGN * RRL_POLICY_ALIGN; }
+
+// Exact for |v| in [2^-14, 2^15] with at most 11 significant bits.
+uint16_t to_half(float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    if ((bits & 0x7FFFFFFFu) == 0) return static_cast<uint16_t>(sign);
+    const int exp = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+    return static_cast<uint16_t>(sign | (exp << 10) | ((bits >> 13) & 0x3FFu));
+}
+
+// Random weights of `dtype`, on grids each format stores exactly.
+Layer make_layer(uint32_t in, uint32_t out, uint32_t act, int32_t dtype, std::mt19937& rng)
+{
+    Layer l{in, out, act, dtype, {}, {}, {}, {}};
+    const size_t n = size_t(in) * out;
+    std::uniform_int_distribution<int> q(-127, 127), grid(-64, 64);
+    l.w.resize(n);
+    l.b.resize(out);
+    for (float& v : l.b) v = grid(rng) / 64.f;
+    if (dtype == RRL_DTYPE_INT8) {
+        l.scale.resize(out);
+        for (uint32_t j = 0; j < out; ++j) l.scale[j] = (1 + j % 4) / 256.f;
+        l.raw.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            const int8_t v = static_cast<int8_t>(q(rng));
+            l.raw[i] = static_cast<unsigned char>(v);
+            l.w[i]   = v * l.scale[i % out];
+        }
+    } else if (dtype == RRL_DTYPE_FLOAT16) {
+        l.raw.resize(n * 2);
+        for (size_t i = 0; i < n; ++i) {
+            l.w[i] = grid(rng) / 64.f;
+            const uint16_t h = to_half(l.w[i]);
+            std::memcpy(l.raw.data() + i * 2, &h, 2);
+        }
+    } else {
+        l.raw.resize(n * 4);
+        for (size_t i = 0; i < n; ++i) l.w[i] = grid(rng) / 64.f;
+        std::memcpy(l.raw.data(), l.w.data(), n * 4);
+    }
+    return l;
+}
+
+std::vector<unsigned char> build(const std::vector<Layer>& layers)
+{
+    size_t off = round_up(sizeof(RRL_PolicyHeader) + layers.size() * sizeof(RRL_PolicyLayer));
+    std::vector<RRL_PolicyLayer> ls(layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        RRL_PolicyLayer& l = ls[i];
+        l = RRL_PolicyLayer{};
+        l.kind = RRL_LAYER_DENSE;
+        l.activation = layers[i].act;
+        l.in_dims[0] = l.in_dims[1] = l.out_dims[0] = l.out_dims[1] = 1;
+        l.in_dims[2]  = layers[i].in;
+        l.out_dims[2] = layers[i].out;
+        l.weight_dtype  = layers[i].dtype;
+        l.weight_offset = off;
+        off = round_up(off + layers[i].raw.size());
+        l.bias_offset = off;
+        off = round_up(off + layers[i].b.size() * sizeof(float));
+        if (!layers[i].scale.empty()) {
+            l.scale_offset = off;
+            off = round_up(off + layers[i].scale.size() * sizeof(float));
+        }
+    }
+    std::vector<unsigned char> blob(off, 0);
+    RRL_PolicyHeader h{};
+    h.magic = RRL_POLICY_MAGIC;
+    h.version = RRL_POLICY_VERSION;
+    h.num_layers = static_cast<uint32_t>(layers.size());
+    h.output_kind = RRL_POLICY_OUT_CONTINUOUS;
+    h.input_dtype = RRL_DTYPE_FLOAT32;
+    h.input_dims[0] = h.input_dims[1] = 1;
+    h.input_dims[2] = layers[0].in;
+    h.input_scale = 1.f;
+    h.weight_align = RRL_POLICY_ALIGN;
+    std::memcpy(blob.data(), &h, sizeof(h));
+    std::memcpy(blob.data() + sizeof(h), ls.data(), ls.size() * sizeof(RRL_PolicyLayer));
+    for (size_t i = 0; i < layers.size(); ++i) {
+        const Layer& l = layers[i];
+        std::memcpy(blob.data() + ls[i].weight_offset, l.raw.data(), l.raw.size());
+        std::memcpy(blob.data() + ls[i].bias_offset, l.b.data(), l.b.size() * 4);
+        if (!l.scale.empty())
+            std::memcpy(blob.data() + ls[i].scale_offset, l.scale.data(), l.scale.size() * 4);
+    }
+    return blob;
+}
+
+// W is K×N, row-major (rrl_policy_format.h).
+std::vector<double> reference(const std::vector<Layer>& layers, const float* x)
+{
+    std::vector<double> cur(x, x + layers[0].in);
+    for (const Layer& l : layers) {
+        std::vector<double> next(l.out);
+        for (uint32_t j = 0; j < l.out; ++j) {
+            double s = l.b[j];
+            for (uint32_t k = 0; k < l.in; ++k) s += cur[k] * l.w[k * l.out + j];
+            next[j] = l.act == RRL_ACT_RELU && s < 0 ? 0 : s;
+        }
+        cur.swap(next);
+    }
+    return cur;
+}
+
+void check_mlp(int32_t dtype, std::mt19937& rng)
+{
+    const std::vector<Layer> layers = { make_layer(kIn, kHidden, RRL_ACT_RELU, dtype, rng),
+                                        make_layer(kHidden, kOut, RRL_ACT_NONE, dtype, rng) };
+    const std::vector<unsigned char> blob = build(layers);
+    RRLPolicy p = rrl_policy_create(blob.data(), blob.size());
+    RRL_CHECK(p != nullptr);
+    size_t ob = 0, ab = 0;
+    RRL_CHECK_EQ(rrl_policy_io(p, &ob, &ab), RRL_SUCCESS);
+    RRL_CHECK_EQ(ob, kIn * sizeof(float));
+    RRL_CHECK_EQ(ab, kOut * sizeof(float));
+
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    for (size_t n : {1u, 3u, 4u, 9u}) {
+        std::vector<float> obs(n * kIn), act(n * kOut);
+        for (float& v : obs) v = u(rng);
+        RRL_CHECK_EQ(rrl_policy_act(p, n, obs.data(), act.data()), RRL_SUCCESS);
+        double worst = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const std::vector<double> ref = reference(layers, obs.data() + i * kIn);
+            for (uint32_t j = 0; j < kOut; ++j)
+                worst = std::fmax(worst, std::fabs(ref[j] - act[i * kOut + j]));
+        }
+        RRL_CHECK(worst < 1e-4);
+    }
+    rrl_policy_release(p);
+}
+
+// Runs a 1 → N layer on x = 1 and returns its N outputs.
+std::vector<float> outputs(const Layer& l)
+{
+    const std::vector<unsigned char> blob = build({l});
+    RRLPolicy p = rrl_policy_create(blob.data(), blob.size());
+    std::vector<float> y(l.out, -1.f);
+    const float one = 1.f;
+    RRL_CHECK(p && rrl_policy_act(p, 1, &one, y.data()) == RRL_SUCCESS);
+    rrl_policy_release(p);
+    return y;
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    std::mt19937 rng(7);
+    check_mlp(RRL_DTYPE_FLOAT32, rng);
+    check_mlp(RRL_DTYPE_FLOAT16, rng);
+    check_mlp(RRL_DTYPE_INT8, rng);
+
+    // float16 bit patterns → values (11 of them: vector and scalar lanes).
+    const uint16_t halves[11] = { 0x0000, 0x8000, 0x0001, 0x03FF, 0x0400, 0x3C00,
+                                  0xC000, 0x7BFF, 0xFBFF, 0x3555, 0x3E00 };
+    const float    want_h[11] = { 0.f, -0.f, 5.9604645e-8f, 6.0975552e-5f, 6.1035156e-5f, 1.f,
+                                  -2.f, 65504.f, -65504.f, 0.33325195f, 1.5f };
+    Layer h{1, 11, RRL_ACT_NONE, RRL_DTYPE_FLOAT16, {}, {}, std::vector<float>(11, 0.f), {}};
+    h.raw.resize(sizeof(halves));
+    std::memcpy(h.raw.data(), halves, sizeof(halves));
+    const std::vector<float> yh = outputs(h);
+    for (int j = 0; j < 11; ++j) RRL_CHECK_EQ(yh[j], want_h[j]);
+
+    // int8 values times their column's scale.
+    const int8_t qs[11] = { -128, -127, -1, 0, 1, 2, 63, 64, 100, 126, 127 };
+    Layer q{1, 11, RRL_ACT_NONE, RRL_DTYPE_INT8, {}, {}, std::vector<float>(11, 0.f), {}};
+    q.raw.assign(reinterpret_cast<const unsigned char*>(qs), reinterpret_cast<const unsigned char*>(qs) + 11);
+    for (int j = 0; j < 11; ++j) q.scale.push_back(j % 2 ? 0.5f : 0.25f);
+    const std::vector<float> yq = outputs(q);
+    for (int j = 0; j < 11; ++j) RRL_CHECK_EQ(yq[j], qs[j] * q.scale[j]);
+    return rrl_test::failures();
+}
@@ -0,0 +1,185 @@
+//─────────────────────────────────────────────────────────────
+//  test_loopback.cpp  —  Ghost trainer: latency, rate cap, handles
+//
+//  • A step is not ready before `latency_us` and the stats report
+//    that latency; steps of one handle are no closer than 1/rate_hz,
+//    while other handles are not held back by it.
+//  • Recorded actions loop per handle and rrl_reset() rewinds them.
+//  • Handles the installed loopback did not open — made-up addresses
+//    or another loopback's — are refused without being read, as is a
+//    null handle in rrl_wait_any().
+//─────────────────────────────────────────────────────────────
+#include "rrl_loopback.h"
+#include "rrl_test.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+double ms_since(Clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+RRLHandle open_one()
+{
+    RRL_OpenConfig oc{};
+    oc.struct_size = sizeof(oc);
+    return rrl_open(&oc);
+}
+
+void latency()
+{
+    RRL_LoopbackConfig cfg{};
+    cfg.struct_size = sizeof(cfg);
+    cfg.latency_us  = 3000;
+    cfg.concurrency = 2;
+    cfg.seed        = 7;
+    RRLLoopback lb = rrl_loopback_create(&cfg);
+    RRL_CHECK(lb != nullptr);
+    if (!lb) return;
+    RRL_CHECK_EQ(rrl_loopback_install(lb), RRL_SUCCESS);
+    RRLHandle h = open_one();
+    RRL_CHECK(h != nullptr);
+
+    int early = 0;
+    for (int i = 0; i < 10; ++i) {
+        const Clock::time_point t0 = Clock::now();
+        RRL_CHECK_EQ(rrl_loopback_submit(h), RRL_SUCCESS);
+        RRL_CHECK_EQ(rrl_loopback_submit(h), RRL_ERR_INVALID_ARGUMENT);   // in flight
+        early += rrl_poll(h) != 0;
+        RRL_CHECK_EQ(rrl_wait_any(&h, 1, 1000000), 0);
+        early += ms_since(t0) < 3.0;
+    }
+    RRL_CHECK_EQ(early, 0);
+    size_t len = 0;
+    const void* act = rrl_loopback_action(h, &len);
+    RRL_CHECK(act != nullptr);
+    RRL_CHECK_EQ(len, sizeof(float) * 4);
+
+    RRL_StatsV2 s{};
+    s.struct_size = sizeof(s);
+    RRL_CHECK_EQ(rrl_get_stats_v2(h, &s), RRL_SUCCESS);
+    RRL_CHECK_EQ(s.base.steps, 10ul);
+    RRL_CHECK(s.base.latency_ms >= 3.0);
+    RRL_CHECK_EQ(s.latency.total, uint64_t(10));
+    RRL_CHECK_EQ(s.bytes_in, uint64_t(10 * 4 * sizeof(float)));
+    RRL_CHECK_EQ(s.bytes_out, uint64_t(10 * 16 * sizeof(float)));
+    rrl_loopback_destroy(lb);
+}
+
+void rate()
+{
+    RRL_LoopbackConfig cfg{};
+    cfg.struct_size = sizeof(cfg);
+    cfg.rate_hz     = 500;   // 2 ms apart
+    cfg.concurrency = 2;
+    RRLLoopback lb = rrl_loopback_create(&cfg);
+    RRL_CHECK(lb != nullptr);
+    if (!lb) return;
+    rrl_loopback_install(lb);
+    RRLHandle h[2] = {open_one(), open_one()};
+
+    // 25 steps each, in lock step: the cap is per handle, so the pair
+    // takes about as long as one handle alone.
+    const Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < 25; ++i) {
+        RRL_CHECK_EQ(rrl_loopback_submit(h[0]), RRL_SUCCESS);
+        RRL_CHECK_EQ(rrl_loopback_submit(h[1]), RRL_SUCCESS);
+        RRL_CHECK_EQ(rrl_wait_any(&h[0], 1, 1000000), 0);
+        RRL_CHECK_EQ(rrl_wait_any(&h[1], 1, 1000000), 0);
+    }
+    const double ms = ms_since(t0);
+    RRL_CHECK(ms >= 24 * 2.0);
+    RRL_CHECK(ms < 1000.0);
+    RRL_StatsV2 s{};
+    s.struct_size = sizeof(s);
+    RRL_CHECK_EQ(rrl_get_stats_v2(h[1], &s), RRL_SUCCESS);
+    RRL_CHECK_EQ(s.base.steps, 25ul);
+    rrl_loopback_destroy(lb);
+}
+
+void recorded()
+{
+    const float acts[3][4] = {{1, 1, 1, 1}, {2, 2, 2, 2}, {3, 3, 3, 3}};
+    RRL_LoopbackConfig cfg{};
+    cfg.struct_size   = sizeof(cfg);
+    cfg.actions       = acts;
+    cfg.actions_bytes = sizeof(acts);
+    RRLLoopback lb = rrl_loopback_create(&cfg);
+    RRL_CHECK(lb != nullptr);
+    if (!lb) return;
+    rrl_loopback_install(lb);
+    RRLHandle h = open_one();
+
+    const float want[] = {1, 2, 3, 1, 2, 1, 2};   // reset before the 6th
+    for (int i = 0; i < 7; ++i) {
+        if (i == 5) RRL_CHECK_EQ(rrl_reset(h), RRL_SUCCESS);
+        rrl_loopback_submit(h);
+        RRL_CHECK_EQ(rrl_wait_any(&h, 1, 1000000), 0);
+        float got[4];
+        std::memcpy(got, rrl_loopback_action(h, nullptr), sizeof(got));
+        RRL_CHECK_EQ(got[0], want[i]);
+        RRL_CHECK_EQ(got[3], want[i]);
+    }
+    rrl_loopback_destroy(lb);
+}
+
+void foreign_handles()
+{
+    RRL_LoopbackConfig cfg{};
+    cfg.struct_size = sizeof(cfg);
+    RRLLoopback a = rrl_loopback_create(&cfg);
+    RRLLoopback b = rrl_loopback_create(&cfg);
+    RRL_CHECK(a != nullptr && b != nullptr);
+    if (!a || !b) return;
+    rrl_loopback_install(b);
+    RRLHandle hb = open_one();
+    RRL_CHECK(hb != nullptr);
+    rrl_loopback_install(a);
+    RRLHandle ha = open_one();
+
+    // Unmapped addresses: reading them would crash.
+    for (uintptr_t i = 0; i < 4; ++i) {
+        RRL_CHECK_EQ(rrl_poll(fake(i)), 0);
+        RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_HANDLE);
+        RRL_CHECK_EQ(rrl_loopback_submit(fake(i)), RRL_ERR_INVALID_HANDLE);
+        RRL_CHECK(rrl_loopback_action(fake(i), nullptr) == nullptr);
+    }
+    // Another loopback's handle.
+    RRL_CHECK_EQ(rrl_poll(hb), 0);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_HANDLE);
+    RRL_CHECK_EQ(rrl_loopback_submit(hb), RRL_ERR_INVALID_HANDLE);
+    const RRLHandle mixed[2] = {ha, hb};
+    RRL_CHECK_EQ(rrl_wait_any(mixed, 2, 0), RRL_ERR_INVALID_HANDLE);
+    RRL_CHECK_EQ(rrl_poll(ha), 0);
+
+    // A null entry anywhere is refused at once, not waited on.
+    const RRLHandle with_null[2] = {nullptr, ha};
+    const Clock::time_point t0 = Clock::now();
+    RRL_CHECK_EQ(rrl_wait_any(with_null, 2, 1000000), RRL_ERR_INVALID_HANDLE);
+    RRL_CHECK(ms_since(t0) < 500.0);
+
+    // Uninstalled: none of its handles are served any more.
+    rrl_loopback_install(nullptr);
+    RRL_CHECK(rrl_loopback_submit(ha) != RRL_SUCCESS);
+    rrl_loopback_destroy(b);
+    rrl_loopback_destroy(a);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    latency();
+    rate();
+    recorded();
+    foreign_handles();
+    return rrl_test::failures();
+}
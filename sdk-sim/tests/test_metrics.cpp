@@ -0,0 +1,180 @@
+//─────────────────────────────────────────────────────────────
+//  test_metrics.cpp  —  RRLMetrics render snapshots
+//
+//  • Process and per‑label series sum the tracked handles' stats;
+//    the histogram is cumulative and ends at the sample count.
+//  • rrl_close() and rrl_metrics_untrack() keep a handle's counters in
+//    the exposition while its gauges go.
+//  • A render running next to rrl_close() never reads a handle after
+//    rrl_close() returned, and rrl_steps_total never goes backwards.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+uintptr_t index_of(RRLHandle h) { return (reinterpret_cast<uintptr_t>(h) - 0x1000) / 64; }
+
+constexpr uintptr_t kHandles = 4096;
+
+std::atomic<bool> g_dead[kHandles];
+std::atomic<int>  g_after_close{0};
+
+// Handle i: 10·i steps, i bytes each way, latency 200 µs on every step.
+int stats(RRLHandle h, RRL_StatsV2* out)
+{
+    const uintptr_t i = index_of(h);
+    if (i >= kHandles) return RRL_ERR_INVALID_HANDLE;
+    if (g_dead[i].load()) g_after_close.fetch_add(1);
+    out->base.fps        = 60.0;
+    out->base.steps      = static_cast<unsigned long>(10 * i);
+    out->base.latency_ms = 0.2;
+    out->bytes_in        = i;
+    out->bytes_out       = i;
+    out->queue_depth     = 1;
+    rrl_hist_record(&out->latency, 200);   // one sample stands for all of them
+    return RRL_SUCCESS;
+}
+
+std::string render(RRLMetrics m)
+{
+    std::string s(rrl_metrics_render(m, nullptr, 0), '\0');
+    rrl_metrics_render(m, &s[0], s.size() + 1);
+    return s;
+}
+
+// Value of the series line starting with `series` (name and labels);
+// -1 if absent.
+double value(const std::string& text, const std::string& series)
+{
+    const std::string key = "\n" + series + " ";
+    const size_t at = text.find(key);
+    if (at == std::string::npos) return -1;
+    return std::strtod(text.c_str() + at + key.size(), nullptr);
+}
+
+void snapshot()
+{
+    RRL_MetricsConfig c{};
+    c.struct_size = sizeof(c);
+    c.node        = "n1";
+    c.labels      = "gpu";
+    RRLMetrics m = rrl_metrics_create(&c);
+    RRL_CHECK(m != nullptr);
+    if (!m) return;
+    RRL_CHECK_EQ(rrl_metrics_port(m), 0);
+
+    RRL_CHECK_EQ(rrl_metrics_track(m, fake(1), nullptr), RRL_SUCCESS);          // gpu
+    RRL_CHECK_EQ(rrl_metrics_track(m, fake(2), "lab, gpu ,lab"), RRL_SUCCESS);  // gpu, lab
+    RRL_CHECK_EQ(rrl_metrics_track(m, fake(3), "lab"), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_metrics_untrack(m, fake(9)), RRL_ERR_INVALID_HANDLE);
+
+    std::string t = render(m);
+    RRL_CHECK_EQ(value(t, "rrl_envs{node=\"n1\"}"), 3.0);
+    RRL_CHECK_EQ(value(t, "rrl_fps{node=\"n1\"}"), 180.0);
+    RRL_CHECK_EQ(value(t, "rrl_steps_total{node=\"n1\"}"), 60.0);
+    RRL_CHECK_EQ(value(t, "rrl_steps_total{node=\"n1\",label=\"gpu\"}"), 30.0);
+    RRL_CHECK_EQ(value(t, "rrl_steps_total{node=\"n1\",label=\"lab\"}"), 50.0);
+    RRL_CHECK_EQ(value(t, "rrl_sent_bytes_total{node=\"n1\",label=\"lab\"}"), 5.0);
+    RRL_CHECK_EQ(value(t, "rrl_queue_depth{node=\"n1\"}"), 3.0);
+    // 200 µs: above the 128 µs bound, within 256 µs.
+    RRL_CHECK_EQ(value(t, "rrl_step_latency_seconds_bucket{node=\"n1\",le=\"0.000128\"}"), 0.0);
+    RRL_CHECK_EQ(value(t, "rrl_step_latency_seconds_bucket{node=\"n1\",le=\"0.000256\"}"), 3.0);
+    RRL_CHECK_EQ(value(t, "rrl_step_latency_seconds_bucket{node=\"n1\",le=\"+Inf\"}"), 3.0);
+    RRL_CHECK_EQ(value(t, "rrl_step_latency_seconds_count{node=\"n1\",label=\"lab\"}"), 2.0);
+    RRL_CHECK(t.find("# TYPE rrl_steps_total counter\n") != std::string::npos);
+
+    // Truncated copy: NUL-terminated, full length returned.
+    char small[16];
+    RRL_CHECK_EQ(rrl_metrics_render(m, small, sizeof(small)), t.size());
+    RRL_CHECK_EQ(std::strlen(small), sizeof(small) - 1);
+
+    // Closed: counters stay, gauges go, the handle is not read again.
+    rrl_close(fake(2));
+    g_dead[2].store(true);
+    t = render(m);
+    RRL_CHECK_EQ(g_after_close.load(), 0);
+    RRL_CHECK_EQ(value(t, "rrl_envs{node=\"n1\"}"), 2.0);
+    RRL_CHECK_EQ(value(t, "rrl_fps{node=\"n1\"}"), 120.0);
+    RRL_CHECK_EQ(value(t, "rrl_steps_total{node=\"n1\"}"), 60.0);
+    RRL_CHECK_EQ(value(t, "rrl_steps_total{node=\"n1\",label=\"gpu\"}"), 30.0);
+    RRL_CHECK_EQ(value(t, "rrl_steps_total{node=\"n1\",label=\"lab\"}"), 50.0);
+    RRL_CHECK_EQ(value(t, "rrl_envs{node=\"n1\",label=\"lab\"}"), 1.0);
+    RRL_CHECK_EQ(value(t, "rrl_step_latency_seconds_count{node=\"n1\"}"), 3.0);
+
+    // Untracked: likewise.
+    RRL_CHECK_EQ(rrl_metrics_untrack(m, fake(3)), RRL_SUCCESS);
+    t = render(m);
+    RRL_CHECK_EQ(value(t, "rrl_envs{node=\"n1\"}"), 1.0);
+    RRL_CHECK_EQ(value(t, "rrl_envs{node=\"n1\",label=\"lab\"}"), 0.0);
+    RRL_CHECK_EQ(value(t, "rrl_steps_total{node=\"n1\"}"), 60.0);
+    RRL_CHECK_EQ(value(t, "rrl_steps_total{node=\"n1\",label=\"lab\"}"), 50.0);
+    RRL_CHECK_EQ(value(t, "rrl_step_latency_seconds_count{node=\"n1\",label=\"lab\"}"), 2.0);
+
+    rrl_metrics_destroy(m);
+}
+
+void close_while_rendering()
+{
+    RRL_MetricsConfig c{};
+    c.struct_size = sizeof(c);
+    c.node        = "n2";
+    RRLMetrics m = rrl_metrics_create(&c);
+    RRL_CHECK(m != nullptr);
+    if (!m) return;
+
+    constexpr uintptr_t kFirst = 100, kLive = 8;
+    for (uintptr_t i = kFirst; i < kFirst + kLive; ++i) rrl_metrics_track(m, fake(i), nullptr);
+
+    std::atomic<bool> done{false};
+    std::atomic<int>  backwards{0}, renders{0};
+    std::thread scraper([&] {
+        double last = 0;
+        while (!done.load()) {
+            const double steps = value(render(m), "rrl_steps_total{node=\"n2\"}");
+            if (steps < last) backwards.fetch_add(1);
+            last = steps;
+            renders.fetch_add(1);
+        }
+    });
+    // Keep kLive tracked: close the oldest, "free" it, track a new one.
+    for (uintptr_t i = kFirst; i + kLive < kHandles; ++i) {
+        rrl_close(fake(i));
+        g_dead[i].store(true);
+        rrl_metrics_track(m, fake(i + kLive), nullptr);
+        if (i % 256 == 0) std::this_thread::yield();
+    }
+    done.store(true);
+    scraper.join();
+    RRL_CHECK(renders.load() > 0);
+    RRL_CHECK_EQ(backwards.load(), 0);
+    RRL_CHECK_EQ(g_after_close.load(), 0);
+
+    // Every handle ever tracked: 10 · (kFirst + … + kHandles − 1) steps.
+    const double all = 10.0 * (double(kHandles - 1) * kHandles / 2 - double(kFirst - 1) * kFirst / 2);
+    RRL_CHECK_EQ(value(render(m), "rrl_steps_total{node=\"n2\"}"), all);
+    rrl_metrics_destroy(m);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    RRL_BackendHooksExt ext{};
+    ext.struct_size  = sizeof(ext);
+    ext.get_stats_v2 = stats;
+    RRL_CHECK_EQ(rrl_register_backend_ext(&ext), RRL_SUCCESS);
+
+    snapshot();
+    close_while_rendering();
+    return rrl_test::failures();
+}
@@ -0,0 +1,283 @@
+//─────────────────────────────────────────────────────────────
+//  test_mux.cpp  —  RRLMux batching and rrl_wire_mux_next
+//
+//  • Streams land on connection stream % connections, in write order,
+//    16‑aligned and byte‑exact; batches are numbered per connection.
+//  • A batch leaves on the writer that fills max_batch_bytes, or on
+//    the flush thread once its oldest frame is flush_us old.
+//  • A failed deferred send is reported by the next write, once.
+//  • Writers on many threads: nothing lost or reordered per stream,
+//    never two sends at once on one connection.
+//  • Malformed MUX frames are refused.
+//─────────────────────────────────────────────────────────────
+#include "rrl_wire.h"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Record {
+    uint32_t                   stream;
+    std::vector<unsigned char> frame;
+};
+
+struct Batch {
+    unsigned            conn;
+    uint32_t            seq;
+    std::thread::id     thread;
+    Clock::time_point   at;
+    std::vector<Record> records;
+    bool                aligned = true;
+};
+
+struct Sink {
+    std::mutex          mtx;
+    std::vector<Batch>  batches;
+    std::atomic<int>    fail{RRL_SUCCESS};   // next send returns this, once
+    std::atomic<int>    in_send[4] = {};
+    std::atomic<int>    overlapped{0};
+    std::atomic<int>    malformed{0};
+};
+
+int on_send(void* user, unsigned conn, const void* mux, size_t len)
+{
+    Sink& s = *static_cast<Sink*>(user);
+    if (conn < 4 && s.in_send[conn].fetch_add(1) != 0) s.overlapped.fetch_add(1);
+    Batch b{conn, 0, std::this_thread::get_id(), Clock::now(), {}};
+    RRL_WireMuxHeader h;
+    std::memcpy(&h, mux, sizeof(h));
+    b.seq = h.seq;
+    size_t off = 0;
+    uint32_t stream;
+    const void* frame;
+    size_t n;
+    int rc;
+    while ((rc = rrl_wire_mux_next(mux, len, &off, &stream, &frame, &n)) == 1) {
+        const auto* p = static_cast<const unsigned char*>(frame);
+        if ((p - static_cast<const unsigned char*>(mux)) % RRL_WIRE_ALIGN) b.aligned = false;
+        b.records.push_back(Record{stream, std::vector<unsigned char>(p, p + n)});
+    }
+    if (rc < 0 || b.records.size() != h.count) s.malformed.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lk(s.mtx);
+        s.batches.push_back(std::move(b));
+    }
+    if (conn < 4) s.in_send[conn].fetch_sub(1);
+    return s.fail.exchange(RRL_SUCCESS);
+}
+
+RRL_MuxConfig config(unsigned conns, uint32_t flush_us, size_t batch)
+{
+    RRL_MuxConfig c{};
+    c.struct_size     = sizeof(c);
+    c.connections     = conns;
+    c.flush_us        = flush_us;
+    c.max_batch_bytes = batch;
+    return c;
+}
+
+// Frame k of `stream`: len bytes, first the pair, then a pattern.
+std::vector<unsigned char> frame(uint32_t stream, uint32_t k, size_t len)
+{
+    std::vector<unsigned char> f(len);
+    for (size_t i = 0; i < len; ++i) f[i] = static_cast<unsigned char>(stream * 31 + k * 7 + i);
+    if (len >= 8) {
+        std::memcpy(f.data(), &stream, 4);
+        std::memcpy(f.data() + 4, &k, 4);
+    }
+    return f;
+}
+
+void routing()
+{
+    Sink sink;
+    const RRL_MuxConfig c = config(3, 10000000, 0);   // nothing leaves on its own
+    RRLMux m = rrl_mux_create(&c, on_send, &sink);
+    RRL_CHECK(m != nullptr);
+    if (!m) return;
+
+    // Streams 0–8, three frames each, lengths 1…40 (padding and not).
+    for (uint32_t k = 0; k < 3; ++k)
+        for (uint32_t s = 0; s < 9; ++s) {
+            const auto f = frame(s, k, 1 + (s * 13 + k * 5) % 40);
+            RRL_CHECK_EQ(rrl_mux_write(m, s, f.data(), f.size()), RRL_SUCCESS);
+        }
+    RRL_CHECK(sink.batches.empty());
+    RRL_CHECK_EQ(rrl_mux_flush(m), RRL_SUCCESS);
+    RRL_CHECK_EQ(sink.batches.size(), size_t(3));
+    for (const Batch& b : sink.batches) {
+        RRL_CHECK_EQ(b.seq, uint32_t(0));
+        RRL_CHECK(b.aligned);
+        RRL_CHECK_EQ(b.records.size(), size_t(9));
+        uint32_t next[9] = {};
+        for (const Record& r : b.records) {
+            RRL_CHECK_EQ(r.stream % 3, b.conn);
+            if (r.stream >= 9) continue;
+            const uint32_t k = next[r.stream]++;
+            RRL_CHECK(r.frame == frame(r.stream, k, 1 + (r.stream * 13 + k * 5) % 40));
+        }
+    }
+    RRL_CHECK_EQ(sink.malformed.load(), 0);
+
+    // Second batch on connection 1 only.
+    const auto f = frame(4, 3, 16);
+    RRL_CHECK_EQ(rrl_mux_write(m, 4, f.data(), f.size()), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_mux_flush(m), RRL_SUCCESS);
+    RRL_CHECK_EQ(sink.batches.size(), size_t(4));
+    RRL_CHECK(sink.batches.back().conn == 1 && sink.batches.back().seq == 1);
+    RRL_CHECK_EQ(rrl_mux_flush(m), RRL_SUCCESS);   // nothing pending: no send
+    RRL_CHECK_EQ(sink.batches.size(), size_t(4));
+    rrl_mux_destroy(m);
+
+    // Refusals.
+    RRL_CHECK(rrl_mux_create(&c, nullptr, nullptr) == nullptr);
+    const RRL_MuxConfig many = config(2000, 0, 0);
+    RRL_CHECK(rrl_mux_create(&many, on_send, &sink) == nullptr);
+    RRL_CHECK_EQ(rrl_mux_write(nullptr, 0, f.data(), f.size()), RRL_ERR_INVALID_ARGUMENT);
+}
+
+void triggers()
+{
+    // Size: 16-byte header + 5 × (16 + 32) = 256 fills the batch.
+    Sink sink;
+    RRL_MuxConfig c = config(1, 10000000, 256);
+    RRLMux m = rrl_mux_create(&c, on_send, &sink);
+    RRL_CHECK(m != nullptr);
+    if (!m) return;
+    for (uint32_t k = 0; k < 4; ++k) {
+        const auto f = frame(0, k, 32);
+        rrl_mux_write(m, 0, f.data(), f.size());
+    }
+    RRL_CHECK(sink.batches.empty());
+    const auto f = frame(0, 4, 32);
+    RRL_CHECK_EQ(rrl_mux_write(m, 0, f.data(), f.size()), RRL_SUCCESS);
+    RRL_CHECK_EQ(sink.batches.size(), size_t(1));
+    RRL_CHECK(!sink.batches.empty() && sink.batches[0].records.size() == 5 &&
+              sink.batches[0].thread == std::this_thread::get_id());
+    rrl_mux_destroy(m);
+
+    // Age: the flush thread sends a lone frame about flush_us later.
+    Sink aged;
+    c = config(1, 5000, 0);
+    m = rrl_mux_create(&c, on_send, &aged);
+    RRL_CHECK(m != nullptr);
+    if (!m) return;
+    const Clock::time_point t0 = Clock::now();
+    RRL_CHECK_EQ(rrl_mux_write(m, 7, f.data(), f.size()), RRL_SUCCESS);
+    for (int i = 0; i < 2000; ++i) {
+        {
+            std::lock_guard<std::mutex> lk(aged.mtx);
+            if (!aged.batches.empty()) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    {
+        std::lock_guard<std::mutex> lk(aged.mtx);
+        RRL_CHECK_EQ(aged.batches.size(), size_t(1));
+        if (!aged.batches.empty()) {
+            RRL_CHECK(aged.batches[0].thread != std::this_thread::get_id());
+            RRL_CHECK(aged.batches[0].at - t0 >= std::chrono::microseconds(5000));
+        }
+    }
+
+    // That send fails: the next write says so, the one after is fine.
+    aged.fail.store(RRL_ERR_IO);
+    RRL_CHECK_EQ(rrl_mux_write(m, 7, f.data(), f.size()), RRL_SUCCESS);
+    for (int i = 0; i < 2000 && aged.fail.load() != RRL_SUCCESS; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));   // the mux stores it after send returns
+    RRL_CHECK_EQ(rrl_mux_write(m, 7, f.data(), f.size()), RRL_ERR_IO);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_IO);
+    RRL_CHECK_EQ(rrl_mux_write(m, 7, f.data(), f.size()), RRL_SUCCESS);
+    rrl_mux_destroy(m);   // flushes the last frame
+    RRL_CHECK_EQ(aged.batches.size(), size_t(3));
+}
+
+void threads()
+{
+    constexpr unsigned kConns = 2, kThreads = 4, kStreams = 3, kFrames = 3000;
+    Sink sink;
+    const RRL_MuxConfig c = config(kConns, 200, 1024);
+    RRLMux m = rrl_mux_create(&c, on_send, &sink);
+    RRL_CHECK(m != nullptr);
+    if (!m) return;
+    std::atomic<int> failed{0};
+    std::vector<std::thread> ts;
+    for (unsigned t = 0; t < kThreads; ++t)
+        ts.emplace_back([&, t] {
+            for (uint32_t k = 0; k < kFrames; ++k) {
+                const uint32_t s = t * kStreams + k % kStreams;
+                const auto f = frame(s, k / kStreams, 8 + k % 50);
+                if (rrl_mux_write(m, s, f.data(), f.size()) != RRL_SUCCESS) failed.fetch_add(1);
+            }
+        });
+    for (auto& t : ts) t.join();
+    rrl_mux_destroy(m);
+    RRL_CHECK_EQ(failed.load(), 0);
+    RRL_CHECK_EQ(sink.overlapped.load(), 0);
+    RRL_CHECK_EQ(sink.malformed.load(), 0);
+
+    // Sends on one connection happen in seq order; per stream, k counts up.
+    std::vector<uint32_t> next_seq(kConns, 0), next_k(kThreads * kStreams, 0);
+    size_t total = 0;
+    int wrong = 0;
+    for (const Batch& b : sink.batches) {
+        wrong += b.seq != next_seq[b.conn]++;
+        for (const Record& r : b.records) {
+            uint32_t s, k;
+            std::memcpy(&s, r.frame.data(), 4);
+            std::memcpy(&k, r.frame.data() + 4, 4);
+            wrong += s != r.stream || s % kConns != b.conn || s >= next_k.size() || k != next_k[s]++;
+            ++total;
+        }
+    }
+    RRL_CHECK_EQ(wrong, 0);
+    RRL_CHECK_EQ(total, size_t(kThreads) * kFrames);
+}
+
+void malformed()
+{
+    alignas(16) unsigned char buf[64] = {};
+    RRL_WireMuxHeader h{};
+    h.kind  = RRL_WIRE_MUX;
+    h.count = 1;
+    h.bytes = sizeof(buf);
+    std::memcpy(buf, &h, sizeof(h));
+    RRL_WireMuxRecord r{};
+    r.stream = 1;
+    r.bytes  = 40;   // 48 padded: runs past the 64-byte frame
+    std::memcpy(buf + sizeof(h), &r, sizeof(r));
+    size_t off = 0, n;
+    uint32_t s;
+    const void* f;
+    RRL_CHECK(rrl_wire_mux_next(buf, sizeof(buf), &off, &s, &f, &n) < 0);
+    r.bytes = 32;
+    std::memcpy(buf + sizeof(h), &r, sizeof(r));
+    RRL_CHECK_EQ(rrl_wire_mux_next(buf, sizeof(buf), &off, &s, &f, &n), 1);
+    RRL_CHECK(s == 1 && n == 32 && f == buf + 32);
+    RRL_CHECK_EQ(rrl_wire_mux_next(buf, sizeof(buf), &off, &s, &f, &n), 0);
+    RRL_CHECK(rrl_wire_mux_next(buf, 48, &(off = 0), &s, &f, &n) < 0);   // bytes ≠ len
+    h.kind = RRL_WIRE_MUX + 1;
+    std::memcpy(buf, &h, sizeof(h));
+    RRL_CHECK(rrl_wire_mux_next(buf, sizeof(buf), &(off = 0), &s, &f, &n) < 0);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    routing();
+    triggers();
+    threads();
+    malformed();
+    return rrl_test::failures();
+}
@@ -0,0 +1,98 @@
+//─────────────────────────────────────────────────────────────
+//  test_override.cpp  —  Strong exports seen by every SDK path
+//
+//  • Defines rrl_poll, rrl_get_stats and rrl_load_policy the way an
+//    integrator overrides the weak exports, then checks that
+//    rrl_poll_many, rrl_wait_any, rrl_vec_step's fallback,
+//    rrl_get_stats_v2 and rrl_bind_policy all ask them rather than
+//    the stubs.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+std::atomic<unsigned> g_polls{0};
+size_t                g_loaded = 0;
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+int never_ready(RRLHandle) { return 0; }
+int bind_ok(RRLHandle, void*, size_t, void*, size_t) { return RRL_SUCCESS; }
+
+} // namespace (anonymous)
+
+// Odd handles are ready.
+extern "C" int rrl_poll(RRLHandle h)
+{
+    g_polls.fetch_add(1, std::memory_order_relaxed);
+    return ((reinterpret_cast<uintptr_t>(h) - 0x1000) / 64) % 2 ? 1 : 0;
+}
+
+extern "C" int rrl_get_stats(RRLHandle, RRL_Stats* s)
+{
+    s->fps        = 144.0;
+    s->latency_ms = 2.5;
+    s->steps      = 7;
+    return RRL_SUCCESS;
+}
+
+extern "C" int rrl_load_policy(RRLHandle, const void*, size_t len)
+{
+    g_loaded = len;
+    return RRL_SUCCESS;
+}
+
+int main()
+{
+    std::vector<RRLHandle> hs;
+    for (uintptr_t i = 0; i < 70; ++i) hs.push_back(fake(i));
+
+    uint64_t mask[RRL_MASK_WORDS(70)];
+    std::vector<size_t> idx(hs.size());
+    RRL_CHECK_EQ(rrl_poll_many(hs.data(), hs.size(), mask, idx.data()), 35);
+    RRL_CHECK_EQ(g_polls.load(), 70u);
+    RRL_CHECK_EQ(idx[0], size_t(1));
+    RRL_CHECK_EQ(mask[0], 0xAAAAAAAAAAAAAAAAull);
+    RRL_CHECK_EQ(mask[1], 0x2Aull);
+
+    // A registered backend does not outrank the linked-in export.
+    RRL_BackendHooks hooks{};
+    hooks.poll = never_ready;
+    rrl_register_backend(&hooks);
+    RRL_CHECK_EQ(rrl_poll_many(hs.data(), hs.size(), nullptr, nullptr), 35);
+    RRL_CHECK_EQ(rrl_wait_any(hs.data(), 4, 0), 1);
+    rrl_register_backend(nullptr);
+
+    // Fallback vec step: done once every sub-env reports ready.
+    RRL_BackendHooksExt ext{};
+    ext.struct_size  = sizeof(ext);
+    ext.bind_buffers = bind_ok;
+    rrl_register_backend_ext(&ext);
+    RRLHandle odd[2] = { fake(1), fake(3) };
+    RRLVecHandle vec = rrl_vec_create(odd, 2);
+    RRL_CHECK(vec != nullptr);
+    if (vec) RRL_CHECK_EQ(rrl_vec_step(vec, 100000), RRL_SUCCESS);
+    rrl_vec_destroy(vec);
+    rrl_register_backend_ext(nullptr);
+
+    RRL_StatsV2 st{};
+    st.struct_size = sizeof(st);
+    RRL_CHECK_EQ(rrl_get_stats_v2(fake(0), &st), RRL_SUCCESS);
+    RRL_CHECK_EQ(st.base.fps, 144.0);
+    RRL_CHECK_EQ(st.base.steps, 7ul);
+    RRL_CHECK_EQ(st.pipeline_depth, 1u);
+
+    // Without a bind_policy hook the export gets the one-off copy.
+    const unsigned char blob[24] = {};
+    RRLPolicy p = rrl_policy_create(blob, sizeof(blob));
+    RRL_CHECK_EQ(rrl_bind_policy(fake(0), p), RRL_SUCCESS);
+    RRL_CHECK_EQ(g_loaded, sizeof(blob));
+    rrl_close(fake(0));
+    rrl_policy_release(p);
+    return rrl_test::failures();
+}
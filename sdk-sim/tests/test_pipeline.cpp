@@ -0,0 +1,114 @@
+//─────────────────────────────────────────────────────────────
+//  test_pipeline.cpp  —  rrl_set_pipeline_depth and its stats
+//
+//  • Out-of-range depths and null handles are refused before the
+//    backend sees them; without a hook only depth 1 is accepted.
+//  • A pipelined backend stays ready until `depth` steps are in
+//    flight, and RRL_StatsV2 reports the configured and reached
+//    depth (1 when the backend leaves it unset).
+//  • A caller built before the pipeline fields never has them
+//    written.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+// One pipelined env: steps submitted, steps answered.
+struct Pipe { unsigned depth = 1, in_flight = 0, max_in_flight = 0, calls = 0; };
+Pipe g_pipe;
+
+int set_depth(RRLHandle h, unsigned depth)
+{
+    if (h != fake(0)) return RRL_ERR_INVALID_HANDLE;
+    g_pipe.depth = depth;
+    ++g_pipe.calls;
+    return RRL_SUCCESS;
+}
+
+int pipe_poll(RRLHandle) { return g_pipe.in_flight < g_pipe.depth; }
+
+void submit()
+{
+    ++g_pipe.in_flight;
+    if (g_pipe.in_flight > g_pipe.max_in_flight) g_pipe.max_in_flight = g_pipe.in_flight;
+}
+
+int pipe_stats(RRLHandle h, RRL_StatsV2* s)
+{
+    if (h != fake(0)) return RRL_SUCCESS;   // other envs leave the depth unset
+    s->pipeline_depth     = g_pipe.depth;
+    s->pipeline_depth_max = g_pipe.max_in_flight;
+    s->queue_depth        = g_pipe.in_flight;
+    return RRL_SUCCESS;
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    // No hook: lock-step only.
+    RRL_CHECK_EQ(rrl_set_pipeline_depth(fake(0), 1), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_set_pipeline_depth(fake(0), 4), RRL_ERR_UNSUPPORTED);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_UNSUPPORTED);
+
+    RRL_BackendHooks base{};
+    base.poll = pipe_poll;
+    RRL_CHECK_EQ(rrl_register_backend(&base), RRL_SUCCESS);
+    RRL_BackendHooksExt ext{};
+    ext.struct_size        = sizeof(ext);
+    ext.set_pipeline_depth = set_depth;
+    ext.get_stats_v2       = pipe_stats;
+    RRL_CHECK_EQ(rrl_register_backend_ext(&ext), RRL_SUCCESS);
+
+    // Refused by the SDK: the hook is never called.
+    RRL_CHECK_EQ(rrl_set_pipeline_depth(nullptr, 2), RRL_ERR_INVALID_HANDLE);
+    RRL_CHECK_EQ(rrl_set_pipeline_depth(fake(0), 0), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK_EQ(rrl_set_pipeline_depth(fake(0), RRL_MAX_PIPELINE_DEPTH + 1), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK_EQ(g_pipe.calls, 0u);
+
+    // Backend errors come back with last_error set.
+    RRL_CHECK_EQ(rrl_set_pipeline_depth(fake(1), 2), RRL_ERR_INVALID_HANDLE);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_HANDLE);
+
+    // Ready until `depth` steps are unanswered.
+    RRL_CHECK_EQ(rrl_set_pipeline_depth(fake(0), 4), RRL_SUCCESS);
+    RRL_CHECK_EQ(g_pipe.depth, 4u);
+    int sent = 0;
+    while (rrl_poll(fake(0)) == 1 && sent < 100) { submit(); ++sent; }
+    RRL_CHECK_EQ(sent, 4);
+    --g_pipe.in_flight;                           // action for step t arrives
+    RRL_CHECK_EQ(rrl_poll(fake(0)), 1);
+
+    RRL_StatsV2 st{};
+    st.struct_size = sizeof(st);
+    RRL_CHECK_EQ(rrl_get_stats_v2(fake(0), &st), RRL_SUCCESS);
+    RRL_CHECK_EQ(st.pipeline_depth, 4u);
+    RRL_CHECK_EQ(st.pipeline_depth_max, 4u);
+    RRL_CHECK_EQ(st.queue_depth, 3u);
+
+    // Unset by the backend: reported as lock-step.
+    RRL_StatsV2 other{};
+    other.struct_size = sizeof(other);
+    RRL_CHECK_EQ(rrl_get_stats_v2(fake(1), &other), RRL_SUCCESS);
+    RRL_CHECK_EQ(other.pipeline_depth, 1u);
+    RRL_CHECK_EQ(other.pipeline_depth_max, 0u);
+
+    // An older struct stops before the pipeline fields.
+    RRL_StatsV2 old{};
+    old.struct_size        = offsetof(RRL_StatsV2, pipeline_depth);
+    old.pipeline_depth     = 0xDEAD;
+    old.pipeline_depth_max = 0xBEEF;
+    RRL_CHECK_EQ(rrl_get_stats_v2(fake(0), &old), RRL_SUCCESS);
+    RRL_CHECK_EQ(old.struct_size, offsetof(RRL_StatsV2, pipeline_depth));
+    RRL_CHECK_EQ(old.pipeline_depth, 0xDEADu);
+    RRL_CHECK_EQ(old.pipeline_depth_max, 0xBEEFu);
+    RRL_CHECK_EQ(old.queue_depth, 3u);
+
+    return rrl_test::failures();
+}
@@ -0,0 +1,182 @@
+//─────────────────────────────────────────────────────────────
+//  test_policy.cpp  —  Policy binding lifecycle
+//
+//  • A dense 16 → 4 continuous policy whose weights are zero, so
+//    each handle's action is its policy's bias and shows which
+//    policy it is bound to.
+//  • Covers load / bind / update / unbind, rrl_close() dropping the
+//    binding, a failed backend bind leaving none behind and enough
+//    handles to grow the binding table past its first size.
+//  • A model whose weight size wraps around is refused.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_policy_format.h"
+#include "rrl_test.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+constexpr size_t kIn = 16, kOut = 4;
+constexpr size_t kLayer  = sizeof(RRL_PolicyHeader);
+constexpr size_t kWeight = 192;                         // 64 + 80, rounded up to 64
+constexpr size_t kBias   = kWeight + kIn * kOut * sizeof(float);
+
+std::vector<unsigned char> blob(float bias)
+{
+    std::vector<unsigned char> b(kBias + kOut * sizeof(float), 0);
+    RRL_PolicyHeader h{};
+    h.magic        = RRL_POLICY_MAGIC;
+    h.version      = RRL_POLICY_VERSION;
+    h.num_layers   = 1;
+    h.output_kind  = RRL_POLICY_OUT_CONTINUOUS;
+    h.input_dtype  = RRL_DTYPE_FLOAT32;
+    h.input_dims[0] = h.input_dims[1] = 1;
+    h.input_dims[2] = kIn;
+    h.input_scale  = 1.f;
+    h.weight_align = RRL_POLICY_ALIGN;
+    RRL_PolicyLayer l{};
+    l.kind          = RRL_LAYER_DENSE;
+    l.activation    = RRL_ACT_NONE;
+    l.in_dims[0] = l.in_dims[1] = 1;
+    l.in_dims[2]    = kIn;
+    l.out_dims[0] = l.out_dims[1] = 1;
+    l.out_dims[2]   = kOut;
+    l.weight_dtype  = RRL_DTYPE_FLOAT32;
+    l.weight_offset = kWeight;
+    l.bias_offset   = kBias;
+    std::memcpy(b.data(), &h, sizeof(h));
+    std::memcpy(b.data() + kLayer, &l, sizeof(l));
+    for (size_t n = 0; n < kOut; ++n) {
+        const float v = bias + static_cast<float>(n);
+        std::memcpy(b.data() + kBias + n * sizeof(float), &v, sizeof(v));
+    }
+    return b;
+}
+
+// First action component of `h`'s bound policy, or the error.
+float act(RRLHandle h, int* rc = nullptr)
+{
+    float obs[kIn] = {}, out[kOut] = {};
+    const int r = rrl_act_batch(&h, 1, obs, out);
+    if (rc) *rc = r;
+    return r == RRL_SUCCESS ? out[0] : -1.f;
+}
+
+// A conv layer whose K·N·4 weight bytes (2^66) wrap to 0 in 64 bits.
+std::vector<unsigned char> wrapping_blob()
+{
+    constexpr uint32_t kMax = 1u << 16;
+    std::vector<unsigned char> b(kWeight + kMax * sizeof(float), 0);
+    RRL_PolicyHeader h{};
+    h.magic       = RRL_POLICY_MAGIC;
+    h.version     = RRL_POLICY_VERSION;
+    h.num_layers  = 1;
+    h.output_kind = RRL_POLICY_OUT_CONTINUOUS;
+    h.input_dtype = RRL_DTYPE_FLOAT32;
+    h.input_dims[0] = h.input_dims[1] = h.input_dims[2] = kMax;
+    h.input_scale = 1.f;
+    RRL_PolicyLayer l{};
+    l.kind = RRL_LAYER_CONV2D;
+    l.in_dims[0] = l.in_dims[1] = l.in_dims[2] = kMax;
+    l.out_dims[0] = l.out_dims[1] = 1;
+    l.out_dims[2]   = kMax;
+    l.kernel        = kMax;
+    l.stride        = 1;
+    l.weight_dtype  = RRL_DTYPE_FLOAT32;
+    l.weight_offset = kWeight;
+    l.bias_offset   = kWeight;
+    std::memcpy(b.data(), &h, sizeof(h));
+    std::memcpy(b.data() + kLayer, &l, sizeof(l));
+    return b;
+}
+
+int bind_refused(RRLHandle, RRLPolicy) { return RRL_ERR_IO; }
+
+} // namespace (anonymous)
+
+int main()
+{
+    const std::vector<unsigned char> a = blob(1.f), b = blob(10.f), c = blob(20.f);
+    int rc = 0;
+
+    // Backend-less load: the built-in engine serves it.
+    RRL_CHECK_EQ(rrl_load_policy(fake(0), a.data(), a.size()), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_load_policy(fake(1), a.data(), a.size()), RRL_SUCCESS);
+    RRL_CHECK_EQ(act(fake(0)), 1.f);
+    RRL_CHECK_EQ(act(fake(1)), 1.f);
+
+    // Sizes that overflow are rejected, not wrapped.
+    const std::vector<unsigned char> bad = wrapping_blob();
+    RRL_CHECK_EQ(rrl_load_policy(fake(5), bad.data(), bad.size()), RRL_ERR_UNSUPPORTED);
+
+    // Bind, then update retargets the bound handle.
+    RRLPolicy p = rrl_policy_create(b.data(), b.size());
+    RRL_CHECK(p != nullptr);
+    RRL_CHECK_EQ(rrl_bind_policy(fake(1), p), RRL_SUCCESS);
+    RRL_CHECK_EQ(act(fake(1)), 10.f);
+    RRL_CHECK_EQ(rrl_policy_update(p, c.data(), c.size()), RRL_SUCCESS);
+    RRL_CHECK_EQ(act(fake(1)), 20.f);
+    RRL_CHECK_EQ(act(fake(0)), 1.f);
+
+    // Unbind, and rrl_close() dropping the binding.
+    RRL_CHECK_EQ(rrl_bind_policy(fake(1), nullptr), RRL_SUCCESS);
+    act(fake(1), &rc);
+    RRL_CHECK_EQ(rc, RRL_ERR_INVALID_HANDLE);
+    rrl_close(fake(0));
+    act(fake(0), &rc);
+    RRL_CHECK_EQ(rc, RRL_ERR_INVALID_HANDLE);
+
+    // A bind the backend refuses is not recorded.
+    RRL_BackendHooksExt ext{};
+    ext.struct_size = sizeof(ext);
+    ext.bind_policy = bind_refused;
+    RRL_CHECK_EQ(rrl_register_backend_ext(&ext), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_bind_policy(fake(2), p), RRL_ERR_IO);
+    RRL_CHECK_EQ(rrl_register_backend_ext(nullptr), RRL_SUCCESS);
+    act(fake(2), &rc);
+    RRL_CHECK_EQ(rc, RRL_ERR_INVALID_HANDLE);
+
+    // Grow the table, close every other handle, rebind a few of them.
+    constexpr uintptr_t kMany = 1000;
+    for (uintptr_t i = 10; i < 10 + kMany; ++i)
+        RRL_CHECK_EQ(rrl_bind_policy(fake(i), p), RRL_SUCCESS);
+    for (uintptr_t i = 10; i < 10 + kMany; i += 2) rrl_close(fake(i));
+    for (uintptr_t i = 10; i < 30; i += 2)
+        RRL_CHECK_EQ(rrl_load_policy(fake(i), a.data(), a.size()), RRL_SUCCESS);
+    int wrong = 0;
+    for (uintptr_t i = 10; i < 10 + kMany; ++i) {
+        const float v = act(fake(i), &rc);
+        const bool even = i % 2 == 0;
+        if (even && i < 30) wrong += v != 1.f;
+        else if (even)      wrong += rc != RRL_ERR_INVALID_HANDLE;
+        else                wrong += v != 20.f;
+    }
+    RRL_CHECK_EQ(wrong, 0);
+
+    // Bindings hold their own reference.
+    rrl_policy_release(p);
+    RRL_CHECK_EQ(act(fake(11)), 20.f);
+
+    // Mapped file: shares the mapping instead of copying it.
+    const char* file = "rrl_test_policy.bin";   // in ctest's working directory
+    std::FILE* f = std::fopen(file, "wb");
+    RRL_CHECK(f != nullptr);
+    if (f) {
+        std::fwrite(b.data(), 1, b.size(), f);
+        std::fclose(f);
+        RRL_CHECK_EQ(rrl_load_policy_file(fake(3), file), RRL_SUCCESS);
+        RRL_CHECK_EQ(rrl_load_policy_file(fake(4), file), RRL_SUCCESS);
+        RRL_CHECK_EQ(act(fake(3)), 10.f);
+        RRL_CHECK_EQ(act(fake(4)), 10.f);
+        rrl_close(fake(3));
+        rrl_close(fake(4));
+        std::remove(file);
+    }
+    return rrl_test::failures();
+}
@@ -0,0 +1,125 @@
+//─────────────────────────────────────────────────────────────
+//  test_pool.cpp  —  RRLPool acquire / release
+//
+//  • Every handle is opened and bound at create; acquire runs out
+//    with RRL_ERR_EXHAUSTED, and foreign or doubled releases are
+//    refused.  A release whose reset fails keeps the handle.
+//  • Threads hammering acquire / release never hold the same handle
+//    at once, every release resets once, and the pool ends full.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+constexpr size_t kCap = 8;
+
+std::atomic<uintptr_t> g_opened{0};
+std::atomic<unsigned>  g_resets{0}, g_binds{0};
+std::atomic<bool>      g_reset_fails{false};
+
+int open_env(const RRL_OpenConfig*, RRLHandle* out)
+{
+    *out = fake(g_opened.fetch_add(1));
+    return RRL_SUCCESS;
+}
+
+int reset_env(RRLHandle)
+{
+    if (g_reset_fails.load()) return RRL_ERR_IO;
+    g_resets.fetch_add(1, std::memory_order_relaxed);
+    return RRL_SUCCESS;
+}
+
+int bind(RRLHandle, void*, size_t, void*, size_t)
+{
+    g_binds.fetch_add(1);
+    return RRL_SUCCESS;
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    RRL_BackendHooksExt ext{};
+    ext.struct_size  = sizeof(ext);
+    ext.open         = open_env;
+    ext.reset        = reset_env;
+    ext.bind_buffers = bind;
+    RRL_CHECK_EQ(rrl_register_backend_ext(&ext), RRL_SUCCESS);
+
+    RRL_OpenConfig cfg{};
+    cfg.struct_size = sizeof(cfg);
+    RRLPool pool = rrl_pool_create(kCap, &cfg);
+    RRL_CHECK(pool != nullptr);
+    if (!pool) return rrl_test::failures();
+    RRL_CHECK_EQ(g_opened.load(), uintptr_t(kCap));
+    RRL_CHECK_EQ(g_binds.load(), unsigned(kCap));
+    RRL_CHECK_EQ(rrl_pool_available(pool), kCap);
+
+    // Single thread: exhaust, then the refusals.
+    RRLHandle held[kCap];
+    for (size_t i = 0; i < kCap; ++i) {
+        held[i] = rrl_pool_acquire(pool);
+        RRL_CHECK(held[i] != nullptr);
+        RRL_PoolSlot slot{};
+        RRL_CHECK_EQ(rrl_pool_slot(pool, held[i], &slot), RRL_SUCCESS);
+        RRL_CHECK(slot.bound && slot.obs_bytes == 64 && slot.action_bytes == 16);
+        RRL_CHECK_EQ(reinterpret_cast<uintptr_t>(slot.obs) % RRL_BUFFER_ALIGN, uintptr_t(0));
+    }
+    RRL_CHECK(rrl_pool_acquire(pool) == nullptr);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_EXHAUSTED);
+    RRL_CHECK_EQ(rrl_pool_release(pool, fake(1000)), RRL_ERR_INVALID_HANDLE);
+
+    g_reset_fails.store(true);
+    RRL_CHECK_EQ(rrl_pool_release(pool, held[0]), RRL_ERR_IO);
+    RRL_CHECK_EQ(rrl_pool_available(pool), size_t(0));
+    g_reset_fails.store(false);
+    for (RRLHandle h : held) RRL_CHECK_EQ(rrl_pool_release(pool, h), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_pool_release(pool, held[0]), RRL_ERR_INVALID_HANDLE);   // twice
+    RRL_CHECK_EQ(rrl_pool_available(pool), kCap);
+    RRL_CHECK_EQ(g_resets.load(), unsigned(kCap));
+
+    // Threads: more takers than handles.
+    constexpr int kThreads = 6, kRounds = 20000;
+    std::atomic<int> owner[kCap];
+    for (auto& o : owner) o.store(-1);
+    std::atomic<int> doubled{0}, acquired{0}, failed{0};
+    std::vector<std::thread> ts;
+    g_resets.store(0);
+    for (int t = 0; t < kThreads; ++t)
+        ts.emplace_back([&, t] {
+            for (int r = 0; r < kRounds; ++r) {
+                RRLHandle h = rrl_pool_acquire(pool);
+                if (!h) {
+                    if (rrl_last_error() != RRL_ERR_EXHAUSTED) failed.fetch_add(1);
+                    continue;
+                }
+                acquired.fetch_add(1, std::memory_order_relaxed);
+                RRL_PoolSlot slot{};
+                if (rrl_pool_slot(pool, h, &slot) != RRL_SUCCESS) { failed.fetch_add(1); continue; }
+                if (owner[slot.index].exchange(t) != -1) doubled.fetch_add(1);
+                std::memset(slot.obs, t, slot.obs_bytes);   // the buffer is ours alone
+                if (static_cast<unsigned char*>(slot.obs)[slot.obs_bytes - 1] != t) doubled.fetch_add(1);
+                owner[slot.index].store(-1);
+                if (rrl_pool_release(pool, h) != RRL_SUCCESS) failed.fetch_add(1);
+            }
+        });
+    for (auto& t : ts) t.join();
+    RRL_CHECK_EQ(doubled.load(), 0);
+    RRL_CHECK_EQ(failed.load(), 0);
+    RRL_CHECK(acquired.load() > 0);
+    RRL_CHECK_EQ(g_resets.load(), unsigned(acquired.load()));
+    RRL_CHECK_EQ(rrl_pool_available(pool), kCap);
+
+    rrl_pool_destroy(pool);
+    return rrl_test::failures();
+}
@@ -0,0 +1,258 @@
+//─────────────────────────────────────────────────────────────
+//  test_preproc.cpp  —  Preprocessing stages against reference values
+//
+//  • Grayscale and area resize (integer and fractional factors, uint8
+//    and float32) match a direct evaluation of the documented
+//    weights.
+//  • Running normalize: mean / variance track a double-precision
+//    reference over an odd-length vector (vector body and scalar
+//    tail), outputs are the clipped z-scores, freeze_stats holds them.
+//  • Frame stack: oldest first, repeats the oldest until full, and
+//    restarts after a reset.
+//  • A replacement pipeline on a handle keeps the running stats, also
+//    while another thread is stepping through the old one.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+RRL_SpaceDesc space(int dtype, uint32_t a, uint32_t b = 0, uint32_t c = 0)
+{
+    RRL_SpaceDesc s{};
+    s.dtype    = dtype;
+    s.ndim     = c ? 3 : b ? 2 : 1;
+    s.shape[0] = a;
+    s.shape[1] = b;
+    s.shape[2] = c;
+    return s;
+}
+
+RRL_PreprocConfig config()
+{
+    RRL_PreprocConfig c{};
+    c.struct_size = sizeof(c);
+    return c;
+}
+
+bool near(double a, double b, double tol) { return std::fabs(a - b) <= tol * (1 + std::fabs(b)); }
+
+// Area weight of input sample i for output o when `in` maps onto `out`.
+double overlap(int i, int o, int in, int out)
+{
+    const double s = double(in) / out, lo = o * s, hi = (o + 1) * s;
+    return std::max(0.0, std::min(hi, i + 1.0) - std::max(lo, double(i))) / s;
+}
+
+void resize()
+{
+    // uint8, RGB → gray, 6×4 → 3×2: each output the rounded mean of a 2×2 block.
+    const int H = 6, W = 4;
+    std::vector<uint8_t> rgb(H * W * 3), gray(H * W);
+    for (int i = 0; i < H * W; ++i) {
+        rgb[3 * i] = uint8_t(i * 7), rgb[3 * i + 1] = uint8_t(i * 3), rgb[3 * i + 2] = uint8_t(255 - i);
+        gray[i] = uint8_t((77u * rgb[3 * i] + 150u * rgb[3 * i + 1] + 29u * rgb[3 * i + 2] + 128u) >> 8);
+    }
+    RRL_PreprocConfig c = config();
+    c.grayscale = 1;
+    c.resize_h  = 3;
+    c.resize_w  = 2;
+    const RRL_SpaceDesc in = space(RRL_DTYPE_UINT8, H, W, 3);
+    RRLPreproc pp = rrl_preproc_create(&in, &c);
+    RRL_CHECK(pp != nullptr);
+    RRL_SpaceDesc out{};
+    RRL_CHECK_EQ(rrl_preproc_output_space(pp, &out), RRL_SUCCESS);
+    RRL_CHECK(out.ndim == 3 && out.shape[0] == 3 && out.shape[1] == 2 && out.shape[2] == 1);
+    uint8_t y[6] = {};
+    RRL_CHECK_EQ(rrl_preproc_apply(pp, rgb.data(), y), RRL_SUCCESS);
+    for (int oy = 0; oy < 3; ++oy)
+        for (int ox = 0; ox < 2; ++ox) {
+            const int a = gray[(2 * oy) * W + 2 * ox], b = gray[(2 * oy) * W + 2 * ox + 1];
+            const int d = gray[(2 * oy + 1) * W + 2 * ox], e = gray[(2 * oy + 1) * W + 2 * ox + 1];
+            const int ref = int(std::floor((a + b + d + e) / 4.0 + 0.5));
+            RRL_CHECK(std::abs(int(y[oy * 2 + ox]) - ref) <= 1);
+        }
+    rrl_preproc_destroy(pp);
+
+    // float32, 7×19 → 3×5: fractional spans weigh partial pixels.
+    const int h = 7, w = 19, oh = 3, ow = 5;
+    std::vector<float> src(h * w);
+    for (int i = 0; i < h * w; ++i) src[i] = std::sin(0.37f * i) * 50.f;
+    c = config();
+    c.resize_h = oh;
+    c.resize_w = ow;
+    const RRL_SpaceDesc fin = space(RRL_DTYPE_FLOAT32, h, w);
+    pp = rrl_preproc_create(&fin, &c);
+    RRL_CHECK(pp != nullptr);
+    std::vector<float> fy(oh * ow);
+    RRL_CHECK_EQ(rrl_preproc_apply(pp, src.data(), fy.data()), RRL_SUCCESS);
+    for (int oy = 0; oy < oh; ++oy)
+        for (int ox = 0; ox < ow; ++ox) {
+            double ref = 0;
+            for (int iy = 0; iy < h; ++iy)
+                for (int ix = 0; ix < w; ++ix)
+                    ref += overlap(iy, oy, h, oh) * overlap(ix, ox, w, ow) * src[iy * w + ix];
+            RRL_CHECK(near(fy[oy * ow + ox], ref, 1e-5));
+        }
+    rrl_preproc_destroy(pp);
+}
+
+void running_stats()
+{
+    constexpr int N = 13, Steps = 200;
+    RRL_PreprocConfig c = config();
+    c.normalize = RRL_NORM_RUNNING;
+    c.clip      = 3.f;
+    const RRL_SpaceDesc in = space(RRL_DTYPE_FLOAT32, N);
+    RRLPreproc pp = rrl_preproc_create(&in, &c);
+    RRL_CHECK(pp != nullptr);
+
+    double sum[N] = {}, sq[N] = {};
+    float x[N], y[N];
+    uint32_t r = 1;
+    for (int t = 1; t <= Steps; ++t) {
+        for (int i = 0; i < N; ++i) {
+            r = r * 1664525u + 1013904223u;
+            x[i] = float(i) + float(r >> 8) / float(1u << 24) * (1.f + i);   // element i: mean ≈ 1.5i + 0.5
+            sum[i] += x[i];
+            sq[i]  += double(x[i]) * x[i];
+        }
+        RRL_CHECK_EQ(rrl_preproc_apply(pp, x, y), RRL_SUCCESS);
+    }
+    float mean[N], var[N];
+    uint64_t count = 0;
+    RRL_CHECK_EQ(rrl_preproc_get_stats(pp, mean, var, &count), RRL_SUCCESS);
+    RRL_CHECK_EQ(count, uint64_t(Steps));
+    for (int i = 0; i < N; ++i) {
+        const double m = sum[i] / Steps, v = sq[i] / Steps - m * m;   // population variance
+        RRL_CHECK(near(mean[i], m, 1e-4));
+        RRL_CHECK(near(var[i], v, 1e-3));
+        const double z = std::min(3.0, std::max(-3.0, (x[i] - mean[i]) / std::sqrt(var[i] + 1e-8)));
+        RRL_CHECK(near(y[i], z, 1e-4));
+    }
+
+    // Frozen: same outputs for the same input, stats untouched.
+    rrl_preproc_destroy(pp);
+    c.freeze_stats = 1;
+    pp = rrl_preproc_create(&in, &c);
+    RRL_CHECK_EQ(rrl_preproc_set_stats(pp, mean, var, count), RRL_SUCCESS);
+    float y2[N];
+    RRL_CHECK_EQ(rrl_preproc_apply(pp, x, y2), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_preproc_apply(pp, x, y2), RRL_SUCCESS);
+    uint64_t after = 0;
+    RRL_CHECK_EQ(rrl_preproc_get_stats(pp, nullptr, nullptr, &after), RRL_SUCCESS);
+    RRL_CHECK_EQ(after, count);
+    for (int i = 0; i < N; ++i) RRL_CHECK(near(y2[i], y[i], 1e-6));
+    rrl_preproc_destroy(pp);
+}
+
+void frame_stack()
+{
+    // 5×7 one-byte frames, N = 4: the interleave's vector body and tail.
+    constexpr int H = 5, W = 7, PX = H * W, N = 4;
+    RRL_PreprocConfig c = config();
+    c.frame_stack = N;
+    const RRL_SpaceDesc in = space(RRL_DTYPE_UINT8, H, W);
+    RRLPreproc pp = rrl_preproc_create(&in, &c);
+    RRL_CHECK(pp != nullptr);
+    RRL_SpaceDesc out{};
+    rrl_preproc_output_space(pp, &out);
+    RRL_CHECK(out.ndim == 3 && out.shape[2] == uint32_t(N));
+
+    auto frame = [](int k) {
+        std::vector<uint8_t> f(PX);
+        for (int p = 0; p < PX; ++p) f[p] = uint8_t(k * 40 + p);
+        return f;
+    };
+    // Output channel j holds frame ids[j] at every pixel.
+    auto holds = [&](const std::vector<uint8_t>& y, const int (&ids)[N]) {
+        int wrong = 0;
+        for (int p = 0; p < PX; ++p)
+            for (int j = 0; j < N; ++j) wrong += y[p * N + j] != uint8_t(ids[j] * 40 + p);
+        return wrong == 0;
+    };
+    std::vector<uint8_t> y(PX * N);
+    rrl_preproc_apply(pp, frame(1).data(), y.data());
+    RRL_CHECK(holds(y, {1, 1, 1, 1}));
+    rrl_preproc_apply(pp, frame(2).data(), y.data());
+    RRL_CHECK(holds(y, {1, 1, 1, 2}));
+    for (int k = 3; k <= 6; ++k) rrl_preproc_apply(pp, frame(k).data(), y.data());
+    RRL_CHECK(holds(y, {3, 4, 5, 6}));
+    rrl_preproc_reset(pp);
+    rrl_preproc_apply(pp, frame(0).data(), y.data());
+    RRL_CHECK(holds(y, {0, 0, 0, 0}));
+    rrl_preproc_destroy(pp);
+}
+
+int accept_space(RRLHandle, const RRL_SpaceDesc*) { return RRL_SUCCESS; }
+
+// test_core.cpp: float32[16] observations.
+void replacement()
+{
+    RRL_BackendHooksExt ext{};
+    ext.struct_size           = sizeof(ext);
+    ext.set_observation_space = accept_space;
+    RRL_CHECK_EQ(rrl_register_backend_ext(&ext), RRL_SUCCESS);
+
+    RRL_PreprocConfig c = config();
+    c.normalize = RRL_NORM_RUNNING;
+    const RRLHandle h = fake(0);
+    RRL_CHECK_EQ(rrl_set_preprocess(h, &c), RRL_SUCCESS);
+
+    // Stepping on one thread, replacing on another: the stepper keeps
+    // going until every replacement is done, so all of them overlap it.
+    std::atomic<bool> started{false}, stop{false};
+    std::atomic<int>  failed{0}, steps{0};
+    std::thread stepper([&] {
+        float x[16], y[16];
+        std::fill(x, x + 16, 2.f);
+        do {
+            if (rrl_preprocess(h, x, y) != RRL_SUCCESS) failed.fetch_add(1);
+            steps.fetch_add(1, std::memory_order_relaxed);
+            started.store(true);
+        } while (!stop.load() || steps.load(std::memory_order_relaxed) < 20000);
+    });
+    while (!started.load()) std::this_thread::yield();
+    const int before = steps.load();
+    for (int i = 0; i < 200; ++i) RRL_CHECK_EQ(rrl_set_preprocess(h, &c), RRL_SUCCESS);
+    stop.store(true);
+    stepper.join();
+    RRL_CHECK_EQ(failed.load(), 0);
+    RRL_CHECK(steps.load() > before);
+
+
+    // A frozen replacement still sees mean 2, variance 0: fresh stats
+    // (mean 0, variance 1) would pass 2 through unchanged.
+    c.freeze_stats = 1;
+    RRL_CHECK_EQ(rrl_set_preprocess(h, &c), RRL_SUCCESS);
+    float x[16], y[16];
+    std::fill(x, x + 16, 2.f);
+    RRL_CHECK_EQ(rrl_preprocess(h, x, y), RRL_SUCCESS);
+    RRL_CHECK(std::fabs(y[0]) < 1e-3f && std::fabs(y[15]) < 1e-3f);
+    std::fill(x, x + 16, 3.f);
+    RRL_CHECK_EQ(rrl_preprocess(h, x, y), RRL_SUCCESS);
+    RRL_CHECK_EQ(y[0], 10.f);   // clipped at the default ±10
+
+    rrl_close(h);
+    RRL_CHECK_EQ(rrl_preprocess(h, x, y), RRL_ERR_INVALID_ARGUMENT);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    resize();
+    running_stats();
+    frame_stack();
+    replacement();
+    return rrl_test::failures();
+}
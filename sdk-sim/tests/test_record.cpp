@@ -0,0 +1,454 @@
+//─────────────────────────────────────────────────────────────
+//  test_record.cpp  —  Recorder files: columns, drops, threads, append
+//
+//  • Rows come back from the file in order, chunk by chunk, with the
+//    partial chunk rrl_recorder_flush() ships.
+//  • For each compression built in (the others refuse to create):
+//    the wide obs column is stored compressed, the tiny done column,
+//    which cannot shrink, plain; both decode to what was recorded.
+//  • With one chunk per thread, rows recorded while it waits for the
+//    flush thread are dropped: RRL_ERR_EXHAUSTED and `dropped`.
+//  • Two threads recording at once: every row lands exactly once, in
+//    order per thread.  rrl_vec_set_recorder() records each
+//    rrl_vec_step() with the actions the vec_step hook returned.
+//  • Appending continues after the last whole chunk: a chunk torn by
+//    a crash is cut off and the new rows follow the intact ones.
+//  • With `append`, only a missing or empty file is started; a file
+//    that is not a recording, or one of other spaces, is refused and
+//    left as it was.  Without it the file is truncated.
+//─────────────────────────────────────────────────────────────
+#include "rrl_record.h"
+#include "rrl_test.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(RRL_HAVE_ZSTD)
+#  include <zstd.h>
+#endif
+#if defined(RRL_HAVE_LZ4)
+#  include <lz4.h>
+#endif
+
+namespace {
+
+const char* const kPath = "rrl_test_record.bin";
+
+RRL_SpaceDesc vec_space(uint32_t n)
+{
+    RRL_SpaceDesc s{};
+    s.ndim     = 1;
+    s.shape[0] = n;
+    s.dtype    = RRL_DTYPE_FLOAT32;
+    return s;
+}
+
+const RRL_SpaceDesc g_obs = vec_space(3);
+const RRL_SpaceDesc g_act = vec_space(2);
+
+RRL_RecorderConfig config(bool append, const RRL_SpaceDesc* obs = &g_obs)
+{
+    RRL_RecorderConfig c{};
+    c.struct_size    = sizeof(c);
+    c.obs_space      = obs;
+    c.action_space   = &g_act;
+    c.rows_per_chunk = 4;
+    c.append         = append ? 1 : 0;
+    return c;
+}
+
+RRLRecorder open_recorder(bool append, const RRL_SpaceDesc* obs = &g_obs)
+{
+    const RRL_RecorderConfig c = config(append, obs);
+    return rrl_recorder_create(kPath, &c);
+}
+
+// Row for env `e`: obs {e, e+1, e+2, 0, …}, action {-e, e}, reward e/2.
+std::vector<float> obs_of(uint32_t e, size_t n)
+{
+    std::vector<float> obs(n);
+    for (size_t j = 0; j < n && j < 3; ++j) obs[j] = float(e + j);
+    return obs;
+}
+
+void record(RRLRecorder r, uint32_t first, uint32_t count, size_t obs_n = 3)
+{
+    for (uint32_t e = first; e < first + count; ++e) {
+        const std::vector<float> obs = obs_of(e, obs_n);
+        const float act[2] = {-float(e), float(e)};
+        RRL_CHECK_EQ(rrl_record(r, e, obs.data(), act, float(e) / 2, uint8_t(e % 2)), RRL_SUCCESS);
+    }
+}
+
+std::vector<unsigned char> slurp()
+{
+    std::ifstream in(kPath, std::ios::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Every whole chunk of the file, columns decoded.
+struct Rows {
+    size_t obs_n = 0, act_n = 0;
+    std::vector<uint32_t> env;
+    std::vector<float>    obs, action, reward;   // obs / action: obs_n / act_n per row
+    std::vector<uint8_t>  done;
+    std::vector<RRL_RecordChunk> chunks;
+};
+
+// Appends column `col` of the chunk at `base`, `raw` bytes once decoded.
+template <class T>
+void decode(const unsigned char* base, const RRL_RecordColumn& col, size_t raw, std::vector<T>& out)
+{
+    const size_t at = out.size();
+    out.resize(at + raw / sizeof(T));
+    void* dst = out.data() + at;
+    const unsigned char* src = base + col.offset;
+    switch (col.compression) {
+    case RRL_WIRE_COMP_NONE:
+        RRL_CHECK_EQ(col.bytes, uint64_t(raw));
+        std::memcpy(dst, src, raw);
+        break;
+#if defined(RRL_HAVE_ZSTD)
+    case RRL_WIRE_COMP_ZSTD:
+        RRL_CHECK_EQ(ZSTD_decompress(dst, raw, src, static_cast<size_t>(col.bytes)), raw);
+        break;
+#endif
+#if defined(RRL_HAVE_LZ4)
+    case RRL_WIRE_COMP_LZ4:
+        RRL_CHECK_EQ(LZ4_decompress_safe(reinterpret_cast<const char*>(src), static_cast<char*>(dst),
+                                         static_cast<int>(col.bytes), static_cast<int>(raw)),
+                     static_cast<int>(raw));
+        break;
+#endif
+    default:
+        RRL_CHECK(false);   // a codec this test cannot decode
+    }
+}
+
+Rows read_all()
+{
+    const std::vector<unsigned char> f = slurp();
+    Rows rows;
+    RRL_RecordHeader h;
+    RRL_CHECK(f.size() >= sizeof(h));
+    if (f.size() < sizeof(h)) return rows;
+    std::memcpy(&h, f.data(), sizeof(h));
+    RRL_CHECK_EQ(h.magic, RRL_RECORD_MAGIC);
+    rows.obs_n = h.obs_bytes / 4;
+    rows.act_n = h.action_bytes / 4;
+    size_t at = sizeof(h);
+    RRL_RecordChunk c;
+    while (f.size() - at >= sizeof(c)) {
+        std::memcpy(&c, f.data() + at, sizeof(c));
+        if (c.magic != RRL_RECORD_CHUNK || c.chunk_bytes > f.size() - at) break;   // torn
+        const unsigned char* base = f.data() + at;
+        decode(base, c.column[RRL_RECORD_ENV],    c.rows * 4, rows.env);
+        decode(base, c.column[RRL_RECORD_OBS],    c.rows * size_t(h.obs_bytes), rows.obs);
+        decode(base, c.column[RRL_RECORD_ACTION], c.rows * size_t(h.action_bytes), rows.action);
+        decode(base, c.column[RRL_RECORD_REWARD], c.rows * 4, rows.reward);
+        decode(base, c.column[RRL_RECORD_DONE],   c.rows, rows.done);
+        rows.chunks.push_back(c);
+        at += c.chunk_bytes;
+    }
+    return rows;
+}
+
+// Env ids of every whole chunk, checking the other columns against them.
+std::vector<uint32_t> read_back()
+{
+    const Rows rows = read_all();
+    RRL_CHECK_EQ(rows.act_n, size_t(2));
+    for (size_t i = 0; i < rows.env.size(); ++i) {
+        const uint32_t e = rows.env[i];
+        RRL_CHECK(std::equal(rows.obs.begin() + i * rows.obs_n, rows.obs.begin() + (i + 1) * rows.obs_n,
+                             obs_of(e, rows.obs_n).begin()));
+        RRL_CHECK_EQ(rows.action[i * 2], -float(e));
+        RRL_CHECK_EQ(rows.action[i * 2 + 1], float(e));
+        RRL_CHECK_EQ(rows.reward[i], float(e) / 2);
+        RRL_CHECK_EQ(uint32_t(rows.done[i]), e % 2);
+    }
+    return rows.env;
+}
+
+std::vector<uint32_t> range(uint32_t first, uint32_t count)
+{
+    std::vector<uint32_t> v;
+    for (uint32_t e = first; e < first + count; ++e) v.push_back(e);
+    return v;
+}
+
+void write_file(const std::string& bytes)
+{
+    std::ofstream(kPath, std::ios::binary | std::ios::trunc) << bytes;
+}
+
+void compressed()
+{
+    const RRL_SpaceDesc wide = vec_space(64);   // 1 KiB per chunk, mostly zeros
+    for (int comp : {RRL_WIRE_COMP_LZ4, RRL_WIRE_COMP_ZSTD}) {
+        std::remove(kPath);
+        RRL_RecorderConfig c = config(false, &wide);
+        c.compression = comp;
+        RRLRecorder r = rrl_recorder_create(kPath, &c);
+        if (!rrl_wire_codec_available(comp)) {
+            RRL_CHECK(r == nullptr);
+            RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_UNSUPPORTED);
+            continue;
+        }
+        RRL_CHECK(r != nullptr);
+        if (!r) continue;
+        record(r, 0, 10, 64);
+        rrl_recorder_destroy(r);
+        RRL_CHECK(read_back() == range(0, 10));
+        const Rows rows = read_all();
+        RRL_CHECK_EQ(rows.chunks.size(), size_t(3));
+        for (const RRL_RecordChunk& k : rows.chunks) {
+            RRL_CHECK_EQ(k.column[RRL_RECORD_OBS].compression, uint32_t(comp));
+            RRL_CHECK(k.column[RRL_RECORD_OBS].bytes < k.rows * 256u);
+            RRL_CHECK_EQ(k.column[RRL_RECORD_DONE].compression, uint32_t(RRL_WIRE_COMP_NONE));
+            RRL_CHECK_EQ(k.column[RRL_RECORD_DONE].bytes, uint64_t(k.rows));
+        }
+    }
+}
+
+void dropped()
+{
+    std::remove(kPath);
+    RRL_RecorderConfig c = config(false);
+    c.chunks_per_thread = 1;
+    RRLRecorder r = rrl_recorder_create(kPath, &c);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    // One batch holds the thread's chunk lock: the full chunk cannot
+    // come back from the flush thread before the batch ends.
+    float obs[10][3], act[10][2], rew[10];
+    uint8_t done[10];
+    for (uint32_t e = 0; e < 10; ++e) {
+        const std::vector<float> o = obs_of(e, 3);
+        std::copy(o.begin(), o.end(), obs[e]);
+        act[e][0] = -float(e);
+        act[e][1] = float(e);
+        rew[e]    = float(e) / 2;
+        done[e]   = uint8_t(e % 2);
+    }
+    RRL_CHECK_EQ(rrl_record_batch(r, 0, 10, obs, 0, act, 0, rew, done), RRL_ERR_EXHAUSTED);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_EXHAUSTED);
+    RRL_CHECK_EQ(rrl_recorder_flush(r), RRL_SUCCESS);
+    RRL_RecorderStats s{};
+    rrl_recorder_stats(r, &s);
+    RRL_CHECK_EQ(s.rows, uint64_t(4));
+    RRL_CHECK_EQ(s.dropped, uint64_t(6));
+
+    // Written back: the chunk is free again.
+    record(r, 20, 2);
+    rrl_recorder_destroy(r);
+    std::vector<uint32_t> want = range(0, 4);
+    want.push_back(20);
+    want.push_back(21);
+    RRL_CHECK(read_back() == want);
+}
+
+void two_threads()
+{
+    constexpr uint32_t kRows = 5000;   // per thread
+    std::remove(kPath);
+    RRL_RecorderConfig c = config(false);
+    c.chunks_per_thread = 2;   // drops likely: retried below
+    RRLRecorder r = rrl_recorder_create(kPath, &c);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    auto writer = [r](uint32_t first, int* failed) {
+        for (uint32_t e = first; e < first + kRows; ++e) {
+            const std::vector<float> obs = obs_of(e, 3);
+            const float act[2] = {-float(e), float(e)};
+            int rc;
+            while ((rc = rrl_record(r, e, obs.data(), act, float(e) / 2, uint8_t(e % 2))) == RRL_ERR_EXHAUSTED)
+                std::this_thread::yield();
+            *failed += rc != RRL_SUCCESS;
+        }
+    };
+    int failed[2] = {};
+    std::thread a(writer, 0, &failed[0]);
+    std::thread b(writer, 100000, &failed[1]);
+    a.join();
+    b.join();
+    RRL_CHECK_EQ(failed[0] + failed[1], 0);
+    RRL_CHECK_EQ(rrl_recorder_flush(r), RRL_SUCCESS);
+    RRL_RecorderStats s{};
+    rrl_recorder_stats(r, &s);
+    RRL_CHECK_EQ(s.rows, uint64_t(2 * kRows));
+    rrl_recorder_destroy(r);
+
+    // Each thread's rows in its own order; together, each once.
+    const std::vector<uint32_t> envs = read_back();
+    std::vector<uint32_t> lo, hi;
+    for (uint32_t e : envs) (e < 100000 ? lo : hi).push_back(e);
+    RRL_CHECK(lo == range(0, kRows));
+    RRL_CHECK(hi == range(100000, kRows));
+}
+
+// vec_step hook: action[i] = {-obs[i][0], i}.
+int vec_step(const RRLHandle*, size_t k, const RRL_VecBuffers* b, int64_t)
+{
+    for (size_t i = 0; i < k; ++i) {
+        const float* obs = reinterpret_cast<const float*>(static_cast<const unsigned char*>(b->obs) + i * b->obs_stride);
+        float* act = reinterpret_cast<float*>(static_cast<unsigned char*>(b->actions) + i * b->action_stride);
+        act[0] = -obs[0];
+        act[1] = float(i);
+    }
+    return RRL_SUCCESS;
+}
+
+void vec_recorder()
+{
+    RRL_BackendHooks base{};
+    RRL_BackendHooksExt ext{};
+    ext.struct_size = sizeof(ext);
+    ext.vec_step    = vec_step;
+    RRL_CHECK_EQ(rrl_register_backends(&base, &ext), RRL_SUCCESS);
+
+    // The stand-in core's spaces: float32[16] obs, float32[4] actions.
+    const RRL_SpaceDesc obs = vec_space(16), act = vec_space(4);
+    std::remove(kPath);
+    RRL_RecorderConfig c = config(false, &obs);
+    c.action_space = &act;
+    RRLRecorder r = rrl_recorder_create(kPath, &c);
+    const RRLHandle envs[2] = {reinterpret_cast<RRLHandle>(0x1000), reinterpret_cast<RRLHandle>(0x1040)};
+    RRLVecHandle vec = rrl_vec_create(envs, 2);
+    RRL_CHECK(r != nullptr && vec != nullptr);
+    if (r && vec) {
+        RRL_CHECK_EQ(rrl_vec_set_recorder(vec, r, 10), RRL_SUCCESS);
+        RRL_VecBuffers b{};
+        rrl_vec_buffers(vec, &b);
+        for (int step = 0; step < 3; ++step) {
+            for (size_t i = 0; i < 2; ++i) {
+                float* o = reinterpret_cast<float*>(static_cast<unsigned char*>(b.obs) + i * b.obs_stride);
+                o[0]         = float(step * 10 + int(i));
+                b.rewards[i] = float(step);
+                b.dones[i]   = uint8_t(step == 2);
+            }
+            RRL_CHECK_EQ(rrl_vec_step(vec, 0), RRL_SUCCESS);
+        }
+        RRL_CHECK_EQ(rrl_vec_set_recorder(vec, nullptr, 0), RRL_SUCCESS);
+        RRL_CHECK_EQ(rrl_vec_step(vec, 0), RRL_SUCCESS);   // not recorded
+    }
+    rrl_vec_destroy(vec);
+    rrl_recorder_destroy(r);
+    rrl_register_backends(nullptr, nullptr);
+
+    const Rows rows = read_all();
+    RRL_CHECK_EQ(rows.env.size(), size_t(6));
+    if (rows.env.size() != 6) return;
+    for (size_t n = 0; n < 6; ++n) {
+        const size_t step = n / 2, i = n % 2;
+        RRL_CHECK_EQ(rows.env[n], uint32_t(10 + i));
+        RRL_CHECK_EQ(rows.obs[n * 16], float(step * 10 + i));
+        RRL_CHECK_EQ(rows.action[n * 4], -float(step * 10 + i));
+        RRL_CHECK_EQ(rows.action[n * 4 + 1], float(i));
+        RRL_CHECK_EQ(rows.reward[n], float(step));
+        RRL_CHECK_EQ(uint32_t(rows.done[n]), uint32_t(step == 2));
+    }
+}
+
+void append_after_torn_tail()
+{
+    std::remove(kPath);
+    RRLRecorder r = open_recorder(true);   // missing: started
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    record(r, 0, 10);                      // chunks of 4, 4 and (flushed) 2
+    rrl_recorder_destroy(r);
+    RRL_CHECK(read_back() == range(0, 10));
+
+    // Clean reopen: continues after row 9.
+    r = open_recorder(true);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    RRL_RecorderStats s{};
+    rrl_recorder_stats(r, &s);
+    RRL_CHECK_EQ(s.rows, uint64_t(10));
+    record(r, 10, 3);
+    rrl_recorder_destroy(r);
+    std::vector<uint32_t> want = range(0, 13);
+    RRL_CHECK(read_back() == want);
+
+    // A crash in the middle of the last chunk (rows 10..12).
+    const uintmax_t size = std::filesystem::file_size(kPath);
+    std::filesystem::resize_file(kPath, size - 20);
+    RRL_CHECK(read_back() == range(0, 10));
+    r = open_recorder(true);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    s = RRL_RecorderStats{};
+    rrl_recorder_stats(r, &s);
+    RRL_CHECK_EQ(s.rows, uint64_t(10));
+    record(r, 100, 5);
+    rrl_recorder_destroy(r);
+    want = range(0, 10);
+    for (uint32_t e : range(100, 5)) want.push_back(e);
+    RRL_CHECK(read_back() == want);
+}
+
+void refusals()
+{
+    // Not a recording: refused, not overwritten.
+    write_file("precious notes\n");
+    RRL_CHECK(open_recorder(true) == nullptr);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK(slurp().size() == 15);
+
+    // Shorter than a header: not a recording either.
+    write_file(std::string(40, '\0'));
+    RRL_CHECK(open_recorder(true) == nullptr);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_ARGUMENT);
+
+    // A recording of other spaces.
+    std::remove(kPath);
+    RRLRecorder r = open_recorder(false);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    record(r, 0, 4);
+    rrl_recorder_destroy(r);
+    const RRL_SpaceDesc other = vec_space(5);
+    RRL_CHECK(open_recorder(true, &other) == nullptr);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK(read_back() == range(0, 4));
+
+    // Without `append` it starts over.
+    r = open_recorder(false);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    rrl_recorder_destroy(r);
+    RRL_CHECK(read_back().empty());
+
+    // Empty: started in place.
+    write_file("");
+    r = open_recorder(true);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    record(r, 7, 2);
+    rrl_recorder_destroy(r);
+    RRL_CHECK(read_back() == range(7, 2));
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    compressed();
+    dropped();
+    two_threads();
+    vec_recorder();
+    append_after_torn_tail();
+    refusals();
+    std::remove(kPath);
+    return rrl_test::failures();
+}
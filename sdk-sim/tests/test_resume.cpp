@@ -0,0 +1,232 @@
+//─────────────────────────────────────────────────────────────
+//  test_resume.cpp  —  RRLReplay across a dropped connection
+//
+//  • A sender keeps every unacknowledged frame; after a drop the peer's
+//    RESUME seq makes rrl_replay_resend() pass exactly the lost frames,
+//    byte for byte and in order, across the ring's wrap and seq 2^32.
+//  • A full buffer refuses with RRL_ERR_EXHAUSTED until acks free it;
+//    a failing send leaves the frames buffered.
+//  • The bound handle reports the reconnect and its downtime;
+//    rrl_close() unbinds it, so the address can be bound again.
+//  • The send callback may push and ack on the same replay.
+//  • Tokens are copied out whole while another thread replaces them.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_wire.h"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+// Frame `seq`: 24–87 bytes, the seq first, then a pattern.
+std::vector<unsigned char> frame(uint32_t seq)
+{
+    std::vector<unsigned char> f(24 + seq % 64);
+    for (size_t i = 0; i < f.size(); ++i) f[i] = static_cast<unsigned char>(seq * 17 + i);
+    std::memcpy(f.data(), &seq, 4);
+    return f;
+}
+
+// The receiving side of the link.
+struct Peer {
+    std::vector<std::vector<unsigned char>> got;
+    int fail_after = -1;   // refuse the send after this many
+
+    uint32_t last() const {
+        uint32_t s = 0;
+        if (!got.empty()) std::memcpy(&s, got.back().data(), 4);
+        return s;
+    }
+};
+
+int deliver(void* user, const void* f, size_t len)
+{
+    Peer& p = *static_cast<Peer*>(user);
+    if (p.fail_after == 0) return RRL_ERR_IO;
+    if (p.fail_after > 0) --p.fail_after;
+    const auto* b = static_cast<const unsigned char*>(f);
+    p.got.emplace_back(b, b + len);
+    return RRL_SUCCESS;
+}
+
+// The backend leaves reconnects / downtime to the bound replay.
+int stats(RRLHandle, RRL_StatsV2*) { return RRL_SUCCESS; }
+
+// Frames first..last (wrapping) arrived intact and in order.
+bool received(const Peer& p, size_t from, uint32_t first, uint32_t last)
+{
+    size_t i = from;
+    for (uint32_t s = first;; ++s, ++i) {
+        if (i >= p.got.size() || p.got[i] != frame(s)) return false;
+        if (s == last) return i + 1 == p.got.size();
+    }
+}
+
+void dropped_connection()
+{
+    // 1 KiB ring: the 400 frames wrap it many times.
+    RRLReplay r = rrl_replay_create(1024);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    const RRLHandle h = fake(1);
+    RRL_CHECK_EQ(rrl_replay_bind(r, h), RRL_SUCCESS);
+
+    Peer peer;
+    uint32_t seq = 0xFFFFFF00u;   // crosses 2^32 on the way
+    for (int round = 0; round < 8; ++round) {
+        // Connected: 40 frames, the peer acks each as it arrives.
+        for (int i = 0; i < 40; ++i, ++seq) {
+            const auto f = frame(seq);
+            RRL_CHECK_EQ(rrl_replay_push(r, seq, f.data(), f.size()), RRL_SUCCESS);
+            deliver(&peer, f.data(), f.size());
+            rrl_replay_ack(r, seq);
+        }
+        // Dropped: ten more are sent into the void, none acked.
+        rrl_replay_link(r, 0);
+        const uint32_t lost = seq;
+        for (int i = 0; i < 10; ++i, ++seq) {
+            const auto f = frame(seq);
+            RRL_CHECK_EQ(rrl_replay_push(r, seq, f.data(), f.size()), RRL_SUCCESS);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        // Back: the peer's RESUME names the last seq it has.
+        rrl_replay_link(r, 1);
+        const size_t before = peer.got.size();
+        RRL_CHECK_EQ(rrl_replay_resend(r, peer.last(), deliver, &peer), 10);
+        RRL_CHECK(received(peer, before, lost, seq - 1));
+        rrl_replay_ack(r, seq - 1);
+    }
+    RRL_CHECK(received(peer, 0, 0xFFFFFF00u, seq - 1));
+
+    RRL_StatsV2 s{};
+    s.struct_size = sizeof(s);
+    RRL_CHECK_EQ(rrl_get_stats_v2(h, &s), RRL_SUCCESS);
+    RRL_CHECK_EQ(s.reconnects, uint64_t(8));
+    RRL_CHECK(s.downtime_us >= 8000);
+
+    // Closed: the binding goes with it, the address is free again.
+    rrl_close(h);
+    s = RRL_StatsV2{};
+    s.struct_size = sizeof(s);
+    RRL_CHECK_EQ(rrl_get_stats_v2(h, &s), RRL_SUCCESS);
+    RRL_CHECK_EQ(s.reconnects, uint64_t(0));
+    RRLReplay other = rrl_replay_create(0);
+    RRL_CHECK_EQ(rrl_replay_bind(other, h), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_replay_bind(r, h), RRL_ERR_INVALID_HANDLE);
+    rrl_replay_destroy(other);
+    rrl_replay_destroy(r);
+}
+
+void full_and_failing()
+{
+    RRLReplay r = rrl_replay_create(256);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    const auto big = frame(63);   // 87 bytes: two fit, the third does not
+    RRL_CHECK_EQ(rrl_replay_push(r, 1, big.data(), big.size()), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_replay_push(r, 2, big.data(), big.size()), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_replay_push(r, 2, big.data(), big.size()), RRL_ERR_INVALID_ARGUMENT);   // not after 2
+    RRL_CHECK_EQ(rrl_replay_push(r, 3, big.data(), 300), RRL_ERR_INVALID_ARGUMENT);          // > capacity
+    RRL_CHECK_EQ(rrl_replay_push(r, 3, big.data(), big.size()), RRL_ERR_EXHAUSTED);
+    rrl_replay_ack(r, 1);
+    RRL_CHECK_EQ(rrl_replay_push(r, 3, big.data(), big.size()), RRL_SUCCESS);
+
+    // The send breaks after one frame: both stay for the next attempt.
+    Peer peer;
+    peer.fail_after = 1;
+    RRL_CHECK_EQ(rrl_replay_resend(r, 1, deliver, &peer), RRL_ERR_IO);
+    peer.fail_after = -1;
+    peer.got.clear();
+    RRL_CHECK_EQ(rrl_replay_resend(r, 1, deliver, &peer), 2);
+    // Rejected resume: nothing left to replay.
+    rrl_replay_reset(r);
+    RRL_CHECK_EQ(rrl_replay_resend(r, 1, deliver, &peer), 0);
+    rrl_replay_destroy(r);
+}
+
+// Resends, then keeps streaming from inside the callback.
+struct Streamer {
+    RRLReplay r;
+    Peer      peer;
+    uint32_t  next;
+};
+
+int stream_on(void* user, const void* f, size_t len)
+{
+    Streamer& s = *static_cast<Streamer*>(user);
+    deliver(&s.peer, f, len);
+    const auto more = frame(s.next);
+    const int rc = rrl_replay_push(s.r, s.next++, more.data(), more.size());
+    rrl_replay_ack(s.r, s.peer.last());
+    return rc;
+}
+
+void reentrant_send()
+{
+    Streamer s{rrl_replay_create(4096), Peer{}, 0};
+    RRL_CHECK(s.r != nullptr);
+    if (!s.r) return;
+    for (; s.next < 5; ++s.next) {
+        const auto f = frame(s.next);
+        rrl_replay_push(s.r, s.next, f.data(), f.size());
+    }
+    // Frames 1..4 are resent; each push adds one that is not.
+    RRL_CHECK_EQ(rrl_replay_resend(s.r, 0, stream_on, &s), 4);
+    RRL_CHECK(received(s.peer, 0, 1, 4));
+    RRL_CHECK_EQ(s.next, 9u);
+    Peer rest;
+    RRL_CHECK_EQ(rrl_replay_resend(s.r, 4, deliver, &rest), 4);
+    RRL_CHECK(received(rest, 0, 5, 8));
+    rrl_replay_destroy(s.r);
+}
+
+void tokens()
+{
+    RRLReplay r = rrl_replay_create(0);
+    RRL_CHECK(r != nullptr);
+    if (!r) return;
+    uint8_t a[RRL_RESUME_TOKEN], b[RRL_RESUME_TOKEN], got[RRL_RESUME_TOKEN];
+    std::memset(a, 0xAA, sizeof(a));
+    std::memset(b, 0x55, sizeof(b));
+    rrl_replay_set_token(r, a);
+    rrl_replay_token(r, got);
+    RRL_CHECK_EQ(std::memcmp(got, a, sizeof(a)), 0);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int i = 0; i < 20000; ++i) rrl_replay_set_token(r, i % 2 ? a : b);
+        done.store(true);
+    });
+    int torn = 0;
+    while (!done.load()) {
+        rrl_replay_token(r, got);
+        torn += std::memcmp(got, a, sizeof(a)) != 0 && std::memcmp(got, b, sizeof(b)) != 0;
+    }
+    writer.join();
+    RRL_CHECK_EQ(torn, 0);
+    rrl_replay_destroy(r);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    RRL_BackendHooksExt ext{};
+    ext.struct_size  = sizeof(ext);
+    ext.get_stats_v2 = stats;
+    RRL_CHECK_EQ(rrl_register_backend_ext(&ext), RRL_SUCCESS);
+
+    dropped_connection();
+    full_and_failing();
+    reentrant_send();
+    tokens();
+    return rrl_test::failures();
+}
@@ -0,0 +1,163 @@
+//─────────────────────────────────────────────────────────────
+//  test_runner.cpp  —  rrl::Runner pinning and work stealing
+//
+//  • rrl_allowed_cores() matches the process affinity mask, and a
+//    pinned Runner inside a narrowed mask (taskset style) pins every
+//    worker onto an allowed core.
+//  • A worker whose home envs are never ready steals from a busy
+//    one; no env is stepped twice at once or without being ready.
+//  • A failing rrl_poll_many() stops the workers and is rethrown by
+//    stop() instead of leaving them spinning.
+//─────────────────────────────────────────────────────────────
+#include "rrl_runner.hpp"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+uintptr_t index_of(RRLHandle h) { return (reinterpret_cast<uintptr_t>(h) - 0x1000) / 64; }
+
+// Even envs are always ready, odd ones never.
+int even_ready(RRLHandle h) { return index_of(h) % 2 == 0; }
+
+constexpr std::size_t kEnvs = 8;
+
+std::vector<RRLHandle> make_envs()
+{
+    std::vector<RRLHandle> envs;
+    for (std::size_t i = 0; i < kEnvs; ++i) envs.push_back(fake(i));
+    return envs;
+}
+
+#if defined(__linux__)
+void pinning()
+{
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    RRL_CHECK_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    const int n = rrl_allowed_cores(nullptr, 0);
+    RRL_CHECK_EQ(n, CPU_COUNT(&mask));
+    std::vector<unsigned> cores(static_cast<std::size_t>(n));
+    RRL_CHECK_EQ(rrl_allowed_cores(cores.data(), cores.size()), n);
+    for (unsigned c : cores) RRL_CHECK(CPU_ISSET(c, &mask));
+    unsigned first = 0;
+    RRL_CHECK_EQ(rrl_allowed_cores(&first, 1), n);   // short array: count still total
+    RRL_CHECK_EQ(first, cores.front());
+
+    // Narrow this thread to its last allowed core; workers inherit it.
+    const unsigned only = cores.back();
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    CPU_SET(only, &one);
+    RRL_CHECK_EQ(pthread_setaffinity_np(pthread_self(), sizeof(one), &one), 0);
+
+    std::atomic<int> steps{0}, off_core{0};
+    {
+        rrl::RunnerConfig cfg;
+        cfg.workers    = 2;
+        cfg.first_core = 1;   // an index into the allowed cores
+        rrl::Runner runner(make_envs(), [&](std::size_t) {
+            cpu_set_t got;
+            CPU_ZERO(&got);
+            pthread_getaffinity_np(pthread_self(), sizeof(got), &got);
+            if (CPU_COUNT(&got) != 1 || !CPU_ISSET(only, &got)) off_core.fetch_add(1);
+            steps.fetch_add(1);
+        }, cfg);
+        runner.start();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (steps.load() < 16 && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        runner.stop();
+    }
+    RRL_CHECK(steps.load() >= 16);
+    RRL_CHECK_EQ(off_core.load(), 0);
+
+    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+}
+#endif
+
+void stealing()
+{
+    std::atomic<int> in_step[kEnvs] = {}, overlap{0}, not_ready{0}, steps{0};
+    rrl::RunnerConfig cfg;
+    cfg.workers = 2;   // worker 0 homes the even envs, worker 1 the odd
+    cfg.pin     = false;
+    rrl::Runner runner(make_envs(), [&](std::size_t e) {
+        if (in_step[e].fetch_add(1) != 0) overlap.fetch_add(1);
+        if (e % 2) not_ready.fetch_add(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));   // slow step
+        in_step[e].fetch_sub(1);
+        steps.fetch_add(1);
+    }, cfg);
+    runner.start();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((runner.steals() < 4 || steps.load() < 64) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    runner.stop();
+
+    RRL_CHECK(runner.steals() >= 4);
+    RRL_CHECK_EQ(runner.steps(), uint64_t(steps.load()));
+    RRL_CHECK_EQ(overlap.load(), 0);
+    RRL_CHECK_EQ(not_ready.load(), 0);
+}
+
+int poll_many_fails(const RRLHandle*, size_t, uint64_t*, size_t*) { return RRL_ERR_IO; }
+
+void poll_error()
+{
+    RRL_BackendHooks hooks{};
+    hooks.poll = even_ready;
+    RRL_BackendHooksExt ext{};
+    ext.struct_size = sizeof(ext);
+    ext.poll_many   = poll_many_fails;
+    rrl_register_backends(&hooks, &ext);
+
+    std::atomic<int> steps{0};
+    rrl::RunnerConfig cfg;
+    cfg.workers = 2;
+    cfg.pin     = false;
+    rrl::Runner runner(make_envs(), [&](std::size_t) { steps.fetch_add(1); }, cfg);
+    runner.start();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (runner.running() && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    RRL_CHECK(!runner.running());
+    bool thrown = false;
+    try {
+        runner.stop();
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()).find("poll_many") != std::string::npos;
+    }
+    RRL_CHECK(thrown);
+    RRL_CHECK_EQ(steps.load(), 0);
+    rrl_register_backends(&hooks, nullptr);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    RRL_BackendHooks hooks{};
+    hooks.poll = even_ready;
+    rrl_register_backend(&hooks);
+
+#if defined(__linux__)
+    pinning();
+#endif
+    stealing();
+    poll_error();
+    return rrl_test::failures();
+}
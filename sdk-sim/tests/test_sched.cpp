@@ -0,0 +1,297 @@
+//─────────────────────────────────────────────────────────────
+//  test_sched.cpp  —  Decision-rate scheduler: sizing k, rewards, hold
+//
+//  • `fixed`: k = tick_hz / decision_hz, and the stats are never read.
+//  • Otherwise k widens to fit the reported RTT plus a quarter, within
+//    max_skip, and the stats are read once per decision, never per
+//    frame.
+//  • A trainer slower than k makes decision frames late: k grows by
+//    one per late interval and gives it back once actions return with
+//    frames to spare.  Failing stats are not asked again; the round
+//    trip the schedule sees stands in for them.
+//  • Against hand-computed values: the discounted reward sum, gamma^n
+//    and n of each interval; a done frame ending it at once, or as
+//    soon as the in-flight action lands.  LERP applies the first
+//    action at once and eases later ones in over `ramp` frames; it
+//    is refused for integer actions.
+//─────────────────────────────────────────────────────────────
+#include "rrl_sched.h"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+std::atomic<int>      g_ready{0};
+std::atomic<unsigned> g_stats_calls{0};
+double                g_latency_ms = 0;
+bool                  g_stats_fail = false;
+float                 g_act[4];
+
+int poll(RRLHandle) { return g_ready.load(); }
+
+int stats(RRLHandle, RRL_StatsV2* out)
+{
+    g_stats_calls.fetch_add(1);
+    if (g_stats_fail) return RRL_ERR_IO;
+    out->base.latency_ms = g_latency_ms;   // empty histogram: p90 falls back to it
+    return RRL_SUCCESS;
+}
+
+// A trainer that answers each decision `lag` frames later.
+struct Game {
+    RRLSched sched;
+    uint64_t tick = 0, due = 0;
+    bool     pending = false;
+    unsigned decisions = 0;
+
+    void frames(int n, uint64_t lag)
+    {
+        for (int i = 0; i < n; ++i) {
+            ++tick;
+            if (pending && tick >= due) {
+                g_act[0] = static_cast<float>(decisions);
+                g_ready.store(1);
+                pending = false;
+            }
+            float action[4];
+            RRL_SchedTick t;
+            const int rc = rrl_sched_tick(sched, 1.f, 0, action, &t);
+            RRL_CHECK(rc == RRL_SCHED_HOLD || rc == RRL_SCHED_DECIDE);
+            if (t.fresh) RRL_CHECK_EQ(action[0], static_cast<float>(decisions));
+            if (rc == RRL_SCHED_DECIDE) {
+                g_ready.store(0);
+                pending = true;
+                due = tick + lag;
+                ++decisions;
+            }
+        }
+    }
+};
+
+RRL_SchedConfig config(bool fixed, unsigned max_skip = 0)
+{
+    RRL_SchedConfig c{};
+    c.struct_size = sizeof(c);
+    c.act         = g_act;
+    c.tick_hz     = 60;
+    c.decision_hz = 20;
+    c.max_skip    = max_skip;
+    c.fixed       = fixed ? 1 : 0;
+    return c;
+}
+
+RRLSched make(bool fixed, unsigned max_skip = 0)
+{
+    const RRL_SchedConfig c = config(fixed, max_skip);
+    return rrl_sched_create(fake(1), &c);
+}
+
+RRL_SchedStats stats_of(RRLSched s)
+{
+    RRL_SchedStats st{};
+    RRL_CHECK_EQ(rrl_sched_stats(s, &st), RRL_SUCCESS);
+    return st;
+}
+
+void fixed_k()
+{
+    g_stats_calls.store(0);
+    g_latency_ms = 500;   // ignored
+    Game g{make(true)};
+    RRL_CHECK(g.sched != nullptr);
+    if (!g.sched) return;
+    g.frames(30, 1);
+    const RRL_SchedStats st = stats_of(g.sched);
+    RRL_CHECK_EQ(st.interval, 3u);
+    RRL_CHECK_EQ(st.decisions, uint64_t(10));   // ticks 1, 4, … 28
+    RRL_CHECK_EQ(st.late, uint64_t(0));
+    RRL_CHECK_EQ(g_stats_calls.load(), 0u);
+    rrl_sched_destroy(g.sched);
+}
+
+void rtt_sized_k()
+{
+    g_stats_calls.store(0);
+    g_latency_ms = 100;   // 1.25 · 0.1 s · 60 Hz = 7.5 frames
+    Game g{make(false)};
+    RRL_CHECK(g.sched != nullptr);
+    if (!g.sched) return;
+    g.frames(80, 1);
+    RRL_SchedStats st = stats_of(g.sched);
+    RRL_CHECK_EQ(st.interval, 8u);
+    RRL_CHECK_EQ(st.rtt_ms, 100.0);
+    RRL_CHECK_EQ(st.decisions, uint64_t(10));
+    RRL_CHECK_EQ(g_stats_calls.load(), 10u);   // per decision, not per frame
+
+    // Far more than max_skip: clamped.
+    g_latency_ms = 1000;
+    RRLSched capped = make(false, 16);
+    Game c{capped};
+    c.frames(40, 1);
+    RRL_CHECK_EQ(stats_of(capped).interval, 16u);
+    rrl_sched_destroy(capped);
+    rrl_sched_destroy(g.sched);
+}
+
+void late_actions()
+{
+    g_latency_ms = 0;   // nothing reported: sized by what the schedule sees
+    Game g{make(false)};
+    RRL_CHECK(g.sched != nullptr);
+    if (!g.sched) return;
+    g.frames(30, 1);
+    RRL_CHECK_EQ(stats_of(g.sched).interval, 3u);
+    RRL_CHECK_EQ(stats_of(g.sched).late, uint64_t(0));
+
+    // The trainer slows to 10 frames: late, and k widens past it.
+    g.frames(120, 10);
+    RRL_SchedStats st = stats_of(g.sched);
+    RRL_CHECK(st.late > 0);
+    RRL_CHECK(st.interval > 10u);
+
+    // Fast again: k comes back down.
+    g.frames(600, 1);
+    st = stats_of(g.sched);
+    RRL_CHECK(st.interval <= 4u);
+    rrl_sched_destroy(g.sched);
+}
+
+void failing_stats()
+{
+    g_stats_calls.store(0);
+    g_stats_fail = true;
+    Game g{make(false)};
+    RRL_CHECK(g.sched != nullptr);
+    if (!g.sched) return;
+    g.frames(60, 6);
+    const RRL_SchedStats st = stats_of(g.sched);
+    RRL_CHECK_EQ(g_stats_calls.load(), 1u);
+    RRL_CHECK_EQ(st.rtt_ms, 100.0);   // 6 frames at 60 Hz
+    RRL_CHECK(st.interval >= 7u);
+    g_stats_fail = false;
+    rrl_sched_destroy(g.sched);
+}
+
+void reward_sum_and_done()
+{
+    RRL_SchedConfig c = config(true);
+    c.gamma = 0.5f;
+    RRLSched s = rrl_sched_create(fake(1), &c);
+    RRL_CHECK(s != nullptr);
+    if (!s) return;
+    float a[4];
+    RRL_SchedTick t;
+    g_ready.store(1);   // every action back by the next frame
+
+    // The first frame decides at once.
+    RRL_CHECK_EQ(rrl_sched_tick(s, 1.f, 0, a, &t), RRL_SCHED_DECIDE);
+    RRL_CHECK_EQ(t.reward, 1.f);
+    RRL_CHECK_EQ(t.discount, 0.5f);
+    RRL_CHECK_EQ(t.frames, 1u);
+
+    // k = 3: 2 + 0.5·4 + 0.25·8, discount 0.5³.
+    RRL_CHECK_EQ(rrl_sched_tick(s, 2.f, 0, a, &t), RRL_SCHED_HOLD);
+    RRL_CHECK_EQ(t.fresh, 1);
+    RRL_CHECK_EQ(rrl_sched_tick(s, 4.f, 0, a, &t), RRL_SCHED_HOLD);
+    RRL_CHECK_EQ(rrl_sched_tick(s, 8.f, 0, a, &t), RRL_SCHED_DECIDE);
+    RRL_CHECK_EQ(t.reward, 6.f);
+    RRL_CHECK_EQ(t.discount, 0.125f);
+    RRL_CHECK_EQ(t.frames, 3u);
+    RRL_CHECK_EQ(t.done, 0);
+
+    // A done frame with the action in closes the interval early.
+    RRL_CHECK_EQ(rrl_sched_tick(s, 3.f, 1, a, &t), RRL_SCHED_DECIDE);
+    RRL_CHECK_EQ(t.reward, 3.f);
+    RRL_CHECK_EQ(t.frames, 1u);
+    RRL_CHECK_EQ(t.done, 1);
+
+    // With it in flight, the done frame is held until it lands.
+    g_ready.store(0);
+    RRL_CHECK_EQ(rrl_sched_tick(s, 2.f, 1, a, &t), RRL_SCHED_HOLD);
+    RRL_CHECK_EQ(stats_of(s).late, uint64_t(1));
+    g_ready.store(1);
+    RRL_CHECK_EQ(rrl_sched_tick(s, 0.f, 1, a, &t), RRL_SCHED_DECIDE);
+    RRL_CHECK_EQ(t.fresh, 1);
+    RRL_CHECK_EQ(t.reward, 2.f);
+    RRL_CHECK_EQ(t.discount, 0.25f);
+    RRL_CHECK_EQ(t.frames, 2u);
+    RRL_CHECK_EQ(t.done, 1);
+    g_ready.store(0);
+    rrl_sched_destroy(s);
+}
+
+void lerp()
+{
+    RRL_SchedConfig c = config(true);
+    c.hold = RRL_SCHED_LERP;
+    c.ramp = 4;
+    RRLSched s = rrl_sched_create(fake(1), &c);
+    RRL_CHECK(s != nullptr);
+    if (!s) return;
+    float a[4];
+    RRL_SchedTick t;
+    const float first[4] = {4, 8, 0, 0}, second[4] = {8, 0, 0, 0};
+
+    RRL_CHECK_EQ(rrl_sched_tick(s, 0.f, 0, a, &t), RRL_SCHED_DECIDE);
+    RRL_CHECK_EQ(a[0], 0.f);   // zeros until an action arrives
+    std::memcpy(g_act, first, sizeof(first));
+    g_ready.store(1);
+
+    // The first action is applied at once: nothing to ease from.
+    RRL_CHECK_EQ(rrl_sched_tick(s, 0.f, 0, a, &t), RRL_SCHED_HOLD);
+    RRL_CHECK_EQ(t.fresh, 1);
+    RRL_CHECK(std::memcmp(a, first, sizeof(a)) == 0);
+    RRL_CHECK_EQ(rrl_sched_tick(s, 0.f, 0, a, &t), RRL_SCHED_HOLD);
+    RRL_CHECK_EQ(rrl_sched_tick(s, 0.f, 0, a, &t), RRL_SCHED_DECIDE);
+    RRL_CHECK(std::memcmp(a, first, sizeof(a)) == 0);
+
+    // The next one eases in over `ramp` = 4 frames, then holds.
+    std::memcpy(g_act, second, sizeof(second));
+    const float want[5][2] = {{5, 6}, {6, 4}, {7, 2}, {8, 0}, {8, 0}};
+    for (int i = 0; i < 5; ++i) {
+        rrl_sched_tick(s, 0.f, 0, a, &t);
+        g_ready.store(0);   // no further action during the ramp
+        RRL_CHECK_EQ(a[0], want[i][0]);
+        RRL_CHECK_EQ(a[1], want[i][1]);
+    }
+    rrl_sched_destroy(s);
+}
+
+void lerp_refusal()
+{
+    // Integer actions cannot be eased; repeating them is fine.
+    RRL_SchedConfig c = config(true);
+    c.hold = RRL_SCHED_LERP;
+    RRL_CHECK(rrl_sched_create(reinterpret_cast<RRLHandle>(rrl_test::kIntActions), &c) == nullptr);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_ARGUMENT);
+    c.hold = RRL_SCHED_REPEAT;
+    RRLSched s = rrl_sched_create(reinterpret_cast<RRLHandle>(rrl_test::kIntActions), &c);
+    RRL_CHECK(s != nullptr);
+    rrl_sched_destroy(s);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    RRL_BackendHooks base{};
+    base.poll = poll;
+    RRL_BackendHooksExt ext{};
+    ext.struct_size  = sizeof(ext);
+    ext.get_stats_v2 = stats;
+    RRL_CHECK_EQ(rrl_register_backends(&base, &ext), RRL_SUCCESS);
+
+    fixed_k();
+    rtt_sized_k();
+    late_actions();
+    failing_stats();
+    reward_sum_and_done();
+    lerp();
+    lerp_refusal();
+    return rrl_test::failures();
+}
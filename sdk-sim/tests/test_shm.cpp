@@ -0,0 +1,193 @@
+//─────────────────────────────────────────────────────────────
+//  test_shm.cpp  —  Shared‑memory rings: wraparound, wake‑ups, echo
+//
+//  • Frames of uneven sizes go round a 4 KiB ring many times (SKIP
+//    records at the end) and come out byte‑exact and 16‑aligned.
+//  • A full ring refuses with RRL_ERR_TIMEOUT; a writer blocked on it
+//    wakes once the reader releases, a reader blocked on an empty one
+//    once the writer commits.
+//  • Echo: a trainer thread sends every UP frame back on DOWN, over
+//    two channels, 20000 round trips.
+//  • A second trainer is refused; closing the trainer is seen by the
+//    simulator.  Skipped where the host has no POSIX shared memory.
+//─────────────────────────────────────────────────────────────
+#include "rrl_shm.h"
+#include "rrl_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int64_t kLong = 5000000;   // µs: a missed wake‑up fails instead of hanging
+
+// Frame k: 1…1500 bytes, k first, then a pattern.
+std::vector<unsigned char> frame(uint32_t k)
+{
+    std::vector<unsigned char> f(1 + (k * 379) % 1500);
+    for (size_t i = 0; i < f.size(); ++i) f[i] = static_cast<unsigned char>(k * 13 + i);
+    if (f.size() >= 4) std::memcpy(f.data(), &k, 4);
+    return f;
+}
+
+bool same(const void* p, size_t len, const std::vector<unsigned char>& f)
+{
+    return len == f.size() && std::memcmp(p, f.data(), len) == 0;
+}
+
+void wraparound(RRLShm sim, RRLShm trainer)
+{
+    int wrong = 0;
+    for (uint32_t k = 0; k < 2000; ++k) {
+        const auto f = frame(k);
+        if (k % 2) {
+            if (rrl_shm_write(sim, 0, f.data(), f.size(), 0) != RRL_SUCCESS) ++wrong;
+        } else {   // in place
+            void* dst = rrl_shm_reserve(sim, 0, 1500, 0);
+            if (!dst) { ++wrong; continue; }
+            std::memcpy(dst, f.data(), f.size());
+            if (rrl_shm_commit(sim, 0, f.size()) != RRL_SUCCESS) ++wrong;
+        }
+        const void* p;
+        size_t len;
+        if (rrl_shm_read(trainer, 0, &p, &len, 0) != RRL_SUCCESS) { ++wrong; continue; }
+        wrong += !same(p, len, f) || reinterpret_cast<uintptr_t>(p) % 16 != 0;
+        rrl_shm_release(trainer, 0);
+    }
+    RRL_CHECK_EQ(wrong, 0);
+
+    // Refusals.
+    const void* p;
+    size_t len;
+    RRL_CHECK_EQ(rrl_shm_read(trainer, 0, &p, &len, 0), RRL_ERR_TIMEOUT);
+    RRL_CHECK_EQ(rrl_shm_release(trainer, 0), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK(rrl_shm_reserve(sim, 0, 4096, 0) == nullptr);   // over half the ring
+    RRL_CHECK(rrl_shm_reserve(sim, 2, 16, 0) == nullptr);     // no such channel
+}
+
+void wakeups(RRLShm sim, RRLShm trainer)
+{
+    // Fill channel 1's UP ring.
+    const auto f = frame(7);   // 1154 bytes: three fit in 4 KiB
+    int queued = 0;
+    while (rrl_shm_write(sim, 1, f.data(), f.size(), 0) == RRL_SUCCESS) ++queued;
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_TIMEOUT);
+    RRL_CHECK_EQ(queued, 3);
+
+    // Writer sleeps on the full ring until the reader frees a slot.
+    std::atomic<int> rc{1};
+    Clock::time_point woke{};
+    std::thread writer([&] {
+        rc.store(rrl_shm_write(sim, 1, f.data(), f.size(), kLong));
+        woke = Clock::now();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    RRL_CHECK_EQ(rc.load(), 1);   // still waiting
+    const Clock::time_point freed = Clock::now();
+    const void* p;
+    size_t len;
+    RRL_CHECK_EQ(rrl_shm_read(trainer, 1, &p, &len, 0), RRL_SUCCESS);
+    rrl_shm_release(trainer, 1);
+    writer.join();
+    RRL_CHECK_EQ(rc.load(), RRL_SUCCESS);
+    RRL_CHECK(woke - freed < std::chrono::seconds(1));
+    for (int i = 0; i < queued; ++i) {
+        RRL_CHECK_EQ(rrl_shm_read(trainer, 1, &p, &len, 0), RRL_SUCCESS);
+        RRL_CHECK(same(p, len, f));
+        rrl_shm_release(trainer, 1);
+    }
+
+    // Reader sleeps on the empty ring until the writer commits.
+    rc.store(1);
+    std::thread reader([&] {
+        const void* q;
+        size_t n;
+        int r = rrl_shm_read(trainer, 1, &q, &n, kLong);
+        if (r == RRL_SUCCESS && !same(q, n, f)) r = RRL_ERR_IO;
+        if (r == RRL_SUCCESS) rrl_shm_release(trainer, 1);
+        woke = Clock::now();
+        rc.store(r);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    RRL_CHECK_EQ(rc.load(), 1);
+    const Clock::time_point sent = Clock::now();
+    RRL_CHECK_EQ(rrl_shm_write(sim, 1, f.data(), f.size(), 0), RRL_SUCCESS);
+    reader.join();
+    RRL_CHECK_EQ(rc.load(), RRL_SUCCESS);
+    RRL_CHECK(woke - sent < std::chrono::seconds(1));
+}
+
+void echo(RRLShm sim, RRLShm trainer)
+{
+    constexpr uint32_t kRounds = 10000;   // per channel
+    std::atomic<int> trainer_wrong{0};
+    std::thread t([&] {
+        for (uint32_t k = 0; k < 2 * kRounds; ++k) {
+            const uint32_t ch = k % 2;
+            const void* p;
+            size_t len;
+            if (rrl_shm_read(trainer, ch, &p, &len, kLong) != RRL_SUCCESS) { trainer_wrong.fetch_add(1); return; }
+            const std::vector<unsigned char> copy(static_cast<const unsigned char*>(p),
+                                                  static_cast<const unsigned char*>(p) + len);
+            rrl_shm_release(trainer, ch);
+            if (rrl_shm_write(trainer, ch, copy.data(), copy.size(), kLong) != RRL_SUCCESS) trainer_wrong.fetch_add(1);
+        }
+    });
+    int wrong = 0;
+    for (uint32_t k = 0; k < 2 * kRounds && !trainer_wrong.load(); ++k) {
+        const uint32_t ch = k % 2;
+        const auto f = frame(k);
+        if (rrl_shm_write(sim, ch, f.data(), f.size(), kLong) != RRL_SUCCESS) { ++wrong; break; }
+        const void* p;
+        size_t len;
+        if (rrl_shm_read(sim, ch, &p, &len, kLong) != RRL_SUCCESS) { ++wrong; break; }
+        wrong += !same(p, len, f);
+        rrl_shm_release(sim, ch);
+    }
+    t.join();
+    RRL_CHECK_EQ(wrong, 0);
+    RRL_CHECK_EQ(trainer_wrong.load(), 0);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    char name[96];
+    if (rrl_shm_name("test_shm", 0, name, sizeof(name)) != RRL_SUCCESS) {
+        std::printf("test_shm: no POSIX shared memory, skipped\n");
+        return rrl_test::failures();
+    }
+    RRLShm sim = rrl_shm_create(name, 2, 4096);
+    if (!sim) {
+        std::printf("test_shm: cannot create %s, skipped\n", name);
+        return rrl_test::failures();
+    }
+    RRL_CHECK_EQ(rrl_shm_channels(sim), uint32_t(2));
+    RRL_CHECK_EQ(rrl_shm_peer_alive(sim), 0);
+    RRLShm trainer = rrl_shm_attach(name);
+    RRL_CHECK(trainer != nullptr);
+    if (trainer) {
+        RRL_CHECK(rrl_shm_attach(name) == nullptr);
+        RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_EXHAUSTED);
+        RRL_CHECK_EQ(rrl_shm_peer_alive(sim), 1);
+        RRL_CHECK_EQ(rrl_shm_peer_alive(trainer), 1);
+
+        wraparound(sim, trainer);
+        wakeups(sim, trainer);
+        echo(sim, trainer);
+
+        rrl_shm_close(trainer);
+        RRL_CHECK_EQ(rrl_shm_peer_alive(sim), 0);
+    }
+    rrl_shm_close(sim);
+    RRL_CHECK(rrl_shm_attach(name) == nullptr);   // unlinked
+    return rrl_test::failures();
+}
@@ -0,0 +1,83 @@
+//─────────────────────────────────────────────────────────────
+//  test_static.cpp  —  Exports generated by RRL_DEFINE_BACKEND
+//
+//  • Engine has poll and load_policy but no get_stats or
+//    poll_many: the generated exports add the SDK's argument checks
+//    and last_error reporting, loop poll_many over poll and report
+//    the missing hook as RRL_ERR_UNSUPPORTED.
+//  • A registered backend table is bypassed for all of them.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_env.hpp"
+#include "rrl_test.hpp"
+
+#include <cstdint>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+size_t g_loaded = 0;
+
+// Odd handles are ready; handle 5 is broken.
+struct Engine {
+    static int poll(RRLHandle h)
+    {
+        const uintptr_t i = (reinterpret_cast<uintptr_t>(h) - 0x1000) / 64;
+        return i == 5 ? RRL_ERR_IO : static_cast<int>(i % 2);
+    }
+    static int load_policy(RRLHandle, const void*, std::size_t len)
+    {
+        g_loaded = len;
+        return RRL_SUCCESS;
+    }
+};
+
+int table_poll(RRLHandle) { return 1; }
+
+} // namespace (anonymous)
+
+RRL_DEFINE_BACKEND(Engine);
+
+int main()
+{
+    RRL_BackendHooks hooks{};
+    hooks.poll = table_poll;
+    rrl_register_backend(&hooks);
+
+    RRL_CHECK_EQ(rrl_poll(fake(1)), 1);
+    RRL_CHECK_EQ(rrl_poll(fake(2)), 0);
+    RRL_CHECK_EQ(rrl_poll(nullptr), 0);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_HANDLE);
+    RRL_CHECK_EQ(rrl_poll(fake(5)), 0);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_IO);
+
+    // poll_many: per-handle poll, failures count as not ready.
+    RRLHandle hs[8];
+    for (uintptr_t i = 0; i < 8; ++i) hs[i] = fake(i);
+    hs[3] = nullptr;
+    uint64_t mask = ~uint64_t(0);
+    size_t idx[8] = {};
+    rrl_set_last_error(RRL_SUCCESS, nullptr);
+    RRL_CHECK_EQ(rrl_poll_many(hs, 8, &mask, idx), 2);   // 1 and 7; 3 null, 5 broken
+    RRL_CHECK_EQ(mask, 0x82ull);
+    RRL_CHECK_EQ(idx[0], size_t(1));
+    RRL_CHECK_EQ(idx[1], size_t(7));
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_HANDLE);
+    RRL_CHECK_EQ(rrl_poll_many(nullptr, 1, nullptr, nullptr), RRL_ERR_INVALID_ARGUMENT);
+
+    // Missing get_stats hook.
+    RRL_Stats st{60.0, 1.0, 9};
+    RRL_CHECK_EQ(rrl_get_stats(fake(1), &st), RRL_ERR_UNSUPPORTED);
+    RRL_CHECK_EQ(st.steps, 0ul);
+    RRL_CHECK_EQ(rrl_get_stats(fake(1), nullptr), RRL_ERR_INVALID_ARGUMENT);
+
+    const unsigned char blob[12] = {};
+    RRL_CHECK_EQ(rrl_load_policy(fake(1), blob, sizeof(blob)), RRL_SUCCESS);
+    RRL_CHECK_EQ(g_loaded, sizeof(blob));
+    RRL_CHECK_EQ(rrl_load_policy(fake(1), blob, 0), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK_EQ(rrl_load_policy(nullptr, blob, sizeof(blob)), RRL_ERR_INVALID_HANDLE);
+
+    rrl_register_backend(nullptr);
+    return rrl_test::failures();
+}
@@ -0,0 +1,258 @@
+//─────────────────────────────────────────────────────────────
+//  test_trace.cpp  —  Trace hooks and the built‑in ring tracer
+//
+//  • Hooks see the SDK's own spans with their handle and steady‑clock
+//    times, not the spans of SDK calls made from inside the hook, and
+//    nothing once removed.
+//  • The ring keeps the newest spans_per_thread spans of each thread,
+//    forgets everything on restart, and a stopped tracer hands out 0.
+//  • Chrome JSON has one complete event per span and a thread_name per
+//    thread; Perfetto slices nest and every begin has its end.
+//  Builds with RRL_ENABLE_TRACING=OFF only check the refusals.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_env.hpp"
+#include "rrl_test.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+const char* const kFile = "rrl_test_trace.out";   // in ctest's working directory
+
+uint64_t now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::string slurp(const char* path)
+{
+    std::string s;
+    if (std::FILE* f = std::fopen(path, "rb")) {
+        char buf[4096];
+        size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) s.append(buf, n);
+        std::fclose(f);
+    }
+    return s;
+}
+
+size_t count(const std::string& s, const std::string& what)
+{
+    size_t n = 0;
+    for (size_t at = s.find(what); at != std::string::npos; at = s.find(what, at + 1)) ++n;
+    return n;
+}
+
+std::string hex(RRLHandle h)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "\"0x%llx\"",
+                  static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(h)));
+    return buf;
+}
+
+//──── Hooks ────────────────────────────────────────────────//
+struct Seen {
+    int       kind;
+    RRLHandle handle;
+    uint64_t  begin, end;
+};
+
+std::vector<Seen> g_seen;
+bool              g_reenter = false;
+
+void on_span(void*, int kind, RRLHandle handle, uint64_t begin, uint64_t end)
+{
+    g_seen.push_back(Seen{kind, handle, begin, end});
+    if (g_reenter) rrl_poll(fake(99));   // not reported
+}
+
+void hooks()
+{
+    RRL_TraceHooks bad{};
+    RRL_CHECK_EQ(rrl_register_trace_hooks(&bad), RRL_ERR_INVALID_ARGUMENT);
+
+    RRL_TraceHooks h{};
+    h.struct_size = sizeof(h);
+    h.span        = on_span;
+    RRL_CHECK_EQ(rrl_register_trace_hooks(&h), RRL_SUCCESS);
+
+    const uint64_t t0 = now_ns();
+    rrl_poll(fake(1));
+    const uint64_t t1 = now_ns();
+    RRL_CHECK_EQ(g_seen.size(), size_t(1));
+    if (g_seen.size() == 1) {
+        const Seen& s = g_seen[0];
+        RRL_CHECK_EQ(s.kind, int(RRL_SPAN_POLL));
+        RRL_CHECK(s.handle == fake(1));
+        RRL_CHECK(s.begin <= s.end);
+        // Converted from ticks: allow the calibration some slack.
+        RRL_CHECK(s.begin + 1000000 >= t0 && s.end <= t1 + 1000000);
+    }
+
+    g_seen.clear();
+    g_reenter = true;
+    rrl_poll(fake(2));
+    g_reenter = false;
+    RRL_CHECK_EQ(g_seen.size(), size_t(1));
+
+    const uint64_t t = rrl_trace_begin();
+    RRL_CHECK(t != 0);
+    rrl_trace_end(RRL_SPAN_SEND, fake(3), t);
+    rrl_trace_end(RRL_SPAN_KINDS, fake(3), t);   // unknown kind: ignored
+    RRL_CHECK_EQ(g_seen.size(), size_t(2));
+    RRL_CHECK(g_seen.size() == 2 && g_seen[1].kind == RRL_SPAN_SEND && g_seen[1].handle == fake(3));
+
+    RRL_CHECK_EQ(rrl_register_trace_hooks(nullptr), RRL_SUCCESS);
+    g_seen.clear();
+    rrl_poll(fake(1));
+    RRL_CHECK(g_seen.empty());
+    RRL_CHECK_EQ(rrl_trace_begin(), uint64_t(0));   // nothing tracing
+}
+
+//──── Ring and Chrome JSON ─────────────────────────────────//
+void ring()
+{
+    RRL_CHECK_EQ(rrl_trace_start(0), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK_EQ(rrl_trace_write(kFile, 7), RRL_ERR_INVALID_ARGUMENT);
+
+    // 3 rounds up to 4; the slot the owner writes next is not trusted
+    // by a write, so the newest three of ten come out.
+    RRL_CHECK_EQ(rrl_trace_start(3), RRL_SUCCESS);
+    for (uintptr_t i = 0; i < 10; ++i) rrl_trace_end(RRL_SPAN_RECV, fake(i), rrl_trace_begin());
+
+    // Three more threads, alive until the write so their rings are not reused.
+    std::atomic<int> recorded{0};
+    std::atomic<bool> written{false};
+    std::vector<std::thread> ts;
+    for (uintptr_t t = 0; t < 3; ++t)
+        ts.emplace_back([&, t] {
+            rrl_trace_end(RRL_SPAN_CALLBACK, fake(100 + t), rrl_trace_begin());
+            recorded.fetch_add(1);
+            while (!written.load()) std::this_thread::yield();
+        });
+    while (recorded.load() < 3) std::this_thread::yield();
+
+    RRL_CHECK_EQ(rrl_trace_write(kFile, RRL_TRACE_CHROME_JSON), RRL_SUCCESS);
+    written.store(true);
+    for (auto& t : ts) t.join();
+
+    const std::string json = slurp(kFile);
+    RRL_CHECK_EQ(count(json, "\"ph\":\"X\""), size_t(6));
+    RRL_CHECK_EQ(count(json, "\"thread_name\""), size_t(4));
+    RRL_CHECK_EQ(count(json, "\"name\":\"recv\""), size_t(3));
+    RRL_CHECK_EQ(count(json, "\"name\":\"callback\""), size_t(3));
+    for (uintptr_t i = 0; i < 10; ++i) RRL_CHECK_EQ(count(json, hex(fake(i))), size_t(i >= 7));
+    for (uintptr_t t = 0; t < 3; ++t) RRL_CHECK_EQ(count(json, hex(fake(100 + t))), size_t(1));
+
+    // Restart drops what was there; stop hands out 0 again.
+    RRL_CHECK_EQ(rrl_trace_start(3), RRL_SUCCESS);
+    RRL_CHECK_EQ(rrl_trace_write(kFile, RRL_TRACE_CHROME_JSON), RRL_SUCCESS);
+    RRL_CHECK_EQ(count(slurp(kFile), "\"ph\":\"X\""), size_t(0));
+    rrl_trace_stop();
+    RRL_CHECK_EQ(rrl_trace_begin(), uint64_t(0));
+}
+
+//──── Perfetto ─────────────────────────────────────────────//
+struct Field {
+    unsigned    num, wire;
+    uint64_t    value;    // varint
+    const char* data;     // length‑delimited
+};
+
+bool varint(const char*& p, const char* end, uint64_t& v)
+{
+    v = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        const auto b = static_cast<unsigned char>(*p++);
+        v |= uint64_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// Fields of one message (varint and length‑delimited only, as written).
+bool fields(const char* p, const char* end, std::vector<Field>& out)
+{
+    out.clear();
+    while (p < end) {
+        uint64_t key, v;
+        if (!varint(p, end, key) || !varint(p, end, v)) return false;
+        Field f{static_cast<unsigned>(key >> 3), static_cast<unsigned>(key & 7), v, nullptr};
+        if (f.wire == 2) {
+            if (v > uint64_t(end - p)) return false;
+            f.data = p;
+            p += v;
+        } else if (f.wire != 0) {
+            return false;
+        }
+        out.push_back(f);
+    }
+    return true;
+}
+
+void perfetto()
+{
+    RRL_CHECK_EQ(rrl_trace_start(64), RRL_SUCCESS);
+    {
+        rrl::TraceSpan outer(RRL_SPAN_CALLBACK, fake(1));
+        rrl_poll(fake(1));
+        rrl_poll(fake(2));
+    }
+    rrl_trace_stop();
+    RRL_CHECK_EQ(rrl_trace_write(kFile, RRL_TRACE_PERFETTO), RRL_SUCCESS);
+    const std::string pb = slurp(kFile);
+
+    // Trace{1: TracePacket{11: TrackEvent{9: type, 23: name}}}
+    std::vector<Field> top, pkt, te;
+    RRL_CHECK(fields(pb.data(), pb.data() + pb.size(), top));
+    std::vector<std::string> names;
+    int depth = 0, max_depth = 0, begins = 0;
+    bool ok = true;
+    for (const Field& t : top) {
+        if (t.num != 1 || !t.data || !fields(t.data, t.data + t.value, pkt)) { ok = false; continue; }
+        for (const Field& p : pkt) {
+            if (p.num != 11) continue;
+            if (!fields(p.data, p.data + p.value, te)) { ok = false; continue; }
+            for (const Field& e : te) {
+                if (e.num == 9 && e.value == 1) ++begins, max_depth = std::max(max_depth, ++depth);
+                if (e.num == 9 && e.value == 2 && --depth < 0) ok = false;
+                if (e.num == 23) names.emplace_back(e.data, e.value);
+            }
+        }
+    }
+    RRL_CHECK(ok);
+    RRL_CHECK_EQ(depth, 0);
+    RRL_CHECK_EQ(begins, 3);
+    RRL_CHECK_EQ(max_depth, 2);
+    RRL_CHECK(names.size() == 3 && names[0] == "callback" && names[1] == "poll" && names[2] == "poll");
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    if (rrl_trace_start(16) == RRL_ERR_UNSUPPORTED) {
+        RRL_CHECK_EQ(rrl_register_trace_hooks(nullptr), RRL_ERR_UNSUPPORTED);
+        RRL_CHECK_EQ(rrl_trace_begin(), uint64_t(0));
+        std::printf("test_trace: built with RRL_ENABLE_TRACING=OFF, spans skipped\n");
+        return rrl_test::failures();
+    }
+    rrl_trace_stop();
+    hooks();
+    ring();
+    perfetto();
+    std::remove(kFile);
+    return rrl_test::failures();
+}
@@ -0,0 +1,162 @@
+//─────────────────────────────────────────────────────────────
+//  test_vec.cpp  —  rrl_vec_step through a vec_step hook
+//
+//  • The hook gets the vec's sub-envs in order, the caller's timeout
+//    and the same RRL_VecBuffers rrl_vec_buffers() reports: one
+//    aligned block of obs | actions | rewards | dones, 64-byte
+//    strides, stable across steps.  No sub-env is bound.
+//  • What the caller wrote (obs, rewards, dones) reaches the hook;
+//    the actions it writes are what the caller reads back.
+//  • A failing hook's code is returned and recorded.  The per-handle
+//    fallback is covered by test_override.
+//─────────────────────────────────────────────────────────────
+#include "rrl_env.h"
+#include "rrl_test.hpp"
+
+#include <cstdint>
+
+namespace {
+
+constexpr size_t kEnvs = 3;
+
+RRLHandle fake(uintptr_t i) { return reinterpret_cast<RRLHandle>(0x1000 + i * 64); }
+
+struct Seen {
+    unsigned              calls = 0;
+    RRLHandle             envs[kEnvs] = {};
+    size_t                k = 0;
+    const RRL_VecBuffers* bufs = nullptr;
+    int64_t               timeout_us = 0;
+    int                   wrong = 0;   // inputs not as the caller wrote them
+} g_seen;
+
+int      g_rc    = RRL_SUCCESS;
+unsigned g_binds = 0;
+
+float* at(void* base, size_t stride, size_t i)
+{
+    return reinterpret_cast<float*>(static_cast<unsigned char*>(base) + i * stride);
+}
+
+// action[i] = {obs[i][0] + reward[i], done[i], i, obs[i][15]}
+int vec_step(const RRLHandle* envs, size_t k, const RRL_VecBuffers* b, int64_t timeout_us)
+{
+    ++g_seen.calls;
+    g_seen.k = k;
+    g_seen.bufs = b;
+    g_seen.timeout_us = timeout_us;
+    for (size_t i = 0; i < k && i < kEnvs; ++i) g_seen.envs[i] = envs[i];
+    if (g_rc != RRL_SUCCESS) return g_rc;
+    for (size_t i = 0; i < k; ++i) {
+        const float* obs = at(b->obs, b->obs_stride, i);
+        g_seen.wrong += obs[1] != float(10 * i + 1);
+        float* act = at(b->actions, b->action_stride, i);
+        act[0] = obs[0] + b->rewards[i];
+        act[1] = float(b->dones[i]);
+        act[2] = float(i);
+        act[3] = obs[15];
+    }
+    return RRL_SUCCESS;
+}
+
+int bind(RRLHandle, void*, size_t, void*, size_t)
+{
+    ++g_binds;
+    return RRL_SUCCESS;
+}
+
+bool aligned(const void* p)
+{
+    return reinterpret_cast<uintptr_t>(p) % RRL_BUFFER_ALIGN == 0;
+}
+
+void layout(RRLVecHandle vec)
+{
+    RRL_VecBuffers b{};
+    RRL_CHECK_EQ(rrl_vec_buffers(vec, &b), RRL_SUCCESS);
+    RRL_CHECK_EQ(b.num_envs, kEnvs);
+    RRL_CHECK_EQ(b.obs_bytes, size_t(64));      // float32[16]
+    RRL_CHECK_EQ(b.obs_stride, size_t(64));
+    RRL_CHECK_EQ(b.action_bytes, size_t(16));   // float32[4]
+    RRL_CHECK_EQ(b.action_stride, size_t(64));
+    RRL_CHECK(aligned(b.obs) && aligned(b.actions) && aligned(b.rewards) && aligned(b.dones));
+    auto* base = static_cast<unsigned char*>(b.obs);
+    RRL_CHECK(b.actions == base + kEnvs * 64);
+    RRL_CHECK(reinterpret_cast<unsigned char*>(b.rewards) == base + 2 * kEnvs * 64);
+    RRL_CHECK(b.dones == base + 2 * kEnvs * 64 + 64);
+}
+
+void step(RRLVecHandle vec, const RRLHandle* envs)
+{
+    RRL_VecBuffers b{};
+    rrl_vec_buffers(vec, &b);
+    for (int round = 0; round < 3; ++round) {
+        for (size_t i = 0; i < kEnvs; ++i) {
+            float* obs = at(b.obs, b.obs_stride, i);
+            obs[0]  = float(100 * round + int(i));
+            obs[1]  = float(10 * i + 1);
+            obs[15] = -float(i);
+            b.rewards[i] = 0.5f * float(round);
+            b.dones[i]   = uint8_t(i == 1);
+        }
+        const unsigned before = g_seen.calls;
+        RRL_CHECK_EQ(rrl_vec_step(vec, 2500 + round), RRL_SUCCESS);
+        RRL_CHECK_EQ(g_seen.calls, before + 1);
+        RRL_CHECK_EQ(g_seen.k, kEnvs);
+        RRL_CHECK_EQ(g_seen.timeout_us, int64_t(2500 + round));
+        RRL_CHECK(g_seen.bufs != nullptr);
+        if (!g_seen.bufs) return;
+        // The vec's own buffers, not a copy.
+        RRL_CHECK(g_seen.bufs->obs == b.obs && g_seen.bufs->actions == b.actions);
+        RRL_CHECK(g_seen.bufs->rewards == b.rewards && g_seen.bufs->dones == b.dones);
+        RRL_CHECK_EQ(g_seen.bufs->obs_stride, b.obs_stride);
+        RRL_CHECK_EQ(g_seen.bufs->action_stride, b.action_stride);
+        for (size_t i = 0; i < kEnvs; ++i) {
+            RRL_CHECK(g_seen.envs[i] == envs[i]);
+            const float* act = at(b.actions, b.action_stride, i);
+            RRL_CHECK_EQ(act[0], float(100 * round + int(i)) + 0.5f * float(round));
+            RRL_CHECK_EQ(act[1], float(i == 1));
+            RRL_CHECK_EQ(act[2], float(i));
+            RRL_CHECK_EQ(act[3], -float(i));
+        }
+    }
+    RRL_CHECK_EQ(g_seen.wrong, 0);
+}
+
+void hook_errors(RRLVecHandle vec)
+{
+    g_rc = RRL_ERR_TIMEOUT;
+    RRL_CHECK_EQ(rrl_vec_step(vec, 0), RRL_ERR_TIMEOUT);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_TIMEOUT);
+    g_rc = RRL_ERR_IO;
+    RRL_CHECK_EQ(rrl_vec_step(vec, 0), RRL_ERR_IO);
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_IO);
+    g_rc = RRL_SUCCESS;
+    RRL_CHECK_EQ(rrl_vec_step(vec, 0), RRL_SUCCESS);
+}
+
+} // namespace (anonymous)
+
+int main()
+{
+    RRL_BackendHooks base{};
+    RRL_BackendHooksExt ext{};
+    ext.struct_size  = sizeof(ext);
+    ext.vec_step     = vec_step;
+    ext.bind_buffers = bind;
+    RRL_CHECK_EQ(rrl_register_backends(&base, &ext), RRL_SUCCESS);
+
+    const RRLHandle envs[kEnvs] = {fake(2), fake(0), fake(5)};
+    RRLVecHandle vec = rrl_vec_create(envs, kEnvs);
+    RRL_CHECK(vec != nullptr);
+    if (vec) {
+        RRL_CHECK_EQ(g_binds, 0u);
+        layout(vec);
+        step(vec, envs);
+        hook_errors(vec);
+        rrl_vec_destroy(vec);
+    }
+    RRL_CHECK_EQ(g_binds, 0u);
+    rrl_register_backends(nullptr, nullptr);
+    return rrl_test::failures();
+}
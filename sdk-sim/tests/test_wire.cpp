@@ -0,0 +1,125 @@
+//─────────────────────────────────────────────────────────────
+//  test_wire.cpp  —  STEP / ACTION frame round trips
+//
+//  • Encodes strided observations with rrl_wire_write_step and
+//    checks rrl_wire_parse gives back the same header, rewards,
+//    dones and dense tensors; same for ACTION frames and for the
+//    plain (COMP_NONE) codec.
+//  • Bad sizes fail instead of writing: short buffers, wrong frame
+//    lengths and counts whose layout overflows.
+//─────────────────────────────────────────────────────────────
+#include "rrl_wire.h"
+#include "rrl_test.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t kCount = 3, kObsFloats = 15, kStride = 80;   // 60-byte obs, 20 bytes apart
+
+RRL_SpaceDesc space(int dtype, uint32_t a, uint32_t b)
+{
+    RRL_SpaceDesc s{};
+    s.dtype    = dtype;
+    s.ndim     = b ? 2 : 1;
+    s.shape[0] = a;
+    s.shape[1] = b;
+    return s;
+}
+
+// Frames are parsed in place and must be 4-byte aligned.
+std::vector<float> frame_buffer(size_t bytes) { return std::vector<float>((bytes + 3) / 4 + 1); }
+
+} // namespace (anonymous)
+
+int main()
+{
+    const RRL_SpaceDesc obs = space(RRL_DTYPE_FLOAT32, 3, 5), act = space(RRL_DTYPE_INT32, 2, 0);
+    RRL_WireSchema schema{};
+    RRL_CHECK_EQ(rrl_wire_schema(&obs, &act, &schema), RRL_SUCCESS);
+    RRL_CHECK_EQ(schema.obs_bytes, kObsFloats * sizeof(float));
+    RRL_CHECK_EQ(schema.action_bytes, 2 * sizeof(int32_t));
+    RRL_WireSchema back{};
+    RRL_CHECK_EQ(rrl_wire_read_schema(&schema, sizeof(schema), &back), RRL_SUCCESS);
+    RRL_CHECK(std::memcmp(&back, &schema, sizeof(schema)) == 0);
+
+    // STEP: strided observations come back dense.
+    std::vector<unsigned char> src(kCount * kStride, 0xEE);
+    for (size_t e = 0; e < kCount; ++e)
+        for (size_t i = 0; i < kObsFloats; ++i) {
+            const float v = static_cast<float>(e * 100 + i);
+            std::memcpy(src.data() + e * kStride + i * sizeof(float), &v, sizeof(v));
+        }
+    const float   rewards[kCount] = {0.5f, -1.f, 2.f};
+    const uint8_t dones[kCount]   = {0, 1, 0};
+    const size_t  bytes = rrl_wire_frame_bytes(&schema, RRL_WIRE_STEP, kCount);
+    RRL_CHECK(bytes > 0);
+    std::vector<float> buf = frame_buffer(bytes);
+    RRL_CHECK_EQ(rrl_wire_write_step(&schema, 42, kCount, src.data(), kStride, rewards, dones,
+                                     buf.data(), bytes - 1), size_t(0));
+    RRL_CHECK_EQ(rrl_last_error(), RRL_ERR_INVALID_ARGUMENT);
+    RRL_CHECK_EQ(rrl_wire_write_step(&schema, 42, kCount, src.data(), kStride, rewards, dones,
+                                     buf.data(), bytes), bytes);
+
+    RRL_WireFrame f{};
+    RRL_CHECK_EQ(rrl_wire_parse(&schema, buf.data(), bytes, &f), RRL_SUCCESS);
+    RRL_CHECK_EQ(f.header.kind, RRL_WIRE_STEP);
+    RRL_CHECK_EQ(f.header.seq, 42u);
+    RRL_CHECK_EQ(f.header.count, kCount);
+    RRL_CHECK(std::memcmp(f.rewards, rewards, sizeof(rewards)) == 0);
+    RRL_CHECK(std::memcmp(f.dones, dones, sizeof(dones)) == 0);
+    RRL_CHECK_EQ(reinterpret_cast<uintptr_t>(f.tensors) % RRL_WIRE_ALIGN,
+                 reinterpret_cast<uintptr_t>(buf.data()) % RRL_WIRE_ALIGN);
+    auto dense_obs = [&](const void* t) {
+        int wrong = 0;
+        for (size_t e = 0; e < kCount; ++e)
+            wrong += std::memcmp(static_cast<const unsigned char*>(t) + e * schema.obs_bytes,
+                                 src.data() + e * kStride, schema.obs_bytes) != 0;
+        return wrong == 0;
+    };
+    RRL_CHECK(dense_obs(f.tensors));
+    RRL_CHECK(rrl_wire_parse(&schema, buf.data(), bytes - 4, &f) != RRL_SUCCESS);
+
+    // NULL rewards / dones encode as zeros.
+    RRL_CHECK_EQ(rrl_wire_write_step(&schema, 1, kCount, src.data(), kStride, nullptr, nullptr,
+                                     buf.data(), bytes), bytes);
+    RRL_CHECK_EQ(rrl_wire_parse(&schema, buf.data(), bytes, &f), RRL_SUCCESS);
+    RRL_CHECK(f.rewards[0] == 0.f && f.rewards[2] == 0.f && f.dones[1] == 0);
+
+    // Layouts that overflow size_t are refused, not wrapped.
+    RRL_CHECK_EQ(rrl_wire_frame_bytes(&schema, RRL_WIRE_STEP, SIZE_MAX / 4), size_t(0));
+    RRL_CHECK_EQ(rrl_wire_write_step(&schema, 0, SIZE_MAX / 4, src.data(), 0, nullptr, nullptr,
+                                     buf.data(), bytes), size_t(0));
+
+    // ACTION
+    const int32_t actions[kCount * 2] = {1, 2, 3, 4, 5, 6};
+    const size_t  abytes = rrl_wire_frame_bytes(&schema, RRL_WIRE_ACTION, kCount);
+    std::vector<float> abuf = frame_buffer(abytes);
+    RRL_CHECK_EQ(rrl_wire_write_action(&schema, 42, kCount, actions, 0, abuf.data(), abytes), abytes);
+    RRL_CHECK_EQ(rrl_wire_parse(&schema, abuf.data(), abytes, &f), RRL_SUCCESS);
+    RRL_CHECK_EQ(f.header.kind, RRL_WIRE_ACTION);
+    RRL_CHECK(f.rewards == nullptr && f.dones == nullptr);
+    RRL_CHECK(std::memcmp(f.tensors, actions, sizeof(actions)) == 0);
+
+    // The plain codec round-trips the same frame.
+    RRL_WireCodecConfig cfg{};
+    cfg.struct_size = sizeof(cfg);
+    cfg.compression = RRL_WIRE_COMP_NONE;
+    RRLWireCodec w = rrl_wire_codec_create(&schema, &cfg), r = rrl_wire_codec_create(&schema, &cfg);
+    RRL_CHECK(w != nullptr && r != nullptr);
+    if (w && r) {
+        std::vector<float> cbuf = frame_buffer(rrl_wire_codec_bound(w, kCount));
+        const size_t n = rrl_wire_codec_write_step(w, 7, kCount, src.data(), kStride, rewards, dones,
+                                                   cbuf.data(), cbuf.size() * sizeof(float));
+        RRL_CHECK(n > 0);
+        RRL_CHECK_EQ(rrl_wire_codec_read(r, cbuf.data(), n, &f), RRL_SUCCESS);
+        RRL_CHECK_EQ(f.header.seq, 7u);
+        RRL_CHECK(dense_obs(f.tensors));
+        RRL_CHECK(std::memcmp(f.rewards, rewards, sizeof(rewards)) == 0);
+    }
+    rrl_wire_codec_destroy(w);
+    rrl_wire_codec_destroy(r);
+    return rrl_test::failures();
+}